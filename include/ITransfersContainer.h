@@ -104,6 +104,11 @@ public:
   virtual std::vector<TransactionOutputInformation> getTransactionInputs(const Crypto::Hash& transactionHash, uint32_t flags) const = 0;
   virtual void getUnconfirmedTransactions(std::vector<Crypto::Hash>& transactions) const = 0;
   virtual std::vector<TransactionSpentOutputInformation> getSpentOutputs() const = 0;
+
+  // Random access to the outputs matching IncludeKeyUnlocked, so that callers can sample them without copying all of them.
+  // Indexes stay valid only until the container is changed.
+  virtual size_t getUnlockedOutputsCount() const = 0;
+  virtual bool getUnlockedOutput(size_t index, TransactionOutputInformation& output) const = 0;
 };
 
 }
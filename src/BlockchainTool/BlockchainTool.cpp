@@ -0,0 +1,364 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include "Common/CommandLine.h"
+#include "Common/ScopeExit.h"
+#include "Common/SignalHandler.h"
+#include "Common/StringTools.h"
+#include "Common/Util.h"
+#include "crypto/hash.h"
+#include "CryptoNoteCore/BootstrapFile.h"
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/DatabaseBlockchainCache.h"
+#include "CryptoNoteCore/DatabaseBlockchainCacheFactory.h"
+#include "CryptoNoteCore/MainChainStorage.h"
+#include "CryptoNoteCore/RocksDBWrapper.h"
+#include "Logging/ConsoleLogger.h"
+#include "Logging/LoggerRef.h"
+#include "version.h"
+
+using namespace CryptoNote;
+using namespace Logging;
+
+namespace po = boost::program_options;
+
+namespace {
+
+const command_line::arg_descriptor<std::string> arg_export_file = {"export", "Export the main chain to the bootstrap file", ""};
+const command_line::arg_descriptor<std::string> arg_import_file = {"import", "Import blocks from the bootstrap file", ""};
+const command_line::arg_descriptor<uint32_t>    arg_chunk_size  = {"chunk-size", "Number of blocks in a bootstrap file chunk", 1000};
+const command_line::arg_descriptor<uint32_t>    arg_threads     = {"threads", "Number of threads preparing blocks for import, 0 - use all cores", 0};
+const command_line::arg_descriptor<std::vector<std::string>> arg_checkpoints = {"checkpoint", "Trust blocks up to this checkpoint, "
+  "format is index:hash. Proof of work and ring signatures are verified above the highest checkpoint only"};
+const command_line::arg_descriptor<int>         arg_log_level   = {"log-level", "", 2}; // info level
+const command_line::arg_descriptor<bool>        arg_testnet_on  = {"testnet", "Use testnet currency, hardcoded checkpoints are ignored", false};
+
+// Chunks prepared ahead of the one being imported, bounds memory held by the import pipeline
+const size_t PREPARED_CHUNKS_PER_THREAD = 2;
+
+struct PreparedChunk {
+  std::vector<RawBlock> rawBlocks;
+  std::vector<BlockTemplate> blocks;
+  std::vector<CachedBlock> cachedBlocks;
+  std::exception_ptr error;
+};
+
+std::atomic<bool> stopRequested(false);
+
+void addCheckpoints(Checkpoints& checkpoints, const std::vector<std::string>& values) {
+  for (const auto& value : values) {
+    auto separator = value.find(':');
+    uint32_t index;
+    if (separator == std::string::npos || !Common::fromString(value.substr(0, separator), index) ||
+        !checkpoints.addCheckpoint(index, value.substr(separator + 1))) {
+      throw std::runtime_error("Invalid checkpoint: " + value);
+    }
+  }
+}
+
+// Deserializes block headers and computes their hashes. Proof of work hash is cached in CachedBlock,
+// so computing it here for blocks above the checkpoint zone takes it off the importing thread.
+std::unique_ptr<PreparedChunk> prepareChunk(BootstrapFileReader& reader, size_t chunkIndex, uint32_t verifyFromIndex,
+  Crypto::cn_context& cryptoContext) {
+
+  std::unique_ptr<PreparedChunk> chunk(new PreparedChunk());
+  try {
+    uint32_t startIndex = reader.getChunks()[chunkIndex].startIndex;
+    chunk->rawBlocks = reader.readChunk(chunkIndex);
+    chunk->blocks.resize(chunk->rawBlocks.size());
+    chunk->cachedBlocks.reserve(chunk->rawBlocks.size());
+
+    for (size_t i = 0; i < chunk->rawBlocks.size(); ++i) {
+      if (!fromBinaryArray(chunk->blocks[i], chunk->rawBlocks[i].block)) {
+        throw std::runtime_error("Couldn't deserialize block " + std::to_string(startIndex + i));
+      }
+
+      chunk->cachedBlocks.emplace_back(chunk->blocks[i]);
+      const CachedBlock& cachedBlock = chunk->cachedBlocks.back();
+      cachedBlock.getBlockHash();
+      if (startIndex + i >= verifyFromIndex) {
+        cachedBlock.getBlockLongHash(cryptoContext);
+      }
+    }
+  } catch (...) {
+    chunk->error = std::current_exception();
+  }
+
+  return chunk;
+}
+
+void exportBlocks(const Currency& currency, const std::string& dataDir, const std::string& path, uint32_t chunkSize, LoggerRef& logger) {
+  auto mainChainStorage = createSwappedMainChainStorage(dataDir, currency);
+  uint32_t blockCount = mainChainStorage->getBlockCount();
+  if (blockCount == 0) {
+    throw std::runtime_error("Blockchain in " + dataDir + " is empty");
+  }
+
+  logger(INFO) << "Exporting " << blockCount << " blocks to " << path;
+
+  BootstrapFileWriter writer(path, currency.genesisBlockHash(), chunkSize);
+  for (uint32_t index = 0; index < blockCount && !stopRequested; ++index) {
+    writer.pushBlock(mainChainStorage->getBlockByIndex(index));
+    if ((index + 1) % chunkSize == 0) {
+      logger(INFO) << "Exported " << index + 1 << " of " << blockCount << " blocks";
+    }
+  }
+
+  writer.finish();
+  logger(INFO, BRIGHT_GREEN) << "Exported " << writer.getBlockCount() << " blocks";
+}
+
+void importBlocks(Core& core, const Currency& currency, const std::string& path, uint32_t verifyFromIndex, size_t threadCount, LoggerRef& logger) {
+  BootstrapFileReader reader(path);
+  if (reader.getGenesisBlockHash() != currency.genesisBlockHash()) {
+    throw std::runtime_error("Bootstrap file " + path + " was made for another network, genesis block " +
+      Common::podToHex(reader.getGenesisBlockHash()));
+  }
+
+  uint32_t startIndex = core.getTopBlockIndex() + 1;
+  size_t firstChunk = reader.findChunk(startIndex);
+  if (firstChunk == reader.getChunks().size()) {
+    logger(INFO) << "Blockchain already contains all " << reader.getBlockCount() << " blocks of " << path;
+    return;
+  }
+
+  logger(INFO) << "Importing blocks " << startIndex << " - " << reader.getBlockCount() - 1 << " using " << threadCount << " threads";
+
+  const size_t chunkCount = reader.getChunks().size();
+  const size_t preparedChunksLimit = threadCount * PREPARED_CHUNKS_PER_THREAD;
+
+  std::mutex mutex;
+  std::condition_variable chunksChanged;
+  std::map<size_t, std::unique_ptr<PreparedChunk>> preparedChunks;
+  size_t nextChunk = firstChunk;
+  size_t importedChunk = firstChunk;
+  bool stopWorkers = false;
+
+  std::vector<std::thread> workers;
+  Tools::ScopeExit joinWorkers([&] {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      stopWorkers = true;
+    }
+
+    chunksChanged.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  });
+
+  for (size_t i = 0; i < threadCount; ++i) {
+    workers.emplace_back([&] {
+      Crypto::cn_context cryptoContext;
+      for (;;) {
+        size_t chunkIndex;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          chunksChanged.wait(lock, [&] { return stopWorkers || nextChunk == chunkCount || nextChunk < importedChunk + preparedChunksLimit; });
+          if (stopWorkers || nextChunk == chunkCount) {
+            return;
+          }
+
+          chunkIndex = nextChunk++;
+        }
+
+        auto chunk = prepareChunk(reader, chunkIndex, verifyFromIndex, cryptoContext);
+
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          preparedChunks.emplace(chunkIndex, std::move(chunk));
+        }
+
+        chunksChanged.notify_all();
+      }
+    });
+  }
+
+  uint32_t importedBlocks = 0;
+  for (size_t chunkIndex = firstChunk; chunkIndex < chunkCount && !stopRequested; ++chunkIndex) {
+    std::unique_ptr<PreparedChunk> chunk;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      chunksChanged.wait(lock, [&] { return preparedChunks.count(chunkIndex) != 0; });
+      auto it = preparedChunks.find(chunkIndex);
+      chunk = std::move(it->second);
+      preparedChunks.erase(it);
+      importedChunk = chunkIndex + 1;
+    }
+
+    chunksChanged.notify_all();
+    if (chunk->error) {
+      std::rethrow_exception(chunk->error);
+    }
+
+    uint32_t blockIndex = reader.getChunks()[chunkIndex].startIndex;
+    for (size_t i = 0; i < chunk->cachedBlocks.size(); ++i, ++blockIndex) {
+      if (blockIndex < startIndex) {
+        continue;
+      }
+
+      auto result = core.addBlock(chunk->cachedBlocks[i], std::move(chunk->rawBlocks[i]));
+      if (result != error::AddBlockErrorCode::ADDED_TO_MAIN) {
+        throw std::runtime_error("Failed to import block " + std::to_string(blockIndex) + ": " + result.message());
+      }
+
+      ++importedBlocks;
+    }
+
+    logger(INFO) << "Imported " << blockIndex << " of " << reader.getBlockCount() << " blocks";
+  }
+
+  logger(INFO, BRIGHT_GREEN) << "Imported " << importedBlocks << " blocks, top block index " << core.getTopBlockIndex();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  ConsoleLogger consoleLogger;
+  LoggerRef logger(consoleLogger, "BlockchainTool");
+
+  try {
+    po::options_description desc_options("Allowed options");
+    command_line::add_arg(desc_options, command_line::arg_help);
+    command_line::add_arg(desc_options, command_line::arg_version);
+    command_line::add_arg(desc_options, command_line::arg_data_dir, Tools::getDefaultDataDirectory());
+    command_line::add_arg(desc_options, arg_export_file);
+    command_line::add_arg(desc_options, arg_import_file);
+    command_line::add_arg(desc_options, arg_chunk_size);
+    command_line::add_arg(desc_options, arg_threads);
+    command_line::add_arg(desc_options, arg_checkpoints);
+    command_line::add_arg(desc_options, arg_log_level);
+    command_line::add_arg(desc_options, arg_testnet_on);
+    DataBaseConfig::initOptions(desc_options);
+
+    po::variables_map vm;
+    bool r = command_line::handle_error_helper(desc_options, [&]() {
+      po::store(po::parse_command_line(argc, argv, desc_options), vm);
+      po::notify(vm);
+      return true;
+    });
+
+    if (!r) {
+      return 1;
+    }
+
+    if (command_line::get_arg(vm, command_line::arg_help) || command_line::get_arg(vm, command_line::arg_version)) {
+      std::cout << CryptoNote::CRYPTONOTE_NAME << " v" << PROJECT_VERSION_LONG << std::endl;
+      if (command_line::get_arg(vm, command_line::arg_help)) {
+        std::cout << desc_options << std::endl;
+      }
+
+      return 0;
+    }
+
+    std::string exportFile = command_line::get_arg(vm, arg_export_file);
+    std::string importFile = command_line::get_arg(vm, arg_import_file);
+    if (exportFile.empty() == importFile.empty()) {
+      std::cout << "Specify either --" << arg_export_file.name << " or --" << arg_import_file.name << std::endl << desc_options << std::endl;
+      return 1;
+    }
+
+    uint32_t chunkSize = command_line::get_arg(vm, arg_chunk_size);
+    if (chunkSize == 0) {
+      throw std::runtime_error("Chunk size must be positive");
+    }
+
+    consoleLogger.setMaxLevel(static_cast<Level>(static_cast<int>(Logging::ERROR) + command_line::get_arg(vm, arg_log_level)));
+
+    bool testnet = command_line::get_arg(vm, arg_testnet_on);
+    std::string dataDir = command_line::get_arg(vm, command_line::arg_data_dir);
+
+    CurrencyBuilder currencyBuilder(consoleLogger);
+    currencyBuilder.testnet(testnet);
+    Currency currency = currencyBuilder.currency();
+
+    Tools::SignalHandler::install([] { stopRequested = true; });
+
+    if (!exportFile.empty()) {
+      exportBlocks(currency, dataDir, exportFile, chunkSize, logger);
+      return 0;
+    }
+
+    Checkpoints checkpoints(consoleLogger);
+    if (!testnet) {
+      for (const auto& cp : CryptoNote::CHECKPOINTS) {
+        checkpoints.addCheckpoint(cp.index, cp.blockId);
+      }
+    }
+
+    addCheckpoints(checkpoints, command_line::get_arg(vm, arg_checkpoints));
+    auto checkpointHeights = checkpoints.getCheckpointHeights();
+    uint32_t verifyFromIndex = checkpointHeights.empty() ? 0 : *std::max_element(checkpointHeights.begin(), checkpointHeights.end()) + 1;
+
+    size_t threadCount = command_line::get_arg(vm, arg_threads);
+    if (threadCount == 0) {
+      threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    DataBaseConfig dbConfig;
+    dbConfig.init(vm);
+    if (!Tools::create_directories_if_necessary(dbConfig.getDataDir())) {
+      throw std::runtime_error("Can't create directory: " + dbConfig.getDataDir());
+    }
+
+    RocksDBWrapper database(consoleLogger);
+    database.init(dbConfig);
+    Tools::ScopeExit dbShutdownOnExit([&database] () { database.shutdown(); });
+
+    if (!DatabaseBlockchainCache::checkDBSchemeVersion(database, consoleLogger)) {
+      dbShutdownOnExit.cancel();
+      database.shutdown();
+
+      database.destoy(dbConfig);
+
+      database.init(dbConfig);
+      dbShutdownOnExit.resume();
+    }
+
+    System::Dispatcher dispatcher;
+    Core core(
+      currency,
+      consoleLogger,
+      std::move(checkpoints),
+      dispatcher,
+      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, consoleLogger)),
+      createSwappedMainChainStorage(dataDir, currency),
+      dataDir);
+
+    core.load();
+    importBlocks(core, currency, importFile, verifyFromIndex, threadCount, logger);
+    core.save();
+  } catch (const std::exception& e) {
+    logger(ERROR, BRIGHT_RED) << "Exception: " << e.what();
+    return 1;
+  }
+
+  return 0;
+}
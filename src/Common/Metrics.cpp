@@ -0,0 +1,314 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Metrics.h"
+
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+namespace Common {
+
+namespace {
+
+// Exported bucket bounds: 2^3 us (8 us) to 2^25 us (~33.5 s).
+const size_t EXPORTED_MIN_POWER = 3;
+const size_t EXPORTED_MAX_POWER = 25;
+
+std::atomic<size_t> nextShardIndex(0);
+
+size_t currentShardIndex() {
+  thread_local size_t shardIndex = nextShardIndex.fetch_add(1, std::memory_order_relaxed) % MetricHistogram::SHARD_COUNT;
+  return shardIndex;
+}
+
+size_t highestBit(uint64_t value) {
+  size_t bit = 0;
+  while (value >>= 1) {
+    ++bit;
+  }
+
+  return bit;
+}
+
+std::string escapeLabelValue(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
+std::string formatLabels(const MetricLabels& labels) {
+  std::string formatted;
+  for (const auto& label : labels) {
+    if (!formatted.empty()) {
+      formatted += ',';
+    }
+
+    formatted += label.first + "=\"" + escapeLabelValue(label.second) + '"';
+  }
+
+  return formatted;
+}
+
+std::string withLabels(const std::string& labels, const std::string& extra) {
+  if (labels.empty() && extra.empty()) {
+    return std::string();
+  }
+
+  if (labels.empty() || extra.empty()) {
+    return '{' + labels + extra + '}';
+  }
+
+  return '{' + labels + ',' + extra + '}';
+}
+
+std::string formatSeconds(uint64_t microseconds) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(microseconds) / 1000000.0);
+  return buffer;
+}
+
+}
+
+MetricCounter::MetricCounter() : m_value(0) {
+}
+
+MetricGauge::MetricGauge() : m_value(0) {
+}
+
+MetricHistogram::MetricHistogram() : shards(new Shard[SHARD_COUNT]) {
+  for (size_t i = 0; i < SHARD_COUNT; ++i) {
+    for (auto& bucket : shards[i].buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+
+    shards[i].sum.store(0, std::memory_order_relaxed);
+  }
+}
+
+void MetricHistogram::observe(uint64_t microseconds) {
+  Shard& shard = shards[currentShardIndex()];
+  shard.buckets[bucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(microseconds, std::memory_order_relaxed);
+}
+
+void MetricHistogram::observe(std::chrono::steady_clock::duration duration) {
+  auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  observe(microseconds > 0 ? static_cast<uint64_t>(microseconds) : 0);
+}
+
+MetricHistogram::Snapshot MetricHistogram::snapshot() const {
+  Snapshot result;
+  result.buckets.assign(BUCKET_COUNT, 0);
+  result.count = 0;
+  result.sum = 0;
+
+  for (size_t i = 0; i < SHARD_COUNT; ++i) {
+    for (size_t j = 0; j < BUCKET_COUNT; ++j) {
+      uint64_t bucket = shards[i].buckets[j].load(std::memory_order_relaxed);
+      result.buckets[j] += bucket;
+      result.count += bucket;
+    }
+
+    result.sum += shards[i].sum.load(std::memory_order_relaxed);
+  }
+
+  return result;
+}
+
+// Bucket i holds the values in (bucketUpperBound(i - 1), bucketUpperBound(i)], so that power-of-two
+// bounds match the "less than or equal" semantics of Prometheus buckets exactly.
+size_t MetricHistogram::bucketIndex(uint64_t value) {
+  uint64_t shifted = value > 0 ? value - 1 : 0;
+  if (shifted < SUB_BUCKET_COUNT) {
+    return static_cast<size_t>(shifted);
+  }
+
+  size_t power = highestBit(shifted);
+  if (power > MAX_POWER) {
+    return BUCKET_COUNT - 1;
+  }
+
+  size_t subBucket = static_cast<size_t>(shifted >> (power - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+  return (power - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t MetricHistogram::bucketUpperBound(size_t index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index + 1;
+  }
+
+  size_t power = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+  uint64_t subBucket = index % SUB_BUCKET_COUNT;
+  return ((SUB_BUCKET_COUNT + subBucket + 1) << (power - SUB_BUCKET_BITS));
+}
+
+uint64_t MetricHistogram::Snapshot::countNotGreaterThan(uint64_t value) const {
+  uint64_t result = 0;
+  for (size_t i = 0; i < buckets.size() && bucketUpperBound(i) <= value; ++i) {
+    result += buckets[i];
+  }
+
+  return result;
+}
+
+uint64_t MetricHistogram::Snapshot::valueAtQuantile(double quantile) const {
+  if (count == 0) {
+    return 0;
+  }
+
+  uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(count));
+  if (rank >= count) {
+    rank = count - 1;
+  }
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen > rank) {
+      return bucketUpperBound(i);
+    }
+  }
+
+  return bucketUpperBound(buckets.size() - 1);
+}
+
+MetricTimer::MetricTimer(MetricHistogram& histogram) : histogram(&histogram), start(std::chrono::steady_clock::now()) {
+}
+
+MetricTimer::~MetricTimer() {
+  stop();
+}
+
+void MetricTimer::stop() {
+  if (histogram != nullptr) {
+    histogram->observe(std::chrono::steady_clock::now() - start);
+    histogram = nullptr;
+  }
+}
+
+MetricsRegistry::MetricsRegistry() {
+}
+
+MetricsRegistry::~MetricsRegistry() {
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& metric = getFamily(name, help, Type::COUNTER).counters[formatLabels(labels)];
+  if (!metric) {
+    metric.reset(new MetricCounter());
+  }
+
+  return *metric;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& metric = getFamily(name, help, Type::GAUGE).gauges[formatLabels(labels)];
+  if (!metric) {
+    metric.reset(new MetricGauge());
+  }
+
+  return *metric;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const MetricLabels& labels) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& metric = getFamily(name, help, Type::HISTOGRAM).histograms[formatLabels(labels)];
+  if (!metric) {
+    metric.reset(new MetricHistogram());
+  }
+
+  return *metric;
+}
+
+MetricsRegistry::Family& MetricsRegistry::getFamily(const std::string& name, const std::string& help, Type type) {
+  auto it = families.find(name);
+  if (it == families.end()) {
+    Family family;
+    family.type = type;
+    family.help = help;
+    it = families.emplace(name, std::move(family)).first;
+  } else if (it->second.type != type) {
+    throw std::runtime_error("MetricsRegistry::getFamily, metric " + name + " is already registered with another type");
+  }
+
+  return it->second;
+}
+
+std::string MetricsRegistry::exportPrometheus() const {
+  std::ostringstream out;
+  std::lock_guard<std::mutex> lock(mutex);
+
+  for (const auto& familyPair : families) {
+    const std::string& name = familyPair.first;
+    const Family& family = familyPair.second;
+
+    out << "# HELP " << name << ' ' << family.help << '\n';
+    switch (family.type) {
+    case Type::COUNTER:
+      out << "# TYPE " << name << " counter\n";
+      for (const auto& metric : family.counters) {
+        out << name << withLabels(metric.first, "") << ' ' << metric.second->get() << '\n';
+      }
+      break;
+    case Type::GAUGE:
+      out << "# TYPE " << name << " gauge\n";
+      for (const auto& metric : family.gauges) {
+        out << name << withLabels(metric.first, "") << ' ' << metric.second->get() << '\n';
+      }
+      break;
+    case Type::HISTOGRAM:
+      out << "# TYPE " << name << " histogram\n";
+      for (const auto& metric : family.histograms) {
+        auto snapshot = metric.second->snapshot();
+        for (size_t power = EXPORTED_MIN_POWER; power <= EXPORTED_MAX_POWER; ++power) {
+          uint64_t bound = uint64_t(1) << power;
+          out << name << "_bucket" << withLabels(metric.first, "le=\"" + formatSeconds(bound) + '"') << ' ' <<
+            snapshot.countNotGreaterThan(bound) << '\n';
+        }
+
+        out << name << "_bucket" << withLabels(metric.first, "le=\"+Inf\"") << ' ' << snapshot.count << '\n';
+        out << name << "_sum" << withLabels(metric.first, "") << ' ' << formatSeconds(snapshot.sum) << '\n';
+        out << name << "_count" << withLabels(metric.first, "") << ' ' << snapshot.count << '\n';
+      }
+      break;
+    }
+  }
+
+  return out.str();
+}
+
+MetricsRegistry& metrics() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Common {
+
+typedef std::vector<std::pair<std::string, std::string>> MetricLabels;
+
+class MetricCounter {
+public:
+  MetricCounter();
+
+  void add(uint64_t value = 1) {
+    m_value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t get() const {
+    return m_value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> m_value;
+};
+
+class MetricGauge {
+public:
+  MetricGauge();
+
+  void set(int64_t value) {
+    m_value.store(value, std::memory_order_relaxed);
+  }
+
+  void add(int64_t value) {
+    m_value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  int64_t get() const {
+    return m_value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> m_value;
+};
+
+// Latency histogram with HDR-style log-linear buckets: every power of two of microseconds is split into
+// SUB_BUCKET_COUNT buckets, so any value is kept with 25% relative precision. Observations go to one of
+// SHARD_COUNT stripes picked per thread, so concurrent writers don't contend on the same cache lines.
+class MetricHistogram {
+public:
+  static const size_t SUB_BUCKET_BITS = 2;
+  static const size_t SUB_BUCKET_COUNT = size_t(1) << SUB_BUCKET_BITS;
+  static const size_t MAX_POWER = 36;
+  static const size_t BUCKET_COUNT = (MAX_POWER - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT;
+  static const size_t SHARD_COUNT = 8;
+
+  struct Snapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count;
+    uint64_t sum;
+
+    // Number of observations less than or equal to value; exact when value is a power of two.
+    uint64_t countNotGreaterThan(uint64_t value) const;
+    // Upper bound of the bucket holding the given quantile, in microseconds.
+    uint64_t valueAtQuantile(double quantile) const;
+  };
+
+  MetricHistogram();
+
+  void observe(uint64_t microseconds);
+  void observe(std::chrono::steady_clock::duration duration);
+  Snapshot snapshot() const;
+
+  static size_t bucketIndex(uint64_t value);
+  static uint64_t bucketUpperBound(size_t index);
+
+private:
+  struct Shard {
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets;
+    std::atomic<uint64_t> sum;
+    char padding[64];
+  };
+
+  std::unique_ptr<Shard[]> shards;
+};
+
+// Observes the time elapsed since construction, either when stop() is called or on destruction.
+class MetricTimer {
+public:
+  explicit MetricTimer(MetricHistogram& histogram);
+  ~MetricTimer();
+
+  MetricTimer(const MetricTimer&) = delete;
+  MetricTimer& operator=(const MetricTimer&) = delete;
+
+  void stop();
+
+private:
+  MetricHistogram* histogram;
+  std::chrono::steady_clock::time_point start;
+};
+
+class MetricsRegistry {
+public:
+  MetricsRegistry();
+  ~MetricsRegistry();
+
+  // Returns the metric registered under the name and labels, creating it on first use. References stay
+  // valid for the lifetime of the registry, so hot paths should look metrics up once and keep them.
+  MetricCounter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = MetricLabels());
+  MetricGauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = MetricLabels());
+  MetricHistogram& histogram(const std::string& name, const std::string& help, const MetricLabels& labels = MetricLabels());
+
+  // Prometheus text exposition format, version 0.0.4. Histograms are reported in seconds.
+  std::string exportPrometheus() const;
+
+private:
+  enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<MetricCounter>> counters;
+    std::map<std::string, std::unique_ptr<MetricGauge>> gauges;
+    std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+  };
+
+  Family& getFamily(const std::string& name, const std::string& help, Type type);
+
+  mutable std::mutex mutex;
+  std::map<std::string, Family> families;
+};
+
+// Process-wide registry exported by the daemon's /metrics endpoint.
+MetricsRegistry& metrics();
+
+}
@@ -79,6 +79,9 @@ const uint64_t CRYPTONOTE_LOCKED_TX_ALLOWED_DELTA_SECONDS    = DIFFICULTY_TARGET
 const uint64_t CRYPTONOTE_MEMPOOL_TX_LIVETIME                = 60 * 60 * 24;
 const uint64_t CRYPTONOTE_MEMPOOL_TX_FROM_ALT_BLOCK_LIVETIME = 60 * 60 * 24 * 7;
 const uint64_t CRYPTONOTE_NUMBER_OF_PERIODS_TO_FORGET_TX_DELETED_FROM_POOL = 7;
+const uint64_t CRYPTONOTE_MEMPOOL_MAX_SIZE                   = 128 * 1024 * 1024;
+const uint64_t CRYPTONOTE_MEMPOOL_MIN_FEE_HALF_LIFE          = 60 * 60 * 12;
+const uint64_t CRYPTONOTE_MEMPOOL_INCREMENTAL_FEE_PER_KB     = UINT64_C(100000);   // added to the fee rate of evicted transactions
 
 const size_t   FUSION_TX_MAX_SIZE                            = CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE_CURRENT * 15 / 100;
 const size_t   FUSION_TX_MIN_INPUT_COUNT                     = 12;
@@ -129,6 +132,11 @@ const int      RPC_DEFAULT_PORT                              =  26081;
 
 const size_t   P2P_LOCAL_WHITE_PEERLIST_LIMIT                =  1000;
 const size_t   P2P_LOCAL_GRAY_PEERLIST_LIMIT                 =  5000;
+const size_t   P2P_MAX_GRAY_PEERS_PER_BUCKET                 =  64;     // per /16 network
+const size_t   P2P_MAX_OUTGOING_CONNECTIONS_PER_BUCKET       =  2;
+const uint32_t P2P_MAX_PEER_CONNECT_FAILURES                 =  3;
+const uint32_t P2P_FAILED_PEER_BASE_BACKOFF                  =  60;     // seconds
+const uint32_t P2P_FAILED_PEER_MAX_BACKOFF                   =  60 * 60 * 4; // seconds
 
 const size_t   P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE          = 64 * 1024 * 1024; // 64 MB
 const uint32_t P2P_DEFAULT_CONNECTIONS_COUNT                 = 8;
@@ -140,6 +148,10 @@ const uint32_t P2P_DEFAULT_CONNECTION_TIMEOUT                = 5000;          //
 const uint32_t P2P_DEFAULT_PING_CONNECTION_TIMEOUT           = 2000;          // 2 seconds
 const uint64_t P2P_DEFAULT_INVOKE_TIMEOUT                    = 60 * 2 * 1000; // 2 minutes
 const size_t   P2P_DEFAULT_HANDSHAKE_INVOKE_TIMEOUT          = 5000;          // 5 seconds
+const uint32_t P2P_TRANSACTION_ANNOUNCE_INTERVAL             = 500;           // milliseconds
+const size_t   P2P_MAX_TRANSACTION_ANNOUNCE_COUNT            = 5000;          // hashes per announcement
+const size_t   P2P_MAX_KNOWN_TRANSACTIONS_PER_PEER           = 50000;
+const uint32_t P2P_TRANSACTION_REQUEST_TIMEOUT               = 30;            // seconds
 const char     P2P_STAT_TRUSTED_PUB_KEY[]                    = "db9eabe971890012a4071a96468155c2c360f80d18e73caa97bffd3b7381eed7";
 
 const char* const SEED_NODES[] = {
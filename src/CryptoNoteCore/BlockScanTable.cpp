@@ -0,0 +1,101 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "BlockScanTable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include "CachedBlock.h"
+#include "CachedTransaction.h"
+#include "CryptoNoteSerialization.h"
+#include "CryptoNoteTools.h"
+#include "IBlockchainCache.h"
+#include "TransactionExtra.h"
+#include "Common/StringTools.h"
+#include "Serialization/SerializationOverloads.h"
+
+namespace CryptoNote {
+
+void ScanTableTransaction::serialize(ISerializer& s) {
+  s(transactionHash, "hash");
+  s(transactionPublicKey, "public_key");
+  s(unlockTime, "unlock_time");
+  serializeAsBinary(keyImages, "key_images", s);
+  serializeAsBinary(outputs, "outputs", s);
+}
+
+void BlockScanTable::serialize(ISerializer& s) {
+  s(blockHash, "hash");
+  s(timestamp, "timestamp");
+  s(transactions, "transactions");
+}
+
+ScanTableTransaction makeScanTableTransaction(const CachedTransaction& cachedTransaction, const std::vector<uint32_t>& globalIndexes) {
+  const auto& transaction = cachedTransaction.getTransactionPrefix();
+  assert(globalIndexes.size() == transaction.outputs.size());
+
+  ScanTableTransaction entry;
+  entry.transactionHash = cachedTransaction.getTransactionHash();
+  entry.transactionPublicKey = getTransactionPublicKeyFromExtra(transaction.extra);
+  entry.unlockTime = transaction.unlockTime;
+
+  for (const auto& input : transaction.inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      entry.keyImages.push_back(boost::get<KeyInput>(input).keyImage);
+    }
+  }
+
+  for (size_t i = 0; i < transaction.outputs.size(); ++i) {
+    const auto& output = transaction.outputs[i];
+    if (output.target.type() == typeid(KeyOutput)) {
+      entry.outputs.push_back({boost::get<KeyOutput>(output.target).key, output.amount, globalIndexes[i], static_cast<uint16_t>(i)});
+    }
+  }
+
+  return entry;
+}
+
+BlockScanTable makeBlockScanTable(const IBlockchainCache& segment, uint32_t blockIndex) {
+  RawBlock rawBlock = segment.getBlockByIndex(blockIndex);
+  BlockTemplate block = fromBinaryArray<BlockTemplate>(rawBlock.block);
+  CachedBlock cachedBlock(block);
+
+  BlockScanTable table;
+  table.blockHash = cachedBlock.getBlockHash();
+  table.timestamp = block.timestamp;
+  table.transactions.reserve(rawBlock.transactions.size() + 1);
+
+  auto pushTransaction = [&segment, &table] (const CachedTransaction& transaction) {
+    std::vector<uint32_t> globalIndexes;
+    if (!segment.getTransactionGlobalIndexes(transaction.getTransactionHash(), globalIndexes)) {
+      throw std::runtime_error("Couldn't get global indexes of transaction " + Common::podToHex(transaction.getTransactionHash()));
+    }
+
+    table.transactions.push_back(makeScanTableTransaction(transaction, globalIndexes));
+  };
+
+  pushTransaction(CachedTransaction(block.baseTransaction));
+  for (const auto& rawTransaction : rawBlock.transactions) {
+    pushTransaction(CachedTransaction(rawTransaction));
+  }
+
+  return table;
+}
+
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CryptoNote.h"
+
+namespace CryptoNote {
+
+class CachedTransaction;
+class IBlockchainCache;
+class ISerializer;
+
+#pragma pack(push, 1)
+struct ScanTableOutput {
+  Crypto::PublicKey key;
+  uint64_t amount;
+  uint32_t globalIndex;
+  uint16_t outputIndex; // index within the transaction, needed to derive the output key
+};
+#pragma pack(pop)
+
+struct ScanTableTransaction {
+  Crypto::Hash transactionHash;
+  Crypto::PublicKey transactionPublicKey;
+  uint64_t unlockTime;
+  std::vector<Crypto::KeyImage> keyImages;
+  std::vector<ScanTableOutput> outputs; // key outputs only
+
+  void serialize(ISerializer& s);
+};
+
+/*
+ * Everything a wallet needs to find its outputs and spendings in a block: transaction public keys,
+ * key outputs with global indexes and spent key images. Prefixes and signatures are left out.
+ */
+struct BlockScanTable {
+  Crypto::Hash blockHash;
+  uint64_t timestamp;
+  std::vector<ScanTableTransaction> transactions; // base transaction first
+
+  void serialize(ISerializer& s);
+};
+
+ScanTableTransaction makeScanTableTransaction(const CachedTransaction& cachedTransaction, const std::vector<uint32_t>& globalIndexes);
+// Builds the table from the raw block and the output indexes the segment keeps for its transactions
+BlockScanTable makeBlockScanTable(const IBlockchainCache& segment, uint32_t blockIndex);
+
+}
@@ -27,6 +27,7 @@
 #include "Common/StdOutputStream.h"
 #include "Common/ShuffleGenerator.h"
 
+#include "CryptoNoteCore/BlockScanTable.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteSerialization.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
@@ -410,7 +411,7 @@ void BlockchainCache::pushTransaction(const CachedTransaction& cachedTransaction
                                       uint16_t transactionInBlockIndex) {
   logger(Logging::DEBUGGING) << "Adding transaction " << cachedTransaction.getTransactionHash() << " at block " << blockIndex << ", index in block " << transactionInBlockIndex;
 
-  const auto& tx = cachedTransaction.getTransaction();
+  const auto& tx = cachedTransaction.getTransactionPrefix();
 
   CachedTransactionInfo transactionCacheInfo;
   transactionCacheInfo.blockIndex = blockIndex;
@@ -1001,6 +1002,15 @@ std::vector<Crypto::Hash> BlockchainCache::getBlockHashesByTimestamps(uint64_t t
   return blockHashes;
 }
 
+BlockScanTable BlockchainCache::getBlockScanTable(uint32_t blockIndex) const {
+  if (blockIndex < startIndex) {
+    assert(parent != nullptr);
+    return parent->getBlockScanTable(blockIndex);
+  }
+
+  return makeBlockScanTable(*this, blockIndex);
+}
+
 ExtractOutputKeysResult BlockchainCache::extractKeyOtputIndexes(uint64_t amount,
                                                                 Common::ArrayView<uint32_t> globalIndexes,
                                                                 std::vector<PackedOutIndex>& outIndexes) const {
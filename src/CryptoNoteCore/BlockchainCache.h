@@ -209,6 +209,8 @@ public:
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const override;
 
+  virtual BlockScanTable getBlockScanTable(uint32_t blockIndex) const override;
+
 private:
 
   struct BlockIndexTag {};
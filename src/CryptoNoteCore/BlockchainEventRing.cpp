@@ -0,0 +1,336 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BlockchainEventRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace CryptoNote {
+
+namespace {
+
+const uint8_t RECORD_CONTINUATION = 1; // carries one more hash of the preceding message
+const uint8_t RECORD_TRUNCATED = 2;    // the message hashes were dropped
+
+const uint64_t FREE_CURSOR = std::numeric_limits<uint64_t>::max();
+
+size_t roundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+
+  return result;
+}
+
+}
+
+struct BlockchainEventRing::Record {
+  uint8_t type;
+  uint8_t flags;
+  uint8_t reason;
+  uint8_t reserved;
+  uint32_t index; // block index for block messages, common root index for chain switch
+  uint32_t topBlockIndex;
+  uint32_t hashCount;
+  Crypto::Hash hash;
+};
+
+struct BlockchainEventRing::Slot {
+  static_assert(sizeof(Record) % sizeof(uint64_t) == 0, "Record must consist of whole words");
+  static const size_t WORD_COUNT = sizeof(Record) / sizeof(uint64_t);
+
+  // 2 * sequence + 1 while the record is being written, 2 * sequence + 2 once it is complete
+  std::atomic<uint64_t> stamp;
+  std::atomic<uint64_t> words[WORD_COUNT];
+};
+
+BlockchainEventRing::BlockchainEventRing(size_t ringCapacity) :
+  capacity(roundUpToPowerOfTwo(std::max<size_t>(ringCapacity, 2))),
+  mask(capacity - 1),
+  slots(new Slot[capacity]),
+  head(0),
+  topBlockIndex(0),
+  waiters(0) {
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i].stamp.store(0, std::memory_order_relaxed);
+  }
+
+  for (auto& cursor : cursors) {
+    cursor.store(FREE_CURSOR, std::memory_order_relaxed);
+  }
+}
+
+BlockchainEventRing::~BlockchainEventRing() {
+}
+
+void BlockchainEventRing::publish(const BlockchainMessage& message, uint32_t topIndex) {
+  Record header;
+  std::memset(&header, 0, sizeof(header));
+  header.type = static_cast<uint8_t>(message.getType());
+  header.topBlockIndex = topIndex;
+
+  const std::vector<Crypto::Hash>* hashes = nullptr;
+  bool poolMessage = false;
+  switch (message.getType()) {
+  case BlockchainMessage::Type::NewBlock:
+    header.index = message.getNewBlock().blockIndex;
+    header.hash = message.getNewBlock().blockHash;
+    break;
+  case BlockchainMessage::Type::NewAlternativeBlock:
+    header.index = message.getNewAlternativeBlock().blockIndex;
+    header.hash = message.getNewAlternativeBlock().blockHash;
+    break;
+  case BlockchainMessage::Type::ChainSwitch:
+    header.index = message.getChainSwitch().commonRootIndex;
+    hashes = &message.getChainSwitch().blocksFromCommonRoot;
+    break;
+  case BlockchainMessage::Type::AddTransaction:
+    hashes = &message.getAddTransaction().hashes;
+    poolMessage = true;
+    break;
+  case BlockchainMessage::Type::DeleteTransaction:
+    header.reason = static_cast<uint8_t>(message.getDeleteTransaction().reason);
+    hashes = &message.getDeleteTransaction().hashes;
+    poolMessage = true;
+    break;
+  }
+
+  if (hashes != nullptr) {
+    size_t recordCount = std::max<size_t>(hashes->size(), 1);
+    // Lagging subscribers get hash-less pool messages rather than being overrun by them,
+    // chain messages are always published in full unless they can't fit the ring at all
+    if (recordCount > capacity || (poolMessage && recordCount > getFreeSpace())) {
+      header.flags |= RECORD_TRUNCATED;
+      hashes = nullptr;
+    } else {
+      header.hashCount = static_cast<uint32_t>(hashes->size());
+      if (!hashes->empty()) {
+        header.hash = hashes->front();
+      }
+    }
+  }
+
+  uint64_t sequence = head.load(std::memory_order_relaxed);
+  writeRecord(sequence++, header);
+  if (hashes != nullptr) {
+    Record continuation = header;
+    continuation.flags = RECORD_CONTINUATION;
+    for (size_t i = 1; i < hashes->size(); ++i) {
+      continuation.hash = (*hashes)[i];
+      writeRecord(sequence++, continuation);
+    }
+  }
+
+  topBlockIndex.store(topIndex, std::memory_order_relaxed);
+  // Messages become visible only as a whole, so subscribers never wait in the middle of one
+  head.store(sequence);
+  wakeWaiters();
+}
+
+size_t BlockchainEventRing::getCapacity() const {
+  return capacity;
+}
+
+size_t BlockchainEventRing::getFreeSpace() const {
+  uint64_t published = head.load(std::memory_order_acquire);
+  uint64_t used = published - getSlowestCursor(published);
+  return used >= capacity ? 0 : static_cast<size_t>(capacity - used);
+}
+
+uint32_t BlockchainEventRing::getTopBlockIndex() const {
+  return topBlockIndex.load(std::memory_order_relaxed);
+}
+
+void BlockchainEventRing::writeRecord(uint64_t sequence, const Record& record) {
+  uint64_t words[Slot::WORD_COUNT];
+  std::memcpy(words, &record, sizeof(record));
+
+  Slot& slot = slots[sequence & mask];
+  slot.stamp.store(2 * sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < Slot::WORD_COUNT; ++i) {
+    slot.words[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  slot.stamp.store(2 * sequence + 2, std::memory_order_release);
+}
+
+bool BlockchainEventRing::readRecord(uint64_t sequence, Record& record) const {
+  const Slot& slot = slots[sequence & mask];
+  const uint64_t expectedStamp = 2 * sequence + 2;
+  if (slot.stamp.load(std::memory_order_acquire) != expectedStamp) {
+    return false;
+  }
+
+  uint64_t words[Slot::WORD_COUNT];
+  for (size_t i = 0; i < Slot::WORD_COUNT; ++i) {
+    words[i] = slot.words[i].load(std::memory_order_relaxed);
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.stamp.load(std::memory_order_relaxed) != expectedStamp) {
+    return false;
+  }
+
+  std::memcpy(&record, words, sizeof(record));
+  return true;
+}
+
+uint64_t BlockchainEventRing::getSlowestCursor(uint64_t published) const {
+  uint64_t slowest = published;
+  for (auto& cursor : cursors) {
+    slowest = std::min(slowest, cursor.load(std::memory_order_acquire));
+  }
+
+  return slowest;
+}
+
+void BlockchainEventRing::wakeWaiters() {
+  if (waiters.load() == 0) {
+    return;
+  }
+
+  {
+    // a waiter that has already checked the head is either asleep or will see the new value
+    std::lock_guard<std::mutex> lock(waitMutex);
+  }
+
+  waitCondition.notify_all();
+}
+
+BlockchainEventRing::Subscriber::Subscriber(BlockchainEventRing& eventRing) :
+  ring(eventRing), slot(MAX_SUBSCRIBERS), cursor(0), overflowCount(0), stopped(false) {
+  for (size_t i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    uint64_t expected = FREE_CURSOR;
+    cursor = ring.head.load();
+    if (ring.cursors[i].compare_exchange_strong(expected, cursor)) {
+      slot = i;
+      return;
+    }
+  }
+
+  throw std::runtime_error("Too many blockchain event subscribers");
+}
+
+BlockchainEventRing::Subscriber::~Subscriber() {
+  ring.cursors[slot].store(FREE_CURSOR, std::memory_order_release);
+}
+
+BlockchainEventRing::ReadResult BlockchainEventRing::Subscriber::tryRead(boost::optional<BlockchainMessage>& message, uint32_t& topIndex) {
+  if (stopped.load()) {
+    return ReadResult::Stopped;
+  }
+
+  uint64_t published = ring.head.load(std::memory_order_acquire);
+  if (cursor == published) {
+    return ReadResult::Empty;
+  }
+
+  auto overflow = [this, published] {
+    ++overflowCount;
+    cursor = published;
+    ring.cursors[slot].store(cursor, std::memory_order_release);
+    return ReadResult::Overflow;
+  };
+
+  Record header;
+  if (published - cursor > ring.capacity || !ring.readRecord(cursor, header) || (header.flags & RECORD_CONTINUATION) != 0) {
+    return overflow();
+  }
+
+  uint64_t next = cursor + 1;
+  if ((header.flags & RECORD_TRUNCATED) != 0) {
+    // A message without its hashes can't be acted upon, the subscriber resynchronizes as after an overflow
+    ++overflowCount;
+    topIndex = header.topBlockIndex;
+    cursor = next;
+    ring.cursors[slot].store(cursor, std::memory_order_release);
+    return ReadResult::Overflow;
+  }
+
+  std::vector<Crypto::Hash> hashes;
+  if (header.hashCount != 0) {
+    hashes.reserve(header.hashCount);
+    hashes.push_back(header.hash);
+    for (uint32_t i = 1; i < header.hashCount; ++i) {
+      Record continuation;
+      if (!ring.readRecord(next++, continuation)) {
+        return overflow();
+      }
+
+      hashes.push_back(continuation.hash);
+    }
+  }
+
+  switch (static_cast<BlockchainMessage::Type>(header.type)) {
+  case BlockchainMessage::Type::NewBlock:
+    message.emplace(makeNewBlockMessage(header.index, header.hash));
+    break;
+  case BlockchainMessage::Type::NewAlternativeBlock:
+    message.emplace(makeNewAlternativeBlockMessage(header.index, header.hash));
+    break;
+  case BlockchainMessage::Type::ChainSwitch:
+    message.emplace(makeChainSwitchMessage(header.index, std::move(hashes)));
+    break;
+  case BlockchainMessage::Type::AddTransaction:
+    message.emplace(makeAddTransactionMessage(std::move(hashes)));
+    break;
+  case BlockchainMessage::Type::DeleteTransaction:
+    message.emplace(makeDelTransactionMessage(std::move(hashes), static_cast<Messages::DeleteTransaction::Reason>(header.reason)));
+    break;
+  }
+
+  topIndex = header.topBlockIndex;
+  cursor = next;
+  ring.cursors[slot].store(cursor, std::memory_order_release);
+  return ReadResult::Message;
+}
+
+BlockchainEventRing::ReadResult BlockchainEventRing::Subscriber::read(boost::optional<BlockchainMessage>& message, uint32_t& topIndex) {
+  for (;;) {
+    ReadResult result = tryRead(message, topIndex);
+    if (result != ReadResult::Empty) {
+      return result;
+    }
+
+    std::unique_lock<std::mutex> lock(ring.waitMutex);
+    ++ring.waiters;
+    ring.waitCondition.wait(lock, [this] { return stopped.load() || ring.head.load() != cursor; });
+    --ring.waiters;
+  }
+}
+
+void BlockchainEventRing::Subscriber::stop() {
+  stopped = true;
+
+  {
+    std::lock_guard<std::mutex> lock(ring.waitMutex);
+  }
+
+  ring.waitCondition.notify_all();
+}
+
+uint64_t BlockchainEventRing::Subscriber::getOverflowCount() const {
+  return overflowCount;
+}
+
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <boost/optional.hpp>
+
+#include "BlockchainMessages.h"
+
+namespace CryptoNote {
+
+/*
+ * Lock-free broadcast ring for chain and pool events. Core is the only producer and publishes from
+ * its dispatcher thread; every Subscriber keeps its own cursor and reads from any thread without
+ * entering the core dispatcher. Messages are flattened into fixed-size records held in atomic words
+ * and stamped with their sequence number, so a subscriber that falls more than capacity records behind
+ * sees Overflow instead of a torn message. Pool events shrink to a hash-less record when the slowest
+ * subscriber has no room left for their hashes, such records are read as Overflow as well.
+ */
+class BlockchainEventRing {
+public:
+  enum class ReadResult {
+    Message,
+    Empty,
+    Overflow, // messages or their hashes were lost, the subscriber must resynchronize
+    Stopped
+  };
+
+  static const size_t DEFAULT_CAPACITY = 4096;
+  static const size_t MAX_SUBSCRIBERS = 16;
+
+  class Subscriber {
+  public:
+    explicit Subscriber(BlockchainEventRing& ring);
+    ~Subscriber();
+
+    Subscriber(const Subscriber&) = delete;
+    Subscriber& operator=(const Subscriber&) = delete;
+
+    ReadResult tryRead(boost::optional<BlockchainMessage>& message, uint32_t& topBlockIndex);
+    // Blocks until a message arrives, an overflow is detected or stop() is called
+    ReadResult read(boost::optional<BlockchainMessage>& message, uint32_t& topBlockIndex);
+    // May be called from any thread
+    void stop();
+
+    uint64_t getOverflowCount() const;
+
+  private:
+    BlockchainEventRing& ring;
+    size_t slot;
+    uint64_t cursor;
+    uint64_t overflowCount;
+    std::atomic<bool> stopped;
+  };
+
+  explicit BlockchainEventRing(size_t capacity = DEFAULT_CAPACITY);
+  ~BlockchainEventRing();
+
+  BlockchainEventRing(const BlockchainEventRing&) = delete;
+  BlockchainEventRing& operator=(const BlockchainEventRing&) = delete;
+
+  // Must be called from a single producer thread
+  void publish(const BlockchainMessage& message, uint32_t topBlockIndex);
+
+  size_t getCapacity() const;
+  // Records the slowest subscriber can still take before it is overrun
+  size_t getFreeSpace() const;
+  uint32_t getTopBlockIndex() const;
+
+private:
+  struct Record;
+  struct Slot;
+
+  void writeRecord(uint64_t sequence, const Record& record);
+  bool readRecord(uint64_t sequence, Record& record) const;
+  uint64_t getSlowestCursor(uint64_t head) const;
+  void wakeWaiters();
+
+  const size_t capacity;
+  const uint64_t mask;
+  std::unique_ptr<Slot[]> slots;
+  std::atomic<uint64_t> head;
+  std::atomic<uint32_t> topBlockIndex;
+
+  std::atomic<uint64_t> cursors[MAX_SUBSCRIBERS];
+
+  std::atomic<size_t> waiters;
+  std::mutex waitMutex;
+  std::condition_variable waitCondition;
+};
+
+}
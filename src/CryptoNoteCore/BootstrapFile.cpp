@@ -0,0 +1,280 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "BootstrapFile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "Serialization/SerializationOverloads.h"
+
+namespace CryptoNote {
+
+namespace {
+
+const char BOOTSTRAP_FILE_SIGNATURE[8] = {'C', 'N', 'B', 'O', 'O', 'T', 'S', 'T'};
+const uint32_t BOOTSTRAP_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct FileHeader {
+  char signature[8];
+  uint32_t version;
+  Crypto::Hash genesisBlockHash;
+};
+
+struct ChunkHeader {
+  uint32_t startIndex;
+  uint32_t blockCount;
+  uint64_t size;
+  Crypto::Hash payloadHash;
+};
+
+struct IndexEntry {
+  uint32_t startIndex;
+  uint32_t blockCount;
+  uint64_t offset;
+};
+
+struct IndexFooter {
+  uint64_t indexOffset;
+  uint32_t chunkCount;
+  uint32_t blockCount;
+  Crypto::Hash indexHash;
+  char signature[8];
+};
+#pragma pack(pop)
+
+struct ChunkPayload {
+  std::vector<RawBlock> blocks;
+
+  void serialize(ISerializer& serializer) {
+    serializer(blocks, "blocks");
+  }
+};
+
+template <typename T>
+void writePod(std::ostream& stream, const T& value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readPod(std::istream& stream, T& value) {
+  return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+}
+
+BootstrapFileWriter::BootstrapFileWriter(const std::string& path, const Crypto::Hash& genesisBlockHash, uint32_t chunkBlockCount) :
+  chunkBlockCount(std::max<uint32_t>(chunkBlockCount, 1)), blockCount(0), offset(0), finished(false) {
+
+  stream.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!stream) {
+    throw std::runtime_error("BootstrapFileWriter, failed to create " + path);
+  }
+
+  FileHeader header;
+  std::memcpy(header.signature, BOOTSTRAP_FILE_SIGNATURE, sizeof(header.signature));
+  header.version = BOOTSTRAP_FILE_VERSION;
+  header.genesisBlockHash = genesisBlockHash;
+  writePod(stream, header);
+  offset = sizeof(header);
+}
+
+void BootstrapFileWriter::pushBlock(RawBlock&& block) {
+  assert(!finished);
+
+  chunkBlocks.emplace_back(std::move(block));
+  ++blockCount;
+  if (chunkBlocks.size() == chunkBlockCount) {
+    flushChunk();
+  }
+}
+
+void BootstrapFileWriter::finish() {
+  assert(!finished);
+  flushChunk();
+
+  IndexFooter footer;
+  footer.indexOffset = offset;
+  footer.chunkCount = static_cast<uint32_t>(index.size() / sizeof(IndexEntry));
+  footer.blockCount = blockCount;
+  footer.indexHash = Crypto::cn_fast_hash(index.data(), index.size());
+  std::memcpy(footer.signature, BOOTSTRAP_FILE_SIGNATURE, sizeof(footer.signature));
+
+  stream.write(reinterpret_cast<const char*>(index.data()), index.size());
+  writePod(stream, footer);
+  stream.flush();
+  if (!stream) {
+    throw std::runtime_error("BootstrapFileWriter, failed to write chunk index");
+  }
+
+  stream.close();
+  finished = true;
+}
+
+uint32_t BootstrapFileWriter::getBlockCount() const {
+  return blockCount;
+}
+
+void BootstrapFileWriter::flushChunk() {
+  if (chunkBlocks.empty()) {
+    return;
+  }
+
+  ChunkPayload chunkPayload;
+  chunkPayload.blocks.swap(chunkBlocks);
+  BinaryArray payload = toBinaryArray(chunkPayload);
+  chunkBlocks.swap(chunkPayload.blocks);
+
+  ChunkHeader header;
+  header.startIndex = blockCount - static_cast<uint32_t>(chunkBlocks.size());
+  header.blockCount = static_cast<uint32_t>(chunkBlocks.size());
+  header.size = payload.size();
+  header.payloadHash = Crypto::cn_fast_hash(payload.data(), payload.size());
+
+  writePod(stream, header);
+  stream.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+  if (!stream) {
+    throw std::runtime_error("BootstrapFileWriter, failed to write chunk starting at block " + std::to_string(header.startIndex));
+  }
+
+  IndexEntry entry{header.startIndex, header.blockCount, offset};
+  const uint8_t* entryData = reinterpret_cast<const uint8_t*>(&entry);
+  index.insert(index.end(), entryData, entryData + sizeof(entry));
+
+  offset += sizeof(header) + payload.size();
+  chunkBlocks.clear();
+}
+
+BootstrapFileReader::BootstrapFileReader(const std::string& path) : blockCount(0) {
+  stream.open(path, std::ios::binary | std::ios::in);
+  if (!stream) {
+    throw std::runtime_error("BootstrapFileReader, failed to open " + path);
+  }
+
+  FileHeader header;
+  if (!readPod(stream, header) || std::memcmp(header.signature, BOOTSTRAP_FILE_SIGNATURE, sizeof(header.signature)) != 0) {
+    throw std::runtime_error("BootstrapFileReader, " + path + " is not a bootstrap file");
+  }
+
+  if (header.version != BOOTSTRAP_FILE_VERSION) {
+    throw std::runtime_error("BootstrapFileReader, unsupported bootstrap file version " + std::to_string(header.version));
+  }
+
+  genesisBlockHash = header.genesisBlockHash;
+
+  stream.seekg(0, std::ios::end);
+  uint64_t fileSize = static_cast<uint64_t>(stream.tellg());
+
+  IndexFooter footer;
+  if (fileSize < sizeof(header) + sizeof(footer) || !stream.seekg(fileSize - sizeof(footer)) || !readPod(stream, footer) ||
+      std::memcmp(footer.signature, BOOTSTRAP_FILE_SIGNATURE, sizeof(footer.signature)) != 0) {
+    throw std::runtime_error("BootstrapFileReader, " + path + " is truncated");
+  }
+
+  uint64_t indexSize = static_cast<uint64_t>(footer.chunkCount) * sizeof(IndexEntry);
+  if (footer.indexOffset < sizeof(header) || footer.indexOffset + indexSize != fileSize - sizeof(footer)) {
+    throw std::runtime_error("BootstrapFileReader, " + path + " has invalid chunk index");
+  }
+
+  std::vector<IndexEntry> entries(footer.chunkCount);
+  stream.seekg(footer.indexOffset);
+  if (!stream.read(reinterpret_cast<char*>(entries.data()), indexSize) ||
+      Crypto::cn_fast_hash(entries.data(), indexSize) != footer.indexHash) {
+    throw std::runtime_error("BootstrapFileReader, " + path + " has damaged chunk index");
+  }
+
+  uint64_t previousOffset = 0;
+  for (const auto& entry : entries) {
+    if (entry.startIndex != blockCount || entry.blockCount == 0 || entry.offset < sizeof(header) ||
+        entry.offset >= footer.indexOffset || entry.offset <= previousOffset) {
+      throw std::runtime_error("BootstrapFileReader, " + path + " has invalid chunk index");
+    }
+
+    chunks.push_back(Chunk{entry.startIndex, entry.blockCount, entry.offset});
+    blockCount += entry.blockCount;
+    previousOffset = entry.offset;
+  }
+
+  if (blockCount != footer.blockCount) {
+    throw std::runtime_error("BootstrapFileReader, " + path + " has invalid chunk index");
+  }
+
+  chunkEndOffset = footer.indexOffset;
+}
+
+const Crypto::Hash& BootstrapFileReader::getGenesisBlockHash() const {
+  return genesisBlockHash;
+}
+
+uint32_t BootstrapFileReader::getBlockCount() const {
+  return blockCount;
+}
+
+const std::vector<BootstrapFileReader::Chunk>& BootstrapFileReader::getChunks() const {
+  return chunks;
+}
+
+size_t BootstrapFileReader::findChunk(uint32_t blockIndex) const {
+  if (blockIndex >= blockCount) {
+    return chunks.size();
+  }
+
+  auto it = std::upper_bound(chunks.begin(), chunks.end(), blockIndex, [] (uint32_t index, const Chunk& chunk) {
+    return index < chunk.startIndex;
+  });
+
+  assert(it != chunks.begin());
+  return static_cast<size_t>(std::distance(chunks.begin(), it) - 1);
+}
+
+std::vector<RawBlock> BootstrapFileReader::readChunk(size_t chunkIndex) {
+  assert(chunkIndex < chunks.size());
+  const Chunk& chunk = chunks[chunkIndex];
+  uint64_t chunkEnd = chunkIndex + 1 < chunks.size() ? chunks[chunkIndex + 1].offset : chunkEndOffset;
+
+  ChunkHeader header;
+  BinaryArray payload;
+  {
+    std::unique_lock<std::mutex> lock(streamMutex);
+    stream.clear();
+    stream.seekg(chunk.offset);
+    if (!readPod(stream, header) || header.startIndex != chunk.startIndex || header.blockCount != chunk.blockCount ||
+        chunk.offset + sizeof(header) + header.size != chunkEnd) {
+      throw std::runtime_error("BootstrapFileReader, chunk starting at block " + std::to_string(chunk.startIndex) + " is damaged");
+    }
+
+    payload.resize(static_cast<size_t>(header.size));
+    if (!stream.read(reinterpret_cast<char*>(payload.data()), payload.size())) {
+      throw std::runtime_error("BootstrapFileReader, failed to read chunk starting at block " + std::to_string(chunk.startIndex));
+    }
+  }
+
+  ChunkPayload chunkPayload;
+  if (Crypto::cn_fast_hash(payload.data(), payload.size()) != header.payloadHash || !fromBinaryArray(chunkPayload, payload) ||
+      chunkPayload.blocks.size() != chunk.blockCount) {
+    throw std::runtime_error("BootstrapFileReader, chunk starting at block " + std::to_string(chunk.startIndex) + " is damaged");
+  }
+
+  return std::move(chunkPayload.blocks);
+}
+
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CryptoNote.h"
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+/*
+ * Bootstrap file is a portable copy of the main chain used to provision nodes without P2P sync.
+ * Blocks are stored in chunks, every chunk carries its block range and the hash of its payload.
+ * The chunk index at the end of the file lets readers start from any block and verify chunks independently.
+ *
+ * Layout: FileHeader, chunks (ChunkHeader + payload), chunk index (IndexEntry array), IndexFooter.
+ */
+class BootstrapFileWriter {
+public:
+  BootstrapFileWriter(const std::string& path, const Crypto::Hash& genesisBlockHash, uint32_t chunkBlockCount);
+  BootstrapFileWriter(const BootstrapFileWriter&) = delete;
+  BootstrapFileWriter& operator=(const BootstrapFileWriter&) = delete;
+
+  void pushBlock(RawBlock&& block);
+  // Writes buffered blocks and the chunk index, no blocks may be pushed after that
+  void finish();
+
+  uint32_t getBlockCount() const;
+
+private:
+  void flushChunk();
+
+  std::ofstream stream;
+  const uint32_t chunkBlockCount;
+  uint32_t blockCount;
+  uint64_t offset;
+  std::vector<RawBlock> chunkBlocks;
+  // serialized chunk index, written at the end of the file
+  std::vector<uint8_t> index;
+  bool finished;
+};
+
+class BootstrapFileReader {
+public:
+  struct Chunk {
+    uint32_t startIndex;
+    uint32_t blockCount;
+    uint64_t offset;
+  };
+
+  explicit BootstrapFileReader(const std::string& path);
+  BootstrapFileReader(const BootstrapFileReader&) = delete;
+  BootstrapFileReader& operator=(const BootstrapFileReader&) = delete;
+
+  const Crypto::Hash& getGenesisBlockHash() const;
+  uint32_t getBlockCount() const;
+  const std::vector<Chunk>& getChunks() const;
+  // Index of the chunk containing the block, or getChunks().size() if there is no such chunk
+  size_t findChunk(uint32_t blockIndex) const;
+
+  // Reads and verifies a chunk, can be called from several threads at once
+  std::vector<RawBlock> readChunk(size_t chunkIndex);
+
+private:
+  std::ifstream stream;
+  std::mutex streamMutex;
+  Crypto::Hash genesisBlockHash;
+  uint32_t blockCount;
+  std::vector<Chunk> chunks;
+  uint64_t chunkEndOffset;
+};
+
+}
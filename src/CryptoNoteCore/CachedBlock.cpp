@@ -27,15 +27,44 @@ using namespace CryptoNote;
 CachedBlock::CachedBlock(const BlockTemplate& block) : block(block) {
 }
 
+CachedBlock::CachedBlock(const BlockTemplate& block, const BinaryArray& blockBinaryArray) : block(block) {
+  // the base transaction is followed only by the transaction hashes, so its size is enough to find it in the blob
+  size_t transactionSize = getObjectBinarySize(block.baseTransaction);
+  size_t hashesSize = Tools::get_varint_data(block.transactionHashes.size()).size() + block.transactionHashes.size() * sizeof(Crypto::Hash);
+  if (transactionSize + hashesSize > blockBinaryArray.size()) {
+    throw std::runtime_error("Block binary array doesn't match the block");
+  }
+
+  baseTransactionHash = Crypto::Hash();
+  cn_fast_hash(blockBinaryArray.data() + blockBinaryArray.size() - hashesSize - transactionSize, transactionSize, baseTransactionHash.get());
+  baseTransactionSize = transactionSize;
+}
+
 const BlockTemplate& CachedBlock::getBlock() const {
   return block;
 }
 
+const Crypto::Hash& CachedBlock::getBaseTransactionHash() const {
+  if (!baseTransactionHash.is_initialized()) {
+    baseTransactionHash = getObjectHash(block.baseTransaction);
+  }
+
+  return baseTransactionHash.get();
+}
+
+uint64_t CachedBlock::getBaseTransactionSize() const {
+  if (!baseTransactionSize.is_initialized()) {
+    baseTransactionSize = getObjectBinarySize(block.baseTransaction);
+  }
+
+  return baseTransactionSize.get();
+}
+
 const Crypto::Hash& CachedBlock::getTransactionTreeHash() const {
   if (!transactionTreeHash.is_initialized()) {
     std::vector<Crypto::Hash> transactionHashes;
     transactionHashes.reserve(block.transactionHashes.size() + 1);
-    transactionHashes.push_back(getObjectHash(block.baseTransaction));
+    transactionHashes.push_back(getBaseTransactionHash());
     transactionHashes.insert(transactionHashes.end(), block.transactionHashes.begin(), block.transactionHashes.end());
     transactionTreeHash = Crypto::Hash();
     Crypto::tree_hash(transactionHashes.data(), transactionHashes.size(), transactionTreeHash.get());
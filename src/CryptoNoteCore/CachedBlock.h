@@ -31,7 +31,12 @@ namespace CryptoNote {
 class CachedBlock {
 public:
   explicit CachedBlock(const BlockTemplate& block);
+  // 'block' must be decoded from 'blockBinaryArray'. The base transaction hash and size are taken from the blob,
+  // which is not referenced after construction.
+  CachedBlock(const BlockTemplate& block, const BinaryArray& blockBinaryArray);
   const BlockTemplate& getBlock() const;
+  const Crypto::Hash& getBaseTransactionHash() const;
+  uint64_t getBaseTransactionSize() const;
   const Crypto::Hash& getTransactionTreeHash() const;
   const Crypto::Hash& getBlockHash() const;
   const Crypto::Hash& getBlockLongHash(Crypto::cn_context& cryptoContext) const;
@@ -50,6 +55,8 @@ private:
   mutable boost::optional<BinaryArray> parentBlockBinaryArrayHeaderOnly;
   mutable boost::optional<BinaryArray> parentBlockHashingBinaryArrayHeaderOnly;
   mutable boost::optional<uint32_t> blockIndex;
+  mutable boost::optional<Crypto::Hash> baseTransactionHash;
+  mutable boost::optional<uint64_t> baseTransactionSize;
   mutable boost::optional<Crypto::Hash> transactionTreeHash;
   mutable boost::optional<Crypto::Hash> blockHash;
   mutable boost::optional<Crypto::Hash> blockLongHash;
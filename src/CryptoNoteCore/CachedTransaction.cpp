@@ -16,6 +16,7 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "CachedTransaction.h"
+#include <cassert>
 #include <Common/Varint.h>
 #include "CryptoNoteConfig.h"
 #include "CryptoNoteTools.h"
@@ -23,22 +24,96 @@
 using namespace Crypto;
 using namespace CryptoNote;
 
-CachedTransaction::CachedTransaction(Transaction&& transaction) : transaction(std::move(transaction)) {
+namespace {
+
+size_t getSignaturesCount(const TransactionInput& input) {
+  if (input.type() == typeid(KeyInput)) {
+    return boost::get<KeyInput>(input).outputIndexes.size();
+  } else if (input.type() == typeid(MultisignatureInput)) {
+    return boost::get<MultisignatureInput>(input).signatureCount;
+  }
+
+  return 0;
+}
+
+}
+
+CachedTransaction::CachedTransaction(Transaction&& transaction) : transaction(std::move(transaction)), signaturesDecoded(true) {
+}
+
+CachedTransaction::CachedTransaction(const Transaction& transaction) : transaction(transaction), signaturesDecoded(true) {
 }
 
-CachedTransaction::CachedTransaction(const Transaction& transaction) : transaction(transaction) {
+CachedTransaction::CachedTransaction(const BinaryArray& transactionBinaryArray) : signaturesDecoded(false), transactionBinaryArray(transactionBinaryArray) {
+  decodePrefix();
 }
 
-CachedTransaction::CachedTransaction(const BinaryArray& transactionBinaryArray) : transactionBinaryArray(transactionBinaryArray) {
-  if (!fromBinaryArray<Transaction>(transaction, this->transactionBinaryArray.get())) {
+CachedTransaction::CachedTransaction(BinaryArray&& transactionBinaryArray) : signaturesDecoded(false), transactionBinaryArray(std::move(transactionBinaryArray)) {
+  decodePrefix();
+}
+
+CachedTransaction::CachedTransaction(const BinaryArray& transactionBinaryArray, const Crypto::Hash& transactionHash)
+  : CachedTransaction(transactionBinaryArray) {
+  this->transactionHash = transactionHash;
+}
+
+void CachedTransaction::decodePrefix() {
+  const auto& binaryArray = transactionBinaryArray.get();
+  BinaryMemoryInputSerializer serializer(binaryArray.data(), binaryArray.size());
+  try {
+    serialize(static_cast<TransactionPrefix&>(transaction), serializer);
+  } catch (std::exception&) {
+    throw std::runtime_error("CachedTransaction::CachedTransaction(BinaryArray&&), deserealization error.");
+  }
+
+  // signatures are written last and without any framing, so the rest of a well-formed blob is exactly the signatures
+  uint64_t signaturesCount = 0;
+  for (const auto& input : transaction.inputs) {
+    signaturesCount += getSignaturesCount(input);
+  }
+
+  if (serializer.remaining() != signaturesCount * sizeof(Crypto::Signature)) {
     throw std::runtime_error("CachedTransaction::CachedTransaction(BinaryArray&&), deserealization error.");
   }
+
+  prefixSize = serializer.position();
+}
+
+const TransactionPrefix& CachedTransaction::getTransactionPrefix() const {
+  return transaction;
 }
 
 const Transaction& CachedTransaction::getTransaction() const {
+  if (!signaturesDecoded) {
+    // same layout as serialize(Transaction&): a base transaction has no signature lists at all
+    if (!(transaction.inputs.size() == 1 && transaction.inputs[0].type() == typeid(BaseInput))) {
+      transaction.signatures.resize(transaction.inputs.size());
+      for (size_t i = 0; i < transaction.inputs.size(); ++i) {
+        const Crypto::Signature* signatures = getInputSignatures(i);
+        transaction.signatures[i].assign(signatures, signatures + getSignaturesCount(transaction.inputs[i]));
+      }
+    }
+
+    signaturesDecoded = true;
+  }
+
   return transaction;
 }
 
+const Crypto::Signature* CachedTransaction::getInputSignatures(size_t inputIndex) const {
+  assert(inputIndex < transaction.inputs.size());
+  if (signaturesDecoded) {
+    return transaction.signatures[inputIndex].data();
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < inputIndex; ++i) {
+    offset += getSignaturesCount(transaction.inputs[i]);
+  }
+
+  return reinterpret_cast<const Crypto::Signature*>(transactionBinaryArray->data() + prefixSize.get()) + offset;
+}
+
 const Crypto::Hash& CachedTransaction::getTransactionHash() const {
   if (!transactionHash.is_initialized()) {
     transactionHash = getBinaryArrayHash(getTransactionBinaryArray());
@@ -49,7 +124,12 @@ const Crypto::Hash& CachedTransaction::getTransactionHash() const {
 
 const Crypto::Hash& CachedTransaction::getTransactionPrefixHash() const {
   if (!transactionPrefixHash.is_initialized()) {
-    transactionPrefixHash = getObjectHash(static_cast<const TransactionPrefix&>(transaction));
+    if (prefixSize.is_initialized()) {
+      transactionPrefixHash = Crypto::Hash();
+      cn_fast_hash(transactionBinaryArray->data(), prefixSize.get(), transactionPrefixHash.get());
+    } else {
+      transactionPrefixHash = getObjectHash(static_cast<const TransactionPrefix&>(transaction));
+    }
   }
 
   return transactionPrefixHash.get();
@@ -26,15 +26,25 @@ class CachedTransaction {
 public:
   explicit CachedTransaction(Transaction&& transaction);
   explicit CachedTransaction(const Transaction& transaction);
+  // Only the prefix is decoded from the blob. The signatures stay there until getTransaction is called.
   explicit CachedTransaction(const BinaryArray& transactionBinaryArray);
+  explicit CachedTransaction(BinaryArray&& transactionBinaryArray);
+  CachedTransaction(const BinaryArray& transactionBinaryArray, const Crypto::Hash& transactionHash);
+  const TransactionPrefix& getTransactionPrefix() const;
   const Transaction& getTransaction() const;
+  // Signatures of the input, read in place if they were not decoded. Doesn't modify the object.
+  const Crypto::Signature* getInputSignatures(size_t inputIndex) const;
   const Crypto::Hash& getTransactionHash() const;
   const Crypto::Hash& getTransactionPrefixHash() const;
   const BinaryArray& getTransactionBinaryArray() const;
   uint64_t getTransactionFee() const;
 
 private:
-  Transaction transaction;
+  void decodePrefix();
+
+  mutable Transaction transaction;
+  mutable bool signaturesDecoded;
+  boost::optional<size_t> prefixSize;
   mutable boost::optional<BinaryArray> transactionBinaryArray;
   mutable boost::optional<Crypto::Hash> transactionHash;
   mutable boost::optional<Crypto::Hash> transactionPrefixHash;
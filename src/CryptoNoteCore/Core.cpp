@@ -16,13 +16,19 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <set>
+#include <thread>
 #include <unordered_set>
 
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
 #include "Core.h"
 #include "Common/ShuffleGenerator.h"
 #include "Common/Math.h"
+#include "Common/Metrics.h"
 #include "Common/MemoryInputStream.h"
 #include "CryptoNoteTools.h"
 #include "CryptoNoteFormatUtils.h"
@@ -37,6 +43,9 @@
 #include "CryptoNoteCore/TransactionPoolCleaner.h"
 #include "CryptoNoteCore/UpgradeManager.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
+#include "Serialization/BinaryMemoryInputSerializer.h"
+#include "Serialization/BinarySerializationTools.h"
+#include "Serialization/SerializationOverloads.h"
 
 #include <System/Timer.h>
 
@@ -56,9 +65,13 @@ std::vector<T> preallocateVector(size_t elements) {
 }
 UseGenesis addGenesisBlock = UseGenesis(true);
 
+Common::MetricHistogram& addBlockStageHistogram(const std::string& stage) {
+  return Common::metrics().histogram("core_add_block_duration_seconds", "Time spent in the stages of adding a block", {{"stage", stage}});
+}
+
 class TransactionSpentInputsChecker {
 public:
-  bool haveSpentInputs(const Transaction& transaction) {
+  bool haveSpentInputs(const TransactionPrefix& transaction) {
     for (const auto& input : transaction.inputs) {
       if (input.type() == typeid(KeyInput)) {
         auto inserted = alreadSpentKeyImages.insert(boost::get<KeyInput>(input).keyImage);
@@ -127,12 +140,12 @@ BlockTemplate extractBlockTemplate(const RawBlock& block) {
 
 Crypto::Hash getBlockHash(const RawBlock& block) {
   BlockTemplate blockTemplate = extractBlockTemplate(block);
-  return CachedBlock(blockTemplate).getBlockHash();
+  return CachedBlock(blockTemplate, block.block).getBlockHash();
 }
 
 TransactionValidatorState extractSpentOutputs(const CachedTransaction& transaction) {
   TransactionValidatorState spentOutputs;
-  const auto& cryptonoteTransaction = transaction.getTransaction();
+  const auto& cryptonoteTransaction = transaction.getTransactionPrefix();
 
   for (const auto& input : cryptonoteTransaction.inputs) {
     if (input.type() == typeid(KeyInput)) {
@@ -200,13 +213,46 @@ uint32_t findCommonRoot(IMainChainStorage& storage, IBlockchainCache& rootSegmen
 }
 
 const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
+const std::chrono::seconds TRANSACTION_POOL_SAVING_INTERVAL = std::chrono::seconds(600);
+
+struct PoolTransactionEntry {
+  BinaryArray transaction;
+  uint64_t receiveTime;
+
+  void serialize(ISerializer& s) {
+    serializeAsBinary(transaction, "transaction", s);
+    s(receiveTime, "receive_time");
+  }
+};
+
+struct TransactionPoolState {
+  // Main chain top at the moment the pool was saved
+  Crypto::Hash topBlockHash;
+  std::vector<PoolTransactionEntry> transactions;
+  std::unordered_map<Crypto::Hash, uint64_t> recentlyDeletedTransactions;
+
+  void serialize(ISerializer& s) {
+    s(topBlockHash, "top_block_hash");
+    s(transactions, "transactions");
+    s(recentlyDeletedTransactions, "recently_deleted_transactions");
+  }
+};
+
+bool checkRingSignature(const Crypto::Hash& prefixHash, const Crypto::KeyImage& keyImage, const std::vector<Crypto::PublicKey>& outputKeys,
+                        const Crypto::Signature* signatures) {
+  std::vector<const Crypto::PublicKey*> outputKeyPointers;
+  outputKeyPointers.reserve(outputKeys.size());
+  std::for_each(outputKeys.begin(), outputKeys.end(), [&outputKeyPointers] (const Crypto::PublicKey& key) { outputKeyPointers.push_back(&key); });
+  return Crypto::check_ring_signature(prefixHash, keyImage, outputKeyPointers.data(), outputKeyPointers.size(), signatures, true);
+}
 
 }
 
 Core::Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
-           std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage)
+           std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage,
+           const std::string& dataFolder)
     : currency(currency), dispatcher(dispatcher), contextGroup(dispatcher), logger(logger, "Core"), checkpoints(std::move(checkpoints)),
-      upgradeManager(new UpgradeManager()), blockchainCacheFactory(std::move(blockchainCacheFactory)),
+      upgradeManager(new UpgradeManager()), dataFolder(dataFolder), blockchainCacheFactory(std::move(blockchainCacheFactory)),
       mainChainStorage(std::move(mainchainStorage)), initialized(false) {
 
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
@@ -214,7 +260,7 @@ Core::Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& che
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_4, currency.upgradeHeight(BLOCK_MAJOR_VERSION_4));
 
   transactionPool = std::unique_ptr<ITransactionPoolCleanWrapper>(new TransactionPoolCleanWrapper(
-    std::unique_ptr<ITransactionPool>(new TransactionPool(logger)),
+    std::unique_ptr<ITransactionPool>(new TransactionPool(logger, currency.mempoolMaxSize(), currency.mempoolIncrementalFeePerKilobyte())),
     std::unique_ptr<ITimeProvider>(new RealTimeProvider()),
     logger,
     currency.mempoolTxLiveTime()));
@@ -233,8 +279,13 @@ bool Core::removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) {
   return queueList.remove(messageQueue);
 }
 
+BlockchainEventRing& Core::getBlockchainEventRing() {
+  return eventRing;
+}
+
 bool Core::notifyObservers(BlockchainMessage&& msg) /* noexcept */ {
   try {
+    eventRing.publish(msg, getTopBlockIndex());
     for (auto& queue : queueList) {
       queue.push(std::move(msg));
     }
@@ -463,6 +514,27 @@ bool Core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, ui
   }
 }
 
+std::vector<BlockScanTable> Core::getBlockScanTables(uint32_t startIndex, uint32_t count) const {
+  assert(!chainsLeaves.empty());
+  throwIfNotInitialized();
+
+  std::vector<BlockScanTable> tables;
+  uint32_t topIndex = chainsLeaves[0]->getTopBlockIndex();
+  if (startIndex > topIndex) {
+    return tables;
+  }
+
+  count = std::min(count, topIndex - startIndex + 1);
+  tables.reserve(count);
+  for (uint32_t blockIndex = startIndex; blockIndex < startIndex + count; ++blockIndex) {
+    IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockIndex);
+    assert(segment != nullptr);
+    tables.emplace_back(segment->getBlockScanTable(blockIndex));
+  }
+
+  return tables;
+}
+
 void Core::getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions,
                            std::vector<Crypto::Hash>& missedHashes) const {
   assert(!chainsLeaves.empty());
@@ -546,11 +618,18 @@ std::vector<Crypto::Hash> Core::findBlockchainSupplement(const std::vector<Crypt
 }
 
 std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) {
+  static Common::MetricHistogram& totalHistogram = addBlockStageHistogram("total");
+  static Common::MetricHistogram& validationHistogram = addBlockStageHistogram("block_validation");
+  static Common::MetricHistogram& transactionsHistogram = addBlockStageHistogram("transaction_validation");
+  static Common::MetricHistogram& proofOfWorkHistogram = addBlockStageHistogram("proof_of_work");
+  static Common::MetricHistogram& storageHistogram = addBlockStageHistogram("storage");
+
   throwIfNotInitialized();
-  logger(Logging::DEBUGGING) << "Request to add block came for block " << cachedBlock.getBlockHash();
+  Common::MetricTimer totalTimer(totalHistogram);
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Request to add block came for block " << cachedBlock.getBlockHash();
 
   if (hasBlock(cachedBlock.getBlockHash())) {
-    logger(Logging::DEBUGGING) << "Block " << cachedBlock.getBlockHash() << " already exists";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Block " << cachedBlock.getBlockHash() << " already exists";
     return error::AddBlockErrorCode::ALREADY_EXISTS;
   }
 
@@ -572,7 +651,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
   }
 
-  auto coinbaseTransactionSize = getObjectBinarySize(blockTemplate.baseTransaction);
+  auto coinbaseTransactionSize = cachedBlock.getBaseTransactionSize();
   assert(coinbaseTransactionSize < std::numeric_limits<decltype(coinbaseTransactionSize)>::max());
   auto cumulativeBlockSize = coinbaseTransactionSize + cumulativeSize;
   TransactionValidatorState validatorState;
@@ -589,7 +668,9 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
   }
 
   uint64_t minerReward = 0;
+  Common::MetricTimer validationTimer(validationHistogram);
   auto blockValidationResult = validateBlock(cachedBlock, cache, minerReward);
+  validationTimer.stop();
   if (blockValidationResult) {
     logger(Logging::WARNING) << "Failed to validate block " << cachedBlock.getBlockHash() << ": " << blockValidationResult.message();
     return blockValidationResult;
@@ -598,22 +679,25 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
   auto currentDifficulty = cache->getDifficultyForNextBlock(previousBlockIndex);
   // logger(Logging::INFO) << "[Core.cpp:599]Current difficulty: " << currentDifficulty << ", para el bloque: " << previousBlockIndex;
   if (currentDifficulty == 0) {
-    logger(Logging::DEBUGGING) << "Block " << cachedBlock.getBlockHash() << " has difficulty overhead";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Block " << cachedBlock.getBlockHash() << " has difficulty overhead";
     return error::BlockValidationError::DIFFICULTY_OVERHEAD;
   }
 
   uint64_t cumulativeFee = 0;
+  Common::MetricTimer transactionsTimer(transactionsHistogram);
   for (const auto& transaction : transactions) {
     uint64_t fee = 0;
     auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex);
     if (transactionValidationResult) {
-      logger(Logging::DEBUGGING) << "Failed to validate transaction " << transaction.getTransactionHash() << ": " << transactionValidationResult.message();
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "Failed to validate transaction " << transaction.getTransactionHash() << ": " << transactionValidationResult.message();
       return transactionValidationResult;
     }
 
     cumulativeFee += fee;
   }
 
+  transactionsTimer.stop();
+
   uint64_t reward = 0;
   int64_t emissionChange = 0;
   auto alreadyGeneratedCoins = cache->getAlreadyGeneratedCoins(previousBlockIndex);
@@ -635,6 +719,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return error::BlockValidationError::BLOCK_REWARD_MISMATCH;
   }
 
+  Common::MetricTimer proofOfWorkTimer(proofOfWorkHistogram);
   if (checkpoints.isInCheckpointZone(cachedBlock.getBlockIndex())) {
     if (!checkpoints.checkBlock(cachedBlock.getBlockIndex(), cachedBlock.getBlockHash())) {
       logger(Logging::WARNING) << "Checkpoint block hash mismatch for block " << cachedBlock.getBlockHash();
@@ -646,7 +731,10 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return error::BlockValidationError::PROOF_OF_WORK_TOO_WEAK;
   }
 
+  proofOfWorkTimer.stop();
+
   auto ret = error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE;
+  Common::MetricTimer storageTimer(storageHistogram);
 
   if (addOnTop) {
     if (cache->getChildCount() == 0) {
@@ -664,7 +752,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
 
         ret = error::AddBlockErrorCode::ADDED_TO_MAIN;
 
-        logger(Logging::DEBUGGING) << "Block " << cachedBlock.getBlockHash() << " added to main chain. Index: " << (previousBlockIndex + 1);
+        LOG_MESSAGE(logger, Logging::DEBUGGING) << "Block " << cachedBlock.getBlockHash() << " added to main chain. Index: " << (previousBlockIndex + 1);
         if ((previousBlockIndex + 1) % 100 == 0) {
           logger(Logging::INFO) << "Block " << cachedBlock.getBlockHash() << " added to main chain. Index: " << (previousBlockIndex + 1);
         }
@@ -704,7 +792,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
       chainsStorage.emplace_back(std::move(newCache));
       chainsLeaves.push_back(newlyForkedChainPtr);
 
-      logger(Logging::DEBUGGING) << "Adding alternative block: " << cachedBlock.getBlockHash();
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "Adding alternative block: " << cachedBlock.getBlockHash();
 
       newlyForkedChainPtr->pushBlock(cachedBlock, transactions, validatorState, cumulativeBlockSize, emissionChange,
                                      currentDifficulty, std::move(rawBlock));
@@ -713,7 +801,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
       updateBlockMedianSize();
     }
   } else {
-    logger(Logging::DEBUGGING) << "Adding alternative block: " << cachedBlock.getBlockHash();
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Adding alternative block: " << cachedBlock.getBlockHash();
 
     auto upperSegment = cache->split(previousBlockIndex + 1);
     //[cache] is lower segment now
@@ -745,7 +833,9 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     updateMainChainSet();
   }
 
-  logger(Logging::DEBUGGING) << "Block: " << cachedBlock.getBlockHash() << " successfully added";
+  storageTimer.stop();
+
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Block: " << cachedBlock.getBlockHash() << " successfully added";
   notifyOnSuccess(ret, previousBlockIndex, cachedBlock, *cache);
 
   return ret;
@@ -825,7 +915,7 @@ std::error_code Core::addBlock(RawBlock&& rawBlock) {
     return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
   }
 
-  CachedBlock cachedBlock(blockTemplate);
+  CachedBlock cachedBlock(blockTemplate, rawBlock.block);
   return addBlock(cachedBlock, std::move(rawBlock));
 }
 
@@ -852,9 +942,9 @@ std::error_code Core::submitBlock(BinaryArray&& rawBlockTemplate) {
 
     rawBlock.transactions.emplace_back(transactionPool->getTransaction(transactionHash).getTransactionBinaryArray());
   }
-  logger(Logging::DEBUGGING) << "BlockVERSION: " << (int)blockTemplate.majorVersion << "." << (int)blockTemplate.minorVersion;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "BlockVERSION: " << (int)blockTemplate.majorVersion << "." << (int)blockTemplate.minorVersion;
 
-  CachedBlock cachedBlock(blockTemplate);
+  CachedBlock cachedBlock(blockTemplate, rawBlock.block);
   return addBlock(cachedBlock, std::move(rawBlock));
 }
 
@@ -894,7 +984,7 @@ bool Core::getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_
 
   auto upperBlockLimit = getTopBlockIndex() - currency.minedMoneyUnlockWindow();
   if (upperBlockLimit < currency.minedMoneyUnlockWindow()) {
-    logger(Logging::DEBUGGING) << "Blockchain height is less than mined unlock window";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Blockchain height is less than mined unlock window";
     return false;
   }
 
@@ -910,10 +1000,10 @@ bool Core::getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_
     case ExtractOutputKeysResult::SUCCESS:
       return true;
     case ExtractOutputKeysResult::INVALID_GLOBAL_INDEX:
-      logger(Logging::DEBUGGING) << "Invalid global index is given";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "Invalid global index is given";
       return false;
     case ExtractOutputKeysResult::OUTPUT_LOCKED:
-      logger(Logging::DEBUGGING) << "Output is locked";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "Output is locked";
       return false;
   }
 
@@ -923,16 +1013,18 @@ bool Core::getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_
 bool Core::addTransactionToPool(const BinaryArray& transactionBinaryArray) {
   throwIfNotInitialized();
 
-  Transaction transaction;
-  if (!fromBinaryArray<Transaction>(transaction, transactionBinaryArray)) {
+  // keeps the received blob, so its hash and prefix hash are not computed by serializing the transaction again
+  boost::optional<CachedTransaction> cachedTransaction;
+  try {
+    cachedTransaction.emplace(transactionBinaryArray);
+  } catch (std::exception&) {
     logger(Logging::WARNING) << "Couldn't add transaction to pool due to deserialization error";
     return false;
   }
 
-  CachedTransaction cachedTransaction(std::move(transaction));
-  auto transactionHash = cachedTransaction.getTransactionHash();
+  auto transactionHash = cachedTransaction->getTransactionHash();
 
-  if (!addTransactionToPool(std::move(cachedTransaction))) {
+  if (!addTransactionToPool(std::move(*cachedTransaction))) {
     return false;
   }
 
@@ -941,26 +1033,67 @@ bool Core::addTransactionToPool(const BinaryArray& transactionBinaryArray) {
 }
 
 bool Core::addTransactionToPool(CachedTransaction&& cachedTransaction) {
+  static Common::MetricHistogram& admissionHistogram = Common::metrics().histogram("core_tx_pool_admission_duration_seconds",
+    "Time spent validating and adding a transaction to the pool");
+  static Common::MetricCounter& acceptedCounter = Common::metrics().counter("core_tx_pool_admissions_total",
+    "Transactions offered to the pool", {{"result", "accepted"}});
+  static Common::MetricCounter& rejectedCounter = Common::metrics().counter("core_tx_pool_admissions_total",
+    "Transactions offered to the pool", {{"result", "rejected"}});
+
+  Common::MetricTimer admissionTimer(admissionHistogram);
   TransactionValidatorState validatorState;
 
+  auto transactionHash = cachedTransaction.getTransactionHash();
+  uint64_t currentTime = getAdjustedTime();
+
+  // checked before the signatures so that a full pool sheds low fee spam cheaply
+  uint64_t minimumFee = transactionPool->getMinimumFeePerKilobyte(currentTime);
+  if (isBelowMinimumFee(cachedTransaction, minimumFee, currency)) {
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Transaction " << transactionHash << " pays less than the pool minimum of " <<
+      minimumFee << " per kilobyte";
+    rejectedCounter.add();
+    return false;
+  }
+
   if (!isTransactionValidForPool(cachedTransaction, validatorState)) {
+    rejectedCounter.add();
     return false;
   }
 
-  auto transactionHash = cachedTransaction.getTransactionHash();
   if (!transactionPool->pushTransaction(std::move(cachedTransaction), std::move(validatorState))) {
-    logger(Logging::DEBUGGING) << "Failed to push transaction " << transactionHash << " to pool, already exists";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Failed to push transaction " << transactionHash << " to pool, already exists";
+    rejectedCounter.add();
     return false;
   }
 
-  logger(Logging::DEBUGGING) << "Transaction " << transactionHash << " has been added to pool";
+  auto evictedTransactions = transactionPool->evictLowestFeeTransactions(currentTime);
+  auto it = std::find(evictedTransactions.begin(), evictedTransactions.end(), transactionHash);
+  bool evictedItself = it != evictedTransactions.end();
+  if (evictedItself) {
+    evictedTransactions.erase(it);
+  }
+
+  if (!evictedTransactions.empty()) {
+    logger(Logging::INFO) << "Transaction pool is full, evicted " << evictedTransactions.size() << " transactions with the lowest fee";
+    notifyObservers(makeDelTransactionMessage(std::move(evictedTransactions), Messages::DeleteTransaction::Reason::NotActual));
+  }
+
+  if (evictedItself) {
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Transaction " << transactionHash << " has been evicted from full pool";
+    rejectedCounter.add();
+    return false;
+  }
+
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Transaction " << transactionHash << " has been added to pool";
+  acceptedCounter.add();
   return true;
 }
 
-bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState) {
+bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState,
+                                     std::vector<RingSignatureCheck>* deferredRingSignatureChecks) {
   uint64_t fee;
 
-  if (auto validationResult = validateTransaction(cachedTransaction, validatorState, chainsLeaves[0], fee, getTopBlockIndex())) {
+  if (auto validationResult = validateTransaction(cachedTransaction, validatorState, chainsLeaves[0], fee, getTopBlockIndex(), deferredRingSignatureChecks)) {
     logger(Logging::WARNING) << "Transaction " << cachedTransaction.getTransactionHash()
       << " is not valid. Reason: " << validationResult.message();
     return false;
@@ -1002,6 +1135,19 @@ std::vector<Crypto::Hash> Core::getPoolTransactionHashes() const {
   return transactionPool->getTransactionHashes();
 }
 
+void Core::getPoolTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions,
+                               std::vector<Crypto::Hash>& missedHashes) const {
+  throwIfNotInitialized();
+
+  for (const auto& hash : transactionHashes) {
+    if (transactionPool->checkIfTransactionPresent(hash)) {
+      transactions.emplace_back(transactionPool->getTransaction(hash).getTransactionBinaryArray());
+    } else {
+      missedHashes.push_back(hash);
+    }
+  }
+}
+
 bool Core::getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes,
                           std::vector<BinaryArray>& addedTransactions,
                           std::vector<Crypto::Hash>& deletedTransactions) const {
@@ -1238,15 +1384,21 @@ std::vector<Transaction> Core::getPoolTransactions() const {
 
 bool Core::extractTransactions(const std::vector<BinaryArray>& rawTransactions,
                                std::vector<CachedTransaction>& transactions, uint64_t& cumulativeSize) {
-  try {
-    for (auto& rawTransaction : rawTransactions) {
-      if (rawTransaction.size() > currency.maxTxSize()) {
-        logger(Logging::INFO) << "Raw transaction size " << rawTransaction.size() << " is too big.";
-        return false;
-      }
+  for (auto& rawTransaction : rawTransactions) {
+    if (rawTransaction.size() > currency.maxTxSize()) {
+      logger(Logging::INFO) << "Raw transaction size " << rawTransaction.size() << " is too big.";
+      return false;
+    }
+
+    cumulativeSize += rawTransaction.size();
+  }
 
-      cumulativeSize += rawTransaction.size();
-      transactions.emplace_back(rawTransaction);
+  auto transactionHashes = getBinaryArrayHashes(rawTransactions);
+
+  transactions.reserve(transactions.size() + rawTransactions.size());
+  try {
+    for (size_t i = 0; i < rawTransactions.size(); ++i) {
+      transactions.emplace_back(rawTransactions[i], transactionHashes[i]);
     }
   } catch (std::runtime_error& e) {
     logger(Logging::INFO) << e.what();
@@ -1257,9 +1409,11 @@ bool Core::extractTransactions(const std::vector<BinaryArray>& rawTransactions,
 }
 
 std::error_code Core::validateTransaction(const CachedTransaction& cachedTransaction, TransactionValidatorState& state,
-                                          IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex) {
+                                          IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+                                          std::vector<RingSignatureCheck>* deferredRingSignatureChecks) {
   // TransactionValidatorState currentState;
-  const auto& transaction = cachedTransaction.getTransaction();
+  // signatures are checked in place, so a transaction decoded from a blob never gets them copied out
+  const auto& transaction = cachedTransaction.getTransactionPrefix();
   uint8_t blockMajorVersion = getBlockMajorVersionForHeight(blockIndex);
   auto error_mixin = validateMixin(transaction, blockMajorVersion);
 
@@ -1304,12 +1458,10 @@ std::error_code Core::validateTransaction(const CachedTransaction& cachedTransac
           return error::TransactionValidationError::INPUT_SPEND_LOCKED_OUT;
         }
 
-        std::vector<const Crypto::PublicKey*> outputKeyPointers;
-        outputKeyPointers.reserve(outputKeys.size());
-        std::for_each(outputKeys.begin(), outputKeys.end(), [&outputKeyPointers] (const Crypto::PublicKey& key) { outputKeyPointers.push_back(&key); });
-        if (!Crypto::check_ring_signature(cachedTransaction.getTransactionPrefixHash(), in.keyImage, outputKeyPointers.data(),
-                                          outputKeyPointers.size(), transaction.signatures[inputIndex].data(),
-                                          true)) {
+        if (deferredRingSignatureChecks != nullptr) {
+          deferredRingSignatureChecks->push_back({cachedTransaction.getTransactionPrefixHash(), in.keyImage, std::move(outputKeys), inputIndex});
+        } else if (!checkRingSignature(cachedTransaction.getTransactionPrefixHash(), in.keyImage, outputKeys,
+                                       cachedTransaction.getInputSignatures(inputIndex))) {
           return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
         }
       }
@@ -1338,6 +1490,7 @@ std::error_code Core::validateTransaction(const CachedTransaction& cachedTransac
         return error::TransactionValidationError::INPUT_WRONG_SIGNATURES_COUNT;
       }
 
+      const Crypto::Signature* signatures = cachedTransaction.getInputSignatures(inputIndex);
       size_t inputSignatureIndex = 0;
       size_t outputKeyIndex = 0;
       while (inputSignatureIndex < in.signatureCount) {
@@ -1346,7 +1499,7 @@ std::error_code Core::validateTransaction(const CachedTransaction& cachedTransac
         }
 
         if (Crypto::check_signature(cachedTransaction.getTransactionPrefixHash(), output.keys[outputKeyIndex],
-                                    transaction.signatures[inputIndex][inputSignatureIndex])) {
+                                    signatures[inputSignatureIndex])) {
           ++inputSignatureIndex;
         }
 
@@ -1364,7 +1517,7 @@ std::error_code Core::validateTransaction(const CachedTransaction& cachedTransac
   return error::TransactionValidationError::VALIDATION_SUCCESS;
 }
 
-bool Core::f_getMixin(const Transaction& transaction, uint64_t& mixin) {
+bool Core::f_getMixin(const TransactionPrefix& transaction, uint64_t& mixin) {
     mixin = 0;
     for (const TransactionInput& txin : transaction.inputs) {
         if (txin.type() != typeid(KeyInput)) {
@@ -1378,7 +1531,7 @@ bool Core::f_getMixin(const Transaction& transaction, uint64_t& mixin) {
     return true;
 }
 
-std::error_code Core::validateMixin(const Transaction& transaction, uint8_t majorBlockVersion) {
+std::error_code Core::validateMixin(const TransactionPrefix& transaction, uint8_t majorBlockVersion) {
     uint64_t mixin = 0;
     f_getMixin(transaction, mixin);
     if (majorBlockVersion >= currency.mandatoryMixinBlockVersion()) {
@@ -1392,7 +1545,7 @@ std::error_code Core::validateMixin(const Transaction& transaction, uint8_t majo
     return error::TransactionValidationError::VALIDATION_SUCCESS;
 }
 
-std::error_code Core::validateSemantic(const Transaction& transaction, uint64_t& fee, uint32_t blockIndex) {
+std::error_code Core::validateSemantic(const TransactionPrefix& transaction, uint64_t& fee, uint32_t blockIndex) {
   if (transaction.inputs.empty()) {
     return error::TransactionValidationError::EMPTY_INPUTS;
   }
@@ -1483,7 +1636,6 @@ std::error_code Core::validateSemantic(const Transaction& transaction, uint64_t&
     return error::TransactionValidationError::WRONG_AMOUNT;
   }
 
-  assert(transaction.signatures.size() == transaction.inputs.size());
   fee = summaryInputAmount - summaryOutputAmount;
   return error::TransactionValidationError::VALIDATION_SUCCESS;
 }
@@ -1601,6 +1753,7 @@ const Currency& Core::getCurrency() const {
 void Core::save() {
   throwIfNotInitialized();
 
+  saveTransactionPool();
   deleteAlternativeChains();
   mergeMainChainSegments();
   chainsLeaves[0]->save();
@@ -1612,7 +1765,7 @@ void Core::load() {
   auto dbBlocksCount = chainsLeaves[0]->getTopBlockIndex() + 1;
   auto storageBlocksCount = mainChainStorage->getBlockCount();
 
-  logger(Logging::DEBUGGING) << "Blockchain storage blocks count: " << storageBlocksCount << ", DB blocks count: " << dbBlocksCount;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Blockchain storage blocks count: " << storageBlocksCount << ", DB blocks count: " << dbBlocksCount;
 
   assert(storageBlocksCount != 0); //we assume the storage has at least genesis block
 
@@ -1631,10 +1784,15 @@ void Core::load() {
                              << "Cutting root segment to common block index " << findCommonRoot(*mainChainStorage, *chainsLeaves[0]) << " and reimporting blocks";
     importBlocksFromStorage();
   } else {
-    logger(Logging::DEBUGGING) << "Blockchain storage and root segment are on the same height and chain";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Blockchain storage and root segment are on the same height and chain";
   }
 
   initialized = true;
+  loadTransactionPool();
+
+  if (!dataFolder.empty()) {
+    contextGroup.spawn(std::bind(&Core::transactionPoolSavingProcedure, this));
+  }
 }
 
 void Core::initRootSegment() {
@@ -1663,7 +1821,7 @@ void Core::importBlocksFromStorage() {
   for (uint32_t i = commonIndex + 1; i < blockCount; ++i) {
     RawBlock rawBlock = mainChainStorage->getBlockByIndex(i);
     auto blockTemplate = extractBlockTemplate(rawBlock);
-    CachedBlock cachedBlock(blockTemplate);
+    CachedBlock cachedBlock(blockTemplate, rawBlock.block);
 
     if (blockTemplate.previousBlockHash != previousBlockHash) {
       logger(Logging::ERROR) << "Corrupted blockchain. Block with index " << i << " and hash " << cachedBlock.getBlockHash()
@@ -1681,7 +1839,7 @@ void Core::importBlocksFromStorage() {
       throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
     }
 
-    cumulativeSize += getObjectBinarySize(blockTemplate.baseTransaction);
+    cumulativeSize += cachedBlock.getBaseTransactionSize();
     TransactionValidatorState spentOutputs = extractSpentOutputs(transactions);
     auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
 
@@ -1868,27 +2026,43 @@ void Core::fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, s
   uint32_t fullBlocksCount = static_cast<uint32_t>(std::min(static_cast<uint32_t>(maxItemsCount), currentIndex - fullOffset + 1));
   entries.reserve(entries.size() + fullBlocksCount);
 
+  // Transactions of the whole range are hashed as one batch before the per-block pass.
+  std::vector<RawBlock> rawBlocks;
+  std::vector<BinaryArray> rawTransactions;
+  rawBlocks.reserve(fullBlocksCount);
+  for (uint32_t blockIndex = fullOffset; blockIndex < fullOffset + fullBlocksCount; ++blockIndex) {
+    rawBlocks.emplace_back(getRawBlock(findMainChainSegmentContainingBlock(blockIndex), blockIndex));
+    for (auto& rawTransaction : rawBlocks.back().transactions) {
+      rawTransactions.push_back(std::move(rawTransaction));
+    }
+  }
+
+  auto transactionHashes = getBinaryArrayHashes(rawTransactions);
+  size_t transactionOffset = 0;
+
   for (uint32_t blockIndex = fullOffset; blockIndex < fullOffset + fullBlocksCount; ++blockIndex) {
     IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockIndex);
-    RawBlock rawBlock = getRawBlock(segment, blockIndex);
+    RawBlock& rawBlock = rawBlocks[blockIndex - fullOffset];
 
     BlockShortInfo blockShortInfo;
     blockShortInfo.block = std::move(rawBlock.block);
     blockShortInfo.blockId = segment->getBlockHash(blockIndex);
 
     blockShortInfo.txPrefixes.reserve(rawBlock.transactions.size());
-    for (auto& rawTransaction : rawBlock.transactions) {
+    for (size_t i = 0; i < rawBlock.transactions.size(); ++i, ++transactionOffset) {
+      const BinaryArray& rawTransaction = rawTransactions[transactionOffset];
       TransactionPrefixInfo prefixInfo;
-      prefixInfo.txHash =
-          getBinaryArrayHash(rawTransaction); // TODO: is there faster way to get hash without calculation?
+      prefixInfo.txHash = transactionHashes[transactionOffset];
 
-      Transaction transaction;
-      if (!fromBinaryArray(transaction, rawTransaction)) {
+      // only the prefix is sent, so the signatures that follow it are not decoded
+      try {
+        BinaryMemoryInputSerializer serializer(rawTransaction.data(), rawTransaction.size());
+        serialize(prefixInfo.txPrefix, serializer);
+      } catch (std::exception&) {
         // TODO: log it
         throw std::runtime_error("Couldn't deserialize transaction");
       }
 
-      prefixInfo.txPrefix = std::move(static_cast<TransactionPrefix&>(transaction));
       blockShortInfo.txPrefixes.emplace_back(std::move(prefixInfo));
     }
 
@@ -1957,10 +2131,10 @@ void Core::fillBlockTemplate(BlockTemplate& block, size_t medianSize, size_t max
       continue;
     }
 
-    if (!spentInputsChecker.haveSpentInputs(transaction.getTransaction())) {
+    if (!spentInputsChecker.haveSpentInputs(transaction.getTransactionPrefix())) {
       block.transactionHashes.emplace_back(transaction.getTransactionHash());
       transactionsSize += transactionBlobSize;
-      logger(Logging::TRACE) << "Fusion transaction " << transaction.getTransactionHash() << " included to block template";
+      LOG_MESSAGE(logger, Logging::TRACE) << "Fusion transaction " << transaction.getTransactionHash() << " included to block template";
     }
   }
 
@@ -1971,13 +2145,13 @@ void Core::fillBlockTemplate(BlockTemplate& block, size_t medianSize, size_t max
       continue;
     }
 
-    if (!spentInputsChecker.haveSpentInputs(cachedTransaction.getTransaction())) {
+    if (!spentInputsChecker.haveSpentInputs(cachedTransaction.getTransactionPrefix())) {
       transactionsSize += cachedTransaction.getTransactionBinaryArray().size();
       fee += cachedTransaction.getTransactionFee();
       block.transactionHashes.emplace_back(cachedTransaction.getTransactionHash());
-      logger(Logging::TRACE) << "Transaction " << cachedTransaction.getTransactionHash() << " included to block template";
+      LOG_MESSAGE(logger, Logging::TRACE) << "Transaction " << cachedTransaction.getTransactionHash() << " included to block template";
     } else {
-      logger(Logging::TRACE) << "Transaction " << cachedTransaction.getTransactionHash() << " is failed to include to block template";
+      LOG_MESSAGE(logger, Logging::TRACE) << "Transaction " << cachedTransaction.getTransactionHash() << " is failed to include to block template";
     }
   }
 }
@@ -2073,7 +2247,7 @@ void Core::mergeSegments(IBlockchainCache* acceptingSegment, IBlockchainCache* s
       throw std::runtime_error("Couldn't deserialize transactions");
     }
 
-    acceptingSegment->pushBlock(CachedBlock(block), transactions, info.validatorState, info.blockSize,
+    acceptingSegment->pushBlock(CachedBlock(block, info.rawBlock.block), transactions, info.validatorState, info.blockSize,
                                 info.generatedCoins, info.blockDifficulty, std::move(info.rawBlock));
   }
 }
@@ -2326,7 +2500,7 @@ std::vector<Crypto::Hash> Core::getAlternativeBlockHashesByIndex(uint32_t blockI
 std::vector<Crypto::Hash> Core::getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const {
   throwIfNotInitialized();
 
-  logger(Logging::DEBUGGING) << "getBlockHashesByTimestamps request with timestamp "
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "getBlockHashesByTimestamps request with timestamp "
                              << timestampBegin << " and seconds count " << secondsCount;
 
   auto mainChain = chainsLeaves[0];
@@ -2344,7 +2518,7 @@ std::vector<Crypto::Hash> Core::getBlockHashesByTimestamps(uint64_t timestampBeg
 std::vector<Crypto::Hash> Core::getTransactionHashesByPaymentId(const Hash& paymentId) const {
   throwIfNotInitialized();
 
-  logger(Logging::DEBUGGING) << "getTransactionHashesByPaymentId request with paymentId " << paymentId;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "getTransactionHashesByPaymentId request with paymentId " << paymentId;
 
   auto mainChain = chainsLeaves[0];
 
@@ -2411,12 +2585,175 @@ void Core::transactionPoolCleaningProcedure() {
       notifyObservers(makeDelTransactionMessage(std::move(deletedTransactions), Messages::DeleteTransaction::Reason::Outdated));
     }
   } catch (System::InterruptedException&) {
-    logger(Logging::DEBUGGING) << "transactionPoolCleaningProcedure has been interrupted";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "transactionPoolCleaningProcedure has been interrupted";
   } catch (std::exception& e) {
     logger(Logging::ERROR) << "Error occurred while cleaning transactions pool: " << e.what();
   }
 }
 
+void Core::transactionPoolSavingProcedure() {
+  System::Timer timer(dispatcher);
+
+  try {
+    for (;;) {
+      timer.sleep(TRANSACTION_POOL_SAVING_INTERVAL);
+      saveTransactionPool();
+    }
+  } catch (System::InterruptedException&) {
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "transactionPoolSavingProcedure has been interrupted";
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Error occurred while saving transactions pool: " << e.what();
+  }
+}
+
+std::string Core::getTransactionPoolFileName() const {
+  return (boost::filesystem::path(dataFolder) / currency.txPoolFileName()).string();
+}
+
+void Core::saveTransactionPool() {
+  if (dataFolder.empty()) {
+    return;
+  }
+
+  TransactionPoolState state;
+  state.topBlockHash = getTopBlockHash();
+  state.recentlyDeletedTransactions = transactionPool->getRecentlyDeletedTransactions();
+  for (const auto& hash : transactionPool->getTransactionHashes()) {
+    state.transactions.push_back({transactionPool->getTransaction(hash).getTransactionBinaryArray(), transactionPool->getTransactionReceiveTime(hash)});
+  }
+
+  // write to a temporary file first, so that a crash while saving doesn't destroy the previous copy
+  auto fileName = getTransactionPoolFileName();
+  auto temporaryFileName = fileName + ".tmp";
+  if (!storeToBinaryFile(state, temporaryFileName)) {
+    logger(Logging::WARNING) << "Failed to save transaction pool to " << temporaryFileName;
+    return;
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::rename(temporaryFileName, fileName, ec);
+  if (ec) {
+    logger(Logging::WARNING) << "Failed to save transaction pool to " << fileName << ": " << ec.message();
+    return;
+  }
+
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Saved " << state.transactions.size() << " pool transactions to " << fileName;
+}
+
+void Core::loadTransactionPool() {
+  if (dataFolder.empty()) {
+    return;
+  }
+
+  auto fileName = getTransactionPoolFileName();
+  boost::system::error_code ec;
+  if (!boost::filesystem::exists(fileName, ec)) {
+    return;
+  }
+
+  TransactionPoolState state;
+  if (!loadFromBinaryFile(state, fileName)) {
+    logger(Logging::WARNING) << "Failed to load transaction pool from " << fileName << ", starting with an empty pool";
+    return;
+  }
+
+  transactionPool->addRecentlyDeletedTransactions(state.recentlyDeletedTransactions);
+
+  // The transactions go through the same checks as new ones, since the rules for the current height (mixin limits, unlock
+  // times, spent inputs) may reject what was accepted at the saved height. If the chain only grew since the pool was saved,
+  // every output the transactions reference is still there, so only their ring signatures, which were verified when they
+  // entered the pool, are skipped. After a reorganization the signatures are verified as well.
+  bool chainExtended = findMainChainSegmentContainingBlock(state.topBlockHash) != nullptr;
+
+  struct RestoredTransaction {
+    CachedTransaction transaction;
+    uint64_t receiveTime;
+    TransactionValidatorState validatorState;
+    std::vector<RingSignatureCheck> ringSignatureChecks;
+  };
+
+  uint64_t currentTime = static_cast<uint64_t>(time(nullptr));
+  std::vector<RestoredTransaction> restored;
+  restored.reserve(state.transactions.size());
+  for (auto& entry : state.transactions) {
+    if (entry.receiveTime + currency.mempoolTxLiveTime() <= currentTime) {
+      continue;
+    }
+
+    boost::optional<CachedTransaction> transaction;
+    try {
+      transaction.emplace(std::move(entry.transaction));
+    } catch (std::exception&) {
+      logger(Logging::WARNING) << "Couldn't deserialize a transaction from " << fileName;
+      continue;
+    }
+
+    RestoredTransaction restoredTransaction{std::move(*transaction), entry.receiveTime, TransactionValidatorState(), {}};
+    if (!isTransactionValidForPool(restoredTransaction.transaction, restoredTransaction.validatorState, &restoredTransaction.ringSignatureChecks)) {
+      continue;
+    }
+
+    if (chainExtended) {
+      restoredTransaction.ringSignatureChecks.clear();
+    }
+
+    restored.emplace_back(std::move(restoredTransaction));
+  }
+
+  std::vector<std::pair<size_t, const RingSignatureCheck*>> checks;
+  for (size_t i = 0; i < restored.size(); ++i) {
+    for (const auto& check : restored[i].ringSignatureChecks) {
+      checks.emplace_back(i, &check);
+    }
+  }
+
+  std::unique_ptr<std::atomic<bool>[]> invalid(new std::atomic<bool>[restored.size()]);
+  for (size_t i = 0; i < restored.size(); ++i) {
+    invalid[i] = false;
+  }
+
+  if (!checks.empty()) {
+    std::atomic<size_t> nextCheck(0);
+    auto worker = [&] {
+      for (size_t i = nextCheck++; i < checks.size(); i = nextCheck++) {
+        const RingSignatureCheck& check = *checks[i].second;
+        // getInputSignatures doesn't decode anything, so the workers can share a transaction
+        const Crypto::Signature* signatures = restored[checks[i].first].transaction.getInputSignatures(check.inputIndex);
+        if (!invalid[checks[i].first] && !checkRingSignature(check.prefixHash, check.keyImage, check.outputKeys, signatures)) {
+          invalid[checks[i].first] = true;
+        }
+      }
+    };
+
+    size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), checks.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) {
+      threads.emplace_back(worker);
+    }
+
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  size_t restoredCount = 0;
+  for (size_t i = 0; i < restored.size(); ++i) {
+    if (invalid[i]) {
+      continue;
+    }
+
+    if (transactionPool->pushTransaction(std::move(restored[i].transaction), std::move(restored[i].validatorState), restored[i].receiveTime)) {
+      ++restoredCount;
+    }
+  }
+
+  // the budget may have been lowered since the pool was saved
+  restoredCount -= transactionPool->evictLowestFeeTransactions(getAdjustedTime()).size();
+
+  logger(Logging::INFO) << "Restored " << restoredCount << " of " << state.transactions.size() << " pool transactions from " << fileName;
+}
+
 void Core::updateBlockMedianSize() {
   auto mainChain = chainsLeaves[0];
 
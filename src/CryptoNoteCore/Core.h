@@ -45,12 +45,15 @@ namespace CryptoNote {
 
 class Core : public ICore, public ICoreInformation {
 public:
+  // The transaction pool is kept in dataFolder across restarts; it isn't persisted if dataFolder is empty.
   Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
-       std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainChainStorage);
+       std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainChainStorage,
+       const std::string& dataFolder = std::string());
   virtual ~Core() override;
 
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>&  messageQueue) override;
   virtual bool removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) override;
+  virtual BlockchainEventRing& getBlockchainEventRing() override;
 
   virtual uint32_t getTopBlockIndex() const override;
   virtual Crypto::Hash getTopBlockHash() const override;
@@ -71,6 +74,7 @@ public:
     uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockFullInfo>& entries) const override;
   virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
     uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockShortInfo>& entries) const override;
+  virtual std::vector<BlockScanTable> getBlockScanTables(uint32_t startIndex, uint32_t count) const override;
 
   virtual bool hasTransaction(const Crypto::Hash& transactionHash) const override;
   virtual void getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions, std::vector<Crypto::Hash>& missedHashes) const override;
@@ -89,6 +93,8 @@ public:
   virtual bool addTransactionToPool(const BinaryArray& transactionBinaryArray) override;
 
   virtual std::vector<Crypto::Hash> getPoolTransactionHashes() const override;
+  virtual void getPoolTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions,
+                                   std::vector<Crypto::Hash>& missedHashes) const override;
   virtual bool getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes, std::vector<BinaryArray>& addedTransactions,
     std::vector<Crypto::Hash>& deletedTransactions) const override;
   virtual bool getPoolChangesLite(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes, std::vector<TransactionPrefixInfo>& addedTransactions,
@@ -121,6 +127,13 @@ public:
   RawBlock getRawBlockForRPC(const Crypto::Hash& blockHash) const;
     
 private:
+  struct RingSignatureCheck {
+    Crypto::Hash prefixHash;
+    Crypto::KeyImage keyImage;
+    std::vector<Crypto::PublicKey> outputKeys;
+    size_t inputIndex;
+  };
+
   const Currency& currency;
   System::Dispatcher& dispatcher;
   System::ContextGroup contextGroup;
@@ -136,6 +149,7 @@ private:
   std::string dataFolder;
 
   IntrusiveLinkedList<MessageQueue<BlockchainMessage>> queueList;
+  BlockchainEventRing eventRing;
   std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory;
   std::unique_ptr<IMainChainStorage> mainChainStorage;
   bool initialized;
@@ -145,10 +159,12 @@ private:
   void throwIfNotInitialized() const;
   bool extractTransactions(const std::vector<BinaryArray>& rawTransactions, std::vector<CachedTransaction>& transactions, uint64_t& cumulativeSize);
 
-  std::error_code validateSemantic(const Transaction& transaction, uint64_t& fee, uint32_t blockIndex);
-  bool f_getMixin(const Transaction& transaction, uint64_t& mixin);
-  std::error_code validateMixin(const Transaction& transaction, uint8_t majorBlockVersion);
-  std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex);
+  std::error_code validateSemantic(const TransactionPrefix& transaction, uint64_t& fee, uint32_t blockIndex);
+  bool f_getMixin(const TransactionPrefix& transaction, uint64_t& mixin);
+  std::error_code validateMixin(const TransactionPrefix& transaction, uint8_t majorBlockVersion);
+  // Ring signatures are appended to deferredRingSignatureChecks instead of being verified when it isn't null
+  std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+    std::vector<RingSignatureCheck>* deferredRingSignatureChecks = nullptr);
   
   uint32_t findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds) const;
   std::vector<Crypto::Hash> getBlockHashes(uint32_t startBlockIndex, uint32_t maxCount) const;
@@ -195,9 +211,14 @@ private:
   void actualizePoolTransactionsLite(const TransactionValidatorState& validatorState); //Checks pool txs only for double spend.
 
   void transactionPoolCleaningProcedure();
+  void transactionPoolSavingProcedure();
+  std::string getTransactionPoolFileName() const;
+  void saveTransactionPool();
+  void loadTransactionPool();
   void updateBlockMedianSize();
   bool addTransactionToPool(CachedTransaction&& cachedTransaction);
-  bool isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState);
+  bool isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState,
+    std::vector<RingSignatureCheck>* deferredRingSignatureChecks = nullptr);
 
   void initRootSegment();
   void importBlocksFromStorage();
@@ -50,6 +50,10 @@ namespace CryptoNote {
 
 template <class T>
 std::ostream &print256(std::ostream &o, const T &v) {
+  if (!o.good()) {
+    return o;
+  }
+
   return o << Common::podToHex(v);
 }
 
@@ -18,6 +18,7 @@
 #include "CryptoNoteFormatUtils.h"
 
 #include <set>
+#include <unordered_map>
 #include <Logging/LoggerRef.h>
 #include <Common/Varint.h>
 
@@ -198,26 +199,38 @@ bool constructTransaction(
 
   uint64_t summary_outs_money = 0;
   //fill outputs
+  //amounts are decomposed, so most destinations repeat an address: derive once per view key, decode each spend key once
+  std::unordered_map<PublicKey, KeyDerivation> derivations;
+  std::unordered_map<PublicKey, public_key_context> spend_contexts;
   size_t output_index = 0;
   for (const TransactionDestinationEntry& dst_entr : shuffled_dsts) {
     if (!(dst_entr.amount > 0)) {
       logger(ERROR, BRIGHT_RED) << "Destination with wrong amount: " << dst_entr.amount;
       return false;
     }
-    KeyDerivation derivation;
-    PublicKey out_eph_public_key;
-    bool r = generate_key_derivation(dst_entr.addr.viewPublicKey, txkey.secretKey, derivation);
+    auto derivation_it = derivations.find(dst_entr.addr.viewPublicKey);
+    if (derivation_it == derivations.end()) {
+      KeyDerivation derivation;
+      bool r = generate_key_derivation(dst_entr.addr.viewPublicKey, txkey.secretKey, derivation);
+
+      if (!(r)) {
+        logger(ERROR, BRIGHT_RED)
+          << "at creation outs: failed to generate_key_derivation("
+          << dst_entr.addr.viewPublicKey << ", " << txkey.secretKey << ")";
+        return false;
+      }
 
-    if (!(r)) {
-      logger(ERROR, BRIGHT_RED)
-        << "at creation outs: failed to generate_key_derivation("
-        << dst_entr.addr.viewPublicKey << ", " << txkey.secretKey << ")";
-      return false;
+      derivation_it = derivations.emplace(dst_entr.addr.viewPublicKey, derivation).first;
+    }
+    const KeyDerivation& derivation = derivation_it->second;
+
+    auto spend_context_it = spend_contexts.find(dst_entr.addr.spendPublicKey);
+    if (spend_context_it == spend_contexts.end()) {
+      spend_context_it = spend_contexts.emplace(dst_entr.addr.spendPublicKey, public_key_context(dst_entr.addr.spendPublicKey)).first;
     }
 
-    r = derive_public_key(derivation, output_index,
-      dst_entr.addr.spendPublicKey,
-      out_eph_public_key);
+    PublicKey out_eph_public_key;
+    bool r = spend_context_it->second.derive_public_key(derivation, output_index, out_eph_public_key);
     if (!(r)) {
       logger(ERROR, BRIGHT_RED)
         << "at creation outs: failed to derive_public_key(" << derivation
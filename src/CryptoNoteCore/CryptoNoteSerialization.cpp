@@ -27,6 +27,7 @@
 #include "Serialization/ISerializer.h"
 #include "Serialization/SerializationOverloads.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinaryMemoryInputSerializer.h"
 #include "Serialization/BinaryOutputStreamSerializer.h"
 
 #include "Common/StringOutputStream.h"
@@ -452,8 +453,7 @@ void serialize(TransactionExtraMergeMiningTag& tag, ISerializer& serializer) {
   } else {
     std::string field;
     serializer(field, "mm_tag");
-    MemoryInputStream stream(field.data(), field.size());
-    BinaryInputStreamSerializer input(stream);
+    BinaryMemoryInputSerializer input(field.data(), field.size());
     doSerialize(tag, input);
   }
 }
@@ -44,7 +44,22 @@ Crypto::Hash CryptoNote::getBinaryArrayHash(const BinaryArray& binaryArray) {
   return hash;
 }
 
-uint64_t CryptoNote::getInputAmount(const Transaction& transaction) {
+std::vector<Crypto::Hash> CryptoNote::getBinaryArrayHashes(const std::vector<BinaryArray>& binaryArrays) {
+  std::vector<const void*> data;
+  std::vector<size_t> lengths;
+  data.reserve(binaryArrays.size());
+  lengths.reserve(binaryArrays.size());
+  for (auto& binaryArray : binaryArrays) {
+    data.push_back(binaryArray.data());
+    lengths.push_back(binaryArray.size());
+  }
+
+  std::vector<Crypto::Hash> hashes(binaryArrays.size());
+  Crypto::cn_fast_hash_batch(data.data(), lengths.data(), data.size(), hashes.data());
+  return hashes;
+}
+
+uint64_t CryptoNote::getInputAmount(const TransactionPrefix& transaction) {
   uint64_t amount = 0;
   for (auto& input : transaction.inputs) {
     if (input.type() == typeid(KeyInput)) {
@@ -72,7 +87,7 @@ std::vector<uint64_t> CryptoNote::getInputsAmounts(const Transaction& transactio
   return inputsAmounts;
 }
 
-uint64_t CryptoNote::getOutputAmount(const Transaction& transaction) {
+uint64_t CryptoNote::getOutputAmount(const TransactionPrefix& transaction) {
   uint64_t amount = 0;
   for (auto& output : transaction.outputs) {
     amount += output.amount;
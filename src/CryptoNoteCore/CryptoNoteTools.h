@@ -23,6 +23,8 @@
 #include "Common/VectorOutputStream.h"
 #include "Serialization/BinaryOutputStreamSerializer.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinaryMemoryInputSerializer.h"
+#include "Serialization/BinarySizeSerializer.h"
 #include "CryptoNoteConfig.h"
 #include "CryptoNoteSerialization.h"
 
@@ -31,6 +33,7 @@ namespace CryptoNote {
 
 void getBinaryArrayHash(const BinaryArray& binaryArray, Crypto::Hash& hash);
 Crypto::Hash getBinaryArrayHash(const BinaryArray& binaryArray);
+std::vector<Crypto::Hash> getBinaryArrayHashes(const std::vector<BinaryArray>& binaryArrays);
 
 // noexcept
 template<class T>
@@ -60,10 +63,9 @@ BinaryArray toBinaryArray(const T& object) {
 template<class T>
 T fromBinaryArray(const BinaryArray& binaryArray) {
   T object;
-  Common::MemoryInputStream stream(binaryArray.data(), binaryArray.size());
-  BinaryInputStreamSerializer serializer(stream);
+  BinaryMemoryInputSerializer serializer(binaryArray.data(), binaryArray.size());
   serialize(object, serializer);
-  if (!stream.endOfStream()) { // check that all data was consumed
+  if (!serializer.endOfStream()) { // check that all data was consumed
     throw std::runtime_error("failed to unpack type");
   }
 
@@ -83,13 +85,15 @@ bool fromBinaryArray(T& object, const BinaryArray& binaryArray) {
 
 template<class T>
 bool getObjectBinarySize(const T& object, size_t& size) {
-  BinaryArray ba;
-  if (!toBinaryArray(object, ba)) {
+  try {
+    BinarySizeSerializer serializer;
+    serialize(const_cast<T&>(object), serializer);
+    size = serializer.getSize();
+  } catch (std::exception&) {
     size = (std::numeric_limits<size_t>::max)();
     return false;
   }
 
-  size = ba.size();
   return true;
 }
 
@@ -147,8 +151,8 @@ inline bool getBaseTransactionHash(const BaseTransaction& tx, Crypto::Hash& hash
   }
 }
 
-uint64_t getInputAmount(const Transaction& transaction);
+uint64_t getInputAmount(const TransactionPrefix& transaction);
 std::vector<uint64_t> getInputsAmounts(const Transaction& transaction);
-uint64_t getOutputAmount(const Transaction& transaction);
+uint64_t getOutputAmount(const TransactionPrefix& transaction);
 void decomposeAmount(uint64_t amount, uint64_t dustThreshold, std::vector<uint64_t>& decomposedAmounts);
 }
@@ -19,6 +19,7 @@
 
 #include "Currency.h"
 #include <cctype>
+#include <numeric>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
 #include "../Common/Math.h"
@@ -345,32 +346,34 @@ bool Currency::constructMinerTx(uint8_t blockMajorVersion, uint32_t height, size
         outAmounts.resize(outAmounts.size() - 1);
     }
 
-    uint64_t summaryAmounts = 0;
-    for (size_t no = 0; no < outAmounts.size(); no++) {
-        Crypto::KeyDerivation derivation = boost::value_initialized<Crypto::KeyDerivation>();
-        Crypto::PublicKey outEphemeralPubKey = boost::value_initialized<Crypto::PublicKey>();
+    // Every output goes to the same address under the same transaction key, so one derivation serves them all
+    // and the output keys are derived as one batch.
+    Crypto::KeyDerivation derivation = boost::value_initialized<Crypto::KeyDerivation>();
+    bool r = Crypto::generate_key_derivation(minerAddress.viewPublicKey, txkey.secretKey, derivation);
 
-        bool r = Crypto::generate_key_derivation(minerAddress.viewPublicKey, txkey.secretKey, derivation);
-
-        if (!(r)) {
-            logger(ERROR, BRIGHT_RED)
-                    << "while creating outs: failed to generate_key_derivation("
-                    << minerAddress.viewPublicKey << ", " << txkey.secretKey << ")";
-            return false;
-        }
+    if (!(r)) {
+        logger(ERROR, BRIGHT_RED)
+                << "while creating outs: failed to generate_key_derivation("
+                << minerAddress.viewPublicKey << ", " << txkey.secretKey << ")";
+        return false;
+    }
 
-        r = Crypto::derive_public_key(derivation, no, minerAddress.spendPublicKey, outEphemeralPubKey);
+    std::vector<size_t> outIndexes(outAmounts.size());
+    std::iota(outIndexes.begin(), outIndexes.end(), 0);
+    std::vector<Crypto::PublicKey> outEphemeralPubKeys(outAmounts.size());
+    r = Crypto::public_key_context(minerAddress.spendPublicKey).derive_public_keys(derivation, outIndexes.data(), outIndexes.size(), outEphemeralPubKeys.data());
 
-        if (!(r)) {
-            logger(ERROR, BRIGHT_RED)
-                    << "while creating outs: failed to derive_public_key("
-                    << derivation << ", " << no << ", "
-                    << minerAddress.spendPublicKey << ")";
-            return false;
-        }
+    if (!(r)) {
+        logger(ERROR, BRIGHT_RED)
+                << "while creating outs: failed to derive_public_key("
+                << derivation << ", " << minerAddress.spendPublicKey << ")";
+        return false;
+    }
 
+    uint64_t summaryAmounts = 0;
+    for (size_t no = 0; no < outAmounts.size(); no++) {
         KeyOutput tk;
-        tk.key = outEphemeralPubKey;
+        tk.key = outEphemeralPubKeys[no];
 
         TransactionOutput out;
         summaryAmounts += out.amount = outAmounts[no];
@@ -765,6 +768,8 @@ Currency::Currency(Currency&& currency) :
     m_lockedTxAllowedDeltaSeconds(currency.m_lockedTxAllowedDeltaSeconds),
     m_lockedTxAllowedDeltaBlocks(currency.m_lockedTxAllowedDeltaBlocks),
     m_mempoolTxLiveTime(currency.m_mempoolTxLiveTime),
+    m_mempoolMaxSize(currency.m_mempoolMaxSize),
+    m_mempoolIncrementalFeePerKilobyte(currency.m_mempoolIncrementalFeePerKilobyte),
     m_numberOfPeriodsToForgetTxDeletedFromPool(currency.m_numberOfPeriodsToForgetTxDeletedFromPool),
     m_fusionTxMaxSize(currency.m_fusionTxMaxSize),
     m_fusionTxMinInputCount(currency.m_fusionTxMinInputCount),
@@ -830,6 +835,8 @@ CurrencyBuilder::CurrencyBuilder(Logging::ILogger& log) : m_currency(log) {
     lockedTxAllowedDeltaBlocks(parameters::CRYPTONOTE_LOCKED_TX_ALLOWED_DELTA_BLOCKS);
 
     mempoolTxLiveTime(parameters::CRYPTONOTE_MEMPOOL_TX_LIVETIME);
+    mempoolMaxSize(parameters::CRYPTONOTE_MEMPOOL_MAX_SIZE);
+    mempoolIncrementalFeePerKilobyte(parameters::CRYPTONOTE_MEMPOOL_INCREMENTAL_FEE_PER_KB);
     mempoolTxFromAltBlockLiveTime(parameters::CRYPTONOTE_MEMPOOL_TX_FROM_ALT_BLOCK_LIVETIME);
     numberOfPeriodsToForgetTxDeletedFromPool(parameters::CRYPTONOTE_NUMBER_OF_PERIODS_TO_FORGET_TX_DELETED_FROM_POOL);
 
@@ -81,6 +81,8 @@ public:
   size_t lockedTxAllowedDeltaBlocks() const { return m_lockedTxAllowedDeltaBlocks; }
 
   uint64_t mempoolTxLiveTime() const { return m_mempoolTxLiveTime; }
+  uint64_t mempoolMaxSize() const { return m_mempoolMaxSize; }
+  uint64_t mempoolIncrementalFeePerKilobyte() const { return m_mempoolIncrementalFeePerKilobyte; }
   uint64_t mempoolTxFromAltBlockLiveTime() const { return m_mempoolTxFromAltBlockLiveTime; }
   uint64_t numberOfPeriodsToForgetTxDeletedFromPool() const { return m_numberOfPeriodsToForgetTxDeletedFromPool; }
 
@@ -193,6 +195,8 @@ private:
   size_t m_lockedTxAllowedDeltaBlocks;
 
   uint64_t m_mempoolTxLiveTime;
+  uint64_t m_mempoolMaxSize;
+  uint64_t m_mempoolIncrementalFeePerKilobyte;
   uint64_t m_mempoolTxFromAltBlockLiveTime;
   uint64_t m_numberOfPeriodsToForgetTxDeletedFromPool;
 
@@ -283,6 +287,8 @@ public:
   CurrencyBuilder& lockedTxAllowedDeltaBlocks(size_t val) { m_currency.m_lockedTxAllowedDeltaBlocks = val; return *this; }
 
   CurrencyBuilder& mempoolTxLiveTime(uint64_t val) { m_currency.m_mempoolTxLiveTime = val; return *this; }
+  CurrencyBuilder& mempoolMaxSize(uint64_t val) { m_currency.m_mempoolMaxSize = val; return *this; }
+  CurrencyBuilder& mempoolIncrementalFeePerKilobyte(uint64_t val) { m_currency.m_mempoolIncrementalFeePerKilobyte = val; return *this; }
   CurrencyBuilder& mempoolTxFromAltBlockLiveTime(uint64_t val) { m_currency.m_mempoolTxFromAltBlockLiveTime = val; return *this; }
   CurrencyBuilder& numberOfPeriodsToForgetTxDeletedFromPool(uint64_t val) { m_currency.m_numberOfPeriodsToForgetTxDeletedFromPool = val; return *this; }
 
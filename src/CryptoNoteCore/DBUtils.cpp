@@ -17,6 +17,8 @@
 
 #include "DBUtils.h"
 
+#include "Serialization/BinaryMemoryInputSerializer.h"
+
 namespace {
   const std::string RAW_BLOCK_NAME = "raw_block";
   const std::string RAW_TXS_NAME = "raw_txs";
@@ -36,9 +38,7 @@ namespace DB {
   }
 
   void deserialize(const std::string& serialized, RawBlock& value, const std::string& name) {
-    std::stringstream ss(serialized);
-    Common::StdInputStream stream(ss);
-    CryptoNote::BinaryInputStreamSerializer serializer(stream);
+    CryptoNote::BinaryMemoryInputSerializer serializer(serialized.data(), serialized.size());
     serializer(value.block, RAW_BLOCK_NAME);
     serializer(value.transactions, RAW_TXS_NAME);
   }
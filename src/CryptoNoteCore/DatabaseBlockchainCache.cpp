@@ -25,6 +25,7 @@
 #include <Common/ShuffleGenerator.h>
 
 #include "BlockchainUtils.h"
+#include "DataBaseErrors.h"
 
 #include "crypto/hash.h"
 
@@ -39,6 +40,7 @@ namespace {
 
 const uint32_t ONE_DAY_SECONDS = 60 * 60 * 24;
 const CachedBlockInfo NULL_CACHED_BLOCK_INFO {NULL_HASH, 0, 0, 0, 0, 0};
+const uint32_t DECOY_OUTPUTS_LOAD_BATCH_SIZE = 10000;
 
 bool requestPackedOutputs(IBlockchainCache::Amount amount, Common::ArrayView<uint32_t> globalIndexes, IDataBase& database, std::vector<PackedOutIndex>& result) {
   BlockchainReadBatch readBatch;
@@ -464,8 +466,10 @@ struct DatabaseBlockchainCache::ExtendedPushedBlockInfo {
 };
 
 
-DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger)
-    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache") {
+DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger,
+                                                 bool storeScanTables)
+    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache"),
+      storeScanTables(storeScanTables) {
   DatabaseVersionReadBatch readBatch;
   auto ec = database.read(readBatch);
   if (ec) {
@@ -474,7 +478,7 @@ DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase
 
   auto version = readBatch.getDbSchemeVersion();
   if (!version) {
-    logger(Logging::DEBUGGING) << "DB scheme version not found, writing: " << CURRENT_DB_SCHEME_VERSION;
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "DB scheme version not found, writing: " << CURRENT_DB_SCHEME_VERSION;
 
     DatabaseVersionWriteBatch writeBatch(CURRENT_DB_SCHEME_VERSION);
     auto writeError = database.write(writeBatch);
@@ -482,11 +486,11 @@ DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase
       throw std::system_error(writeError);
     }
   } else {
-    logger(Logging::DEBUGGING) << "Current db scheme version: " << *version;
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Current db scheme version: " << *version;
   }
 
   if (getTopBlockIndex() == 0) {
-    logger(Logging::DEBUGGING) << "top block index is nill, add genesis block";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "top block index is nill, add genesis block";
     addGenesisBlock(CachedBlock (currency.genesisBlock()));
   }
 }
@@ -542,7 +546,7 @@ void DatabaseBlockchainCache::deleteClosestTimestampBlockIndex(BlockchainWriteBa
     midnight += ONE_DAY_SECONDS;
   }
 
-  logger(Logging::TRACE) << "deleted closest timestamp";
+  LOG_MESSAGE(logger, Logging::TRACE) << "deleted closest timestamp";
 }
 
 /*
@@ -551,7 +555,7 @@ void DatabaseBlockchainCache::deleteClosestTimestampBlockIndex(BlockchainWriteBa
  */
 std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitBlockIndex) {
   assert(splitBlockIndex <= getTopBlockIndex());
-  logger(Logging::DEBUGGING) << "split at index " << splitBlockIndex << " started, top block index: " << getTopBlockIndex();
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "split at index " << splitBlockIndex << " started, top block index: " << getTopBlockIndex();
 
   auto cache = blockchainCacheFactory.createBlockchainCache(currency, this, splitBlockIndex);
 
@@ -564,7 +568,7 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
     ExtendedPushedBlockInfo extendedInfo = getExtendedPushedBlockInfo(blockIndex);
 
     auto validatorState = extendedInfo.pushedBlockInfo.validatorState;
-    logger(Logging::DEBUGGING) << "pushing block " << blockIndex << " to child segment";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "pushing block " << blockIndex << " to child segment";
     auto blockHash = pushBlockToAnotherCache(*cache, std::move(extendedInfo.pushedBlockInfo));
 
     deletingBlocks.emplace_back(blockIndex, blockHash, validatorState, extendedInfo.timestamp);
@@ -576,7 +580,7 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
     auto& validatorState = std::get<2>(*it);
     uint64_t timestamp = std::get<3>(*it);
 
-    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex);
+    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex).removeScanTable(blockIndex);
     requestDeleteSpentOutputs(writeBatch,
                               blockIndex,
                               validatorState);
@@ -608,7 +612,7 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
 
   deleteClosestTimestampBlockIndex(writeBatch, splitBlockIndex);
 
-  logger(Logging::DEBUGGING) << "Performing delete operations";
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Performing delete operations";
   // all data and indexes are now copied, no errors detected, can now erase data from database
   auto err = database.write(writeBatch);
   if (err) {
@@ -619,14 +623,14 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
   cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
 
   children.push_back(cache.get());
-  logger(Logging::TRACE) << "Delete successfull";
+  LOG_MESSAGE(logger, Logging::TRACE) << "Delete successfull";
 
   // invalidate top block index and hash
   topBlockIndex = boost::none;
   topBlockHash = boost::none;
   transactionsCount = boost::none;
 
-  logger(Logging::DEBUGGING) << "split completed";
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "split completed";
   // return new cache
   return cache;
 }
@@ -654,7 +658,7 @@ Crypto::Hash DatabaseBlockchainCache::pushBlockToAnotherCache(IBlockchainCache&
 }
 
 std::vector<Crypto::Hash> DatabaseBlockchainCache::requestTransactionHashesFromBlockIndex(uint32_t splitBlockIndex) {
-  logger(Logging::DEBUGGING) << "Requesting transaction hashes starting from block index " << splitBlockIndex;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Requesting transaction hashes starting from block index " << splitBlockIndex;
 
   BlockchainReadBatch readBatch;
   for (uint32_t blockIndex = splitBlockIndex; blockIndex <= getTopBlockIndex(); ++blockIndex) {
@@ -703,12 +707,12 @@ void DatabaseBlockchainCache::requestDeletePaymentId(BlockchainWriteBatch& write
   assert(count > 0);
   assert(count >= toDelete);
 
-  logger(Logging::DEBUGGING) << "Deleting last " << toDelete << " transaction hashes of payment id " << paymentId;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Deleting last " << toDelete << " transaction hashes of payment id " << paymentId;
   writeBatch.removePaymentId(paymentId, static_cast<uint32_t>(count - toDelete));
 }
 
 void DatabaseBlockchainCache::requestDeleteSpentOutputs(BlockchainWriteBatch& writeBatch, uint32_t blockIndex, const TransactionValidatorState& spentOutputs) {
-  logger(Logging::DEBUGGING) << "Deleting spent outputs for block index " << blockIndex;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Deleting spent outputs for block index " << blockIndex;
 
   std::vector<std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>> spentMultisigs(
         spentOutputs.spentMultisignatureGlobalIndexes.begin(),
@@ -724,7 +728,7 @@ void DatabaseBlockchainCache::requestDeleteKeyOutputs(BlockchainWriteBatch& writ
                                                       const std::map<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>& boundaries) {
   if (boundaries.empty()) {
     //hardly possible
-    logger(Logging::DEBUGGING) << "No key output amounts...";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "No key output amounts...";
     return;
   }
 
@@ -744,7 +748,7 @@ void DatabaseBlockchainCache::requestDeleteKeyOutputs(BlockchainWriteBatch& writ
 
 void DatabaseBlockchainCache::requestDeleteKeyOutputsAmount(BlockchainWriteBatch& writeBatch, IBlockchainCache::Amount amount,
                                                             IBlockchainCache::GlobalOutputIndex boundary, uint32_t outputsCount) {
-  logger(Logging::DEBUGGING) << "Requesting delete for key output amount " << amount <<
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Requesting delete for key output amount " << amount <<
                                 " starting from global index " << boundary << " to " << (outputsCount - 1);
 
   writeBatch.removeKeyOutputGlobalIndexes(amount, outputsCount - boundary, boundary);
@@ -753,12 +757,15 @@ void DatabaseBlockchainCache::requestDeleteKeyOutputsAmount(BlockchainWriteBatch
   }
 
   updateKeyOutputCount(amount, boundary - outputsCount);
+
+  std::lock_guard<std::mutex> lock(decoyOutputsMutex);
+  decoyOutputsIndex.cutOutputs(amount, boundary);
 }
 
 void DatabaseBlockchainCache::requestDeleteMultisignatureOutputs(BlockchainWriteBatch& writeBatch,
                                                                  const std::map<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>& boundaries) {
   if (boundaries.empty()) {
-    logger(Logging::DEBUGGING) << "No multisignature output amounts...";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "No multisignature output amounts...";
     return;
   }
 
@@ -777,7 +784,7 @@ void DatabaseBlockchainCache::requestDeleteMultisignatureOutputs(BlockchainWrite
 
 void DatabaseBlockchainCache::requestDeleteMultisignatureOutputsAmount(BlockchainWriteBatch& writeBatch, IBlockchainCache::Amount amount,
                                                                        IBlockchainCache::GlobalOutputIndex boundary, uint32_t outputsCount) {
-  logger(Logging::DEBUGGING) << "Requesting delete for multisignature output amount " << amount <<
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Requesting delete for multisignature output amount " << amount <<
                                 " starting from global index " << boundary << " to " << (outputsCount - 1);
   writeBatch.removeKeyOutputGlobalIndexes(amount, outputsCount - boundary, boundary);
   updateMultiOutputCount(amount, boundary - outputsCount);
@@ -796,10 +803,10 @@ void DatabaseBlockchainCache::requestRemoveTimestamp(BlockchainWriteBatch& batch
   indexes.erase(it);
 
   if (indexes.empty()) {
-    logger(Logging::DEBUGGING) << "Deleting timestamp " << timestamp;
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Deleting timestamp " << timestamp;
     batch.removeTimestamp(timestamp);
   } else {
-    logger(Logging::DEBUGGING) << "Deleting block hash " << blockHash << " from timestamp " << timestamp;
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Deleting block hash " << blockHash << " from timestamp " << timestamp;
     batch.insertTimestamp(timestamp, indexes);
   }
 }
@@ -807,10 +814,11 @@ void DatabaseBlockchainCache::requestRemoveTimestamp(BlockchainWriteBatch& batch
 void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTransaction,
                                               uint32_t blockIndex,
                                               uint16_t transactionBlockIndex,
-                                              BlockchainWriteBatch& batch) {
+                                              BlockchainWriteBatch& batch,
+                                              BlockScanTable* scanTable) {
 
-  logger(Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash();
-  const auto& tx = cachedTransaction.getTransaction();
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash();
+  const auto& tx = cachedTransaction.getTransactionPrefix();
 
   ExtendedTransactionInfo transactionCacheInfo;
   transactionCacheInfo.blockIndex = blockIndex;
@@ -857,6 +865,9 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
       outputInfo.outputIndex = poi.outputIndex;
 
       batch.insertKeyOutputInfo(output.amount, globalIndex, outputInfo);
+
+      std::lock_guard<std::mutex> lock(decoyOutputsMutex);
+      decoyOutputsIndex.pushOutput(output.amount, globalIndex, blockIndex, tx.unlockTime);
     } else if (output.target.type() == typeid(MultisignatureOutput)) {
       multiIndexes[output.amount].push_back(poi);
       auto outputCountForAmount = updateMultiOutputCount(output.amount, 1);
@@ -892,26 +903,30 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
   }
 
   Crypto::Hash paymentId;
-  if (getPaymentIdFromTxExtra(cachedTransaction.getTransaction().extra, paymentId)) {
+  if (getPaymentIdFromTxExtra(cachedTransaction.getTransactionPrefix().extra, paymentId)) {
     insertPaymentId(batch, cachedTransaction.getTransactionHash(), paymentId);
   }
 
+  if (scanTable != nullptr) {
+    scanTable->transactions.push_back(makeScanTableTransaction(cachedTransaction, transactionCacheInfo.globalIndexes));
+  }
+
   batch.insertCachedTransaction(transactionCacheInfo, getCachedTransactionsCount() + 1);
   transactionsCount = *transactionsCount + 1;
-  logger(Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash() << " finished";
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash() << " finished";
 }
 
 uint32_t DatabaseBlockchainCache::updateKeyOutputCount(Amount amount, int32_t diff) const {
   auto it = keyOutputCountsForAmounts.find(amount);
   if (it == keyOutputCountsForAmounts.end()) {
-    logger(Logging::TRACE) << "updateKeyOutputCount: failed to found key for amount, request database";
+    LOG_MESSAGE(logger, Logging::TRACE) << "updateKeyOutputCount: failed to found key for amount, request database";
 
     BlockchainReadBatch batch;
     auto result = readDatabase(batch.requestKeyOutputGlobalIndexesCountForAmount(amount));
     auto found = result.getKeyOutputGlobalIndexesCountForAmounts().find(amount);
     auto val = found != result.getKeyOutputGlobalIndexesCountForAmounts().end() ? found->second : 0;
     it = keyOutputCountsForAmounts.insert({ amount, val }).first;
-    logger(Logging::TRACE) << "updateKeyOutputCount: database replied: amount " << amount << " value " << val;
+    LOG_MESSAGE(logger, Logging::TRACE) << "updateKeyOutputCount: database replied: amount " << amount << " value " << val;
 
     if (val == 0) {
       if (!keyOutputAmountsCount) {
@@ -934,14 +949,14 @@ uint32_t DatabaseBlockchainCache::updateKeyOutputCount(Amount amount, int32_t di
 uint32_t DatabaseBlockchainCache::updateMultiOutputCount(Amount amount, int32_t diff) const {
   auto it = multiOutputCountsForAmounts.find(amount);
   if (it == multiOutputCountsForAmounts.end()) {
-    logger(Logging::TRACE) << "updateMultiOutputCount: failed to found key for amount, request database";
+    LOG_MESSAGE(logger, Logging::TRACE) << "updateMultiOutputCount: failed to found key for amount, request database";
 
     BlockchainReadBatch batch;
     auto result = readDatabase(batch.requestMultisignatureOutputGlobalIndexesCountForAmount(amount));
     auto found = result.getMultisignatureOutputGlobalIndexesCountForAmounts().find(amount);
     auto val = found != result.getMultisignatureOutputGlobalIndexesCountForAmounts().end() ? found->second : 0;
     it = multiOutputCountsForAmounts.insert({ amount, val }).first;
-    logger(Logging::TRACE) << "updateMultiOutputCount: database replied: amount " << amount << " value " << val;
+    LOG_MESSAGE(logger, Logging::TRACE) << "updateMultiOutputCount: database replied: amount " << amount << " value " << val;
 
     if (val == 0) {
       if (!multiOutputAmountsCount) {
@@ -997,7 +1012,7 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
                                         const TransactionValidatorState& validatorState, size_t blockSize,
                                         uint64_t generatedCoins, Difficulty blockDifficulty, RawBlock&& rawBlock) {
   BlockchainWriteBatch batch;
-  logger(Logging::DEBUGGING) << "push block with hash " << cachedBlock.getBlockHash() << ", and "
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "push block with hash " << cachedBlock.getBlockHash() << ", and "
                              << cachedTransactions.size() + 1 << " transactions"; //+1 for base transaction
 
   // TODO: cache top block difficulty, size, timestamp, coins; use it here
@@ -1027,11 +1042,24 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   batch.insertCachedBlock(blockInfo, getTopBlockIndex() + 1, txHashes);
   batch.insertRawBlock(getTopBlockIndex() + 1, std::move(rawBlock));
 
+  BlockScanTable scanTable;
+  BlockScanTable* scanTablePtr = nullptr;
+  if (storeScanTables) {
+    scanTable.blockHash = cachedBlock.getBlockHash();
+    scanTable.timestamp = cachedBlock.getBlock().timestamp;
+    scanTable.transactions.reserve(cachedTransactions.size() + 1);
+    scanTablePtr = &scanTable;
+  }
+
   auto transactionIndex = 0;
-  pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch);
+  pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch, scanTablePtr);
 
   for (const auto& transaction: cachedTransactions) {
-    pushTransaction(transaction, getTopBlockIndex() + 1, transactionIndex++, batch);
+    pushTransaction(transaction, getTopBlockIndex() + 1, transactionIndex++, batch, scanTablePtr);
+  }
+
+  if (storeScanTables) {
+    batch.insertScanTable(getTopBlockIndex() + 1, scanTable);
   }
 
   auto closestBlockIndexDb = requestClosestBlockIndexByTimestamp(roundToMidnight(cachedBlock.getBlock().timestamp), database);
@@ -1054,7 +1082,7 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
 
   topBlockIndex = *topBlockIndex + 1;
   topBlockHash = cachedBlock.getBlockHash();
-  logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
 
   unitsCache.push_back(blockInfo);
   if (unitsCache.size() > unitsCacheSize) {
@@ -1122,7 +1150,7 @@ DatabaseBlockchainCache::extractKeyOutputKeys(uint64_t amount, uint32_t blockInd
                                               std::vector<Crypto::PublicKey>& publicKeys) const {
   return extractKeyOutputs(amount, blockIndex, globalIndexes, [this, &publicKeys, blockIndex] (const CachedTransactionInfo& info, PackedOutIndex index, uint32_t globalIndex) {
     if (!isTransactionSpendTimeUnlocked(info.unlockTime, blockIndex)) {
-      logger(Logging::DEBUGGING) << "extractKeyOutputKeys: output " << globalIndex << " is locked";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "extractKeyOutputKeys: output " << globalIndex << " is locked";
       return ExtractOutputKeysResult::OUTPUT_LOCKED;
     }
 
@@ -1183,7 +1211,7 @@ std::pair<Crypto::Hash, size_t> DatabaseBlockchainCache::getMultisignatureOutput
   });
 
   if (!res) {
-    logger(Logging::DEBUGGING) << "getMultisignatureOutputReference failed: output not found";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "getMultisignatureOutputReference failed: output not found";
     throw std::runtime_error("Output not found");
   }
 
@@ -1206,7 +1234,7 @@ bool DatabaseBlockchainCache::doGetMultisignatureOutputIfExists(
   auto readResult = batch.extractResult();
   auto it = readResult.getMultisignatureOutputGlobalIndexesForAmounts().find({ amount, globalIndex });
   if (it == readResult.getMultisignatureOutputGlobalIndexesForAmounts().end()) {
-    logger(Logging::DEBUGGING) << "doGetMultisignatureOutputIfExists failed: output not found";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "doGetMultisignatureOutputIfExists failed: output not found";
     return false;
   }
 
@@ -1218,7 +1246,7 @@ bool DatabaseBlockchainCache::doGetMultisignatureOutputIfExists(
 
   std::vector<CachedTransactionInfo> transactions;
   if (!requestCachedTransactionInfos({packedOut}, database, transactions)) {
-    logger(Logging::DEBUGGING) << "doGetMultisignatureOutputIfExists failed: requestCachedTransactionInfos failed";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "doGetMultisignatureOutputIfExists failed: requestCachedTransactionInfos failed";
     return false;
   }
 
@@ -1238,7 +1266,7 @@ uint32_t DatabaseBlockchainCache::getTopBlockIndex() const {
 
     auto readResult = batch.extractResult();
     if (!readResult.getLastBlockIndex().second) {
-      logger(Logging::TRACE) << "Top block index does not exist in database";
+      LOG_MESSAGE(logger, Logging::TRACE) << "Top block index does not exist in database";
       topBlockIndex = 0;
     }
 
@@ -1268,7 +1296,7 @@ uint64_t DatabaseBlockchainCache::getCachedTransactionsCount() const {
 
     auto readResult = batch.extractResult();
     if (!readResult.getTransactionsCount().second) {
-      logger(Logging::TRACE) << "Transactions count does not exist in database";
+      LOG_MESSAGE(logger, Logging::TRACE) << "Transactions count does not exist in database";
       transactionsCount = 0;
     } else {
       transactionsCount = readResult.getTransactionsCount().first;
@@ -1550,7 +1578,7 @@ size_t DatabaseBlockchainCache::getKeyOutputsCountForAmount(uint64_t amount, uin
   });
 
   size_t result = static_cast<size_t>(std::distance(begin, it));
-  logger(Logging::DEBUGGING) << "Key outputs count for amount " << amount << " is " << result << " by block index " << blockIndex;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Key outputs count for amount " << amount << " is " << result << " by block index " << blockIndex;
 
   return result;
 }
@@ -1567,7 +1595,7 @@ size_t DatabaseBlockchainCache::getMultisignatureCountForAmount(uint64_t amount,
   });
 
   size_t result = static_cast<size_t>(std::distance(begin, it));
-  logger(Logging::DEBUGGING) << "Multisignature outputs count for amount " << amount << " is " << result << " by block index " << blockIndex;
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Multisignature outputs count for amount " << amount << " is " << result << " by block index " << blockIndex;
 
   return result;
 }
@@ -1578,7 +1606,7 @@ uint32_t DatabaseBlockchainCache::getTimestampLowerBoundBlockIndex(uint64_t time
   while (midnight > 0) {
     auto dbRes = requestClosestBlockIndexByTimestamp(midnight, database);
     if (!dbRes.second) {
-      logger(Logging::DEBUGGING) << "getTimestampLowerBoundBlockIndex failed: failed to read database";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "getTimestampLowerBoundBlockIndex failed: failed to read database";
       throw std::runtime_error("Couldn't get closest to timestamp block index");
     }
 
@@ -1598,14 +1626,14 @@ bool DatabaseBlockchainCache::getTransactionGlobalIndexes(const Crypto::Hash& tr
   auto batch = BlockchainReadBatch().requestCachedTransaction(transactionHash);
   auto result = database.read(batch);
   if (result) {
-    logger(Logging::DEBUGGING) << "getTransactionGlobalIndexes failed: failed to read database";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "getTransactionGlobalIndexes failed: failed to read database";
     return false;
   }
 
   auto readResult = batch.extractResult();
   auto it = readResult.getCachedTransactions().find(transactionHash);
   if (it == readResult.getCachedTransactions().end()) {
-    logger(Logging::DEBUGGING) << "getTransactionGlobalIndexes failed: cached transaction for hash " << transactionHash << " not present";
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "getTransactionGlobalIndexes failed: cached transaction for hash " << transactionHash << " not present";
     return false;
   }
 
@@ -1674,14 +1702,14 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
   for (const auto& hash: transactions) {
     auto transactionIt = hashesMap.find(hash);
     if (transactionIt == hashesMap.end()) {
-      logger(Logging::DEBUGGING) << "detected missing transaction for hash " << hash << " in getRawTransaction";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "detected missing transaction for hash " << hash << " in getRawTransaction";
       missedTransactions.push_back(hash);
       continue;
     }
 
     auto blockIt = blocksMap.find(transactionIt->second.blockIndex);
     if (blockIt == blocksMap.end()) {
-      logger(Logging::DEBUGGING) << "detected missing transaction for hash " << hash << " in getRawTransaction";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "detected missing transaction for hash " << hash << " in getRawTransaction";
       missedTransactions.push_back(hash);
       continue;
     }
@@ -1696,6 +1724,23 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
   }
 }
 
+BlockScanTable DatabaseBlockchainCache::getBlockScanTable(uint32_t blockIndex) const {
+  if (storeScanTables) {
+    auto batch = BlockchainReadBatch().requestScanTable(blockIndex);
+    auto result = database.read(batch);
+    if (!result) {
+      auto readResult = batch.extractResult();
+      auto it = readResult.getScanTables().find(blockIndex);
+      if (it != readResult.getScanTables().end()) {
+        return it->second;
+      }
+    }
+  }
+
+  // the table was not stored: the block was pushed before scan tables were enabled
+  return makeBlockScanTable(*this, blockIndex);
+}
+
 RawBlock DatabaseBlockchainCache::getBlockByIndex(uint32_t index) const {
   auto batch = BlockchainReadBatch().requestRawBlock(index);
   auto res = readDatabase(batch);
@@ -1713,58 +1758,83 @@ std::vector<Crypto::Hash> DatabaseBlockchainCache::getTransactionHashes() const
 
 std::vector<uint32_t> DatabaseBlockchainCache::getRandomOutsByAmount(uint64_t amount, size_t count,
                                                                      uint32_t blockIndex) const {
-  auto batch = BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount);
-  auto result = readDatabase(batch);
-  auto outputsCount = result.getKeyOutputGlobalIndexesCountForAmounts();
-  auto outputsToPick = std::min(static_cast<uint32_t>(count), outputsCount[amount]);
+  uint32_t uppperBlockIndex = 0;
+  if (blockIndex > currency.minedMoneyUnlockWindow()) {
+    uppperBlockIndex = blockIndex - currency.minedMoneyUnlockWindow();
+  }
 
-  std::vector<uint32_t> resultOuts;
-  resultOuts.reserve(outputsToPick);
+  auto isUnlocked = [this, blockIndex] (uint64_t unlockTime) {
+    return isTransactionSpendTimeUnlocked(unlockTime, blockIndex);
+  };
 
-  ShuffleGenerator<uint32_t, Crypto::random_engine<uint32_t>> generator(outputsCount[amount]);
+  for (;;) {
+    uint64_t loadId;
+    {
+      std::lock_guard<std::mutex> lock(decoyOutputsMutex);
+      if (decoyOutputsIndex.hasAmount(amount)) {
+        return decoyOutputsIndex.getRandomOuts(amount, count, uppperBlockIndex, isUnlocked);
+      }
 
-  while (outputsToPick) {
-    std::vector<uint32_t> globalIndexes;
-    globalIndexes.reserve(outputsToPick);
+      loadId = decoyOutputsIndex.beginLoad(amount);
+    }
 
+    // the database is scanned without decoyOutputsMutex, so pushBlock doesn't wait for it
+    std::vector<uint32_t> blockIndexes;
+    DecoyOutputsIndex::UnlockTimes unlockTimes;
     try {
-      for (uint32_t i = 0; i < outputsToPick; ++i, globalIndexes.push_back(generator())) { }
-      //std::generate_n(std::back_inserter(globalIndexes), outputsToPick, generator);
-    } catch (const SequenceEnded&) {
-      logger(Logging::TRACE) << "getRandomOutsByAmount: generator reached sequence end";
-      return resultOuts;
+      loadDecoyOutputs(amount, blockIndexes, unlockTimes);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(decoyOutputsMutex);
+      decoyOutputsIndex.cancelLoad(loadId);
+      throw;
     }
 
-    std::vector<PackedOutIndex> outputs;
-    if (extractKeyOtputIndexes(amount, Common::ArrayView<uint32_t>(globalIndexes.data(), globalIndexes.size()), outputs) != ExtractOutputKeysResult::SUCCESS) {
-      logger(Logging::DEBUGGING) << "getRandomOutsByAmount: failed to extract key output indexes";
-      throw std::runtime_error("Invalid output index"); //TODO: make error code
+    std::lock_guard<std::mutex> lock(decoyOutputsMutex);
+    if (decoyOutputsIndex.finishLoad(loadId, std::move(blockIndexes), std::move(unlockTimes))) {
+      return decoyOutputsIndex.getRandomOuts(amount, count, uppperBlockIndex, isUnlocked);
     }
 
-    std::vector<ExtendedTransactionInfo> transactions;
-    if (!requestExtendedTransactionInfos(outputs, database, transactions)) {
-      logger(Logging::TRACE) << "getRandomOutsByAmount: requestExtendedTransactionInfos failed";
-      throw std::runtime_error("Error while requesting transactions"); //TODO: make error code
-    }
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Key outputs of amount " << amount << " changed while loading, loading again";
+  }
+}
 
-    assert(globalIndexes.size() == transactions.size());
+void DatabaseBlockchainCache::loadDecoyOutputs(Amount amount, std::vector<uint32_t>& blockIndexes,
+                                               DecoyOutputsIndex::UnlockTimes& unlockTimes) const {
+  auto countResult = readDatabase(BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount));
+  const auto& counts = countResult.getKeyOutputGlobalIndexesCountForAmounts();
+  auto countIt = counts.find(amount);
+  uint32_t outputsCount = countIt != counts.end() ? countIt->second : 0;
 
-    uint32_t uppperBlockIndex = 0;
-    if (blockIndex > currency.minedMoneyUnlockWindow()) {
-      uppperBlockIndex = blockIndex - currency.minedMoneyUnlockWindow();
+  LOG_MESSAGE(logger, Logging::DEBUGGING) << "Loading " << outputsCount << " key outputs of amount " << amount << " to decoy index";
+
+  blockIndexes.reserve(outputsCount);
+
+  for (uint32_t batchStart = 0; batchStart < outputsCount; batchStart += DECOY_OUTPUTS_LOAD_BATCH_SIZE) {
+    uint32_t batchEnd = std::min(outputsCount, batchStart + DECOY_OUTPUTS_LOAD_BATCH_SIZE);
+
+    BlockchainReadBatch batch;
+    for (GlobalOutputIndex globalIndex = batchStart; globalIndex < batchEnd; ++globalIndex) {
+      batch.requestKeyOutputGlobalIndexForAmount(amount, globalIndex);
+      batch.requestKeyOutputInfo(amount, globalIndex);
     }
 
-    for (size_t i = 0; i < transactions.size(); ++i) {
-      if (!isTransactionSpendTimeUnlocked(transactions[i].unlockTime, blockIndex) || transactions[i].blockIndex > uppperBlockIndex) {
-        continue;
+    auto result = readDatabase(batch);
+    const auto& packedOuts = result.getKeyOutputGlobalIndexesForAmounts();
+    const auto& outputInfos = result.getKeyOutputInfo();
+    for (GlobalOutputIndex globalIndex = batchStart; globalIndex < batchEnd; ++globalIndex) {
+      auto packedIt = packedOuts.find(std::make_pair(amount, globalIndex));
+      auto infoIt = outputInfos.find(std::make_pair(amount, globalIndex));
+      if (packedIt == packedOuts.end() || infoIt == outputInfos.end()) {
+        logger(Logging::ERROR) << "loadDecoyOutputs: key output " << globalIndex << " of amount " << amount << " not found";
+        throw std::system_error(make_error_code(error::DataBaseErrorCodes::INTERNAL_ERROR), "Invalid output index");
       }
 
-      resultOuts.push_back(globalIndexes[i]);
-      --outputsToPick;
+      blockIndexes.push_back(packedIt->second.blockIndex);
+      if (infoIt->second.unlockTime != 0) {
+        unlockTimes.emplace(globalIndex, infoIt->second.unlockTime);
+      }
     }
   }
-
-  return resultOuts;
 }
 
 ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
@@ -1790,7 +1860,7 @@ ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
     //TODO: change the interface of extractKeyOutputs to return vector of structures instead of passing callback as predicate
     auto ret = callback(tx, fakePoi, kv.first.second);
     if (ret != ExtractOutputKeysResult::SUCCESS) {
-      logger(Logging::DEBUGGING) << "extractKeyOutputs failed : callback returned error";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << "extractKeyOutputs failed : callback returned error";
       return ret;
     }
   }
@@ -1922,7 +1992,7 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   auto baseTransaction = genesisBlock.getBlock().baseTransaction;
   auto cachedBaseTransaction = CachedTransaction{std::move(baseTransaction)};
 
-  pushTransaction(cachedBaseTransaction, 0, 0, batch);
+  pushTransaction(cachedBaseTransaction, 0, 0, batch, nullptr);
 
   batch.insertCachedBlock(blockInfo, 0, {cachedBaseTransaction.getTransactionHash()});
   batch.insertRawBlock(0, {toBinaryArray(genesisBlock.getBlock()), {}});
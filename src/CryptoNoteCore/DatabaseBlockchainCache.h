@@ -17,15 +17,19 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "Common/StringView.h"
 #include "Currency.h"
 #include "Difficulty.h"
 #include "IBlockchainCache.h"
 #include "CryptoNoteCore/UpgradeManager.h"
 #include <IDataBase.h>
+#include <CryptoNoteCore/BlockScanTable.h>
 #include <CryptoNoteCore/BlockchainReadBatch.h>
 #include <CryptoNoteCore/BlockchainWriteBatch.h>
 #include <CryptoNoteCore/DatabaseCacheData.h>
+#include <CryptoNoteCore/DecoyOutputsIndex.h>
 #include <CryptoNoteCore/IBlockchainCacheFactory.h>
 
 namespace CryptoNote {
@@ -45,9 +49,12 @@ public:
   /*
    * Constructs new DatabaseBlockchainCache object. Currnetly, only factories that produce 
    * BlockchainCache objects as children are supported.
+   * With storeScanTables every pushed block also gets its BlockScanTable written, blocks pushed
+   * before that have their table built from the raw block on request.
    */
   DatabaseBlockchainCache(const Currency& currency, IDataBase& dataBase,
-                          IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& logger);
+                          IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& logger,
+                          bool storeScanTables = false);
 
   static bool checkDBSchemeVersion(IDataBase& dataBase, Logging::ILogger& logger);
 
@@ -170,6 +177,8 @@ public:
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const override;
 
+  virtual BlockScanTable getBlockScanTable(uint32_t blockIndex) const override;
+
 private:
   const Currency& currency;
   IDataBase& database;
@@ -185,6 +194,10 @@ private:
   Logging::LoggerRef logger;
   std::deque<CachedBlockInfo> unitsCache;
   const size_t unitsCacheSize = 1000;
+  // random outputs are requested from RPC threads while the core thread pushes and splits blocks
+  mutable std::mutex decoyOutputsMutex;
+  mutable DecoyOutputsIndex decoyOutputsIndex;
+  const bool storeScanTables;
 
   struct ExtendedPushedBlockInfo;
   ExtendedPushedBlockInfo getExtendedPushedBlockInfo(uint32_t blockIndex) const;
@@ -197,12 +210,14 @@ private:
   void pushTransaction(const CachedTransaction& cachedTransaction,
                        uint32_t blockIndex,
                        uint16_t transactionBlockIndex,
-                       BlockchainWriteBatch& batch);
+                       BlockchainWriteBatch& batch,
+                       BlockScanTable* scanTable);
 
   uint32_t insertKeyOutputToGlobalIndex(uint64_t amount, PackedOutIndex output); //TODO not implemented. Should it be removed?
   uint32_t insertMultisignatureToGlobalIndex(uint64_t amount, PackedOutIndex output);
   uint32_t updateKeyOutputCount(Amount amount, int32_t diff) const;
   uint32_t updateMultiOutputCount(Amount amount, int32_t diff) const;
+  void loadDecoyOutputs(Amount amount, std::vector<uint32_t>& blockIndexes, DecoyOutputsIndex::UnlockTimes& unlockTimes) const;
   void insertPaymentId(BlockchainWriteBatch& batch, const Crypto::Hash& transactionHash, const Crypto::Hash& paymentId);
   void insertBlockTimestamp(BlockchainWriteBatch& batch, uint64_t timestamp, const Crypto::Hash& blockHash);
 
@@ -0,0 +1,225 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "DecoyOutputsIndex.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Common/ShuffleGenerator.h"
+#include "crypto/crypto.h"
+
+namespace CryptoNote {
+
+bool DecoyOutputsIndex::hasAmount(Amount amount) const {
+  return outputs.count(amount) != 0;
+}
+
+void DecoyOutputsIndex::addAmount(Amount amount, std::vector<uint32_t>&& blockIndexes, UnlockTimes&& unlockTimes) {
+  assert(std::is_sorted(blockIndexes.begin(), blockIndexes.end()));
+
+  AmountOutputs& amountOutputs = outputs[amount];
+  amountOutputs.blockIndexes = std::move(blockIndexes);
+  amountOutputs.unlockTimes = std::move(unlockTimes);
+  amountOutputs.prefixValid = false;
+}
+
+void DecoyOutputsIndex::clear() {
+  outputs.clear();
+  loads.clear();
+}
+
+uint64_t DecoyOutputsIndex::beginLoad(Amount amount) {
+  uint64_t loadId = nextLoadId++;
+  loads[loadId].amount = amount;
+  return loadId;
+}
+
+bool DecoyOutputsIndex::finishLoad(uint64_t loadId, std::vector<uint32_t>&& blockIndexes, UnlockTimes&& unlockTimes) {
+  auto loadIt = loads.find(loadId);
+  if (loadIt == loads.end()) {
+    // the index was cleared in the meantime
+    return false;
+  }
+
+  Load load = std::move(loadIt->second);
+  loads.erase(loadIt);
+  if (hasAmount(load.amount)) {
+    // a concurrent request has already loaded it
+    return true;
+  }
+
+  for (const auto& change : load.changes) {
+    if (change.cut) {
+      if (change.globalIndex < blockIndexes.size()) {
+        blockIndexes.resize(change.globalIndex);
+      }
+
+      for (auto unlockIt = unlockTimes.begin(); unlockIt != unlockTimes.end();) {
+        if (unlockIt->first >= change.globalIndex) {
+          unlockIt = unlockTimes.erase(unlockIt);
+        } else {
+          ++unlockIt;
+        }
+      }
+
+      continue;
+    }
+
+    if (change.globalIndex > blockIndexes.size()) {
+      return false;
+    }
+
+    // an output below the loaded count was either read already or pushed again after a cut
+    if (change.globalIndex == blockIndexes.size()) {
+      blockIndexes.push_back(change.blockIndex);
+    } else {
+      blockIndexes[change.globalIndex] = change.blockIndex;
+    }
+
+    unlockTimes.erase(change.globalIndex);
+    if (change.unlockTime != 0) {
+      unlockTimes.emplace(change.globalIndex, change.unlockTime);
+    }
+  }
+
+  if (!std::is_sorted(blockIndexes.begin(), blockIndexes.end())) {
+    return false;
+  }
+
+  addAmount(load.amount, std::move(blockIndexes), std::move(unlockTimes));
+  return true;
+}
+
+void DecoyOutputsIndex::cancelLoad(uint64_t loadId) {
+  loads.erase(loadId);
+}
+
+void DecoyOutputsIndex::recordChange(Amount amount, const LoadChange& change) {
+  for (auto& load : loads) {
+    if (load.second.amount == amount) {
+      load.second.changes.push_back(change);
+    }
+  }
+}
+
+void DecoyOutputsIndex::pushOutput(Amount amount, GlobalOutputIndex globalIndex, uint32_t blockIndex, uint64_t unlockTime) {
+  if (!loads.empty()) {
+    recordChange(amount, LoadChange{false, globalIndex, blockIndex, unlockTime});
+  }
+
+  auto it = outputs.find(amount);
+  if (it == outputs.end()) {
+    return;
+  }
+
+  AmountOutputs& amountOutputs = it->second;
+  if (globalIndex != amountOutputs.blockIndexes.size()) {
+    // The amount was loaded while a block with its outputs was being written and misses some of them,
+    // it is dropped and read from database again on next request
+    outputs.erase(it);
+    return;
+  }
+
+  assert(amountOutputs.blockIndexes.empty() || amountOutputs.blockIndexes.back() <= blockIndex);
+
+  amountOutputs.blockIndexes.push_back(blockIndex);
+  if (unlockTime != 0) {
+    amountOutputs.unlockTimes.emplace(globalIndex, unlockTime);
+  }
+
+  amountOutputs.prefixValid = false;
+}
+
+void DecoyOutputsIndex::cutOutputs(Amount amount, GlobalOutputIndex boundary) {
+  if (!loads.empty()) {
+    recordChange(amount, LoadChange{true, boundary, 0, 0});
+  }
+
+  auto it = outputs.find(amount);
+  if (it == outputs.end()) {
+    return;
+  }
+
+  AmountOutputs& amountOutputs = it->second;
+  if (boundary >= amountOutputs.blockIndexes.size()) {
+    return;
+  }
+
+  amountOutputs.blockIndexes.resize(boundary);
+  for (auto unlockIt = amountOutputs.unlockTimes.begin(); unlockIt != amountOutputs.unlockTimes.end();) {
+    if (unlockIt->first >= boundary) {
+      unlockIt = amountOutputs.unlockTimes.erase(unlockIt);
+    } else {
+      ++unlockIt;
+    }
+  }
+
+  amountOutputs.prefixValid = false;
+}
+
+uint32_t DecoyOutputsIndex::getOutputsCount(Amount amount) const {
+  auto it = outputs.find(amount);
+  return it != outputs.end() ? static_cast<uint32_t>(it->second.blockIndexes.size()) : 0;
+}
+
+uint32_t DecoyOutputsIndex::getSpendablePrefix(Amount amount, uint32_t maxBlockIndex) const {
+  auto it = outputs.find(amount);
+  if (it == outputs.end()) {
+    return 0;
+  }
+
+  const AmountOutputs& amountOutputs = it->second;
+  if (!amountOutputs.prefixValid || amountOutputs.prefixBlockIndex != maxBlockIndex) {
+    auto end = std::upper_bound(amountOutputs.blockIndexes.begin(), amountOutputs.blockIndexes.end(), maxBlockIndex);
+    amountOutputs.prefixSize = static_cast<uint32_t>(std::distance(amountOutputs.blockIndexes.begin(), end));
+    amountOutputs.prefixBlockIndex = maxBlockIndex;
+    amountOutputs.prefixValid = true;
+  }
+
+  return amountOutputs.prefixSize;
+}
+
+std::vector<DecoyOutputsIndex::GlobalOutputIndex> DecoyOutputsIndex::getRandomOuts(Amount amount, size_t count, uint32_t maxBlockIndex,
+  const UnlockPredicate& isUnlocked) const {
+
+  std::vector<GlobalOutputIndex> result;
+  auto it = outputs.find(amount);
+  if (it == outputs.end()) {
+    return result;
+  }
+
+  const UnlockTimes& unlockTimes = it->second.unlockTimes;
+  uint32_t prefix = getSpendablePrefix(amount, maxBlockIndex);
+  result.reserve(std::min(count, static_cast<size_t>(prefix)));
+
+  ShuffleGenerator<uint32_t, Crypto::random_engine<uint32_t>> generator(prefix);
+  while (result.size() < count && !generator.empty()) {
+    GlobalOutputIndex globalIndex = generator();
+
+    auto unlockIt = unlockTimes.find(globalIndex);
+    if (unlockIt != unlockTimes.end() && !isUnlocked(unlockIt->second)) {
+      continue;
+    }
+
+    result.push_back(globalIndex);
+  }
+
+  return result;
+}
+
+}
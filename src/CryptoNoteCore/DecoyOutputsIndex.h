@@ -0,0 +1,90 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace CryptoNote {
+
+/*
+ * In-memory index of key outputs used to pick mixins. For every loaded amount it keeps the block index
+ * of each output in global index order and the unlock times that are not zero, so random outputs can be
+ * drawn without reading the database. Global indexes are assigned in block order, so outputs created up
+ * to some block always form a prefix of the global index range.
+ */
+class DecoyOutputsIndex {
+public:
+  using Amount = uint64_t;
+  using GlobalOutputIndex = uint32_t;
+  using UnlockTimes = std::unordered_map<GlobalOutputIndex, uint64_t>;
+  using UnlockPredicate = std::function<bool(uint64_t unlockTime)>;
+
+  bool hasAmount(Amount amount) const;
+  void addAmount(Amount amount, std::vector<uint32_t>&& blockIndexes, UnlockTimes&& unlockTimes);
+  void clear();
+
+  // An amount may be read from database without holding the lock that guards the index. Outputs pushed
+  // or cut between beginLoad and finishLoad are recorded and replayed over the loaded ones.
+  uint64_t beginLoad(Amount amount);
+  // Returns false if the loaded outputs can't be reconciled with the recorded changes, the amount isn't added then
+  bool finishLoad(uint64_t loadId, std::vector<uint32_t>&& blockIndexes, UnlockTimes&& unlockTimes);
+  void cancelLoad(uint64_t loadId);
+
+  // Outputs of amounts that are not loaded are ignored, they are read from database on first request.
+  // An output that does not follow the loaded ones drops its amount, so it is read again as well
+  void pushOutput(Amount amount, GlobalOutputIndex globalIndex, uint32_t blockIndex, uint64_t unlockTime);
+  void cutOutputs(Amount amount, GlobalOutputIndex boundary);
+
+  uint32_t getOutputsCount(Amount amount) const;
+  // Number of outputs created in blocks up to maxBlockIndex inclusive
+  uint32_t getSpendablePrefix(Amount amount, uint32_t maxBlockIndex) const;
+  std::vector<GlobalOutputIndex> getRandomOuts(Amount amount, size_t count, uint32_t maxBlockIndex, const UnlockPredicate& isUnlocked) const;
+
+private:
+  struct AmountOutputs {
+    std::vector<uint32_t> blockIndexes;
+    UnlockTimes unlockTimes;
+    // last computed spendable prefix, requests usually come for the same top block
+    mutable uint32_t prefixBlockIndex = 0;
+    mutable uint32_t prefixSize = 0;
+    mutable bool prefixValid = false;
+  };
+
+  struct LoadChange {
+    bool cut;
+    GlobalOutputIndex globalIndex; // cut boundary for cuts
+    uint32_t blockIndex;
+    uint64_t unlockTime;
+  };
+
+  struct Load {
+    Amount amount;
+    std::vector<LoadChange> changes;
+  };
+
+  void recordChange(Amount amount, const LoadChange& change);
+
+  std::unordered_map<Amount, AmountOutputs> outputs;
+  std::unordered_map<uint64_t, Load> loads;
+  uint64_t nextLoadId = 0;
+};
+
+}
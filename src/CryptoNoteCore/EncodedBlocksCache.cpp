@@ -0,0 +1,143 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "EncodedBlocksCache.h"
+
+#include <cassert>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "Common/VectorOutputStream.h"
+#include "CryptoNoteCore/ICore.h"
+#include "Serialization/KVBinaryOutputStreamSerializer.h"
+
+namespace CryptoNote {
+
+EncodedBlocksCache::EncodedBlocksCache(size_t maxSize, Encoder encoder) : maxSize(maxSize), encoder(std::move(encoder)), size(0) {
+}
+
+void EncodedBlocksCache::getBlocks(const ICore& core, const std::vector<Crypto::Hash>& blockHashes, std::vector<EncodedBlock>& blocks,
+                                   std::vector<Crypto::Hash>& missedHashes) {
+  std::vector<EncodedBlock> foundBlocks(blockHashes.size());
+  std::vector<Crypto::Hash> uncachedHashes;
+  // a hash can be requested more than once, it is read from core only once
+  std::unordered_map<Crypto::Hash, std::vector<size_t>> uncachedPositions;
+
+  for (size_t i = 0; i < blockHashes.size(); ++i) {
+    auto it = entriesByHash.find(blockHashes[i]);
+    if (it != entriesByHash.end()) {
+      entries.splice(entries.begin(), entries, it->second);
+      foundBlocks[i] = it->second->block;
+      continue;
+    }
+
+    auto& positions = uncachedPositions[blockHashes[i]];
+    if (positions.empty()) {
+      uncachedHashes.push_back(blockHashes[i]);
+    }
+
+    positions.push_back(i);
+  }
+
+  if (!uncachedHashes.empty()) {
+    std::vector<RawBlock> rawBlocks;
+    std::vector<Crypto::Hash> coreMissedHashes;
+    core.getBlocks(uncachedHashes, rawBlocks, coreMissedHashes);
+    assert(rawBlocks.size() + coreMissedHashes.size() == uncachedHashes.size());
+
+    // core returns the found blocks in the order they were requested
+    std::unordered_set<Crypto::Hash> coreMissed(coreMissedHashes.begin(), coreMissedHashes.end());
+    auto rawBlock = rawBlocks.begin();
+    for (const auto& blockHash : uncachedHashes) {
+      if (coreMissed.count(blockHash) != 0) {
+        continue;
+      }
+
+      EncodedBlock block = encode(*rawBlock++);
+      insert(blockHash, block);
+      for (size_t position : uncachedPositions[blockHash]) {
+        foundBlocks[position] = block;
+      }
+    }
+  }
+
+  blocks.reserve(blocks.size() + blockHashes.size());
+  for (size_t i = 0; i < blockHashes.size(); ++i) {
+    if (foundBlocks[i]) {
+      blocks.push_back(std::move(foundBlocks[i]));
+    } else {
+      missedHashes.push_back(blockHashes[i]);
+    }
+  }
+}
+
+void EncodedBlocksCache::clear() {
+  entries.clear();
+  entriesByHash.clear();
+  size = 0;
+}
+
+size_t EncodedBlocksCache::getSize() const {
+  return size;
+}
+
+size_t EncodedBlocksCache::getCount() const {
+  return entries.size();
+}
+
+EncodedBlocksCache::EncodedBlock EncodedBlocksCache::encode(RawBlock& block) const {
+  KVBinaryOutputStreamSerializer serializer;
+  encoder(block, serializer);
+
+  std::shared_ptr<BinaryArray> encoded = std::make_shared<BinaryArray>();
+  Common::VectorOutputStream stream(*encoded);
+  serializer.dumpObjectSection(stream);
+  return encoded;
+}
+
+void EncodedBlocksCache::insert(const Crypto::Hash& blockHash, const EncodedBlock& block) {
+  if (block->size() > maxSize) {
+    return;
+  }
+
+  entries.push_front(Entry{blockHash, block});
+  entriesByHash.emplace(blockHash, entries.begin());
+  size += block->size();
+
+  while (size > maxSize) {
+    const Entry& last = entries.back();
+    size -= last.block->size();
+    entriesByHash.erase(last.blockHash);
+    entries.pop_back();
+  }
+}
+
+void serializeEncodedBlocks(std::vector<EncodedBlocksCache::EncodedBlock>& blocks, Common::StringView name, ISerializer& serializer) {
+  KVBinaryOutputStreamSerializer* kvSerializer = dynamic_cast<KVBinaryOutputStreamSerializer*>(&serializer);
+  if (kvSerializer == nullptr) {
+    throw std::runtime_error("serializeEncodedBlocks, encoded blocks can only be written by KVBinaryOutputStreamSerializer");
+  }
+
+  size_t count = blocks.size();
+  kvSerializer->beginArray(count, name);
+  for (const auto& block : blocks) {
+    kvSerializer->objectSection(block->data(), block->size(), "");
+  }
+  kvSerializer->endArray();
+}
+
+}
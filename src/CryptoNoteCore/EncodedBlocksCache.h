@@ -0,0 +1,76 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "CryptoNote.h"
+#include "Common/StringView.h"
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+class ICore;
+class ISerializer;
+
+/*
+ * Size bounded LRU cache of blocks already encoded as KV binary objects. Block request handlers insert
+ * cached entries into their responses with KVBinaryOutputStreamSerializer::objectSection(), so the blocks
+ * requested by many peers and wallets are read and encoded only once. Entries are keyed by block hash and
+ * never go stale on chain switches.
+ */
+class EncodedBlocksCache {
+public:
+  using EncodedBlock = std::shared_ptr<const BinaryArray>;
+  using Encoder = std::function<void(RawBlock& block, ISerializer& serializer)>;
+
+  EncodedBlocksCache(size_t maxSize, Encoder encoder);
+
+  // Same as ICore::getBlocks, but returns encoded blocks and reads from core only those missing in cache
+  void getBlocks(const ICore& core, const std::vector<Crypto::Hash>& blockHashes, std::vector<EncodedBlock>& blocks,
+                 std::vector<Crypto::Hash>& missedHashes);
+  void clear();
+
+  size_t getSize() const;
+  size_t getCount() const;
+
+private:
+  struct Entry {
+    Crypto::Hash blockHash;
+    EncodedBlock block;
+  };
+
+  EncodedBlock encode(RawBlock& block) const;
+  void insert(const Crypto::Hash& blockHash, const EncodedBlock& block);
+
+  const size_t maxSize;
+  const Encoder encoder;
+  size_t size;
+  // most recently used entries first
+  std::list<Entry> entries;
+  std::unordered_map<Crypto::Hash, std::list<Entry>::iterator> entriesByHash;
+};
+
+// Writes encoded blocks as an array of objects, serializer must be KVBinaryOutputStreamSerializer
+void serializeEncodedBlocks(std::vector<EncodedBlocksCache::EncodedBlock>& blocks, Common::StringView name, ISerializer& serializer);
+
+}
@@ -73,6 +73,7 @@ private:
   
 struct CachedBlockInfo;
 struct CachedTransactionInfo;
+struct BlockScanTable;
 class ITransactionPool;
 
 class IBlockchainCache {
@@ -188,6 +189,8 @@ public:
 
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const = 0;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const = 0;
+
+  virtual BlockScanTable getBlockScanTable(uint32_t blockIndex) const = 0;
 };
 
 }
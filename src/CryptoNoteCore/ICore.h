@@ -21,8 +21,10 @@
 
 #include "AddBlockErrors.h"
 #include "AddBlockErrorCondition.h"
+#include "BlockchainEventRing.h"
 #include "BlockchainExplorerData.h"
 #include "BlockchainMessages.h"
+#include "BlockScanTable.h"
 #include "CachedBlock.h"
 #include "CachedTransaction.h"
 #include "CoreStatistics.h"
@@ -42,6 +44,8 @@ public:
 
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) = 0;
   virtual bool removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) = 0;
+  // Carries the same messages as the queues to subscribers on any thread
+  virtual BlockchainEventRing& getBlockchainEventRing() = 0;
 
   virtual uint32_t getTopBlockIndex() const = 0;
   virtual Crypto::Hash getTopBlockHash() const = 0;
@@ -65,6 +69,7 @@ public:
   virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
                                uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset,
                                std::vector<BlockShortInfo>& entries) const = 0;
+  virtual std::vector<BlockScanTable> getBlockScanTables(uint32_t startIndex, uint32_t count) const = 0;
 
   virtual bool hasTransaction(const Crypto::Hash& transactionHash) const = 0;
   virtual void getTransactions(const std::vector<Crypto::Hash>& transactionHashes,
@@ -89,6 +94,9 @@ public:
   getMultisignatureOutput(uint64_t amount, uint32_t globalIndex) const = 0;
 
   virtual std::vector<Crypto::Hash> getPoolTransactionHashes() const = 0;
+  virtual void getPoolTransactions(const std::vector<Crypto::Hash>& transactionHashes,
+                                   std::vector<BinaryArray>& transactions,
+                                   std::vector<Crypto::Hash>& missedHashes) const = 0;
   virtual bool getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<Crypto::Hash>& knownHashes,
                               std::vector<BinaryArray>& addedTransactions,
                               std::vector<Crypto::Hash>& deletedTransactions) const = 0;
@@ -26,6 +26,7 @@ class ITransactionPool {
 public:
   virtual ~ITransactionPool(){}
   virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState) = 0;
+  virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) = 0;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const = 0;
   virtual bool removeTransaction(const Crypto::Hash& hash) = 0;
 
@@ -38,6 +39,13 @@ public:
 
   virtual uint64_t getTransactionReceiveTime(const Crypto::Hash& hash) const = 0;
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const = 0;
+  // Hashes of the transactions received at or before latestReceiveTime, oldest first
+  virtual std::vector<Crypto::Hash> getOutdatedTransactionHashes(uint64_t latestReceiveTime) const = 0;
+
+  // Fee per kilobyte a new transaction has to pay to get into the pool, zero while the pool has never been full
+  virtual uint64_t getMinimumFeePerKilobyte(uint64_t currentTime) = 0;
+  // Removes the lowest fee rate transactions until the pool fits its memory budget, returns their hashes
+  virtual std::vector<Crypto::Hash> evictLowestFeeTransactions(uint64_t currentTime) = 0;
 };
 
 }
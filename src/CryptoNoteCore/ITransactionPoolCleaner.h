@@ -17,14 +17,12 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
+#include "crypto/hash.h"
 #include "CryptoNoteCore/ITransactionPool.h"
 
-namespace Crypto {
-struct Hash;
-}
-
 namespace CryptoNote {
 
 class ITransactionPoolCleanWrapper: public ITransactionPool {
@@ -32,6 +30,10 @@ public:
   virtual ~ITransactionPoolCleanWrapper() {}
 
   virtual std::vector<Crypto::Hash> clean() = 0;
+
+  // Deletion times of the transactions that can't be added again until the pool timeout expires
+  virtual std::unordered_map<Crypto::Hash, uint64_t> getRecentlyDeletedTransactions() const = 0;
+  virtual void addRecentlyDeletedTransactions(const std::unordered_map<Crypto::Hash, uint64_t>& transactions) = 0;
 };
 
 } //namespace CryptoNote
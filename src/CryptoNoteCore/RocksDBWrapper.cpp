@@ -22,6 +22,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/backupable_db.h"
 
+#include "Common/Metrics.h"
 #include "DataBaseErrors.h"
 
 using namespace CryptoNote;
@@ -30,6 +31,14 @@ using namespace Logging;
 namespace {
   const std::string DB_NAME = "DB";
   const std::string TESTNET_DB_NAME = "testnet_DB";
+
+  Common::MetricHistogram& batchHistogram(const std::string& operation) {
+    return Common::metrics().histogram("db_batch_duration_seconds", "Time spent executing database batches", {{"operation", operation}});
+  }
+
+  Common::MetricCounter& keysCounter(const std::string& operation) {
+    return Common::metrics().counter("db_batch_keys_total", "Keys touched by database batches", {{"operation", operation}});
+  }
 }
 
 RocksDBWrapper::RocksDBWrapper(Logging::ILogger& logger) : logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED){
@@ -124,6 +133,10 @@ std::error_code RocksDBWrapper::writeSync(IWriteBatch& batch) {
 }
 
 std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
+  static Common::MetricHistogram& writeHistogram = batchHistogram("write");
+  static Common::MetricCounter& writeKeysCounter = keysCounter("write");
+
+  Common::MetricTimer timer(writeHistogram);
   rocksdb::WriteOptions writeOptions;
   writeOptions.sync = sync;
 
@@ -138,6 +151,7 @@ std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
     rocksdbBatch.Delete(rocksdb::Slice(key));
   }
 
+  writeKeysCounter.add(rawData.size() + rawKeys.size());
   rocksdb::Status status = db->Write(writeOptions, &rocksdbBatch);
 
   if (!status.ok()) {
@@ -153,6 +167,10 @@ std::error_code RocksDBWrapper::read(IReadBatch& batch) {
     throw std::runtime_error("Not initialized.");
   }
 
+  static Common::MetricHistogram& readHistogram = batchHistogram("read");
+  static Common::MetricCounter& readKeysCounter = keysCounter("read");
+
+  Common::MetricTimer timer(readHistogram);
   rocksdb::ReadOptions readOptions;
 
   std::vector<std::string> rawKeys(batch.getRawKeys());
@@ -162,6 +180,7 @@ std::error_code RocksDBWrapper::read(IReadBatch& batch) {
     keySlices.emplace_back(rocksdb::Slice(key));
   }
 
+  readKeysCounter.add(rawKeys.size());
   std::vector<std::string> values;
   values.reserve(rawKeys.size());
   std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keySlices, &values);
@@ -17,18 +17,27 @@
 
 #include "TransactionExtra.h"
 
-#include "Common/MemoryInputStream.h"
 #include "Common/StreamTools.h"
 #include "Common/StringTools.h"
 #include "CryptoNoteTools.h"
 #include "Serialization/BinaryOutputStreamSerializer.h"
-#include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinaryMemoryInputSerializer.h"
 
 using namespace Crypto;
 using namespace Common;
 
 namespace CryptoNote {
 
+namespace {
+
+uint8_t readByte(BinaryMemoryInputSerializer& serializer) {
+  uint8_t value;
+  serializer.binary(&value, sizeof(value), "");
+  return value;
+}
+
+}
+
 bool parseTransactionExtra(const std::vector<uint8_t> &transactionExtra, std::vector<TransactionExtraField> &transactionExtraFields) {
   transactionExtraFields.clear();
 
@@ -40,13 +49,12 @@ bool parseTransactionExtra(const std::vector<uint8_t> &transactionExtra, std::ve
   bool tx_extra_merge_mining_tag = false;
 
   try {
-    MemoryInputStream iss(transactionExtra.data(), transactionExtra.size());
-    BinaryInputStreamSerializer ar(iss);
+    BinaryMemoryInputSerializer ar(transactionExtra.data(), transactionExtra.size());
 
     int c = 0;
 
-    while (!iss.endOfStream()) {
-      c = read<uint8_t>(iss);
+    while (!ar.endOfStream()) {
+      c = readByte(ar);
       switch (c) {
       case TX_EXTRA_TAG_PADDING: {
         if (tx_extra_tag_padding) {
@@ -54,8 +62,8 @@ bool parseTransactionExtra(const std::vector<uint8_t> &transactionExtra, std::ve
         }
         tx_extra_tag_padding = true;
         size_t size = 1;
-        for (; !iss.endOfStream() && size <= TX_EXTRA_PADDING_MAX_COUNT; ++size) {
-          if (read<uint8_t>(iss) != 0) {
+        for (; !ar.endOfStream() && size <= TX_EXTRA_PADDING_MAX_COUNT; ++size) {
+          if (readByte(ar) != 0) {
             return false; // all bytes should be zero
           }
         }
@@ -85,10 +93,10 @@ bool parseTransactionExtra(const std::vector<uint8_t> &transactionExtra, std::ve
         }
         tx_extra_nonce = true;
         TransactionExtraNonce extraNonce;
-        uint8_t size = read<uint8_t>(iss);
+        uint8_t size = readByte(ar);
         if (size > 0) {
           extraNonce.nonce.resize(size);
-          read(iss, extraNonce.nonce.data(), extraNonce.nonce.size());
+          ar.binary(extraNonce.nonce.data(), extraNonce.nonce.size(), "nonce");
         }
 
         transactionExtraFields.push_back(extraNonce);
@@ -17,12 +17,47 @@
 
 #include "TransactionPool.h"
 
+#include <cmath>
+
 #include "Common/int-util.h"
 #include "CryptoNoteBasicImpl.h"
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/TransactionExtra.h"
 
 namespace CryptoNote {
 
+namespace {
+
+// Bookkeeping per pool entry on top of the transaction itself: the node of every index and the cached hashes
+const uint64_t POOL_ENTRY_OVERHEAD = 512;
+
+uint64_t getTransactionMemoryUsage(const CachedTransaction& transaction) {
+  // both the serialized blob and the parsed transaction are kept, the latter is about the size of the former
+  return 2 * transaction.getTransactionBinaryArray().size() + POOL_ENTRY_OVERHEAD;
+}
+
+}
+
+uint64_t getFeePerKilobyte(const CachedTransaction& transaction) {
+  uint64_t hi;
+  uint64_t lo = mul128(transaction.getTransactionFee(), 1024, &hi);
+  if (hi != 0) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+
+  return lo / transaction.getTransactionBinaryArray().size();
+}
+
+bool isBelowMinimumFee(const CachedTransaction& transaction, uint64_t minimumFeePerKilobyte, const Currency& currency) {
+  if (minimumFeePerKilobyte == 0 || getFeePerKilobyte(transaction) >= minimumFeePerKilobyte) {
+    return false;
+  }
+
+  return transaction.getTransactionFee() != 0 ||
+    !currency.isFusionTransaction(transaction.getTransaction(), transaction.getTransactionBinaryArray().size());
+}
+
 // lhs > hrs
 bool TransactionPool::TransactionPriorityComparator::operator()(const PendingTransactionInfo& lhs, const PendingTransactionInfo& rhs) const {
   const CachedTransaction& left = lhs.cachedTransaction;
@@ -58,17 +93,32 @@ size_t TransactionPool::PaymentIdHasher::operator() (const boost::optional<Crypt
 }
 
 TransactionPool::TransactionPool(Logging::ILogger& logger) :
+  TransactionPool(logger, std::numeric_limits<uint64_t>::max(), 0) {
+}
+
+TransactionPool::TransactionPool(Logging::ILogger& logger, uint64_t maxSize, uint64_t incrementalFeePerKilobyte) :
   transactionHashIndex(transactions.get<TransactionHashTag>()),
   transactionCostIndex(transactions.get<TransactionCostTag>()),
   paymentIdIndex(transactions.get<PaymentIdTag>()),
+  receiveTimeIndex(transactions.get<ReceiveTimeTag>()),
+  maxSize(maxSize),
+  incrementalFeePerKilobyte(incrementalFeePerKilobyte),
+  transactionsMemoryUsage(0),
+  rollingMinimumFee(0),
+  lastRollingFeeUpdate(0),
   logger(logger, "TransactionPool") {
 }
 
 bool TransactionPool::pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState) {
-  auto pendingTx = PendingTransactionInfo{static_cast<uint64_t>(time(nullptr)), std::move(transaction)};
+  return pushTransaction(std::move(transaction), std::move(transactionState), static_cast<uint64_t>(time(nullptr)));
+}
+
+bool TransactionPool::pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState, uint64_t receiveTime) {
+  auto pendingTx = PendingTransactionInfo{receiveTime, std::move(transaction)};
+  pendingTx.memoryUsage = getTransactionMemoryUsage(pendingTx.cachedTransaction);
 
   Crypto::Hash paymentId;
-  if(getPaymentIdFromTxExtra(pendingTx.cachedTransaction.getTransaction().extra, paymentId)) {
+  if(getPaymentIdFromTxExtra(pendingTx.cachedTransaction.getTransactionPrefix().extra, paymentId)) {
     pendingTx.paymentId = paymentId;
   }
 
@@ -83,6 +133,7 @@ bool TransactionPool::pushTransaction(CachedTransaction&& transaction, Transacti
   }
 
   mergeStates(poolState, transactionState);
+  transactionsMemoryUsage += pendingTx.memoryUsage;
 
   logger(Logging::DEBUGGING) << "pushed transaction " << pendingTx.getTransactionHash() << " to pool";
   return transactionHashIndex.emplace(std::move(pendingTx)).second;
@@ -102,13 +153,18 @@ bool TransactionPool::removeTransaction(const Crypto::Hash& hash) {
     return false;
   }
 
-  excludeFromState(poolState, it->cachedTransaction);
-  transactionHashIndex.erase(it);
+  eraseTransaction(it);
 
   logger(Logging::DEBUGGING) << "transaction " << hash << " removed from pool";
   return true;
 }
 
+void TransactionPool::eraseTransaction(TransactionsContainer::index<TransactionHashTag>::type::iterator it) {
+  excludeFromState(poolState, it->cachedTransaction);
+  transactionsMemoryUsage -= it->memoryUsage;
+  transactionHashIndex.erase(it);
+}
+
 size_t TransactionPool::getTransactionCount() const {
   return transactionHashIndex.size();
 }
@@ -161,4 +217,71 @@ std::vector<Crypto::Hash> TransactionPool::getTransactionHashesByPaymentId(const
   return transactionHashes;
 }
 
+std::vector<Crypto::Hash> TransactionPool::getOutdatedTransactionHashes(uint64_t latestReceiveTime) const {
+  std::vector<Crypto::Hash> transactionHashes;
+  for (auto it = receiveTimeIndex.begin(); it != receiveTimeIndex.end() && it->receiveTime <= latestReceiveTime; ++it) {
+    transactionHashes.push_back(it->getTransactionHash());
+  }
+
+  return transactionHashes;
+}
+
+uint64_t TransactionPool::getMinimumFeePerKilobyte(uint64_t currentTime) {
+  if (rollingMinimumFee == 0) {
+    return 0;
+  }
+
+  if (currentTime > lastRollingFeeUpdate) {
+    // the floor decays faster while the pool is far from full, so it does not outlive the spam wave that raised it
+    double halfLife = static_cast<double>(parameters::CRYPTONOTE_MEMPOOL_MIN_FEE_HALF_LIFE);
+    if (transactionsMemoryUsage < maxSize / 4) {
+      halfLife /= 4;
+    } else if (transactionsMemoryUsage < maxSize / 2) {
+      halfLife /= 2;
+    }
+
+    rollingMinimumFee /= std::pow(2.0, static_cast<double>(currentTime - lastRollingFeeUpdate) / halfLife);
+    lastRollingFeeUpdate = currentTime;
+
+    if (rollingMinimumFee < static_cast<double>(incrementalFeePerKilobyte) / 2) {
+      rollingMinimumFee = 0;
+    }
+  }
+
+  return static_cast<uint64_t>(rollingMinimumFee);
+}
+
+std::vector<Crypto::Hash> TransactionPool::evictLowestFeeTransactions(uint64_t currentTime) {
+  std::vector<Crypto::Hash> evictedTransactions;
+  if (transactionsMemoryUsage <= maxSize) {
+    return evictedTransactions;
+  }
+
+  uint64_t minimumFee = getMinimumFeePerKilobyte(currentTime);
+  uint64_t highestEvictedFee = 0;
+  while (transactionsMemoryUsage > maxSize && !transactionCostIndex.empty()) {
+    auto it = std::prev(transactionCostIndex.end());
+    highestEvictedFee = std::max(highestEvictedFee, getFeePerKilobyte(it->cachedTransaction));
+    evictedTransactions.push_back(it->getTransactionHash());
+    eraseTransaction(transactions.project<TransactionHashTag>(it));
+  }
+
+  // transactions paying no more than the evicted ones would only push each other out again
+  uint64_t newMinimumFee = highestEvictedFee > std::numeric_limits<uint64_t>::max() - incrementalFeePerKilobyte ?
+    std::numeric_limits<uint64_t>::max() : highestEvictedFee + incrementalFeePerKilobyte;
+  if (newMinimumFee > minimumFee) {
+    rollingMinimumFee = static_cast<double>(newMinimumFee);
+  }
+
+  lastRollingFeeUpdate = currentTime;
+
+  logger(Logging::DEBUGGING) << "evicted " << evictedTransactions.size() << " transactions from pool, minimum fee per kilobyte is " <<
+    static_cast<uint64_t>(rollingMinimumFee);
+  return evictedTransactions;
+}
+
+uint64_t TransactionPool::getTransactionsMemoryUsage() const {
+  return transactionsMemoryUsage;
+}
+
 }
@@ -34,11 +34,20 @@
 
 namespace CryptoNote {
 
+class Currency;
+
+uint64_t getFeePerKilobyte(const CachedTransaction& transaction);
+// Zero fee fusion transactions are valid without a fee, so the pool minimum doesn't apply to them either
+bool isBelowMinimumFee(const CachedTransaction& transaction, uint64_t minimumFeePerKilobyte, const Currency& currency);
+
 class TransactionPool : public ITransactionPool {
 public:
   TransactionPool(Logging::ILogger& logger);
+  // maxSize is the memory budget in bytes, incrementalFeePerKilobyte is added on top of the fee rate of evicted transactions
+  TransactionPool(Logging::ILogger& logger, uint64_t maxSize, uint64_t incrementalFeePerKilobyte);
 
   virtual bool pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState) override;
+  virtual bool pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState, uint64_t receiveTime) override;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const override;
   virtual bool removeTransaction(const Crypto::Hash& hash) override;
 
@@ -51,6 +60,12 @@ public:
 
   virtual uint64_t getTransactionReceiveTime(const Crypto::Hash& hash) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
+  virtual std::vector<Crypto::Hash> getOutdatedTransactionHashes(uint64_t latestReceiveTime) const override;
+
+  virtual uint64_t getMinimumFeePerKilobyte(uint64_t currentTime) override;
+  virtual std::vector<Crypto::Hash> evictLowestFeeTransactions(uint64_t currentTime) override;
+  uint64_t getTransactionsMemoryUsage() const;
+
 private:
   TransactionValidatorState poolState;
 
@@ -58,6 +73,7 @@ private:
     uint64_t receiveTime;
     CachedTransaction cachedTransaction;
     boost::optional<Crypto::Hash> paymentId;
+    uint64_t memoryUsage;
 
     const Crypto::Hash& getTransactionHash() const;
   };
@@ -70,6 +86,7 @@ private:
   struct TransactionHashTag {};
   struct TransactionCostTag {};
   struct PaymentIdTag {};
+  struct ReceiveTimeTag {};
 
   typedef boost::multi_index::ordered_non_unique<
     boost::multi_index::tag<TransactionCostTag>,
@@ -96,12 +113,18 @@ private:
     PaymentIdHasher
   > PaymentIdIndex;
 
+  typedef boost::multi_index::ordered_non_unique<
+    boost::multi_index::tag<ReceiveTimeTag>,
+    BOOST_MULTI_INDEX_MEMBER(PendingTransactionInfo, uint64_t, receiveTime)
+  > ReceiveTimeIndex;
+
   typedef boost::multi_index_container<
     PendingTransactionInfo,
     boost::multi_index::indexed_by<
       TransactionHashIndex,
       TransactionCostIndex,
-      PaymentIdIndex
+      PaymentIdIndex,
+      ReceiveTimeIndex
     >
   > TransactionsContainer;
 
@@ -109,8 +132,17 @@ private:
   TransactionsContainer::index<TransactionHashTag>::type& transactionHashIndex;
   TransactionsContainer::index<TransactionCostTag>::type& transactionCostIndex;
   TransactionsContainer::index<PaymentIdTag>::type& paymentIdIndex;
-  
+  TransactionsContainer::index<ReceiveTimeTag>::type& receiveTimeIndex;
+
+  uint64_t maxSize;
+  uint64_t incrementalFeePerKilobyte;
+  uint64_t transactionsMemoryUsage;
+  double rollingMinimumFee;
+  uint64_t lastRollingFeeUpdate;
+
   Logging::LoggerRef logger;
+
+  void eraseTransaction(TransactionsContainer::index<TransactionHashTag>::type::iterator it);
 };
 
 }
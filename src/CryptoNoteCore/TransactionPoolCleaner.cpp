@@ -45,6 +45,10 @@ bool TransactionPoolCleanWrapper::pushTransaction(CachedTransaction&& tx, Transa
   return !isTransactionRecentlyDeleted(tx.getTransactionHash()) && transactionPool->pushTransaction(std::move(tx), std::move(transactionState));
 }
 
+bool TransactionPoolCleanWrapper::pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) {
+  return !isTransactionRecentlyDeleted(tx.getTransactionHash()) && transactionPool->pushTransaction(std::move(tx), std::move(transactionState), receiveTime);
+}
+
 const CachedTransaction& TransactionPoolCleanWrapper::getTransaction(const Crypto::Hash& hash) const {
   return transactionPool->getTransaction(hash);
 }
@@ -81,20 +85,31 @@ std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesByPay
   return transactionPool->getTransactionHashesByPaymentId(paymentId);
 }
 
+std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getOutdatedTransactionHashes(uint64_t latestReceiveTime) const {
+  return transactionPool->getOutdatedTransactionHashes(latestReceiveTime);
+}
+
+uint64_t TransactionPoolCleanWrapper::getMinimumFeePerKilobyte(uint64_t currentTime) {
+  return transactionPool->getMinimumFeePerKilobyte(currentTime);
+}
+
+std::vector<Crypto::Hash> TransactionPoolCleanWrapper::evictLowestFeeTransactions(uint64_t currentTime) {
+  return transactionPool->evictLowestFeeTransactions(currentTime);
+}
+
 std::vector<Crypto::Hash> TransactionPoolCleanWrapper::clean() {
   try {
     uint64_t currentTime = timeProvider->now();
-    auto transactionHashes = transactionPool->getTransactionHashes();
 
     std::vector<Crypto::Hash> deletedTransactions;
-    for (const auto& hash: transactionHashes) {
-      uint64_t transactionAge = currentTime - transactionPool->getTransactionReceiveTime(hash);
-      if (transactionAge >= timeout) {
-        logger(Logging::DEBUGGING) << "Deleting transaction " << Common::podToHex(hash) << " from pool";
-        recentlyDeletedTransactions.emplace(hash, currentTime);
-        transactionPool->removeTransaction(hash);
-        deletedTransactions.emplace_back(std::move(hash));
-      }
+    if (currentTime >= timeout) {
+      deletedTransactions = transactionPool->getOutdatedTransactionHashes(currentTime - timeout);
+    }
+
+    for (const auto& hash: deletedTransactions) {
+      logger(Logging::DEBUGGING) << "Deleting transaction " << Common::podToHex(hash) << " from pool";
+      recentlyDeletedTransactions.emplace(hash, currentTime);
+      transactionPool->removeTransaction(hash);
     }
 
     cleanRecentlyDeletedTransactions(currentTime);
@@ -107,6 +122,15 @@ std::vector<Crypto::Hash> TransactionPoolCleanWrapper::clean() {
   }
 }
 
+std::unordered_map<Crypto::Hash, uint64_t> TransactionPoolCleanWrapper::getRecentlyDeletedTransactions() const {
+  return recentlyDeletedTransactions;
+}
+
+void TransactionPoolCleanWrapper::addRecentlyDeletedTransactions(const std::unordered_map<Crypto::Hash, uint64_t>& transactions) {
+  recentlyDeletedTransactions.insert(transactions.begin(), transactions.end());
+  cleanRecentlyDeletedTransactions(timeProvider->now());
+}
+
 bool TransactionPoolCleanWrapper::isTransactionRecentlyDeleted(const Crypto::Hash& hash) const {
   auto it = recentlyDeletedTransactions.find(hash);
   return it != recentlyDeletedTransactions.end() && it->second >= timeout;
@@ -50,6 +50,7 @@ public:
   virtual ~TransactionPoolCleanWrapper();
 
   virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState) override;
+  virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) override;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const override;
   virtual bool removeTransaction(const Crypto::Hash& hash) override;
 
@@ -62,9 +63,16 @@ public:
 
   virtual uint64_t getTransactionReceiveTime(const Crypto::Hash& hash) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
+  virtual std::vector<Crypto::Hash> getOutdatedTransactionHashes(uint64_t latestReceiveTime) const override;
+
+  virtual uint64_t getMinimumFeePerKilobyte(uint64_t currentTime) override;
+  virtual std::vector<Crypto::Hash> evictLowestFeeTransactions(uint64_t currentTime) override;
 
   virtual std::vector<Crypto::Hash> clean() override;
 
+  virtual std::unordered_map<Crypto::Hash, uint64_t> getRecentlyDeletedTransactions() const override;
+  virtual void addRecentlyDeletedTransactions(const std::unordered_map<Crypto::Hash, uint64_t>& transactions) override;
+
 private:
   std::unique_ptr<ITransactionPool> transactionPool;
   std::unique_ptr<ITimeProvider> timeProvider;
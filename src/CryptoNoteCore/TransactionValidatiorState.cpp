@@ -34,7 +34,7 @@ bool hasIntersections(const TransactionValidatorState& destination, const Transa
 }
 
 void excludeFromState(TransactionValidatorState& state, const CachedTransaction& cachedTransaction) {
-  const auto& transaction = cachedTransaction.getTransaction();
+  const auto& transaction = cachedTransaction.getTransactionPrefix();
   for (auto& input : transaction.inputs) {
     if (input.type() == typeid(KeyInput)) {
       const auto& in = boost::get<KeyInput>(input);
@@ -149,4 +149,34 @@ namespace CryptoNote
     const static int ID = BC_COMMANDS_POOL_BASE + 8;
     typedef NOTIFY_REQUEST_TX_POOL_request request;
   };
+
+  /************************************************************************/
+  /* Transaction announcements, P2PProtocolVersion::V2 and above          */
+  /************************************************************************/
+  struct NOTIFY_NEW_TRANSACTION_HASHES_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_NEW_TRANSACTION_HASHES {
+    const static int ID = BC_COMMANDS_POOL_BASE + 9;
+    typedef NOTIFY_NEW_TRANSACTION_HASHES_request request;
+  };
+
+  // answered with NOTIFY_NEW_TRANSACTIONS
+  struct NOTIFY_REQUEST_TRANSACTIONS_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_REQUEST_TRANSACTIONS {
+    const static int ID = BC_COMMANDS_POOL_BASE + 10;
+    typedef NOTIFY_REQUEST_TRANSACTIONS_request request;
+  };
 }
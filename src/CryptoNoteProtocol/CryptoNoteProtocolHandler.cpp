@@ -36,6 +36,8 @@ namespace CryptoNote {
 
 namespace {
 
+const size_t ENCODED_BLOCKS_CACHE_SIZE = 64 * 1024 * 1024;
+
 template<class t_parametr>
 bool post_notify(IP2pEndpoint& p2p, typename t_parametr::request& arg, const CryptoNoteConnectionContext& context) {
   return p2p.invoke_notify_to_peer(t_parametr::ID, LevinProtocol::encode(arg), context);
@@ -46,17 +48,6 @@ void relay_post_notify(IP2pEndpoint& p2p, typename t_parametr::request& arg, con
   p2p.externalRelayNotifyToAll(t_parametr::ID, LevinProtocol::encode(arg), excludeConnection);
 }
 
-std::vector<RawBlockLegacy> convertRawBlocksToRawBlocksLegacy(const std::vector<RawBlock>& rawBlocks) {
-  std::vector<RawBlockLegacy> legacy;
-  legacy.reserve(rawBlocks.size());
-
-  for (const auto& rawBlock: rawBlocks) {
-    legacy.emplace_back(RawBlockLegacy{rawBlock.block, rawBlock.transactions});
-  }
-
-  return legacy;
-}
-
 std::vector<RawBlock> convertRawBlocksLegacyToRawBlocks(const std::vector<RawBlockLegacy>& legacy) {
   std::vector<RawBlock> rawBlocks;
   rawBlocks.reserve(legacy.size());
@@ -126,6 +117,21 @@ static inline void serialize(NOTIFY_RESPONSE_GET_OBJECTS_request& request, ISeri
   s(request.current_blockchain_height, "current_blockchain_height");
 }
 
+// NOTIFY_RESPONSE_GET_OBJECTS as sent by us, blocks are taken already encoded from EncodedBlocksCache
+struct EncodedResponseGetObjects {
+  std::vector<std::string> txs;
+  std::vector<EncodedBlocksCache::EncodedBlock> blocks;
+  std::vector<Crypto::Hash> missed_ids;
+  uint32_t current_blockchain_height;
+};
+
+static inline void serialize(EncodedResponseGetObjects& request, ISerializer& s) {
+  s(request.txs, "txs");
+  serializeEncodedBlocks(request.blocks, "blocks", s);
+  serializeAsBinary(request.missed_ids, "missed_ids", s);
+  s(request.current_blockchain_height, "current_blockchain_height");
+}
+
 CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(const Currency& currency, System::Dispatcher& dispatcher, ICore& rcore, IP2pEndpoint* p_net_layout, Logging::ILogger& log) :
   logger(log, "protocol"),
   m_dispatcher(dispatcher),
@@ -135,7 +141,11 @@ CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(const Currency& currency, S
   m_synchronized(false),
   m_stop(false),
   m_observedHeight(0),
-  m_peersCount(0) {
+  m_peersCount(0),
+  m_encodedBlocks(ENCODED_BLOCKS_CACHE_SIZE, [] (RawBlock& block, ISerializer& s) {
+    RawBlockLegacy legacy{std::move(block.block), std::move(block.transactions)};
+    serialize(legacy, s);
+  }) {
 
   if (!m_p2p) {
     m_p2p = &m_p2p_stub;
@@ -168,7 +178,7 @@ void CryptoNoteProtocolHandler::onConnectionClosed(CryptoNoteConnectionContext&
   }
 
   if (updated) {
-    logger(TRACE) << "Observed height updated: " << m_observedHeight;
+    LOG_MESSAGE(logger, TRACE) << "Observed height updated: " << m_observedHeight;
     m_observerManager.notify(&ICryptoNoteProtocolObserver::lastKnownBlockHeightUpdated, m_observedHeight);
   }
 
@@ -183,7 +193,7 @@ void CryptoNoteProtocolHandler::stop() {
 }
 
 bool CryptoNoteProtocolHandler::start_sync(CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "Starting synchronization";
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "Starting synchronization";
 
   if (context.m_state == CryptoNoteConnectionContext::state_synchronizing) {
     assert(context.m_needed_objects.empty());
@@ -191,7 +201,7 @@ bool CryptoNoteProtocolHandler::start_sync(CryptoNoteConnectionContext& context)
 
     NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
     r.block_ids = m_core.buildSparseChain();
-    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
+    LOG_MESSAGE(logger, Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
     post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
   }
 
@@ -246,9 +256,9 @@ bool CryptoNoteProtocolHandler::process_payload_sync_data(const CORE_SYNC_DATA&
       << " [" << std::abs(diff) << " blocks (" << std::abs(diff) / (24 * 60 * 60 / m_currency.difficultyTarget()) << " days) "
       << (diff >= 0 ? std::string("behind") : std::string("ahead")) << "] " << std::endl << "SYNCHRONIZATION started";
 
-    logger(Logging::DEBUGGING) << "Remote top block height: " << hshd.current_height << ", id: " << hshd.top_id;
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << "Remote top block height: " << hshd.current_height << ", id: " << hshd.top_id;
     //let the socket to send response to handshake, but request callback, to let send request data after response
-    logger(Logging::TRACE) << context << "requesting synchronization";
+    LOG_MESSAGE(logger, Logging::TRACE) << context << "requesting synchronization";
     context.m_state = CryptoNoteConnectionContext::state_sync_required;
   }
 
@@ -298,6 +308,8 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const
     HANDLE_NOTIFY(NOTIFY_REQUEST_CHAIN, handle_request_chain)
     HANDLE_NOTIFY(NOTIFY_RESPONSE_CHAIN_ENTRY, handle_response_chain_entry)
     HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, handleRequestTxPool)
+    HANDLE_NOTIFY(NOTIFY_NEW_TRANSACTION_HASHES, handleNotifyNewTransactionHashes)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_TRANSACTIONS, handleRequestTransactions)
 
   default:
     handled = false;
@@ -309,7 +321,7 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const
 #undef HANDLE_NOTIFY
 
 int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_BLOCK::request& arg, CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "NOTIFY_NEW_BLOCK (hop " << arg.hop << ")";
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_NEW_BLOCK (hop " << arg.hop << ")";
   updateObservedHeight(arg.current_blockchain_height, context);
   context.m_remote_blockchain_height = arg.current_blockchain_height;
   if (context.m_state != CryptoNoteConnectionContext::state_normal) {
@@ -330,18 +342,18 @@ int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_B
       relay_post_notify<NOTIFY_NEW_BLOCK>(*m_p2p, arg, &context.m_connection_id);
       // relay_block(arg, context);
     } else if (result == error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE) {
-      logger(Logging::TRACE) << context << "Block added as alternative";
+      LOG_MESSAGE(logger, Logging::TRACE) << context << "Block added as alternative";
     } else {
-      logger(Logging::TRACE) << context << "Block already exists";
+      LOG_MESSAGE(logger, Logging::TRACE) << context << "Block already exists";
     }
   } else if (result == error::AddBlockErrorCondition::BLOCK_REJECTED) {
     context.m_state = CryptoNoteConnectionContext::state_synchronizing;
     NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
     r.block_ids = m_core.buildSparseChain();
-    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
+    LOG_MESSAGE(logger, Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
     post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
   } else {
-    logger(Logging::DEBUGGING) << context << "Block verification failed, dropping connection: " << result.message();
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << context << "Block verification failed, dropping connection: " << result.message();
     context.m_state = CryptoNoteConnectionContext::state_shutdown;
   }
 
@@ -349,53 +361,116 @@ int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_B
 }
 
 int CryptoNoteProtocolHandler::handle_notify_new_transactions(int command, NOTIFY_NEW_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "NOTIFY_NEW_TRANSACTIONS";
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_NEW_TRANSACTIONS";
 
   if (context.m_state != CryptoNoteConnectionContext::state_normal)
     return 1;
 
+  std::vector<Crypto::Hash> hashes;
+  hashes.reserve(arg.txs.size());
   for (auto tx_blob_it = arg.txs.begin(); tx_blob_it != arg.txs.end();) {
+    Crypto::Hash hash = getBinaryArrayHash(*tx_blob_it);
+    context.addKnownTransaction(hash);
+    m_requestedTransactions.erase(hash);
+
     if (!m_core.addTransactionToPool(*tx_blob_it)) {
-      logger(Logging::DEBUGGING) << context << "Tx verification failed";
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << context << "Tx verification failed";
       tx_blob_it = arg.txs.erase(tx_blob_it);
     } else {
+      hashes.push_back(hash);
       ++tx_blob_it;
     }
   }
 
   if (arg.txs.size()) {
-    //TODO: add announce usage here
-    relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
+    relayTransactionsToPeers(arg.txs, hashes, &context.m_connection_id);
   }
 
   return true;
 }
 
+int CryptoNoteProtocolHandler::handleNotifyNewTransactionHashes(int command, NOTIFY_NEW_TRANSACTION_HASHES::request& arg, CryptoNoteConnectionContext& context) {
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_NEW_TRANSACTION_HASHES: txs.size() = " << arg.txs.size();
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  if (arg.txs.size() > P2P_MAX_TRANSACTION_ANNOUNCE_COUNT) {
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << context << "NOTIFY_NEW_TRANSACTION_HASHES: too many hashes announced, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  NOTIFY_REQUEST_TRANSACTIONS::request request;
+  time_t now = time(nullptr);
+  for (const auto& hash : arg.txs) {
+    context.addKnownTransaction(hash);
+    if (m_requestedTransactions.count(hash) != 0 || m_core.hasTransaction(hash)) {
+      continue;
+    }
+
+    m_requestedTransactions.emplace(hash, now);
+    request.txs.push_back(hash);
+  }
+
+  if (!request.txs.empty()) {
+    LOG_MESSAGE(logger, Logging::TRACE) << context << "-->>NOTIFY_REQUEST_TRANSACTIONS: txs.size() = " << request.txs.size();
+    post_notify<NOTIFY_REQUEST_TRANSACTIONS>(*m_p2p, request, context);
+  }
+
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handleRequestTransactions(int command, NOTIFY_REQUEST_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context) {
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_REQUEST_TRANSACTIONS: txs.size() = " << arg.txs.size();
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  if (arg.txs.size() > P2P_MAX_TRANSACTION_ANNOUNCE_COUNT) {
+    LOG_MESSAGE(logger, Logging::DEBUGGING) << context << "NOTIFY_REQUEST_TRANSACTIONS: too many hashes requested, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  NOTIFY_NEW_TRANSACTIONS::request notification;
+  std::vector<Crypto::Hash> missedHashes;
+  m_core.getPoolTransactions(arg.txs, notification.txs, missedHashes);
+  for (const auto& hash : arg.txs) {
+    context.addKnownTransaction(hash);
+  }
+
+  if (!notification.txs.empty()) {
+    post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+  }
+
+  return 1;
+}
+
 int CryptoNoteProtocolHandler::handle_request_get_objects(int command, NOTIFY_REQUEST_GET_OBJECTS::request& arg, CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_GET_OBJECTS";
-  NOTIFY_RESPONSE_GET_OBJECTS::request rsp;
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_REQUEST_GET_OBJECTS";
+  EncodedResponseGetObjects rsp;
   //if (!m_core.handle_get_objects(arg, rsp)) {
   //  logger(Logging::ERROR) << context << "failed to handle request NOTIFY_REQUEST_GET_OBJECTS, dropping connection";
   //  context.m_state = CryptoNoteConnectionContext::state_shutdown;
   //}
 
   rsp.current_blockchain_height = m_core.getTopBlockIndex() + 1;
-  std::vector<RawBlock> rawBlocks;
-  m_core.getBlocks(arg.blocks, rawBlocks, rsp.missed_ids);
+  m_encodedBlocks.getBlocks(m_core, arg.blocks, rsp.blocks, rsp.missed_ids);
   if (!arg.txs.empty()) {
     logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << context << "NOTIFY_RESPONSE_GET_OBJECTS: request.txs.empty() != true";
   }
 
-  rsp.blocks = convertRawBlocksToRawBlocksLegacy(rawBlocks);
-
-  logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_GET_OBJECTS: blocks.size()=" << rsp.blocks.size() << ", txs.size()=" << rsp.txs.size()
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_GET_OBJECTS: blocks.size()=" << rsp.blocks.size() << ", txs.size()=" << rsp.txs.size()
     << ", rsp.m_current_blockchain_height=" << rsp.current_blockchain_height << ", missed_ids.size()=" << rsp.missed_ids.size();
-  post_notify<NOTIFY_RESPONSE_GET_OBJECTS>(*m_p2p, rsp, context);
+  m_p2p->invoke_notify_to_peer(NOTIFY_RESPONSE_GET_OBJECTS::ID, LevinProtocol::encode(rsp), context);
   return 1;
 }
 
 int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_RESPONSE_GET_OBJECTS::request& arg, CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "NOTIFY_RESPONSE_GET_OBJECTS";
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_RESPONSE_GET_OBJECTS";
 
   if (context.m_last_response_height > arg.current_blockchain_height) {
     logger(Logging::ERROR) << context << "sent wrong NOTIFY_HAVE_OBJECTS: arg.m_current_blockchain_height=" << arg.current_blockchain_height
@@ -427,7 +502,7 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
         context.m_state = CryptoNoteConnectionContext::state_idle;
         context.m_needed_objects.clear();
         context.m_requested_objects.clear();
-        logger(Logging::DEBUGGING) << context << "Connection set to idle state.";
+        LOG_MESSAGE(logger, Logging::DEBUGGING) << context << "Connection set to idle state.";
         return 1;
       }
     }
@@ -487,7 +562,7 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
     if (addResult == error::AddBlockErrorCondition::BLOCK_VALIDATION_FAILED ||
         addResult == error::AddBlockErrorCondition::TRANSACTION_VALIDATION_FAILED ||
         addResult == error::AddBlockErrorCondition::DESERIALIZATION_FAILED) {
-      logger(Logging::DEBUGGING) << context << "Block verification failed, dropping connection: " << addResult.message();
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << context << "Block verification failed, dropping connection: " << addResult.message();
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     } else if (addResult == error::AddBlockErrorCondition::BLOCK_REJECTED) {
@@ -495,7 +570,7 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     } else if (addResult == error::AddBlockErrorCode::ALREADY_EXISTS) {
-      logger(Logging::DEBUGGING) << context << "Block already exists, switching to idle state: " << addResult.message();
+      LOG_MESSAGE(logger, Logging::DEBUGGING) << context << "Block already exists, switching to idle state: " << addResult.message();
       context.m_state = CryptoNoteConnectionContext::state_idle;
       context.m_needed_objects.clear();
       context.m_requested_objects.clear();
@@ -509,7 +584,7 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
 }
 
 int CryptoNoteProtocolHandler::handle_request_chain(int command, NOTIFY_REQUEST_CHAIN::request& arg, CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << arg.block_ids.size();
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << arg.block_ids.size();
 
   if (arg.block_ids.empty()) {
     logger(Logging::ERROR, Logging::BRIGHT_RED) << context << "Failed to handle NOTIFY_REQUEST_CHAIN. block_ids is empty";
@@ -526,7 +601,7 @@ int CryptoNoteProtocolHandler::handle_request_chain(int command, NOTIFY_REQUEST_
   NOTIFY_RESPONSE_CHAIN_ENTRY::request r;
   r.m_block_ids = m_core.findBlockchainSupplement(arg.block_ids, BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT, r.total_height, r.start_height);
 
-  logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_CHAIN_ENTRY: m_start_height=" << r.start_height << ", m_total_height=" << r.total_height << ", m_block_ids.size()=" << r.m_block_ids.size();
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_CHAIN_ENTRY: m_start_height=" << r.start_height << ", m_total_height=" << r.total_height << ", m_block_ids.size()=" << r.m_block_ids.size();
   post_notify<NOTIFY_RESPONSE_CHAIN_ENTRY>(*m_p2p, r, context);
   return 1;
 }
@@ -546,13 +621,13 @@ bool CryptoNoteProtocolHandler::request_missing_objects(CryptoNoteConnectionCont
       }
       it = context.m_needed_objects.erase(it);
     }
-    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size() << ", txs.size()=" << req.txs.size();
+    LOG_MESSAGE(logger, Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size() << ", txs.size()=" << req.txs.size();
     post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
   } else if (context.m_last_response_height < context.m_remote_blockchain_height - 1) {//we have to fetch more objects ids, request blockchain entry
 
     NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
     r.block_ids = m_core.buildSparseChain();
-    logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
+    LOG_MESSAGE(logger, Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
     post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
   } else {
     if (!(context.m_last_response_height ==
@@ -596,7 +671,7 @@ bool CryptoNoteProtocolHandler::on_connection_synchronized() {
 }
 
 int CryptoNoteProtocolHandler::handle_response_chain_entry(int command, NOTIFY_RESPONSE_CHAIN_ENTRY::request& arg, CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "NOTIFY_RESPONSE_CHAIN_ENTRY: m_block_ids.size()=" << arg.m_block_ids.size()
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_RESPONSE_CHAIN_ENTRY: m_block_ids.size()=" << arg.m_block_ids.size()
     << ", m_start_height=" << arg.start_height << ", m_total_height=" << arg.total_height;
 
   if (!arg.m_block_ids.size()) {
@@ -644,7 +719,7 @@ int CryptoNoteProtocolHandler::handle_response_chain_entry(int command, NOTIFY_R
 
 int CryptoNoteProtocolHandler::handleRequestTxPool(int command, NOTIFY_REQUEST_TX_POOL::request& arg,
                                                      CryptoNoteConnectionContext& context) {
-  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_TX_POOL: txs.size() = " << arg.txs.size();
+  LOG_MESSAGE(logger, Logging::TRACE) << context << "NOTIFY_REQUEST_TX_POOL: txs.size() = " << arg.txs.size();
   NOTIFY_NEW_TRANSACTIONS::request notification;
   std::vector<Crypto::Hash> deletedTransactions;
   m_core.getPoolChanges(m_core.getTopBlockHash(), arg.txs, notification.txs, deletedTransactions);
@@ -665,8 +740,76 @@ void CryptoNoteProtocolHandler::relayBlock(NOTIFY_NEW_BLOCK::request& arg) {
 }
 
 void CryptoNoteProtocolHandler::relayTransactions(const std::vector<BinaryArray>& transactions) {
-  auto buf = LevinProtocol::encode(NOTIFY_NEW_TRANSACTIONS::request{transactions});
-  m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf, nullptr);
+  std::vector<Crypto::Hash> hashes;
+  hashes.reserve(transactions.size());
+  for (const auto& transaction : transactions) {
+    hashes.push_back(getBinaryArrayHash(transaction));
+  }
+
+  // can be called from external threads, peer contexts are owned by the dispatcher
+  m_dispatcher.remoteSpawn([this, transactions, hashes] {
+    relayTransactionsToPeers(transactions, hashes, nullptr);
+  });
+}
+
+void CryptoNoteProtocolHandler::relayTransactionsToPeers(const std::vector<BinaryArray>& transactions, const std::vector<Crypto::Hash>& hashes,
+                                                         const net_connection_id* excludeConnection) {
+  assert(transactions.size() == hashes.size());
+
+  // V2 peers get the hashes queued for the next announcement, older peers get the blobs right away
+  BinaryArray legacyNotification;
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& ctx, PeerIdType peerId) {
+    if (peerId == 0 || (excludeConnection != nullptr && ctx.m_connection_id == *excludeConnection) ||
+        (ctx.m_state != CryptoNoteConnectionContext::state_normal && ctx.m_state != CryptoNoteConnectionContext::state_synchronizing)) {
+      return;
+    }
+
+    if (ctx.version < P2PProtocolVersion::V2) {
+      if (legacyNotification.empty()) {
+        legacyNotification = LevinProtocol::encode(NOTIFY_NEW_TRANSACTIONS::request{transactions});
+      }
+
+      m_p2p->invoke_notify_to_peer(NOTIFY_NEW_TRANSACTIONS::ID, legacyNotification, ctx);
+      return;
+    }
+
+    for (const auto& hash : hashes) {
+      if (ctx.addKnownTransaction(hash)) {
+        ctx.m_pendingTransactionAnnounces.push_back(hash);
+      }
+    }
+  });
+}
+
+void CryptoNoteProtocolHandler::announceTransactions() {
+  time_t now = time(nullptr);
+  for (auto it = m_requestedTransactions.begin(); it != m_requestedTransactions.end();) {
+    if (now - it->second > P2P_TRANSACTION_REQUEST_TIMEOUT) {
+      it = m_requestedTransactions.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& ctx, PeerIdType peerId) {
+    if (ctx.m_pendingTransactionAnnounces.empty()) {
+      return;
+    }
+
+    std::vector<Crypto::Hash> pending;
+    pending.swap(ctx.m_pendingTransactionAnnounces);
+    if (ctx.m_state != CryptoNoteConnectionContext::state_normal && ctx.m_state != CryptoNoteConnectionContext::state_synchronizing) {
+      return;
+    }
+
+    for (size_t offset = 0; offset < pending.size(); offset += P2P_MAX_TRANSACTION_ANNOUNCE_COUNT) {
+      NOTIFY_NEW_TRANSACTION_HASHES::request notification;
+      auto end = pending.begin() + std::min(pending.size(), offset + P2P_MAX_TRANSACTION_ANNOUNCE_COUNT);
+      notification.txs.assign(pending.begin() + offset, end);
+      LOG_MESSAGE(logger, Logging::TRACE) << ctx << "-->>NOTIFY_NEW_TRANSACTION_HASHES: txs.size() = " << notification.txs.size();
+      post_notify<NOTIFY_NEW_TRANSACTION_HASHES>(*m_p2p, notification, ctx);
+    }
+  });
 }
 
 void CryptoNoteProtocolHandler::requestMissingPoolTransactions(const CryptoNoteConnectionContext& context) {
@@ -709,7 +852,7 @@ void CryptoNoteProtocolHandler::updateObservedHeight(uint32_t peerHeight, const
   }
 
   if (updated) {
-    logger(TRACE) << "Observed height updated: " << m_observedHeight;
+    LOG_MESSAGE(logger, TRACE) << "Observed height updated: " << m_observedHeight;
     m_observerManager.notify(&ICryptoNoteProtocolObserver::lastKnownBlockHeightUpdated, m_observedHeight);
   }
 }
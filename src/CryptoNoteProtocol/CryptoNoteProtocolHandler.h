@@ -18,9 +18,11 @@
 #pragma once
 
 #include <atomic>
+#include <unordered_map>
 
 #include <Common/ObserverManager.h>
 
+#include "CryptoNoteCore/EncodedBlocksCache.h"
 #include "CryptoNoteCore/ICore.h"
 
 #include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
@@ -68,6 +70,8 @@ namespace CryptoNote
     virtual size_t getPeerCount() const override;
     virtual uint32_t getObservedHeight() const override;
     void requestMissingPoolTransactions(const CryptoNoteConnectionContext& context);
+    // sends queued transaction hashes to V2 peers, called periodically by NodeServer
+    void announceTransactions();
 
   private:
     //----------------- commands handlers ----------------------------------------------
@@ -78,6 +82,8 @@ namespace CryptoNote
     int handle_request_chain(int command, NOTIFY_REQUEST_CHAIN::request& arg, CryptoNoteConnectionContext& context);
     int handle_response_chain_entry(int command, NOTIFY_RESPONSE_CHAIN_ENTRY::request& arg, CryptoNoteConnectionContext& context);
     int handleRequestTxPool(int command, NOTIFY_REQUEST_TX_POOL::request& arg, CryptoNoteConnectionContext& context);
+    int handleNotifyNewTransactionHashes(int command, NOTIFY_NEW_TRANSACTION_HASHES::request& arg, CryptoNoteConnectionContext& context);
+    int handleRequestTransactions(int command, NOTIFY_REQUEST_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context);
 
     //----------------- i_cryptonote_protocol ----------------------------------
     virtual void relayBlock(NOTIFY_NEW_BLOCK::request& arg) override;
@@ -90,6 +96,7 @@ namespace CryptoNote
     void updateObservedHeight(uint32_t peerHeight, const CryptoNoteConnectionContext& context);
     void recalculateMaxObservedHeight(const CryptoNoteConnectionContext& context);
     int processObjects(CryptoNoteConnectionContext& context, std::vector<RawBlock>&& rawBlocks, const std::vector<CachedBlock>& cachedBlocks);
+    void relayTransactionsToPeers(const std::vector<BinaryArray>& transactions, const std::vector<Crypto::Hash>& hashes, const net_connection_id* excludeConnection);
     Logging::LoggerRef logger;
 
   private:
@@ -107,6 +114,9 @@ namespace CryptoNote
     uint32_t m_observedHeight;
 
     std::atomic<size_t> m_peersCount;
+    // announced transactions we asked a peer for, with the request time
+    std::unordered_map<Crypto::Hash, time_t> m_requestedTransactions;
+    EncodedBlocksCache m_encodedBlocks;
     Tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
   };
 }
@@ -28,6 +28,7 @@ public:
   virtual bool addObserver(ICryptoNoteProtocolObserver* observer) = 0;
   virtual bool removeObserver(ICryptoNoteProtocolObserver* observer) = 0;
 
+  // Getters may be called from any thread, InProcessNode reads them without entering the dispatcher
   virtual uint32_t getObservedHeight() const = 0;
   virtual size_t getPeerCount() const = 0;
   virtual bool isSynchronized() const = 0;
@@ -66,6 +66,10 @@ namespace
   const command_line::arg_descriptor<bool>        arg_console     = {"no-console", "Disable daemon console commands"};
   const command_line::arg_descriptor<bool>        arg_testnet_on  = {"testnet", "Used to deploy test nets. Checkpoints and hardcoded seeds are ignored, "
     "network id is changed. Use it with --data-dir flag. The wallet must be launched with --testnet flag.", false};
+  const command_line::arg_descriptor<uint64_t>    arg_txpool_max_size = {"txpool-max-size", "Memory budget of the transaction pool in megabytes, "
+    "transactions paying the lowest fee are evicted above it", CryptoNote::parameters::CRYPTONOTE_MEMPOOL_MAX_SIZE / (1024 * 1024)};
+  const command_line::arg_descriptor<bool>        arg_scan_tables = {"enable-scan-tables", "Store a compact table of transaction keys and outputs "
+    "for every new block, light wallets download it with /getscantables.bin"};
 }
 
 bool command_line_preprocessor(const boost::program_options::variables_map& vm, LoggerRef& logger);
@@ -80,6 +84,7 @@ JsonValue buildLoggerConfiguration(Level level, const std::string& logfile) {
   fileLogger.insert("type", "file");
   fileLogger.insert("filename", logfile);
   fileLogger.insert("level", static_cast<int64_t>(TRACE));
+  fileLogger.insert("async", JsonValue(true));
 
   JsonValue& consoleLogger = cfgLoggers.pushBack(JsonValue::OBJECT);
   consoleLogger.insert("type", "console");
@@ -114,6 +119,8 @@ int main(int argc, char* argv[])
     command_line::add_arg(desc_cmd_sett, arg_log_level);
     command_line::add_arg(desc_cmd_sett, arg_console);
     command_line::add_arg(desc_cmd_sett, arg_testnet_on);
+    command_line::add_arg(desc_cmd_sett, arg_txpool_max_size);
+    command_line::add_arg(desc_cmd_sett, arg_scan_tables);
 
     RpcServerConfig::initOptions(desc_cmd_sett);
     NetNodeConfig::initOptions(desc_cmd_sett);
@@ -197,6 +204,7 @@ int main(int argc, char* argv[])
     //create objects and link them
     CryptoNote::CurrencyBuilder currencyBuilder(logManager);
     currencyBuilder.testnet(testnet_mode);
+    currencyBuilder.mempoolMaxSize(command_line::get_arg(vm, arg_txpool_max_size) * 1024 * 1024);
     CryptoNote::Currency currency = currencyBuilder.currency();
 
     CryptoNote::Checkpoints checkpoints(logManager);
@@ -248,8 +256,9 @@ int main(int argc, char* argv[])
       logManager,
       std::move(checkpoints),
       dispatcher,
-      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger())),
-      createSwappedMainChainStorage(data_dir_path.string(), currency));
+      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger(), command_line::get_arg(vm, arg_scan_tables))),
+      createSwappedMainChainStorage(data_dir_path.string(), currency),
+      data_dir_path.string());
 
     ccore.load();
     logger(INFO) << "Core initialized OK";
@@ -18,7 +18,6 @@
 #include "InProcessNode.h"
 
 #include <functional>
-#include <future>
 #include <boost/utility/value_init.hpp>
 #include <CryptoNoteCore/TransactionApi.h>
 
@@ -40,57 +39,6 @@ namespace CryptoNote {
 
 namespace {
 
-//executes function in dispatcher's context from any thread
-//add <void> specialisation when needed
-template <class ReturnType>
-class RemotelySpawnedSyncContext {
-public:
-  RemotelySpawnedSyncContext(System::Dispatcher& dispatcher, std::atomic<size_t>& counter, System::Event& counterEvent, std::function<ReturnType()>&& function) :
-    called(false)
-  {
-    future = promise.get_future();
-
-    counter++;
-    dispatcher.remoteSpawn([this, function, &counter, &counterEvent] () {
-      Tools::ScopeExit guard([&counter, &counterEvent] () {
-        counter--;
-        counterEvent.set();
-      });
-
-      try {
-        promise.set_value(function());
-      } catch (std::exception&) {
-        promise.set_exception(std::current_exception());
-      }
-    });
-  }
-
-  ~RemotelySpawnedSyncContext() {
-    try {
-      if (!called) {
-        future.get();
-      }
-    } catch (std::exception&){
-    }
-  }
-
-  ReturnType get() {
-    called = true;
-    return future.get();
-  }
-
-  RemotelySpawnedSyncContext(const RemotelySpawnedSyncContext&) = delete;
-  RemotelySpawnedSyncContext& operator=(const RemotelySpawnedSyncContext&) = delete;
-
-  RemotelySpawnedSyncContext(RemotelySpawnedSyncContext&&) = delete;
-  RemotelySpawnedSyncContext& operator=(RemotelySpawnedSyncContext&&) = delete;
-
-private:
-  std::promise<ReturnType> promise;
-  std::future<ReturnType> future;
-  std::atomic<bool> called;
-};
-
 class RemoteContextCounterWrapper {
 public:
   RemoteContextCounterWrapper(System::Dispatcher& dispatcher_, std::function<void()>&& function_, std::atomic<size_t>& contextCounter_, System::Event& contextCounterEvent_):
@@ -147,8 +95,7 @@ uint64_t getBlockReward(const BlockTemplate& block) {
 
 InProcessNode::InProcessNode(CryptoNote::ICore& core, CryptoNote::ICryptoNoteProtocolHandler& protocol,
                              System::Dispatcher& disp)
-    : state(NOT_INITIALIZED), dispatcher(disp), contextCounter(0), contextCounterEvent(disp), contextGroup(dispatcher), core(core), protocol(protocol),
-      messageQueue(dispatcher)  {
+    : state(NOT_INITIALIZED), dispatcher(disp), contextCounter(0), contextCounterEvent(disp), core(core), protocol(protocol) {
   resetLastLocalBlockHeaderInfo();
 }
 
@@ -183,48 +130,8 @@ void InProcessNode::init(const Callback& callback) {
   }
 
   protocol.addObserver(this);
-  core.addMessageQueue(messageQueue);
-
-  contextCounter++;
-  contextGroup.spawn([this] {
-    using namespace Messages;
-
-    Tools::ScopeExit guard([this] () {
-      contextCounter--;
-      contextCounterEvent.set();
-    });
-
-    try {
-      while (true) {
-        messageQueue.front().match(
-          [this](const NewBlock& msg) {
-            auto topBlockIndex = this->core.getTopBlockIndex();
-            executeInRemoteThread([this, topBlockIndex] () { blockchainUpdated(topBlockIndex); });
-          },
-          [this](const NewAlternativeBlock& msg) {
-            auto topBlockIndex = this->core.getTopBlockIndex();
-            executeInRemoteThread([this, topBlockIndex] () { blockchainUpdated(topBlockIndex); });
-          },
-          [this](const ChainSwitch& msg) {
-            auto topBlockIndex = this->core.getTopBlockIndex();
-            executeInRemoteThread([this, msg, topBlockIndex] () {
-              chainSwitched(topBlockIndex, msg.commonRootIndex, msg.blocksFromCommonRoot);
-              blockchainUpdated(topBlockIndex);
-            });
-          },
-          [this](const AddTransaction& msg) {
-            executeInRemoteThread([this] () { poolUpdated(); });
-          },
-          [this](const DeleteTransaction& msg) {
-            executeInRemoteThread([this] () { poolUpdated(); });
-          }
-        );
-
-        messageQueue.pop();
-      }
-    } catch (System::InterruptedException&) {
-    }
-  });
+  eventSubscriber.reset(new BlockchainEventRing::Subscriber(core.getBlockchainEventRing()));
+  eventThread = std::thread(&InProcessNode::processBlockchainEvents, this);
 
   updateLastLocalBlockHeaderInfo();
   state = INITIALIZED;
@@ -242,13 +149,15 @@ bool InProcessNode::doShutdown() {
   }
 
   protocol.removeObserver(this);
-  core.removeMessageQueue(messageQueue); // TODO: add RAII guard
+  eventSubscriber->stop();
   resetLastLocalBlockHeaderInfo();
   state = NOT_INITIALIZED;
-  messageQueue.stop();
 
   lock.unlock();
 
+  eventThread.join();
+  eventSubscriber.reset();
+
   while(contextCounter > 0) {
     contextCounterEvent.wait();
     contextCounterEvent.clear();
@@ -478,11 +387,7 @@ size_t InProcessNode::getPeerCount() const {
     }
   }
 
-  RemotelySpawnedSyncContext<size_t> context(dispatcher, contextCounter, contextCounterEvent, [this] () {
-    return protocol.getPeerCount();
-  });
-
-  return context.get();
+  return protocol.getPeerCount();
 }
 
 uint32_t InProcessNode::getLocalBlockCount() const {
@@ -502,11 +407,7 @@ uint32_t InProcessNode::getKnownBlockCount() const {
     }
   }
 
-  RemotelySpawnedSyncContext<uint32_t> context(dispatcher, contextCounter, contextCounterEvent, [this] {
-    return protocol.getObservedHeight();
-  });
-
-  return context.get();
+  return protocol.getObservedHeight();
 }
 
 uint32_t InProcessNode::getLastLocalBlockHeight() const {
@@ -526,11 +427,7 @@ uint32_t InProcessNode::getLastKnownBlockHeight() const {
     }
   }
 
-  RemotelySpawnedSyncContext<uint32_t> context(dispatcher, contextCounter, contextCounterEvent, [this] {
-    return protocol.getObservedHeight() - 1;
-  });
-
-  return context.get();
+  return protocol.getObservedHeight() - 1;
 }
 
 uint64_t InProcessNode::getLastLocalBlockTimestamp() const {
@@ -618,6 +515,46 @@ void InProcessNode::poolUpdated() {
   observerManager.notify(&INodeObserver::poolChanged);
 }
 
+void InProcessNode::processBlockchainEvents() {
+  using namespace Messages;
+
+  boost::optional<BlockchainMessage> message;
+  uint32_t topBlockIndex;
+  for (;;) {
+    switch (eventSubscriber->read(message, topBlockIndex)) {
+    case BlockchainEventRing::ReadResult::Message:
+      message->match(
+        [this, topBlockIndex](const NewBlock& msg) {
+          blockchainUpdated(topBlockIndex);
+        },
+        [this, topBlockIndex](const NewAlternativeBlock& msg) {
+          blockchainUpdated(topBlockIndex);
+        },
+        [this, topBlockIndex](const ChainSwitch& msg) {
+          chainSwitched(topBlockIndex, msg.commonRootIndex, msg.blocksFromCommonRoot);
+          blockchainUpdated(topBlockIndex);
+        },
+        [this](const AddTransaction& msg) {
+          poolUpdated();
+        },
+        [this](const DeleteTransaction& msg) {
+          poolUpdated();
+        }
+      );
+      break;
+    case BlockchainEventRing::ReadResult::Overflow:
+      // Lost messages can't be replayed, observers resynchronize from the current state instead
+      blockchainUpdated(core.getBlockchainEventRing().getTopBlockIndex());
+      poolUpdated();
+      break;
+    case BlockchainEventRing::ReadResult::Empty:
+      break;
+    case BlockchainEventRing::ReadResult::Stopped:
+      return;
+    }
+  }
+}
+
 void InProcessNode::updateLastLocalBlockHeaderInfo() {
   Hash topBlockHash;
   uint32_t topBlockIndex;
@@ -24,10 +24,8 @@
 #include "CryptoNoteCore/BlockchainMessages.h"
 #include "CryptoNoteCore/ICore.h"
 #include "CryptoNoteCore/ICoreObserver.h"
-#include "CryptoNoteCore/MessageQueue.h"
 #include "Common/ObserverManager.h"
 
-#include "System/ContextGroup.h"
 #include "System/Dispatcher.h"
 
 #include <atomic>
@@ -95,6 +93,8 @@ private:
   void blockchainUpdated(uint32_t topBlockIndex);
   void chainSwitched(uint32_t topBlockIndex, uint32_t commonRoot, const std::vector<Crypto::Hash>& hashes);
   void poolUpdated();
+  // Runs on eventThread, reads core events without entering the dispatcher
+  void processBlockchainEvents();
 
   void executeInRemoteThread(std::function<void()>&& func);
   void executeInDispatcherThread(std::function<void()>&& func);
@@ -126,7 +126,6 @@ private:
   System::Dispatcher& dispatcher;
   mutable std::atomic<size_t> contextCounter;
   mutable System::Event contextCounterEvent;
-  System::ContextGroup contextGroup;
 
   //precondition: any call to core's methods must be performed from user dispatcher's thread
   CryptoNote::ICore& core;
@@ -135,7 +134,8 @@ private:
   Tools::ObserverManager<INodeObserver> observerManager;
   BlockHeaderInfo lastLocalBlockHeaderInfo;
 
-  MessageQueue<BlockchainMessage> messageQueue;
+  std::unique_ptr<BlockchainEventRing::Subscriber> eventSubscriber;
+  std::thread eventThread;
 
   mutable std::mutex mutex;
 };
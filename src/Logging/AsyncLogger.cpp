@@ -0,0 +1,207 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "AsyncLogger.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace Logging {
+
+namespace {
+
+const std::chrono::milliseconds WRITER_IDLE_PERIOD(10);
+
+std::atomic<uint64_t> nextLoggerId(0);
+
+}
+
+struct AsyncLogRecord {
+  std::string category;
+  Level level;
+  boost::posix_time::ptime time;
+  std::string body;
+};
+
+// Single producer single consumer ring, the producer is the owning thread and the consumer is the writer thread
+class AsyncLogRing {
+public:
+  explicit AsyncLogRing(size_t size) : records(size), head(0), tail(0) {
+  }
+
+  bool push(AsyncLogRecord& record) {
+    size_t currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail - head.load(std::memory_order_acquire) == records.size()) {
+      return false;
+    }
+
+    records[currentTail % records.size()] = std::move(record);
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(AsyncLogRecord& record) {
+    size_t currentHead = head.load(std::memory_order_relaxed);
+    if (currentHead == tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    record = std::move(records[currentHead % records.size()]);
+    head.store(currentHead + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+  }
+
+  size_t size() const {
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const {
+    return records.size();
+  }
+
+private:
+  std::vector<AsyncLogRecord> records;
+  std::atomic<size_t> head;
+  std::atomic<size_t> tail;
+};
+
+AsyncLogger::AsyncLogger(std::unique_ptr<CommonLogger>&& logger, Level level, size_t ringSize, OverflowPolicy policy) :
+  CommonLogger(level), logger(std::move(logger)), id(nextLoggerId++), ringSize(ringSize), policy(policy),
+  droppedCount(0), pushedCount(0), writtenCount(0), stopped(false), wakeRequested(false) {
+  writer = std::thread(&AsyncLogger::writerProcedure, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+  stopped = true;
+  wakeWriter();
+  writer.join();
+}
+
+void AsyncLogger::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
+  if (level > logLevel || disabledCategories.count(category) != 0) {
+    return;
+  }
+
+  AsyncLogRecord record{category, level, time, body};
+  AsyncLogRing& ring = getThreadRing();
+  if (!ring.push(record)) {
+    if (policy == DROP) {
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      wakeWriter();
+      return;
+    }
+
+    do {
+      wakeWriter();
+      std::this_thread::yield();
+    } while (!ring.push(record));
+  }
+
+  pushedCount.fetch_add(1, std::memory_order_release);
+  if (level <= ERROR || ring.size() >= ring.capacity() / 2) {
+    wakeWriter();
+  }
+}
+
+void AsyncLogger::waitWritten() {
+  uint64_t target = pushedCount.load(std::memory_order_acquire);
+  while (writtenCount.load(std::memory_order_acquire) < target) {
+    wakeWriter();
+    std::this_thread::yield();
+  }
+}
+
+AsyncLogRing& AsyncLogger::getThreadRing() {
+  // Rings are looked up by logger id, so a new logger allocated at the same address never reuses a stale ring
+  thread_local std::unordered_map<uint64_t, std::shared_ptr<AsyncLogRing>> threadRings;
+  auto it = threadRings.find(id);
+  if (it == threadRings.end()) {
+    auto ring = std::make_shared<AsyncLogRing>(ringSize);
+    {
+      std::lock_guard<std::mutex> lock(ringsMutex);
+      rings.push_back(ring);
+    }
+
+    it = threadRings.emplace(id, std::move(ring)).first;
+  }
+
+  return *it->second;
+}
+
+void AsyncLogger::wakeWriter() {
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    wakeRequested = true;
+  }
+
+  wakeCondition.notify_one();
+}
+
+size_t AsyncLogger::drain() {
+  std::vector<std::shared_ptr<AsyncLogRing>> currentRings;
+  {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    // Forget drained rings of threads that have exited
+    rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<AsyncLogRing>& ring) {
+      return ring.use_count() == 1 && ring->empty();
+    }), rings.end());
+    currentRings = rings;
+  }
+
+  size_t count = 0;
+  AsyncLogRecord record;
+  for (auto& ring : currentRings) {
+    while (ring->pop(record)) {
+      (*logger)(record.category, record.level, record.time, record.body);
+      ++count;
+    }
+  }
+
+  uint64_t dropped = droppedCount.exchange(0);
+  if (dropped != 0) {
+    (*logger)("AsyncLogger", WARNING, boost::posix_time::microsec_clock::local_time(),
+      std::to_string(dropped) + " log messages dropped, log ring is full\n");
+  }
+
+  if (count != 0 || dropped != 0) {
+    logger->flush();
+  }
+
+  writtenCount.fetch_add(count, std::memory_order_release);
+  return count;
+}
+
+void AsyncLogger::writerProcedure() {
+  for (;;) {
+    bool stopping = stopped;
+    size_t count = drain();
+    if (stopping) {
+      break;
+    }
+
+    if (count == 0) {
+      std::unique_lock<std::mutex> lock(wakeMutex);
+      wakeCondition.wait_for(lock, WRITER_IDLE_PERIOD, [this] { return wakeRequested; });
+      wakeRequested = false;
+    }
+  }
+}
+
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CommonLogger.h"
+
+namespace Logging {
+
+class AsyncLogRing;
+
+// Hands messages over to a background thread through per-thread lock-free rings, so the
+// calling thread never waits for the wrapped logger's formatting or I/O.
+class AsyncLogger : public CommonLogger {
+public:
+  enum OverflowPolicy {
+    DROP,   // discard the message and report the number of dropped messages later
+    BLOCK   // wait until the writer thread frees space in the ring
+  };
+
+  static const size_t MAX_RING_SIZE = 1 << 16;
+
+  AsyncLogger(std::unique_ptr<CommonLogger>&& logger, Level level = DEBUGGING, size_t ringSize = 8192, OverflowPolicy policy = DROP);
+  ~AsyncLogger();
+
+  virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+  // Returns after everything logged before the call has been passed to the wrapped logger
+  void waitWritten();
+
+private:
+  std::unique_ptr<CommonLogger> logger;
+  const uint64_t id;
+  const size_t ringSize;
+  const OverflowPolicy policy;
+  std::mutex ringsMutex;
+  std::vector<std::shared_ptr<AsyncLogRing>> rings;
+  std::atomic<uint64_t> droppedCount;
+  std::atomic<uint64_t> pushedCount;
+  std::atomic<uint64_t> writtenCount;
+  std::atomic<bool> stopped;
+  std::mutex wakeMutex;
+  std::condition_variable wakeCondition;
+  bool wakeRequested;
+  std::thread writer;
+
+  AsyncLogRing& getThreadRing();
+  void wakeWriter();
+  size_t drain();
+  void writerProcedure();
+};
+
+}
@@ -90,10 +90,17 @@ void CommonLogger::setMaxLevel(Level level) {
   logLevel = level;
 }
 
+Level CommonLogger::getMaxLevel() const {
+  return logLevel;
+}
+
 CommonLogger::CommonLogger(Level level) : logLevel(level), pattern("%D %T %L [%C] ") {
 }
 
 void CommonLogger::doLogString(const std::string& message) {
 }
 
+void CommonLogger::flush() {
+}
+
 }
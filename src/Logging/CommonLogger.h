@@ -29,6 +29,8 @@ public:
   virtual void enableCategory(const std::string& category);
   virtual void disableCategory(const std::string& category);
   virtual void setMaxLevel(Level level);
+  virtual Level getMaxLevel() const override;
+  virtual void flush();
 
   void setPattern(const std::string& pattern);
   virtual ~CommonLogger(){}
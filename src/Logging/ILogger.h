@@ -57,6 +57,8 @@ public:
   const static std::array<std::string, 6> LEVEL_NAMES;
 
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) = 0;
+  // Most verbose level that can reach any output, messages above it may be skipped without formatting
+  virtual Level getMaxLevel() const { return TRACE; }
   virtual ~ILogger(){}
 };
 
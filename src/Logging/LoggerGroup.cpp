@@ -31,6 +31,15 @@ void LoggerGroup::removeLogger(ILogger& logger) {
   loggers.erase(std::remove(loggers.begin(), loggers.end(), &logger), loggers.end());
 }
 
+Level LoggerGroup::getMaxLevel() const {
+  Level maxLevel = FATAL;
+  for (auto logger : loggers) {
+    maxLevel = std::max(maxLevel, logger->getMaxLevel());
+  }
+
+  return std::min(logLevel, maxLevel);
+}
+
 void LoggerGroup::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
   if (level <= logLevel && disabledCategories.count(category) == 0) {
     for (auto& logger : loggers) {
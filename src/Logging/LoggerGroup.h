@@ -26,9 +26,10 @@ class LoggerGroup : public CommonLogger {
 public:
   LoggerGroup(Level level = DEBUGGING);
 
-  void addLogger(ILogger& logger);
-  void removeLogger(ILogger& logger);
+  virtual void addLogger(ILogger& logger);
+  virtual void removeLogger(ILogger& logger);
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+  virtual Level getMaxLevel() const override;
 
 protected:
   std::vector<ILogger*> loggers;
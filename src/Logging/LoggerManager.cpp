@@ -16,24 +16,78 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "LoggerManager.h"
+#include <algorithm>
 #include <thread>
+#include "AsyncLogger.h"
 #include "ConsoleLogger.h"
 #include "FileLogger.h"
+#include "Common/ScopeExit.h"
 
 namespace Logging {
 
 using Common::JsonValue;
 
-LoggerManager::LoggerManager() {
+LoggerManager::LoggerManager() : maxLevel(LoggerGroup::getMaxLevel()) {
+  publishSnapshot();
+}
+
+void LoggerManager::addLogger(ILogger& logger) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::addLogger(logger);
+  publishSnapshot();
+}
+
+void LoggerManager::removeLogger(ILogger& logger) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::removeLogger(logger);
+  publishSnapshot();
 }
 
 void LoggerManager::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
+  std::shared_ptr<const Snapshot> current = std::atomic_load(&snapshot);
+  if (level <= current->logLevel && current->disabledCategories.count(category) == 0) {
+    for (auto logger : current->loggers) {
+      (*logger)(category, level, time, body);
+    }
+  }
+}
+
+void LoggerManager::enableCategory(const std::string& category) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::enableCategory(category);
+  publishSnapshot();
+}
+
+void LoggerManager::disableCategory(const std::string& category) {
   std::unique_lock<std::mutex> lock(reconfigureLock);
-  LoggerGroup::operator()(category, level, time, body);
+  LoggerGroup::disableCategory(category);
+  publishSnapshot();
+}
+
+Level LoggerManager::getMaxLevel() const {
+  return maxLevel.load(std::memory_order_relaxed);
+}
+
+void LoggerManager::setMaxLevel(Level level) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::setMaxLevel(level);
+  publishSnapshot();
+}
+
+void LoggerManager::publishSnapshot() {
+  std::shared_ptr<Snapshot> updated = std::make_shared<Snapshot>();
+  updated->loggers = LoggerGroup::loggers;
+  updated->ownedLoggers = loggers;
+  updated->disabledCategories = disabledCategories;
+  updated->logLevel = logLevel;
+  std::atomic_store(&snapshot, std::shared_ptr<const Snapshot>(std::move(updated)));
+  maxLevel = LoggerGroup::getMaxLevel();
 }
 
 void LoggerManager::configure(const JsonValue& val) {
   std::unique_lock<std::mutex> lock(reconfigureLock);
+  // the tree is already altered when a bad configuration throws
+  Tools::ScopeExit updateSnapshot([this] { publishSnapshot(); });
   loggers.clear();
   LoggerGroup::loggers.clear();
   Level globalLevel;
@@ -88,6 +142,10 @@ void LoggerManager::configure(const JsonValue& val) {
           std::string filename = loggerConfiguration("filename").getString();
           auto fileLogger = new FileLogger(level);
           fileLogger->init(filename);
+          if (loggerConfiguration.contains("async") && loggerConfiguration("async").getBool()) {
+            fileLogger->setBuffered(true);
+          }
+
           logger.reset(fileLogger);
         } else {
           throw std::runtime_error("Unknown logger type: " + type);
@@ -109,8 +167,32 @@ void LoggerManager::configure(const JsonValue& val) {
           }
         }
 
+        if (loggerConfiguration.contains("async") && loggerConfiguration("async").getBool()) {
+          size_t ringSize = 8192;
+          if (loggerConfiguration.contains("ringSize")) {
+            int64_t configuredSize = loggerConfiguration("ringSize").getInteger();
+            if (configuredSize <= 0) {
+              throw std::runtime_error("parameter ringSize must be positive");
+            }
+
+            ringSize = static_cast<size_t>(std::min(configuredSize, static_cast<int64_t>(AsyncLogger::MAX_RING_SIZE)));
+          }
+
+          AsyncLogger::OverflowPolicy policy = AsyncLogger::DROP;
+          if (loggerConfiguration.contains("overflow")) {
+            std::string overflow = loggerConfiguration("overflow").getString();
+            if (overflow == "block") {
+              policy = AsyncLogger::BLOCK;
+            } else if (overflow != "drop") {
+              throw std::runtime_error("Unknown logger overflow policy: " + overflow);
+            }
+          }
+
+          logger.reset(new AsyncLogger(std::move(logger), level, ringSize, policy));
+        }
+
         loggers.emplace_back(std::move(logger));
-        addLogger(*loggers.back());
+        LoggerGroup::addLogger(*loggers.back());
       }
     } else {
       throw std::runtime_error("loggers parameter has wrong type");
@@ -118,9 +200,9 @@ void LoggerManager::configure(const JsonValue& val) {
   } else {
     throw std::runtime_error("loggers parameter missing");
   }
-  setMaxLevel(globalLevel);
+  LoggerGroup::setMaxLevel(globalLevel);
   for (const auto& category : globalDisabledCategories) {
-    disableCategory(category);
+    LoggerGroup::disableCategory(category);
   }
 }
 
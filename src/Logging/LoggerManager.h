@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <set>
 #include "../Common/JsonValue.h"
 #include "LoggerGroup.h"
 
@@ -29,11 +31,32 @@ class LoggerManager : public LoggerGroup {
 public:
   LoggerManager();
   void configure(const Common::JsonValue& val);
+  virtual void addLogger(ILogger& logger) override;
+  virtual void removeLogger(ILogger& logger) override;
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+  virtual void enableCategory(const std::string& category) override;
+  virtual void disableCategory(const std::string& category) override;
+  virtual Level getMaxLevel() const override;
+  virtual void setMaxLevel(Level level) override;
 
 private:
-  std::vector<std::unique_ptr<CommonLogger>> loggers;
-  std::mutex reconfigureLock;
+  // Immutable copy of the logger tree, messages are dispatched through it without taking reconfigureLock
+  struct Snapshot {
+    std::vector<ILogger*> loggers;
+    // Keeps configured loggers alive while a message still goes through a replaced snapshot
+    std::vector<std::shared_ptr<CommonLogger>> ownedLoggers;
+    std::set<std::string> disabledCategories;
+    Level logLevel;
+  };
+
+  // Must be called with reconfigureLock held, also refreshes maxLevel
+  void publishSnapshot();
+
+  std::vector<std::shared_ptr<CommonLogger>> loggers;
+  std::shared_ptr<const Snapshot> snapshot;
+  mutable std::mutex reconfigureLock;
+  // Read by every LoggerMessage, refreshed whenever the logger tree is reconfigured
+  std::atomic<Level> maxLevel;
 };
 
 }
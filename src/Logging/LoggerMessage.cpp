@@ -26,8 +26,14 @@ LoggerMessage::LoggerMessage(ILogger& logger, const std::string& category, Level
   , category(category)
   , logLevel(level)
   , logger(logger)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
+  , gotText(false)
+  , enabled(level <= logger.getMaxLevel()) {
+  if (enabled) {
+    timestamp = boost::posix_time::microsec_clock::local_time();
+  } else {
+    // A bad stream makes every operator<< return before formatting anything
+    setstate(std::ios_base::badbit);
+  }
 }
 
 LoggerMessage::~LoggerMessage() {
@@ -44,8 +50,9 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
   , category(other.category)
   , logLevel(other.logLevel)
   , logger(other.logger)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
+  , timestamp(other.timestamp)
+  , gotText(false)
+  , enabled(other.enabled) {
   this->set_rdbuf(this);
 }
 #else
@@ -56,8 +63,9 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
   , logLevel(other.logLevel)
   , logger(other.logger)
   , message(other.message)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
+  , timestamp(other.timestamp)
+  , gotText(false)
+  , enabled(other.enabled) {
   if (this != &other) {
     _M_tie = nullptr;
     _M_streambuf = nullptr;
@@ -98,6 +106,10 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
 #endif
 
 int LoggerMessage::sync() {
+  if (!enabled) {
+    return 0;
+  }
+
   logger(category, logLevel, timestamp, message);
   gotText = false;
   message = DEFAULT;
@@ -41,6 +41,7 @@ private:
   ILogger& logger;
   boost::posix_time::ptime timestamp;
   bool gotText;
+  bool enabled;
 };
 
 }
@@ -26,6 +26,7 @@ class LoggerRef {
 public:
   LoggerRef(ILogger& logger, const std::string& category);
   LoggerMessage operator()(Level level = INFO, const std::string& color = DEFAULT) const;
+  bool isEnabled(Level level) const;
   ILogger& getLogger() const;
 
 private:
@@ -34,3 +35,7 @@ private:
 };
 
 }
+
+// Skips the streamed expressions entirely when the level is filtered out, for hot paths whose arguments are costly to format:
+//   LOG_MESSAGE(logger, Logging::DEBUGGING) << "Block " << hash << " added";
+#define LOG_MESSAGE(loggerRef, level) if (!(loggerRef).isEnabled(level)) {} else (loggerRef)(level)
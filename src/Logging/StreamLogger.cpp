@@ -21,10 +21,10 @@
 
 namespace Logging {
 
-StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr) {
+StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr), buffered(false) {
 }
 
-StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream) {
+StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream), buffered(false) {
 }
 
 void StreamLogger::attachToStream(std::ostream& stream) {
@@ -43,6 +43,19 @@ void StreamLogger::doLogString(const std::string& message) {
       }
     }
 
+    if (!buffered) {
+      *stream << std::flush;
+    }
+  }
+}
+
+void StreamLogger::setBuffered(bool buffered) {
+  this->buffered = buffered;
+}
+
+void StreamLogger::flush() {
+  if (stream != nullptr && stream->good()) {
+    std::lock_guard<std::mutex> lock(mutex);
     *stream << std::flush;
   }
 }
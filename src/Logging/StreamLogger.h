@@ -27,6 +27,9 @@ public:
   StreamLogger(Level level = DEBUGGING);
   StreamLogger(std::ostream& stream, Level level = DEBUGGING);
   void attachToStream(std::ostream& stream);
+  // A buffered logger leaves flushing to flush(), used when messages are written in batches
+  void setBuffered(bool buffered);
+  virtual void flush() override;
 
 protected:
   virtual void doLogString(const std::string& message) override;
@@ -36,6 +39,7 @@ protected:
 
 private:
   std::mutex mutex;
+  bool buffered;
 };
 
 }
@@ -26,8 +26,7 @@
 #include <HTTP/HttpResponse.h>
 #include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
-#include <System/Event.h>
-#include <System/EventLock.h>
+#include <System/InterruptedException.h>
 #include <System/Timer.h>
 #include <CryptoNoteCore/TransactionApi.h>
 
@@ -36,6 +35,7 @@
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "Rpc/CoreRpcServerCommandsDefinitions.h"
 #include "Rpc/HttpClient.h"
+#include "Rpc/HttpClientPool.h"
 #include "Rpc/JsonRpc.h"
 
 #ifndef AUTO_VAL_INIT
@@ -51,6 +51,9 @@ namespace CryptoNote {
 
 namespace {
 
+// The node holds change notification requests for up to this time, node status is refreshed after it anyway
+const uint32_t NODE_CHANGES_WAIT_TIMEOUT = 30000;
+
 std::error_code interpretResponseStatus(const std::string& status) {
   if (CORE_RPC_STATUS_BUSY == status) {
     return make_error_code(error::NODE_BUSY);
@@ -68,6 +71,8 @@ NodeRpcProxy::NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort,
     m_nodePort(nodePort),
     m_rpcTimeout(10000),
     m_pullInterval(5000),
+    m_connectionCount(4),
+    m_pipelineDepth(1),
     m_peerCount(0),
     m_networkHeight(0),
     m_connected(true) {
@@ -97,6 +102,8 @@ void NodeRpcProxy::resetInternalState() {
   lastLocalBlockHeaderInfo.difficulty = 0;
   lastLocalBlockHeaderInfo.reward = 0;
   m_knownTxs.clear();
+  m_poolVersion = 0;
+  m_longPollSupported = true;
 }
 
 void NodeRpcProxy::init(const INode::Callback& callback) {
@@ -131,6 +138,10 @@ bool NodeRpcProxy::shutdown() {
 
   m_dispatcher->remoteSpawn([this]() {
     m_stop = true;
+    if (m_waitContext != nullptr) {
+      m_waitContext->interrupt();
+    }
+
     // Run all spawned contexts
     m_dispatcher->yield();
   });
@@ -149,11 +160,11 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
     m_dispatcher = &dispatcher;
     ContextGroup contextGroup(dispatcher);
     m_context_group = &contextGroup;
-    HttpClient httpClient(dispatcher, m_nodeHost, m_nodePort);
+    HttpClientPool httpClient(dispatcher, m_nodeHost, m_nodePort, m_connectionCount, m_pipelineDepth);
     m_httpClient = &httpClient;
-    Event httpEvent(dispatcher);
-    m_httpEvent = &httpEvent;
-    m_httpEvent->set();
+    // change notification requests are held by the node, so they use their own connection
+    HttpClient longPollClient(dispatcher, m_nodeHost, m_nodePort);
+    m_longPollClient = &longPollClient;
 
     {
       std::lock_guard<std::mutex> lock(m_mutex);
@@ -165,11 +176,10 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
     initialized_callback(std::error_code());
 
     contextGroup.spawn([this]() {
-      Timer pullTimer(*m_dispatcher);
       while (!m_stop) {
         updateNodeStatus();
         if (!m_stop) {
-          pullTimer.sleep(std::chrono::milliseconds(m_pullInterval));
+          waitForNodeChanges();
         }
       }
     });
@@ -183,7 +193,7 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
   m_dispatcher = nullptr;
   m_context_group = nullptr;
   m_httpClient = nullptr;
-  m_httpEvent = nullptr;
+  m_longPollClient = nullptr;
   m_connected = false;
   m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
 }
@@ -196,6 +206,62 @@ void NodeRpcProxy::updateNodeStatus() {
   }
 }
 
+void NodeRpcProxy::waitForNodeChanges() {
+  // shutdown interrupts both the change notification request and the polling interval
+  ContextGroup waitContext(*m_dispatcher);
+  m_waitContext = &waitContext;
+  waitContext.spawn([this] {
+    try {
+      if (m_longPollSupported && requestNodeChanges()) {
+        return;
+      }
+
+      if (!m_stop) {
+        Timer(*m_dispatcher).sleep(std::chrono::milliseconds(m_pullInterval));
+      }
+    } catch (System::InterruptedException&) {
+    }
+  });
+
+  waitContext.wait();
+  m_waitContext = nullptr;
+}
+
+bool NodeRpcProxy::requestNodeChanges() {
+  COMMAND_RPC_WAIT_FOR_CHANGES::request req;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    req.tailBlockId = lastLocalBlockHeaderInfo.hash;
+  }
+
+  req.poolVersion = m_poolVersion;
+  req.timeout = NODE_CHANGES_WAIT_TIMEOUT;
+
+  HttpRequest httpReq;
+  httpReq.setUrl("/wait_for_changes.bin");
+  httpReq.setBody(storeToBinaryKeyValue(req));
+
+  try {
+    HttpResponse httpRes;
+    m_longPollClient->request(httpReq, httpRes);
+
+    COMMAND_RPC_WAIT_FOR_CHANGES::response rsp;
+    if (httpRes.getStatus() == HttpResponse::STATUS_404) {
+      m_logger(INFO) << "Node doesn't support change notifications, polling it every " << m_pullInterval << " ms";
+      m_longPollSupported = false;
+    } else if (loadFromBinaryKeyValue(rsp, httpRes.getBody()) && rsp.status == CORE_RPC_STATUS_OK) {
+      m_poolVersion = rsp.poolVersion;
+      return true;
+    }
+  } catch (const System::InterruptedException&) {
+    throw;
+  } catch (const std::exception& e) {
+    m_logger(TRACE) << "wait_for_changes.bin failed: " << e.what();
+  }
+
+  return false;
+}
+
 bool NodeRpcProxy::updatePoolStatus() {
   std::vector<Crypto::Hash> knownTxs = getKnownTxsVector();
   Crypto::Hash tailBlock = lastLocalBlockHeaderInfo.hash;
@@ -751,7 +817,6 @@ std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Reques
   std::error_code ec;
 
   try {
-    EventLock eventLock(*m_httpEvent);
     invokeBinaryCommand(*m_httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
@@ -769,7 +834,6 @@ std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request&
 
   try {
     m_logger(TRACE) << "Send " << url << " JSON request";
-    EventLock eventLock(*m_httpEvent);
     invokeJsonCommand(*m_httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
@@ -793,7 +857,6 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
 
   try {
     m_logger(TRACE) << "Send " << method << " JSON RPC request";
-    EventLock eventLock(*m_httpEvent);
 
     JsonRpc::JsonRpcRequest jsReq;
 
@@ -31,12 +31,12 @@
 namespace System {
   class ContextGroup;
   class Dispatcher;
-  class Event;
 }
 
 namespace CryptoNote {
 
 class HttpClient;
+class HttpClientPool;
 
 class INodeRpcProxyObserver {
 public:
@@ -85,6 +85,8 @@ public:
 
   unsigned int rpcTimeout() const { return m_rpcTimeout; }
   void rpcTimeout(unsigned int val) { m_rpcTimeout = val; }
+  // Connections to the node used for concurrent requests and requests pipelined on each of them, applied on init
+  void connectionPool(size_t connectionCount, size_t pipelineDepth) { m_connectionCount = connectionCount; m_pipelineDepth = pipelineDepth; }
 
 private:
   void resetInternalState();
@@ -93,6 +95,10 @@ private:
   std::vector<Crypto::Hash> getKnownTxsVector() const;
   void pullNodeStatusAndScheduleTheNext();
   void updateNodeStatus();
+  // Waits until the node reports a new top block or pool change, or for the polling interval if it can't
+  void waitForNodeChanges();
+  // Returns false if the node doesn't support change notifications or the request failed
+  bool requestNodeChanges();
   void updateBlockchainStatus();
   bool updatePoolStatus();
   void updatePeerCount(size_t peerCount);
@@ -142,10 +148,15 @@ private:
   const std::string m_nodeHost;
   const unsigned short m_nodePort;
   unsigned int m_rpcTimeout;
-  HttpClient* m_httpClient = nullptr;
-  System::Event* m_httpEvent = nullptr;
+  HttpClientPool* m_httpClient = nullptr;
+  HttpClient* m_longPollClient = nullptr;
+  System::ContextGroup* m_waitContext = nullptr;
 
   uint64_t m_pullInterval;
+  size_t m_connectionCount;
+  size_t m_pipelineDepth;
+  bool m_longPollSupported = true;
+  uint64_t m_poolVersion = 0;
 
   // Internal state
   bool m_stop = false;
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <deque>
 #include <list>
 #include <ostream>
 #include <unordered_set>
@@ -24,6 +25,7 @@
 #include <boost/uuid/uuid.hpp>
 #include "Common/StringTools.h"
 #include "crypto/hash.h"
+#include "CryptoNoteConfig.h"
 
 namespace CryptoNote {
 
@@ -50,6 +52,26 @@ struct CryptoNoteConnectionContext {
   std::unordered_set<Crypto::Hash> m_requested_objects;
   uint32_t m_remote_blockchain_height = 0;
   uint32_t m_last_response_height = 0;
+
+  // transaction inventory, see CryptoNoteProtocolHandler::announceTransactions()
+  std::unordered_set<Crypto::Hash> m_knownTransactions;
+  std::deque<Crypto::Hash> m_knownTransactionsOrder;
+  std::vector<Crypto::Hash> m_pendingTransactionAnnounces;
+
+  // returns false if the peer already knows the transaction
+  bool addKnownTransaction(const Crypto::Hash& hash) {
+    if (!m_knownTransactions.insert(hash).second) {
+      return false;
+    }
+
+    m_knownTransactionsOrder.push_back(hash);
+    if (m_knownTransactionsOrder.size() > P2P_MAX_KNOWN_TRANSACTIONS_PER_PEER) {
+      m_knownTransactions.erase(m_knownTransactionsOrder.front());
+      m_knownTransactionsOrder.pop_front();
+    }
+
+    return true;
+  }
 };
 
 inline std::string get_protocol_state_string(CryptoNoteConnectionContext::state s) {
@@ -77,6 +99,10 @@ inline std::string get_protocol_state_string(CryptoNoteConnectionContext::state
 
 namespace std {
 inline std::ostream& operator << (std::ostream& s, const CryptoNote::CryptoNoteConnectionContext& context) {
+  if (!s.good()) {
+    return s;
+  }
+
   return s << "[" << Common::ipAddressToString(context.m_remote_ip) << ":" << 
     context.m_remote_port << (context.m_is_income ? " INC" : " OUT") << "] ";
 }
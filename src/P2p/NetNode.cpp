@@ -215,6 +215,7 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     m_connections_maker_interval(1),
     m_peerlist_store_interval(60*30, false),
     m_timedSyncTimer(m_dispatcher),
+    m_transactionAnnounceTimer(m_dispatcher),
     m_network_id(MCN_NETWORK) {
   }
 
@@ -504,6 +505,7 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     m_workingContextGroup.spawn(std::bind(&NodeServer::onIdle, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timedSyncLoop, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timeoutLoop, this));
+    m_workingContextGroup.spawn(std::bind(&NodeServer::transactionAnnounceLoop, this));
 
     m_stopEvent.wait();
 
@@ -694,6 +696,22 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
   }
 
 
+  bool NodeServer::is_addr_bucket_saturated(const NetworkAddress& peer) {
+    if (m_allow_local_ip) {
+      return false;
+    }
+
+    size_t count = 0;
+    uint32_t bucket = getAddressBucket(peer);
+    for (const auto& conn : m_connections) {
+      if (!conn.second.m_is_income && getAddressBucket(NetworkAddress{conn.second.m_remote_ip, conn.second.m_remote_port}) == bucket) {
+        ++count;
+      }
+    }
+
+    return count >= CryptoNote::P2P_MAX_OUTGOING_CONNECTIONS_PER_BUCKET;
+  }
+
   bool NodeServer::try_to_connect_and_handshake_with_new_peer(const NetworkAddress& na, bool just_take_peerlist, uint64_t last_seen_stamp, bool white)  {
 
     logger(DEBUGGING) << "Connecting to " << na << " (white=" << white << ", last_seen: "
@@ -790,7 +808,7 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     if(!local_peers_count)
       return false;//no peers
 
-    size_t max_random_index = std::min<uint64_t>(local_peers_count -1, 20);
+    size_t max_random_index = local_peers_count - 1;
 
     std::set<size_t> tried_peers;
 
@@ -809,6 +827,9 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
       bool r = use_white_list ? m_peerlist.get_white_peer_by_index(pe, random_index):m_peerlist.get_gray_peer_by_index(pe, random_index);
       if (!(r)) { logger(ERROR, BRIGHT_RED) << "Failed to get random peer from peerlist(white:" << use_white_list << ")"; return false; }
 
+      if (!m_peerlist.is_peer_connectable(pe.adr, time(nullptr)) || is_addr_bucket_saturated(pe.adr))
+        continue;
+
       ++try_count;
 
       if(is_peer_used(pe))
@@ -817,8 +838,10 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
       logger(DEBUGGING) << "Selected peer: " << pe.id << " " << pe.adr << " [white=" << use_white_list
                     << "] last_seen: " << (pe.last_seen ? Common::timeIntervalToString(time(NULL) - pe.last_seen) : "never");
       
-      if(!try_to_connect_and_handshake_with_new_peer(pe.adr, false, pe.last_seen, use_white_list))
+      if(!try_to_connect_and_handshake_with_new_peer(pe.adr, false, pe.last_seen, use_white_list)) {
+        m_peerlist.set_peer_unreachable(pe);
         continue;
+      }
 
       return true;
     }
@@ -1367,6 +1390,21 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     logger(DEBUGGING) << "timedSyncLoop finished";
   }
 
+  void NodeServer::transactionAnnounceLoop() {
+    try {
+      for (;;) {
+        m_transactionAnnounceTimer.sleep(std::chrono::milliseconds(P2P_TRANSACTION_ANNOUNCE_INTERVAL));
+        m_payload_handler.announceTransactions();
+      }
+    } catch (System::InterruptedException&) {
+      logger(DEBUGGING) << "transactionAnnounceLoop() is interrupted";
+    } catch (std::exception& e) {
+      logger(WARNING) << "Exception in transactionAnnounceLoop: " << e.what();
+    }
+
+    logger(DEBUGGING) << "transactionAnnounceLoop finished";
+  }
+
   void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx) {
     // This inner context is necessary in order to stop connection handler at any moment
     System::Context<> context(m_dispatcher, [this, &connectionId, &ctx] {
@@ -1393,8 +1431,14 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
 
           BinaryArray response;
           bool handled = false;
+          auto handlingStart = std::chrono::steady_clock::now();
           auto retcode = handleCommand(cmd, response, ctx, handled);
 
+          // unknown commands share one series, so that peers can't grow the registry
+          CommandMetrics& commandMetrics = getCommandMetrics(handled ? cmd.command : 0);
+          commandMetrics.handlingTime->observe(std::chrono::steady_clock::now() - handlingStart);
+          commandMetrics.receivedBytes->add(cmd.buf.size());
+
           // send response
           if (cmd.needReply()) {
             if (!handled) {
@@ -1436,6 +1480,20 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     }
   }
 
+  NodeServer::CommandMetrics& NodeServer::getCommandMetrics(uint32_t command) {
+    auto it = m_commandMetrics.find(command);
+    if (it == m_commandMetrics.end()) {
+      Common::MetricLabels labels = {{"command", command != 0 ? std::to_string(command) : "unknown"}};
+      CommandMetrics commandMetrics;
+      commandMetrics.receivedBytes = &Common::metrics().counter("p2p_received_bytes_total", "Payload bytes received from peers", labels);
+      commandMetrics.sentBytes = &Common::metrics().counter("p2p_sent_bytes_total", "Payload bytes sent to peers", labels);
+      commandMetrics.handlingTime = &Common::metrics().histogram("p2p_command_duration_seconds", "Time spent handling peer commands", labels);
+      it = m_commandMetrics.emplace(command, commandMetrics).first;
+    }
+
+    return it->second;
+  }
+
   void NodeServer::writeHandler(P2pConnectionContext& ctx) {
     logger(DEBUGGING) << ctx << "writeHandler started";
 
@@ -1450,6 +1508,7 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
 
         for (const auto& msg : msgs) {
           logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
+          getCommandMetrics(msg.command).sentBytes->add(msg.buffer.size());
           switch (msg.type) {
           case P2pMessage::COMMAND:
             proto.sendMessage(msg.command, msg.buffer, true);
@@ -33,6 +33,7 @@
 #include "CryptoNoteCore/OnceInInterval.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
 #include "Common/CommandLine.h"
+#include "Common/Metrics.h"
 #include "Logging/LoggerRef.h"
 
 #include "ConnectionContext.h"
@@ -195,6 +196,7 @@ namespace CryptoNote
     bool try_to_connect_and_handshake_with_new_peer(const NetworkAddress& na, bool just_take_peerlist = false, uint64_t last_seen_stamp = 0, bool white = true);
     bool is_peer_used(const PeerlistEntry& peer);
     bool is_addr_connected(const NetworkAddress& peer);  
+    bool is_addr_bucket_saturated(const NetworkAddress& peer);
     bool try_ping(basic_node_data& node_data, P2pConnectionContext& context);
     bool make_expected_connections_count(bool white_list, size_t expected_connections);
     bool is_priority_node(const NetworkAddress& na);
@@ -207,6 +209,14 @@ namespace CryptoNote
     //debug functions
     std::string print_connections_container();
 
+    struct CommandMetrics {
+      Common::MetricCounter* receivedBytes;
+      Common::MetricCounter* sentBytes;
+      Common::MetricHistogram* handlingTime;
+    };
+
+    CommandMetrics& getCommandMetrics(uint32_t command);
+
     typedef std::unordered_map<boost::uuids::uuid, P2pConnectionContext, boost::hash<boost::uuids::uuid>> ConnectionContainer;
     typedef ConnectionContainer::iterator ConnectionIterator;
     ConnectionContainer m_connections;
@@ -217,6 +227,7 @@ namespace CryptoNote
     void onIdle();
     void timedSyncLoop();
     void timeoutLoop();
+    void transactionAnnounceLoop();
     
     template<typename T>
     void safeInterrupt(T& obj);
@@ -260,6 +271,7 @@ namespace CryptoNote
     OnceInInterval m_connections_maker_interval;
     OnceInInterval m_peerlist_store_interval;
     System::Timer m_timedSyncTimer;
+    System::Timer m_transactionAnnounceTimer;
 
     std::string m_bind_ip;
     std::string m_port;
@@ -272,5 +284,6 @@ namespace CryptoNote
     std::list<PeerlistEntry> m_command_line_peers;
     uint64_t m_peer_livetime;
     boost::uuids::uuid m_network_id;
+    std::unordered_map<uint32_t, CommandMetrics> m_commandMetrics;
   };
 }
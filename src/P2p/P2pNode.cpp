@@ -451,7 +451,7 @@ std::list<PeerlistEntry> P2pNode::getLocalPeerList() const {
 basic_node_data P2pNode::getNodeData() const {
   basic_node_data nodeData;
   nodeData.network_id = m_cfg.getNetworkId();
-  nodeData.version = P2PProtocolVersion::CURRENT;
+  nodeData.version = P2PProtocolVersion::V1; // no transaction announcements support
   nodeData.local_time = time(nullptr);
   nodeData.peer_id = m_myPeerId;
 
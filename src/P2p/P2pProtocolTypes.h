@@ -61,6 +61,10 @@ namespace CryptoNote
   }
 
   inline std::ostream& operator << (std::ostream& s, const NetworkAddress& na) {
+    if (!s.good()) {
+      return s;
+    }
+
     return s << Common::ipAddressToString(na.ip) << ":" << std::to_string(na.port);   
   }
 
@@ -76,11 +76,9 @@ bool PeerlistManager::Peerlist::get(PeerlistEntry& entry, size_t i) const {
   if (i >= m_peers.size())
     return false;
 
-  peers_indexed::index<by_time>::type& by_time_index = m_peers.get<by_time>();
-
-  auto it = by_time_index.rbegin();
-  std::advance(it, i);
-  entry = *it;
+  // index 0 is the most recently seen peer
+  const peers_indexed::index<by_time>::type& by_time_index = m_peers.get<by_time>();
+  entry = *by_time_index.nth(m_peers.size() - 1 - i);
 
   return true;
 }
@@ -214,6 +212,8 @@ bool PeerlistManager::append_with_peer_white(const PeerlistEntry& ple)
     if (!is_ip_allowed(ple.adr.ip))
       return true;
 
+    m_failures.erase(ple.adr);
+
     //find in white list
     auto by_addr_it_wt = m_peers_white.get<by_addr>().find(ple.adr);
     if (by_addr_it_wt == m_peers_white.get<by_addr>().end()) {
@@ -251,6 +251,11 @@ bool PeerlistManager::append_with_peer_gray(const PeerlistEntry& ple)
     auto by_addr_it_gr = m_peers_gray.get<by_addr>().find(ple.adr);
     if (by_addr_it_gr == m_peers_gray.get<by_addr>().end())
     {
+      //don't let a single network crowd out the rest of the list
+      if (!m_allow_local_ip && m_peers_gray.get<by_bucket>().count(getAddressBucket(ple.adr)) >= CryptoNote::P2P_MAX_GRAY_PEERS_PER_BUCKET) {
+        return true;
+      }
+
       //put new record into white list
       m_peers_gray.insert(ple);
       trim_gray_peerlist();
@@ -266,6 +271,50 @@ bool PeerlistManager::append_with_peer_gray(const PeerlistEntry& ple)
 }
 //--------------------------------------------------------------------------------------------------
 
+bool PeerlistManager::set_peer_unreachable(const PeerlistEntry& pr)
+{
+  time_t now = time(nullptr);
+  if (m_failures.size() >= CryptoNote::P2P_LOCAL_GRAY_PEERLIST_LIMIT) {
+    for (auto it = m_failures.begin(); it != m_failures.end();) {
+      if (now - it->second.lastFailure > static_cast<time_t>(CryptoNote::P2P_FAILED_PEER_MAX_BACKOFF)) {
+        it = m_failures.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  PeerFailures& failures = m_failures[pr.adr];
+  ++failures.count;
+  failures.lastFailure = now;
+
+  //gray peers we never managed to reach are not worth keeping
+  if (failures.count >= CryptoNote::P2P_MAX_PEER_CONNECT_FAILURES) {
+    auto by_addr_it_gr = m_peers_gray.get<by_addr>().find(pr.adr);
+    if (by_addr_it_gr != m_peers_gray.get<by_addr>().end()) {
+      m_peers_gray.erase(by_addr_it_gr);
+      m_failures.erase(pr.adr);
+    }
+  }
+
+  return true;
+}
+//--------------------------------------------------------------------------------------------------
+
+bool PeerlistManager::is_peer_connectable(const NetworkAddress& addr, time_t now) const
+{
+  auto it = m_failures.find(addr);
+  if (it == m_failures.end()) {
+    return true;
+  }
+
+  //exponential backoff: base, 2 * base, 4 * base... up to the maximum
+  uint64_t backoff = CryptoNote::P2P_FAILED_PEER_BASE_BACKOFF << std::min<uint32_t>(it->second.count - 1, 16);
+  backoff = std::min<uint64_t>(backoff, CryptoNote::P2P_FAILED_PEER_MAX_BACKOFF);
+  return now - it->second.lastFailure >= static_cast<time_t>(backoff);
+}
+//--------------------------------------------------------------------------------------------------
+
 PeerlistManager::Peerlist& PeerlistManager::getWhite() { 
   return m_whitePeerlist; 
 }
@@ -18,9 +18,12 @@
 #pragma once
 
 #include <list>
+#include <map>
 
 #include <boost/multi_index_container.hpp>
+#include <boost/multi_index/global_fun.hpp>
 #include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/ranked_index.hpp>
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/member.hpp>
 
@@ -30,6 +33,16 @@
 namespace CryptoNote {
 
 class ISerializer;
+
+// /16 network of the address, peers from one bucket are likely run by the same operator
+inline uint32_t getAddressBucket(const NetworkAddress& addr) {
+  return addr.ip & 0x0000ffff; // ip is in network byte order
+}
+
+inline uint32_t getPeerlistEntryBucket(const PeerlistEntry& entry) {
+  return getAddressBucket(entry.adr);
+}
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
@@ -37,17 +50,25 @@ class PeerlistManager {
   struct by_time{};
   struct by_id{};
   struct by_addr{};
+  struct by_bucket{};
 
   typedef boost::multi_index_container<
     PeerlistEntry,
     boost::multi_index::indexed_by<
     // access by peerlist_entry::net_adress
     boost::multi_index::ordered_unique<boost::multi_index::tag<by_addr>, boost::multi_index::member<PeerlistEntry, NetworkAddress, &PeerlistEntry::adr> >,
-    // sort by peerlist_entry::last_seen<
-    boost::multi_index::ordered_non_unique<boost::multi_index::tag<by_time>, boost::multi_index::member<PeerlistEntry, uint64_t, &PeerlistEntry::last_seen> >
+    // sort by peerlist_entry::last_seen<, ranked for O(log n) access by position
+    boost::multi_index::ranked_non_unique<boost::multi_index::tag<by_time>, boost::multi_index::member<PeerlistEntry, uint64_t, &PeerlistEntry::last_seen> >,
+    // group by address bucket
+    boost::multi_index::ordered_non_unique<boost::multi_index::tag<by_bucket>, boost::multi_index::global_fun<const PeerlistEntry&, uint32_t, &getPeerlistEntryBucket> >
     >
   > peers_indexed;
 
+  struct PeerFailures {
+    uint32_t count;
+    time_t lastFailure;
+  };
+
 public:
 
   class Peerlist {
@@ -77,6 +98,8 @@ public:
   bool set_peer_just_seen(PeerIdType peer, uint32_t ip, uint32_t port);
   bool set_peer_just_seen(PeerIdType peer, const NetworkAddress& addr);
   bool set_peer_unreachable(const PeerlistEntry& pr);
+  // false while the address is backing off after failed connection attempts
+  bool is_peer_connectable(const NetworkAddress& addr, time_t now) const;
   bool is_ip_allowed(uint32_t ip) const;
   void trim_white_peerlist();
   void trim_gray_peerlist();
@@ -93,6 +116,7 @@ private:
   peers_indexed m_peers_white;
   Peerlist m_whitePeerlist;
   Peerlist m_grayPeerlist;
+  std::map<NetworkAddress, PeerFailures> m_failures;
 };
 
 }
@@ -29,32 +29,44 @@ namespace PaymentService {
 
 PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher& sys, System::Event& stopEvent, WalletService& service, Logging::ILogger& loggerGroup) 
   : JsonRpcServer(sys, stopEvent, loggerGroup)
-  , service(service)
+  , services({{"", &service}})
   , logger(loggerGroup, "PaymentServiceJsonRpcServer")
 {
-  handlers.emplace("save", jsonHandler<Save::Request, Save::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSave, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("export", jsonHandler<Export::Request, Export::Response>(std::bind(&PaymentServiceJsonRpcServer::handleExport, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("reset", jsonHandler<Reset::Request, Reset::Response>(std::bind(&PaymentServiceJsonRpcServer::handleReset, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("createAddress", jsonHandler<CreateAddress::Request, CreateAddress::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateAddress, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("createAddressList", jsonHandler<CreateAddressList::Request, CreateAddressList::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateAddressList, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("deleteAddress", jsonHandler<DeleteAddress::Request, DeleteAddress::Response>(std::bind(&PaymentServiceJsonRpcServer::handleDeleteAddress, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getSpendKeys", jsonHandler<GetSpendKeys::Request, GetSpendKeys::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetSpendKeys, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getBalance", jsonHandler<GetBalance::Request, GetBalance::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetBalance, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getBlockHashes", jsonHandler<GetBlockHashes::Request, GetBlockHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetBlockHashes, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getTransactionHashes", jsonHandler<GetTransactionHashes::Request, GetTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getTransactions", jsonHandler<GetTransactions::Request, GetTransactions::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactions, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getUnconfirmedTransactionHashes", jsonHandler<GetUnconfirmedTransactionHashes::Request, GetUnconfirmedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetUnconfirmedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getTransaction", jsonHandler<GetTransaction::Request, GetTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransaction, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("sendTransaction", jsonHandler<SendTransaction::Request, SendTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendTransaction, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("createDelayedTransaction", jsonHandler<CreateDelayedTransaction::Request, CreateDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getDelayedTransactionHashes", jsonHandler<GetDelayedTransactionHashes::Request, GetDelayedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetDelayedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("deleteDelayedTransaction", jsonHandler<DeleteDelayedTransaction::Request, DeleteDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleDeleteDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("sendDelayedTransaction", jsonHandler<SendDelayedTransaction::Request, SendDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getViewKey", jsonHandler<GetViewKey::Request, GetViewKey::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetViewKey, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getStatus", jsonHandler<GetStatus::Request, GetStatus::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetStatus, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getAddresses", jsonHandler<GetAddresses::Request, GetAddresses::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetAddresses, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("sendFusionTransaction", jsonHandler<SendFusionTransaction::Request, SendFusionTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendFusionTransaction, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("estimateFusion", jsonHandler<EstimateFusion::Request, EstimateFusion::Response>(std::bind(&PaymentServiceJsonRpcServer::handleEstimateFusion, this, std::placeholders::_1, std::placeholders::_2)));
+  registerHandlers();
+}
+
+PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher& sys, System::Event& stopEvent, const std::unordered_map<std::string, WalletService*>& services, Logging::ILogger& loggerGroup)
+  : JsonRpcServer(sys, stopEvent, loggerGroup)
+  , services(services)
+  , logger(loggerGroup, "PaymentServiceJsonRpcServer")
+{
+  registerHandlers();
+}
+
+void PaymentServiceJsonRpcServer::registerHandlers() {
+  handlers.emplace("save", jsonHandler<Save::Request, Save::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSave, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("export", jsonHandler<Export::Request, Export::Response>(std::bind(&PaymentServiceJsonRpcServer::handleExport, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("reset", jsonHandler<Reset::Request, Reset::Response>(std::bind(&PaymentServiceJsonRpcServer::handleReset, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("createAddress", jsonHandler<CreateAddress::Request, CreateAddress::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateAddress, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("createAddressList", jsonHandler<CreateAddressList::Request, CreateAddressList::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateAddressList, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("deleteAddress", jsonHandler<DeleteAddress::Request, DeleteAddress::Response>(std::bind(&PaymentServiceJsonRpcServer::handleDeleteAddress, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getSpendKeys", jsonHandler<GetSpendKeys::Request, GetSpendKeys::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetSpendKeys, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getBalance", jsonHandler<GetBalance::Request, GetBalance::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetBalance, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getBlockHashes", jsonHandler<GetBlockHashes::Request, GetBlockHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetBlockHashes, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getTransactionHashes", jsonHandler<GetTransactionHashes::Request, GetTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactionHashes, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getTransactions", jsonHandler<GetTransactions::Request, GetTransactions::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactions, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getUnconfirmedTransactionHashes", jsonHandler<GetUnconfirmedTransactionHashes::Request, GetUnconfirmedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetUnconfirmedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getTransaction", jsonHandler<GetTransaction::Request, GetTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransaction, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("sendTransaction", jsonHandler<SendTransaction::Request, SendTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendTransaction, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("createDelayedTransaction", jsonHandler<CreateDelayedTransaction::Request, CreateDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getDelayedTransactionHashes", jsonHandler<GetDelayedTransactionHashes::Request, GetDelayedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetDelayedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("deleteDelayedTransaction", jsonHandler<DeleteDelayedTransaction::Request, DeleteDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleDeleteDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("sendDelayedTransaction", jsonHandler<SendDelayedTransaction::Request, SendDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getViewKey", jsonHandler<GetViewKey::Request, GetViewKey::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetViewKey, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getStatus", jsonHandler<GetStatus::Request, GetStatus::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetStatus, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("getAddresses", jsonHandler<GetAddresses::Request, GetAddresses::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetAddresses, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("sendFusionTransaction", jsonHandler<SendFusionTransaction::Request, SendFusionTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendFusionTransaction, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  handlers.emplace("estimateFusion", jsonHandler<EstimateFusion::Request, EstimateFusion::Response>(std::bind(&PaymentServiceJsonRpcServer::handleEstimateFusion, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
 }
 
 void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) {
@@ -89,22 +101,43 @@ void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue&
       params = req("params");
     }
 
-    it->second(params, resp);
+    WalletService* service = findService(params);
+    if (service == nullptr) {
+      logger(Logging::WARNING) << "Requested container not found: " << params;
+      makeGenericErrorReponse(resp, "Container not found", -32602);
+      return;
+    }
+
+    it->second(*service, params, resp);
   } catch (std::exception& e) {
     logger(Logging::WARNING) << "Error occurred while processing JsonRpc request: " << e.what();
     makeGenericErrorReponse(resp, e.what());
   }
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleSave(const Save::Request& /*request*/, Save::Response& /*response*/) {
+WalletService* PaymentServiceJsonRpcServer::findService(const Common::JsonValue& params) const {
+  // a single container is served whatever the request says
+  if (services.size() == 1 && services.begin()->first.empty()) {
+    return services.begin()->second;
+  }
+
+  if (!params.contains("container") || !params("container").isString()) {
+    return nullptr;
+  }
+
+  auto it = services.find(params("container").getString());
+  return it != services.end() ? it->second : nullptr;
+}
+
+std::error_code PaymentServiceJsonRpcServer::handleSave(WalletService& service, const Save::Request& /*request*/, Save::Response& /*response*/) {
   return service.saveWalletNoThrow();
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleExport(const Export::Request& request, Export::Response& /*response*/) {
+std::error_code PaymentServiceJsonRpcServer::handleExport(WalletService& service, const Export::Request& request, Export::Response& /*response*/) {
   return service.exportWallet(request.fileName);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleReset(const Reset::Request& request, Reset::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleReset(WalletService& service, const Reset::Request& request, Reset::Response& response) {
   if (request.viewSecretKey.empty()) {
     return service.resetWallet();
   } else {
@@ -112,7 +145,7 @@ std::error_code PaymentServiceJsonRpcServer::handleReset(const Reset::Request& r
   }
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleCreateAddress(const CreateAddress::Request& request, CreateAddress::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleCreateAddress(WalletService& service, const CreateAddress::Request& request, CreateAddress::Response& response) {
   if (request.spendSecretKey.empty() && request.spendPublicKey.empty()) {
     return service.createAddress(response.address);
   } else if (!request.spendSecretKey.empty()) {
@@ -122,19 +155,19 @@ std::error_code PaymentServiceJsonRpcServer::handleCreateAddress(const CreateAdd
   }
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleCreateAddressList(const CreateAddressList::Request& request, CreateAddressList::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleCreateAddressList(WalletService& service, const CreateAddressList::Request& request, CreateAddressList::Response& response) {
   return service.createAddressList(request.spendSecretKeys, response.addresses);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleDeleteAddress(const DeleteAddress::Request& request, DeleteAddress::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleDeleteAddress(WalletService& service, const DeleteAddress::Request& request, DeleteAddress::Response& response) {
   return service.deleteAddress(request.address);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetSpendKeys(const GetSpendKeys::Request& request, GetSpendKeys::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetSpendKeys(WalletService& service, const GetSpendKeys::Request& request, GetSpendKeys::Response& response) {
   return service.getSpendkeys(request.address, response.spendPublicKey, response.spendSecretKey);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetBalance(const GetBalance::Request& request, GetBalance::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetBalance(WalletService& service, const GetBalance::Request& request, GetBalance::Response& response) {
   if (!request.address.empty()) {
     return service.getBalance(request.address, response.availableBalance, response.lockedAmount);
   } else {
@@ -142,11 +175,11 @@ std::error_code PaymentServiceJsonRpcServer::handleGetBalance(const GetBalance::
   }
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetBlockHashes(const GetBlockHashes::Request& request, GetBlockHashes::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetBlockHashes(WalletService& service, const GetBlockHashes::Request& request, GetBlockHashes::Response& response) {
   return service.getBlockHashes(request.firstBlockIndex, request.blockCount, response.blockHashes);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetTransactionHashes(const GetTransactionHashes::Request& request, GetTransactionHashes::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetTransactionHashes(WalletService& service, const GetTransactionHashes::Request& request, GetTransactionHashes::Response& response) {
   if (!request.blockHash.empty()) {
     return service.getTransactionHashes(request.addresses, request.blockHash, request.blockCount, request.paymentId, response.items);
   } else {
@@ -154,7 +187,7 @@ std::error_code PaymentServiceJsonRpcServer::handleGetTransactionHashes(const Ge
   }
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetTransactions(const GetTransactions::Request& request, GetTransactions::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetTransactions(WalletService& service, const GetTransactions::Request& request, GetTransactions::Response& response) {
   if (!request.blockHash.empty()) {
     return service.getTransactions(request.addresses, request.blockHash, request.blockCount, request.paymentId, response.items);
   } else {
@@ -162,51 +195,51 @@ std::error_code PaymentServiceJsonRpcServer::handleGetTransactions(const GetTran
   }
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetUnconfirmedTransactionHashes(const GetUnconfirmedTransactionHashes::Request& request, GetUnconfirmedTransactionHashes::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetUnconfirmedTransactionHashes(WalletService& service, const GetUnconfirmedTransactionHashes::Request& request, GetUnconfirmedTransactionHashes::Response& response) {
   return service.getUnconfirmedTransactionHashes(request.addresses, response.transactionHashes);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetTransaction(const GetTransaction::Request& request, GetTransaction::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetTransaction(WalletService& service, const GetTransaction::Request& request, GetTransaction::Response& response) {
   return service.getTransaction(request.transactionHash, response.transaction);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleSendTransaction(const SendTransaction::Request& request, SendTransaction::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleSendTransaction(WalletService& service, const SendTransaction::Request& request, SendTransaction::Response& response) {
   return service.sendTransaction(request, response.transactionHash);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleCreateDelayedTransaction(const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleCreateDelayedTransaction(WalletService& service, const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response) {
   return service.createDelayedTransaction(request, response.transactionHash);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetDelayedTransactionHashes(const GetDelayedTransactionHashes::Request& request, GetDelayedTransactionHashes::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetDelayedTransactionHashes(WalletService& service, const GetDelayedTransactionHashes::Request& request, GetDelayedTransactionHashes::Response& response) {
   return service.getDelayedTransactionHashes(response.transactionHashes);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleDeleteDelayedTransaction(const DeleteDelayedTransaction::Request& request, DeleteDelayedTransaction::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleDeleteDelayedTransaction(WalletService& service, const DeleteDelayedTransaction::Request& request, DeleteDelayedTransaction::Response& response) {
   return service.deleteDelayedTransaction(request.transactionHash);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleSendDelayedTransaction(const SendDelayedTransaction::Request& request, SendDelayedTransaction::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleSendDelayedTransaction(WalletService& service, const SendDelayedTransaction::Request& request, SendDelayedTransaction::Response& response) {
   return service.sendDelayedTransaction(request.transactionHash);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetViewKey(const GetViewKey::Request& request, GetViewKey::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetViewKey(WalletService& service, const GetViewKey::Request& request, GetViewKey::Response& response) {
   return service.getViewKey(response.viewSecretKey);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetStatus(const GetStatus::Request& request, GetStatus::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetStatus(WalletService& service, const GetStatus::Request& request, GetStatus::Response& response) {
   return service.getStatus(response.blockCount, response.knownBlockCount, response.lastBlockHash, response.peerCount);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetAddresses(const GetAddresses::Request& request, GetAddresses::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetAddresses(WalletService& service, const GetAddresses::Request& request, GetAddresses::Response& response) {
   return service.getAddresses(response.addresses);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleSendFusionTransaction(const SendFusionTransaction::Request& request, SendFusionTransaction::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleSendFusionTransaction(WalletService& service, const SendFusionTransaction::Request& request, SendFusionTransaction::Response& response) {
   return service.sendFusionTransaction(request.threshold, request.anonymity, request.addresses, request.destinationAddress, response.transactionHash);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleEstimateFusion(const EstimateFusion::Request& request, EstimateFusion::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleEstimateFusion(WalletService& service, const EstimateFusion::Request& request, EstimateFusion::Response& response) {
   return service.estimateFusion(request.threshold, request.addresses, response.fusionReadyCount, response.totalOutputCount);
 }
 
@@ -32,20 +32,22 @@ class WalletService;
 class PaymentServiceJsonRpcServer : public CryptoNote::JsonRpcServer {
 public:
   PaymentServiceJsonRpcServer(System::Dispatcher& sys, System::Event& stopEvent, WalletService& service, Logging::ILogger& loggerGroup);
+  // Serves several containers, every request names its container in the "container" parameter
+  PaymentServiceJsonRpcServer(System::Dispatcher& sys, System::Event& stopEvent, const std::unordered_map<std::string, WalletService*>& services, Logging::ILogger& loggerGroup);
   PaymentServiceJsonRpcServer(const PaymentServiceJsonRpcServer&) = delete;
 
 protected:
   virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) override;
 
 private:
-  WalletService& service;
+  std::unordered_map<std::string, WalletService*> services;
   Logging::LoggerRef logger;
 
-  typedef std::function<void (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse)> HandlerFunction;
+  typedef std::function<void (WalletService& service, const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse)> HandlerFunction;
 
   template <typename RequestType, typename ResponseType, typename RequestHandler>
   HandlerFunction jsonHandler(RequestHandler handler) {
-    return [handler] (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse) mutable {
+    return [handler] (WalletService& service, const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse) mutable {
       RequestType request;
       ResponseType response;
 
@@ -57,7 +59,7 @@ private:
         return;
       }
 
-      std::error_code ec = handler(request, response);
+      std::error_code ec = handler(service, request, response);
       if (ec) {
         makeErrorResponse(ec, jsonResponse);
         return;
@@ -71,30 +73,33 @@ private:
 
   std::unordered_map<std::string, HandlerFunction> handlers;
 
-  std::error_code handleSave(const Save::Request& request, Save::Response& response);
-  std::error_code handleExport(const Export::Request& request, Export::Response& response);
-  std::error_code handleReset(const Reset::Request& request, Reset::Response& response);
-  std::error_code handleCreateAddress(const CreateAddress::Request& request, CreateAddress::Response& response);
-  std::error_code handleCreateAddressList(const CreateAddressList::Request& request, CreateAddressList::Response& response);
-  std::error_code handleDeleteAddress(const DeleteAddress::Request& request, DeleteAddress::Response& response);
-  std::error_code handleGetSpendKeys(const GetSpendKeys::Request& request, GetSpendKeys::Response& response);
-  std::error_code handleGetBalance(const GetBalance::Request& request, GetBalance::Response& response);
-  std::error_code handleGetBlockHashes(const GetBlockHashes::Request& request, GetBlockHashes::Response& response);
-  std::error_code handleGetTransactionHashes(const GetTransactionHashes::Request& request, GetTransactionHashes::Response& response);
-  std::error_code handleGetTransactions(const GetTransactions::Request& request, GetTransactions::Response& response);
-  std::error_code handleGetUnconfirmedTransactionHashes(const GetUnconfirmedTransactionHashes::Request& request, GetUnconfirmedTransactionHashes::Response& response);
-  std::error_code handleGetTransaction(const GetTransaction::Request& request, GetTransaction::Response& response);
-  std::error_code handleSendTransaction(const SendTransaction::Request& request, SendTransaction::Response& response);
-  std::error_code handleCreateDelayedTransaction(const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response);
-  std::error_code handleGetDelayedTransactionHashes(const GetDelayedTransactionHashes::Request& request, GetDelayedTransactionHashes::Response& response);
-  std::error_code handleDeleteDelayedTransaction(const DeleteDelayedTransaction::Request& request, DeleteDelayedTransaction::Response& response);
-  std::error_code handleSendDelayedTransaction(const SendDelayedTransaction::Request& request, SendDelayedTransaction::Response& response);
-  std::error_code handleGetViewKey(const GetViewKey::Request& request, GetViewKey::Response& response);
-  std::error_code handleGetStatus(const GetStatus::Request& request, GetStatus::Response& response);
-  std::error_code handleGetAddresses(const GetAddresses::Request& request, GetAddresses::Response& response);
-
-  std::error_code handleSendFusionTransaction(const SendFusionTransaction::Request& request, SendFusionTransaction::Response& response);
-  std::error_code handleEstimateFusion(const EstimateFusion::Request& request, EstimateFusion::Response& response);
+  void registerHandlers();
+  WalletService* findService(const Common::JsonValue& params) const;
+
+  std::error_code handleSave(WalletService& service, const Save::Request& request, Save::Response& response);
+  std::error_code handleExport(WalletService& service, const Export::Request& request, Export::Response& response);
+  std::error_code handleReset(WalletService& service, const Reset::Request& request, Reset::Response& response);
+  std::error_code handleCreateAddress(WalletService& service, const CreateAddress::Request& request, CreateAddress::Response& response);
+  std::error_code handleCreateAddressList(WalletService& service, const CreateAddressList::Request& request, CreateAddressList::Response& response);
+  std::error_code handleDeleteAddress(WalletService& service, const DeleteAddress::Request& request, DeleteAddress::Response& response);
+  std::error_code handleGetSpendKeys(WalletService& service, const GetSpendKeys::Request& request, GetSpendKeys::Response& response);
+  std::error_code handleGetBalance(WalletService& service, const GetBalance::Request& request, GetBalance::Response& response);
+  std::error_code handleGetBlockHashes(WalletService& service, const GetBlockHashes::Request& request, GetBlockHashes::Response& response);
+  std::error_code handleGetTransactionHashes(WalletService& service, const GetTransactionHashes::Request& request, GetTransactionHashes::Response& response);
+  std::error_code handleGetTransactions(WalletService& service, const GetTransactions::Request& request, GetTransactions::Response& response);
+  std::error_code handleGetUnconfirmedTransactionHashes(WalletService& service, const GetUnconfirmedTransactionHashes::Request& request, GetUnconfirmedTransactionHashes::Response& response);
+  std::error_code handleGetTransaction(WalletService& service, const GetTransaction::Request& request, GetTransaction::Response& response);
+  std::error_code handleSendTransaction(WalletService& service, const SendTransaction::Request& request, SendTransaction::Response& response);
+  std::error_code handleCreateDelayedTransaction(WalletService& service, const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response);
+  std::error_code handleGetDelayedTransactionHashes(WalletService& service, const GetDelayedTransactionHashes::Request& request, GetDelayedTransactionHashes::Response& response);
+  std::error_code handleDeleteDelayedTransaction(WalletService& service, const DeleteDelayedTransaction::Request& request, DeleteDelayedTransaction::Response& response);
+  std::error_code handleSendDelayedTransaction(WalletService& service, const SendDelayedTransaction::Request& request, SendDelayedTransaction::Response& response);
+  std::error_code handleGetViewKey(WalletService& service, const GetViewKey::Request& request, GetViewKey::Response& response);
+  std::error_code handleGetStatus(WalletService& service, const GetStatus::Request& request, GetStatus::Response& response);
+  std::error_code handleGetAddresses(WalletService& service, const GetAddresses::Request& request, GetAddresses::Response& response);
+
+  std::error_code handleSendFusionTransaction(WalletService& service, const SendFusionTransaction::Request& request, SendFusionTransaction::Response& response);
+  std::error_code handleEstimateFusion(WalletService& service, const EstimateFusion::Request& request, EstimateFusion::Response& response);
 };
 
 }//namespace PaymentService
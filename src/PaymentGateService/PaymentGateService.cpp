@@ -36,6 +36,7 @@
 #include "P2p/NetNode.h"
 #include <System/Context.h>
 #include "Wallet/WalletGreen.h"
+#include "Wallet/WalletSynchronizerHost.h"
 
 #ifdef ERROR
 #undef ERROR
@@ -269,6 +270,11 @@ void PaymentGateService::runRpcProxy(Logging::LoggerRef& log) {
 }
 
 void PaymentGateService::runWalletService(const CryptoNote::Currency& currency, CryptoNote::INode& node) {
+  if (!config.gateConfiguration.containerList.empty()) {
+    runWalletServices(currency, node);
+    return;
+  }
+
   PaymentService::WalletConfiguration walletConfiguration{
     config.gateConfiguration.containerFile,
     config.gateConfiguration.containerPassword
@@ -305,3 +311,58 @@ void PaymentGateService::runWalletService(const CryptoNote::Currency& currency,
     }
   }
 }
+
+void PaymentGateService::runWalletServices(const CryptoNote::Currency& currency, CryptoNote::INode& node) {
+  std::vector<PaymentService::ContainerListEntry> containers;
+  try {
+    containers = PaymentService::readContainerList(config.gateConfiguration.containerList);
+  } catch (std::exception& e) {
+    Logging::LoggerRef(logger, "run")(Logging::ERROR, Logging::BRIGHT_RED) << "Failed to read container list: " << e.what();
+    return;
+  }
+
+  // all containers scan through one synchronizer, so each block is downloaded and parsed once
+  CryptoNote::WalletSynchronizerHost syncHost(*dispatcher, currency, node, logger);
+
+  std::vector<std::unique_ptr<CryptoNote::WalletGreen>> wallets;
+  std::vector<std::unique_ptr<PaymentService::WalletService>> services;
+  std::unordered_map<std::string, PaymentService::WalletService*> servicesByName;
+
+  for (const auto& container: containers) {
+    PaymentService::WalletConfiguration walletConfiguration{container.containerFile, container.containerPassword};
+
+    wallets.emplace_back(new CryptoNote::WalletGreen(*dispatcher, currency, node, syncHost, logger));
+    services.emplace_back(new PaymentService::WalletService(currency, *dispatcher, node, *wallets.back(), *wallets.back(), walletConfiguration, logger));
+    try {
+      services.back()->init();
+    } catch (std::exception& e) {
+      Logging::LoggerRef(logger, "run")(Logging::ERROR, Logging::BRIGHT_RED) << "Failed to init walletService for container " << container.name << " reason: " << e.what();
+      return;
+    }
+
+    servicesByName.emplace(container.name, services.back().get());
+  }
+
+  if (config.gateConfiguration.printAddresses) {
+    for (const auto& container: containers) {
+      std::vector<std::string> addresses;
+      servicesByName.at(container.name)->getAddresses(addresses);
+      for (const auto& address: addresses) {
+        std::cout << container.name << " address: " << address << std::endl;
+      }
+    }
+  } else {
+    PaymentService::PaymentServiceJsonRpcServer rpcServer(*dispatcher, *stopEvent, servicesByName, logger);
+    rpcServer.start(config.gateConfiguration.bindAddress, config.gateConfiguration.bindPort);
+
+    Logging::LoggerRef(logger, "PaymentGateService")(Logging::INFO, Logging::BRIGHT_WHITE) << "JSON-RPC server stopped, stopping wallet services...";
+
+    for (const auto& container: containers) {
+      try {
+        servicesByName.at(container.name)->saveWallet();
+      } catch (std::exception& ex) {
+        Logging::LoggerRef(logger, "saveWallet")(Logging::WARNING, Logging::YELLOW) << "Couldn't save container " << container.name << ": " << ex.what();
+      }
+    }
+  }
+}
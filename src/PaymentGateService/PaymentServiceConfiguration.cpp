@@ -20,6 +20,8 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <sstream>
+#include <unordered_set>
 #include <boost/program_options.hpp>
 
 #include "Logging/ILogger.h"
@@ -48,6 +50,7 @@ void Configuration::initOptions(boost::program_options::options_description& des
       ("bind-port", po::value<uint16_t>()->default_value(14007), "payment service bind port")
       ("container-file,w", po::value<std::string>(), "container file")
       ("container-password,p", po::value<std::string>(), "container password")
+      ("container-list", po::value<std::string>(), "file with containers to serve from one process, one \"<name> <container file> <password>\" per line")
       ("generate-container,g", "generate new container file with one wallet and exit")
       ("daemon,d", "run as daemon in Unix or as service in Windows")
 #ifdef _WIN32
@@ -109,7 +112,11 @@ void Configuration::init(const boost::program_options::variables_map& options) {
     containerFile = options["container-file"].as<std::string>();
   }
 
-  if (! std::ifstream(containerFile) && options.count("generate-container") == 0) {
+  if (options.count("container-list") != 0) {
+    containerList = options["container-list"].as<std::string>();
+  }
+
+  if (containerList.empty() && ! std::ifstream(containerFile) && options.count("generate-container") == 0) {
     if (std::ifstream(containerFile + ".wallet")) {
       throw ConfigurationError(("Wallet container file not found, do you mean: " + containerFile + ".wallet?").c_str());
     } else {
@@ -130,10 +137,49 @@ void Configuration::init(const boost::program_options::variables_map& options) {
   }
 
   if (!registerService && !unregisterService) {
-    if (containerFile.empty()) {
-      throw ConfigurationError("container-file parameter are required");
+    if (containerFile.empty() && containerList.empty()) {
+      throw ConfigurationError("container-file or container-list parameter are required");
+    }
+  }
+}
+
+std::vector<ContainerListEntry> readContainerList(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw ConfigurationError(("Container list file not found: " + path).c_str());
+  }
+
+  std::vector<ContainerListEntry> containers;
+  std::unordered_set<std::string> names;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    ContainerListEntry entry;
+    if (!(stream >> entry.name) || entry.name[0] == '#') {
+      continue;
+    }
+
+    if (!(stream >> entry.containerFile)) {
+      throw ConfigurationError(("Container file is not set for \"" + entry.name + "\" in " + path).c_str());
+    }
+
+    std::getline(stream >> std::ws, entry.containerPassword);
+    if (!entry.containerPassword.empty() && entry.containerPassword.back() == '\r') {
+      entry.containerPassword.pop_back();
+    }
+
+    if (!names.insert(entry.name).second) {
+      throw ConfigurationError(("Container name \"" + entry.name + "\" is used twice in " + path).c_str());
     }
+
+    containers.emplace_back(std::move(entry));
+  }
+
+  if (containers.empty()) {
+    throw ConfigurationError(("Container list is empty: " + path).c_str());
   }
+
+  return containers;
 }
 
 } //namespace PaymentService
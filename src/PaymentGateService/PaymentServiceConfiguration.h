@@ -20,6 +20,7 @@
 #include <string>
 #include <stdexcept>
 #include <cstdint>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
@@ -30,6 +31,12 @@ public:
   ConfigurationError(const char* desc) : std::runtime_error(desc) {}
 };
 
+struct ContainerListEntry {
+  std::string name;
+  std::string containerFile;
+  std::string containerPassword;
+};
+
 struct Configuration {
   Configuration();
 
@@ -41,6 +48,7 @@ struct Configuration {
 
   std::string containerFile;
   std::string containerPassword;
+  std::string containerList;
   std::string logFile;
   std::string serverRoot;
 
@@ -54,4 +62,7 @@ struct Configuration {
   size_t logLevel;
 };
 
+//reads "<name> <container file> <password>" lines, the password is the rest of the line
+std::vector<ContainerListEntry> readContainerList(const std::string& path);
+
 } //namespace PaymentService
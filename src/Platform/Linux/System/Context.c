@@ -0,0 +1,115 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "Context.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __x86_64__
+
+void machineContextEntry(void);
+
+/*
+ * Suspended stack layout, from the saved stack pointer upwards:
+ *   +0  padding, +8 MXCSR, +12 x87 control word,
+ *   +16 r15, +24 r14, +32 r13, +40 r12, +48 rbx, +56 rbp, +64 return address.
+ */
+__asm__(
+  ".pushsection .text\n"
+  ".globl switchMachineContext\n"
+  ".hidden switchMachineContext\n"
+  ".type switchMachineContext,@function\n"
+  "switchMachineContext:\n"
+  "  pushq %rbp\n"
+  "  pushq %rbx\n"
+  "  pushq %r12\n"
+  "  pushq %r13\n"
+  "  pushq %r14\n"
+  "  pushq %r15\n"
+  "  subq $16, %rsp\n"
+  "  stmxcsr 8(%rsp)\n"
+  "  fnstcw 12(%rsp)\n"
+  "  movq %rsp, (%rdi)\n"
+  "  movq (%rsi), %rsp\n"
+  "  ldmxcsr 8(%rsp)\n"
+  "  fldcw 12(%rsp)\n"
+  "  addq $16, %rsp\n"
+  "  popq %r15\n"
+  "  popq %r14\n"
+  "  popq %r13\n"
+  "  popq %r12\n"
+  "  popq %rbx\n"
+  "  popq %rbp\n"
+  "  ret\n"
+  ".size switchMachineContext,.-switchMachineContext\n"
+  ".globl machineContextEntry\n"
+  ".hidden machineContextEntry\n"
+  ".type machineContextEntry,@function\n"
+  "machineContextEntry:\n"
+  "  movq %r12, %rdi\n"
+  "  callq *%r13\n"
+  "  ud2\n"
+  ".size machineContextEntry,.-machineContextEntry\n"
+  ".popsection\n"
+);
+
+void makeMachineContext(MachineContext* context, void* stack, size_t stackSize, void (*entry)(void*), void* argument) {
+  uintptr_t top = ((uintptr_t)stack + stackSize) & ~(uintptr_t)15;
+  uint64_t* frame = (uint64_t*)(top - 9 * sizeof(uint64_t) - 16);
+  frame[0] = 0;
+  frame[1] = ((uint64_t)0x037F << 32) | 0x1F80; /* default x87 control word and MXCSR */
+  frame[2] = 0;
+  frame[3] = 0;
+  frame[4] = (uint64_t)(uintptr_t)entry;
+  frame[5] = (uint64_t)(uintptr_t)argument;
+  frame[6] = 0;
+  frame[7] = 0;
+  frame[8] = (uint64_t)(uintptr_t)machineContextEntry;
+  context->stackPointer = frame;
+}
+
+#else
+
+static __thread MachineContext* startingContext;
+
+static void machineContextEntry(void) {
+  MachineContext* context = startingContext;
+  context->entry(context->argument);
+  abort();
+}
+
+void makeMachineContext(MachineContext* context, void* stack, size_t stackSize, void (*entry)(void*), void* argument) {
+  if (getcontext(&context->context) == -1) {
+    abort();
+  }
+
+  context->context.uc_stack.ss_sp = stack;
+  context->context.uc_stack.ss_size = stackSize;
+  context->context.uc_link = NULL;
+  context->entry = entry;
+  context->argument = argument;
+  makecontext(&context->context, machineContextEntry, 0);
+}
+
+void switchMachineContext(MachineContext* from, MachineContext* to) {
+  startingContext = to;
+  if (swapcontext(&from->context, &to->context) == -1) {
+    abort();
+  }
+}
+
+#endif
@@ -0,0 +1,55 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <stddef.h>
+
+#ifndef __x86_64__
+#include <ucontext.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __x86_64__
+/*
+ * Only the stack pointer is kept here. Callee-saved registers and the
+ * floating point control words are pushed onto the suspended stack by
+ * switchMachineContext, so a switch costs a handful of instructions and
+ * no sigprocmask system call (unlike swapcontext).
+ */
+typedef struct MachineContext {
+  void* stackPointer;
+} MachineContext;
+#else
+typedef struct MachineContext {
+  ucontext_t context;
+  void (*entry)(void*);
+  void* argument;
+} MachineContext;
+#endif
+
+/* Prepares context to run entry(argument) on the given stack when first switched to. entry must never return. */
+void makeMachineContext(MachineContext* context, void* stack, size_t stackSize, void (*entry)(void*), void* argument);
+/* Saves the current execution state into from and resumes to. */
+void switchMachineContext(MachineContext* from, MachineContext* to);
+
+#ifdef __cplusplus
+}
+#endif
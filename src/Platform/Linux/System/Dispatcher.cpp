@@ -17,15 +17,19 @@
 
 #include "Dispatcher.h"
 #include <cassert>
+#include <stdexcept>
 
+#include <linux/io_uring.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/timerfd.h>
 #include <fcntl.h>
 #include <string.h>
-#include <ucontext.h>
 #include <unistd.h>
+#include "Context.h"
 #include "ErrorMessage.h"
+#include "IoUring.h"
 
 namespace System {
 
@@ -33,7 +37,14 @@ namespace {
 
 struct ContextMakingData {
   Dispatcher* dispatcher;
-  void* ucontext;
+  MachineContext* machineContext;
+};
+
+struct CompletionContext {
+  NativeContext* context;
+  int32_t result;
+  bool completed;
+  bool interrupted;
 };
 
 class MutextGuard {
@@ -55,57 +66,80 @@ private:
 
 static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "invalid pthread mutex size");
 
-const size_t STACK_SIZE = 64 * 1024;
+const int MAX_EPOLL_EVENTS = 64;
+const unsigned IO_URING_ENTRIES = 1024;
 
 };
 
-Dispatcher::Dispatcher() {
+Dispatcher::Dispatcher(size_t contextStackSize, bool allowIoUring) {
   std::string message;
+  pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  this->contextStackSize = (contextStackSize + pageSize - 1) / pageSize * pageSize;
   epoll = ::epoll_create1(0);
   if (epoll == -1) {
     message = "epoll_create1 failed, " + lastErrorMessage();
   } else {
-    mainContext.ucontext = new ucontext_t;
-    if (getcontext(reinterpret_cast<ucontext_t*>(mainContext.ucontext)) == -1) {
-      message = "getcontext failed, " + lastErrorMessage();
+    mainContext.machineContext = new MachineContext;
+    remoteSpawnEvent = eventfd(0, O_NONBLOCK);
+    if(remoteSpawnEvent == -1) {
+      message = "eventfd failed, " + lastErrorMessage();
     } else {
-      remoteSpawnEvent = eventfd(0, O_NONBLOCK);
-      if(remoteSpawnEvent == -1) {
-        message = "eventfd failed, " + lastErrorMessage();
+      remoteSpawnEventContext.writeContext = nullptr;
+      remoteSpawnEventContext.readContext = nullptr;
+
+      epoll_event remoteSpawnEventEpollEvent;
+      remoteSpawnEventEpollEvent.events = EPOLLIN;
+      remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
+
+      if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1) {
+        message = "epoll_ctl failed, " + lastErrorMessage();
       } else {
-        remoteSpawnEventContext.writeContext = nullptr;
-        remoteSpawnEventContext.readContext = nullptr;
+        *reinterpret_cast<pthread_mutex_t*>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
+
+        mainContext.interrupted = false;
+        mainContext.group = &contextGroup;
+        mainContext.groupPrev = nullptr;
+        mainContext.groupNext = nullptr;
+        mainContext.inExecutionQueue = false;
+        contextGroup.firstContext = nullptr;
+        contextGroup.lastContext = nullptr;
+        contextGroup.firstWaiter = nullptr;
+        contextGroup.lastWaiter = nullptr;
+        currentContext = &mainContext;
+        firstResumingContext = nullptr;
+        firstReusableContext = nullptr;
+        runningContextCount = 0;
+
+        ioUring = nullptr;
+        if (allowIoUring) {
+          try {
+            ioUring = new IoUring(IO_URING_ENTRIES);
+          } catch (std::runtime_error&) {
+            // Not available on this kernel, stay on epoll readiness
+          }
 
-        epoll_event remoteSpawnEventEpollEvent;
-        remoteSpawnEventEpollEvent.events = EPOLLIN;
-        remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
+          if (ioUring != nullptr) {
+            ioUringEventContext.writeContext = nullptr;
+            ioUringEventContext.readContext = nullptr;
 
-        if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1) {
-          message = "epoll_ctl failed, " + lastErrorMessage();
-        } else {
-          *reinterpret_cast<pthread_mutex_t*>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
-
-          mainContext.interrupted = false;
-          mainContext.group = &contextGroup;
-          mainContext.groupPrev = nullptr;
-          mainContext.groupNext = nullptr;
-          mainContext.inExecutionQueue = false;
-          contextGroup.firstContext = nullptr;
-          contextGroup.lastContext = nullptr;
-          contextGroup.firstWaiter = nullptr;
-          contextGroup.lastWaiter = nullptr;
-          currentContext = &mainContext;
-          firstResumingContext = nullptr;
-          firstReusableContext = nullptr;
-          runningContextCount = 0;
-          return;
+            epoll_event ioUringEpollEvent;
+            ioUringEpollEvent.events = EPOLLIN;
+            ioUringEpollEvent.data.ptr = &ioUringEventContext;
+            if (epoll_ctl(epoll, EPOLL_CTL_ADD, ioUring->getEventFd(), &ioUringEpollEvent) == -1) {
+              delete ioUring;
+              ioUring = nullptr;
+            }
+          }
         }
 
-        auto result = close(remoteSpawnEvent);
-        assert(result == 0);
+        return;
       }
+
+      auto result = close(remoteSpawnEvent);
+      assert(result == 0);
     }
 
+    delete static_cast<MachineContext*>(mainContext.machineContext);
     auto result = close(epoll);
     assert(result == 0);
   }
@@ -123,13 +157,9 @@ Dispatcher::~Dispatcher() {
   assert(contextGroup.firstWaiter == nullptr);
   assert(firstResumingContext == nullptr);
   assert(runningContextCount == 0);
-  while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
-    firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
-  }
+  delete ioUring;
+  freeReusableContexts();
+  delete static_cast<MachineContext*>(mainContext.machineContext);
 
   while (!timers.empty()) {
     int result = ::close(timers.top());
@@ -146,13 +176,7 @@ Dispatcher::~Dispatcher() {
 }
 
 void Dispatcher::clear() {
-  while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
-    firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
-  }
+  freeReusableContexts();
 
   while (!timers.empty()) {
     int result = ::close(timers.top());
@@ -177,38 +201,20 @@ void Dispatcher::dispatch() {
       break;
     }
 
-    epoll_event event;
-    int count = epoll_wait(epoll, &event, 1, -1);
-    if (count == 1) {
-      ContextPair *contextPair = static_cast<ContextPair*>(event.data.ptr);
-      if(((event.events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-        uint64_t buf;
-        auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-        if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-        }
-
-        MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-        while (!remoteSpawningProcedures.empty()) {
-          spawn(std::move(remoteSpawningProcedures.front()));
-          remoteSpawningProcedures.pop();
-        }
-
-        continue;
-      }
-
-      if ((event.events & EPOLLOUT) != 0) {
-        context = contextPair->writeContext->context;
-        contextPair->writeContext->events = event.events;
-      } else if ((event.events & EPOLLIN) != 0) {
-        context = contextPair->readContext->context;
-        contextPair->readContext->events = event.events;
-      } else {
+    if (ioUring != nullptr) {
+      // Flush everything queued since the last wakeup in one system call
+      ioUring->submit();
+      processCompletions();
+      if (firstResumingContext != nullptr) {
         continue;
       }
+    }
 
-      assert(context != nullptr);
-      break;
+    epoll_event events[MAX_EPOLL_EVENTS];
+    int count = epoll_wait(epoll, events, MAX_EPOLL_EVENTS, -1);
+    if (count > 0) {
+      processEvents(events, count);
+      continue;
     }
 
     if (errno != EINTR) {
@@ -217,11 +223,9 @@ void Dispatcher::dispatch() {
   }
 
   if (context != currentContext) {
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    MachineContext* oldContext = static_cast<MachineContext*>(currentContext->machineContext);
     currentContext = context;
-    if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1) {
-      throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
-    }
+    switchMachineContext(oldContext, static_cast<MachineContext*>(context->machineContext));
   }
 }
 
@@ -306,55 +310,23 @@ void Dispatcher::spawn(std::function<void()>&& procedure) {
 }
 
 void Dispatcher::yield() {
+  if (ioUring != nullptr) {
+    ioUring->submit();
+    processCompletions();
+  }
+
   for(;;){
-    epoll_event events[16];
-    int count = epoll_wait(epoll, events, 16, 0);
+    epoll_event events[MAX_EPOLL_EVENTS];
+    int count = epoll_wait(epoll, events, MAX_EPOLL_EVENTS, 0);
     if (count == 0) {
       break;
     }
 
     if(count > 0) {
-      for(int i = 0; i < count; ++i) {
-        ContextPair *contextPair = static_cast<ContextPair*>(events[i].data.ptr);
-        if(((events[i].events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-          uint64_t buf;
-          auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-          if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-          }
-
-          MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-          while (!remoteSpawningProcedures.empty()) {
-            spawn(std::move(remoteSpawningProcedures.front()));
-            remoteSpawningProcedures.pop();
-          }
-
-          continue;
-        }
-
-        if ((events[i].events & EPOLLOUT) != 0) {
-            if (contextPair->writeContext != nullptr) {
-                if (contextPair->writeContext->context != nullptr) {
-                    contextPair->writeContext->context->interruptProcedure = nullptr;
-                }
-                pushContext(contextPair->writeContext->context);
-                contextPair->writeContext->events = events[i].events;
-            }
-        } else if ((events[i].events & EPOLLIN) != 0) {            
-            if (contextPair->readContext != nullptr) {
-                if (contextPair->readContext->context != nullptr) {
-                    contextPair->readContext->context->interruptProcedure = nullptr;
-                }
-                pushContext(contextPair->readContext->context);
-                contextPair->readContext->events = events[i].events;
-            }
-        } else {
-          continue;
-        }
-      }
+      processEvents(events, count);
     } else {
       if (errno != EINTR) {
-        throw std::runtime_error("Dispatcher::dispatch, epoll_wait failed, " + lastErrorMessage());
+        throw std::runtime_error("Dispatcher::yield, epoll_wait failed, " + lastErrorMessage());
       }
     }
   }
@@ -371,25 +343,25 @@ int Dispatcher::getEpoll() const {
 
 NativeContext& Dispatcher::getReusableContext() {
   if(firstReusableContext == nullptr) {
-    ucontext_t* newlyCreatedContext = new ucontext_t;
-    if (getcontext(newlyCreatedContext) == -1) { //makecontext precondition
-      throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
+    // The lowest page of every stack is a guard page, so an overflow faults instead of corrupting the neighbouring heap
+    void* stackPointer = mmap(nullptr, pageSize + contextStackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stackPointer == MAP_FAILED) {
+      throw std::runtime_error("Dispatcher::getReusableContext, mmap failed, " + lastErrorMessage());
     }
 
-    auto stackPointer = new uint8_t[STACK_SIZE];
-    newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-    newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
+    if (mprotect(stackPointer, pageSize, PROT_NONE) == -1) {
+      std::string message = lastErrorMessage();
+      munmap(stackPointer, pageSize + contextStackSize);
+      throw std::runtime_error("Dispatcher::getReusableContext, mprotect failed, " + message);
+    }
 
+    MachineContext* newlyCreatedContext = new MachineContext;
     ContextMakingData makingContextData {this, newlyCreatedContext};
-    makecontext(newlyCreatedContext, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
-
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
-    if (swapcontext(oldContext, newlyCreatedContext) == -1) {
-      throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
-    }
+    makeMachineContext(newlyCreatedContext, static_cast<uint8_t*>(stackPointer) + pageSize, contextStackSize, contextProcedureStatic, &makingContextData);
+    switchMachineContext(static_cast<MachineContext*>(currentContext->machineContext), newlyCreatedContext);
 
     assert(firstReusableContext != nullptr);
-    assert(firstReusableContext->ucontext == newlyCreatedContext);
+    assert(firstReusableContext->machineContext == newlyCreatedContext);
     firstReusableContext->stackPtr = stackPointer;
   };
 
@@ -404,6 +376,56 @@ void Dispatcher::pushReusableContext(NativeContext& context) {
   --runningContextCount;
 }
 
+bool Dispatcher::hasIoUring() const {
+  return ioUring != nullptr;
+}
+
+io_uring_sqe& Dispatcher::getSubmissionEntry() {
+  assert(ioUring != nullptr);
+  return ioUring->getSubmissionEntry();
+}
+
+int32_t Dispatcher::waitCompletion(io_uring_sqe& entry) {
+  assert(ioUring != nullptr);
+  CompletionContext completionContext;
+  completionContext.context = currentContext;
+  completionContext.completed = false;
+  completionContext.interrupted = false;
+  entry.user_data = reinterpret_cast<uint64_t>(&completionContext);
+  bool isTimeout = entry.opcode == IORING_OP_TIMEOUT;
+  if (isTimeout) {
+    // Timers must start counting now, socket operations wait for the batched submit in dispatch
+    ioUring->submit();
+  }
+
+  currentContext->interruptProcedure = [&]() {
+    completionContext.interrupted = true;
+    if (!completionContext.completed) {
+      io_uring_sqe& cancelEntry = ioUring->getSubmissionEntry();
+      cancelEntry.opcode = isTimeout ? IORING_OP_TIMEOUT_REMOVE : IORING_OP_ASYNC_CANCEL;
+      cancelEntry.fd = -1;
+      cancelEntry.addr = reinterpret_cast<uint64_t>(&completionContext);
+
+      // The kernel may still reference the suspended stack, wait until it releases the operation
+      while (!completionContext.completed) {
+        ioUring->submit(1);
+        processCompletions();
+      }
+    }
+  };
+
+  dispatch();
+  currentContext->interruptProcedure = nullptr;
+  assert(completionContext.completed);
+  assert(completionContext.context == currentContext);
+  if (completionContext.interrupted && completionContext.result != -ECANCELED) {
+    // Completed before it could be cancelled, leave the interrupt for the next operation
+    interrupt();
+  }
+
+  return completionContext.result;
+}
+
 int Dispatcher::getTimer() {
   int timer;
   if (timers.empty()) {
@@ -427,18 +449,15 @@ void Dispatcher::pushTimer(int timer) {
   timers.push(timer);
 }
 
-void Dispatcher::contextProcedure(void* ucontext) {
+void Dispatcher::contextProcedure(void* machineContext) {
   assert(firstReusableContext == nullptr);
   NativeContext context;
-  context.ucontext = ucontext;
+  context.machineContext = machineContext;
   context.interrupted = false;
   context.next = nullptr;
   context.inExecutionQueue = false;
   firstReusableContext = &context;
-  ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
-    throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
-  }
+  switchMachineContext(static_cast<MachineContext*>(context.machineContext), static_cast<MachineContext*>(currentContext->machineContext));
 
   for (;;) {
     ++runningContextCount;
@@ -489,7 +508,80 @@ void Dispatcher::contextProcedure(void* ucontext) {
 
 void Dispatcher::contextProcedureStatic(void *context) {
   ContextMakingData* makingContextData = reinterpret_cast<ContextMakingData*>(context);
-  makingContextData->dispatcher->contextProcedure(makingContextData->ucontext);
+  makingContextData->dispatcher->contextProcedure(makingContextData->machineContext);
+}
+
+void Dispatcher::processEvents(const epoll_event* events, int count) {
+  for(int i = 0; i < count; ++i) {
+    ContextPair *contextPair = static_cast<ContextPair*>(events[i].data.ptr);
+    if (contextPair == &ioUringEventContext) {
+      uint64_t buf;
+      if (read(ioUring->getEventFd(), &buf, sizeof buf) == -1 && errno != EAGAIN) {
+        throw std::runtime_error("Dispatcher::processEvents, read(ioUringEvent) failed, " + lastErrorMessage());
+      }
+
+      processCompletions();
+      continue;
+    }
+
+    if(((events[i].events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
+      uint64_t buf;
+      auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
+      if(transferred == -1) {
+        throw std::runtime_error("Dispatcher::processEvents, read(remoteSpawnEvent) failed, " + lastErrorMessage());
+      }
+
+      MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
+      while (!remoteSpawningProcedures.empty()) {
+        spawn(std::move(remoteSpawningProcedures.front()));
+        remoteSpawningProcedures.pop();
+      }
+
+      continue;
+    }
+
+    if ((events[i].events & EPOLLOUT) != 0) {
+      if (contextPair->writeContext != nullptr) {
+        if (contextPair->writeContext->context != nullptr) {
+          contextPair->writeContext->context->interruptProcedure = nullptr;
+        }
+        pushContext(contextPair->writeContext->context);
+        contextPair->writeContext->events = events[i].events;
+      }
+    } else if ((events[i].events & EPOLLIN) != 0) {
+      if (contextPair->readContext != nullptr) {
+        if (contextPair->readContext->context != nullptr) {
+          contextPair->readContext->context->interruptProcedure = nullptr;
+        }
+        pushContext(contextPair->readContext->context);
+        contextPair->readContext->events = events[i].events;
+      }
+    }
+  }
+}
+
+void Dispatcher::processCompletions() {
+  uint64_t userData;
+  int32_t result;
+  while (ioUring->getCompletion(userData, result)) {
+    // Cancellation requests carry no context
+    if (userData != 0) {
+      CompletionContext* completionContext = reinterpret_cast<CompletionContext*>(userData);
+      completionContext->result = result;
+      completionContext->completed = true;
+      pushContext(completionContext->context);
+    }
+  }
+}
+
+void Dispatcher::freeReusableContexts() {
+  while (firstReusableContext != nullptr) {
+    auto machineContext = static_cast<MachineContext*>(firstReusableContext->machineContext);
+    auto stackPtr = firstReusableContext->stackPtr;
+    firstReusableContext = firstReusableContext->next;
+    munmap(stackPtr, pageSize + contextStackSize);
+    delete machineContext;
+  }
 }
 
 }
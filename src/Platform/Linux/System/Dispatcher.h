@@ -22,12 +22,16 @@
 #include <queue>
 #include <stack>
 
+struct epoll_event;
+struct io_uring_sqe;
+
 namespace System {
 
+class IoUring;
 struct NativeContextGroup;
 
 struct NativeContext {
-  void* ucontext;
+  void* machineContext;
   void* stackPtr;
   bool interrupted;
   bool inExecutionQueue;
@@ -59,7 +63,9 @@ struct ContextPair {
 
 class Dispatcher {
 public:
-  Dispatcher();
+  static const size_t DEFAULT_CONTEXT_STACK_SIZE = 64 * 1024;
+
+  explicit Dispatcher(size_t contextStackSize = DEFAULT_CONTEXT_STACK_SIZE, bool allowIoUring = true);
   Dispatcher(const Dispatcher&) = delete;
   ~Dispatcher();
   Dispatcher& operator=(const Dispatcher&) = delete;
@@ -80,6 +86,12 @@ public:
   int getTimer();
   void pushTimer(int timer);
 
+  // io_uring completion backend, used instead of epoll readiness when the kernel supports it
+  bool hasIoUring() const;
+  io_uring_sqe& getSubmissionEntry();
+  // Suspends the current context until the entry completes, returns -ECANCELED if interrupted
+  int32_t waitCompletion(io_uring_sqe& entry);
+
 #ifdef __x86_64__
 # if __WORDSIZE == 64
   static const int SIZEOF_PTHREAD_MUTEX_T = 40;
@@ -92,10 +104,17 @@ public:
 
 private:
   void spawn(std::function<void()>&& procedure);
+  void processEvents(const epoll_event* events, int count);
+  void processCompletions();
+  void freeReusableContexts();
   int epoll;
+  size_t pageSize;
+  size_t contextStackSize;
   alignas(void*) uint8_t mutex[SIZEOF_PTHREAD_MUTEX_T];
   int remoteSpawnEvent;
   ContextPair remoteSpawnEventContext;
+  IoUring* ioUring;
+  ContextPair ioUringEventContext;
   std::queue<std::function<void()>> remoteSpawningProcedures;
   std::stack<int> timers;
 
@@ -107,7 +126,7 @@ private:
   NativeContext* firstReusableContext;
   size_t runningContextCount;
 
-  void contextProcedure(void* ucontext);
+  void contextProcedure(void* machineContext);
   static void contextProcedureStatic(void* context);
 };
 
@@ -0,0 +1,221 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "IoUring.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ErrorMessage.h"
+
+namespace System {
+
+namespace {
+
+const uint8_t REQUIRED_OPERATIONS[] = {
+  IORING_OP_RECV,
+  IORING_OP_SEND,
+  IORING_OP_ACCEPT,
+  IORING_OP_TIMEOUT,
+  IORING_OP_TIMEOUT_REMOVE,
+  IORING_OP_ASYNC_CANCEL
+};
+
+const unsigned PROBE_OPERATION_COUNT = 256;
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ring, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ring, unsigned opcode, void* arg, unsigned argCount) {
+  return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, argCount));
+}
+
+template<class T> T* ringField(void* ring, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<uint8_t*>(ring) + offset);
+}
+
+}
+
+IoUring::IoUring(unsigned entries) : ring(-1), eventFd(-1), sqRing(MAP_FAILED), cqRing(MAP_FAILED), submissionEntries(static_cast<io_uring_sqe*>(MAP_FAILED)) {
+  io_uring_params params;
+  memset(&params, 0, sizeof params);
+  std::string message;
+  ring = ioUringSetup(entries, &params);
+  if (ring == -1) {
+    message = "io_uring_setup failed, " + lastErrorMessage();
+  } else {
+    std::vector<uint8_t> probeBuffer(sizeof(io_uring_probe) + PROBE_OPERATION_COUNT * sizeof(io_uring_probe_op));
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+    if ((params.features & IORING_FEAT_FAST_POLL) == 0) {
+      // Without internal polling socket operations would be punted to worker threads
+      message = "IORING_FEAT_FAST_POLL is not supported";
+    } else if (ioUringRegister(ring, IORING_REGISTER_PROBE, probe, PROBE_OPERATION_COUNT) == -1) {
+      message = "io_uring_register(IORING_REGISTER_PROBE) failed, " + lastErrorMessage();
+    } else {
+      for (uint8_t operation : REQUIRED_OPERATIONS) {
+        if (operation > probe->last_op || (probe->ops[operation].flags & IO_URING_OP_SUPPORTED) == 0) {
+          message = "operation " + std::to_string(operation) + " is not supported";
+          break;
+        }
+      }
+    }
+
+    if (message.empty()) {
+      sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+      }
+
+      submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+      sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+      if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        cqRing = sqRing;
+      } else if (sqRing != MAP_FAILED) {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+      }
+
+      if (sqRing == MAP_FAILED || cqRing == MAP_FAILED) {
+        message = "mmap of rings failed, " + lastErrorMessage();
+      } else {
+        submissionEntries = static_cast<io_uring_sqe*>(mmap(nullptr, submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES));
+        if (submissionEntries == MAP_FAILED) {
+          message = "mmap of submission entries failed, " + lastErrorMessage();
+        } else {
+          eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+          if (eventFd == -1) {
+            message = "eventfd failed, " + lastErrorMessage();
+          } else if (ioUringRegister(ring, IORING_REGISTER_EVENTFD, &eventFd, 1) == -1) {
+            message = "io_uring_register(IORING_REGISTER_EVENTFD) failed, " + lastErrorMessage();
+          } else {
+            sqHead = ringField<unsigned>(sqRing, params.sq_off.head);
+            sqTail = ringField<unsigned>(sqRing, params.sq_off.tail);
+            sqArray = ringField<unsigned>(sqRing, params.sq_off.array);
+            sqMask = *ringField<unsigned>(sqRing, params.sq_off.ring_mask);
+            sqEntries = params.sq_entries;
+            sqLocalTail = *sqTail;
+            cqHead = ringField<unsigned>(cqRing, params.cq_off.head);
+            cqTail = ringField<unsigned>(cqRing, params.cq_off.tail);
+            cqMask = *ringField<unsigned>(cqRing, params.cq_off.ring_mask);
+            completionEntries = ringField<io_uring_cqe>(cqRing, params.cq_off.cqes);
+            return;
+          }
+        }
+      }
+    }
+
+    release();
+  }
+
+  throw std::runtime_error("IoUring::IoUring, " + message);
+}
+
+IoUring::~IoUring() {
+  release();
+}
+
+int IoUring::getEventFd() const {
+  return eventFd;
+}
+
+io_uring_sqe& IoUring::getSubmissionEntry() {
+  if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+    submit();
+    if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+      throw std::runtime_error("IoUring::getSubmissionEntry, submission queue is full");
+    }
+  }
+
+  unsigned index = sqLocalTail & sqMask;
+  io_uring_sqe& entry = submissionEntries[index];
+  memset(&entry, 0, sizeof entry);
+  sqArray[index] = index;
+  ++sqLocalTail;
+  return entry;
+}
+
+void IoUring::submit(unsigned minComplete) {
+  __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+  unsigned toSubmit = sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+  if (toSubmit == 0 && minComplete == 0) {
+    return;
+  }
+
+  unsigned flags = minComplete != 0 ? IORING_ENTER_GETEVENTS : 0;
+  while (ioUringEnter(ring, toSubmit, minComplete, flags) == -1) {
+    if (errno == EAGAIN || errno == EBUSY) {
+      // Completion queue is backed up; entries stay queued until the next submit
+      return;
+    }
+
+    if (errno != EINTR) {
+      throw std::runtime_error("IoUring::submit, io_uring_enter failed, " + lastErrorMessage());
+    }
+  }
+}
+
+bool IoUring::getCompletion(uint64_t& userData, int32_t& result) {
+  unsigned head = *cqHead;
+  if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+
+  const io_uring_cqe& entry = completionEntries[head & cqMask];
+  userData = entry.user_data;
+  result = entry.res;
+  __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void IoUring::release() {
+  if (submissionEntries != MAP_FAILED) {
+    munmap(submissionEntries, submissionEntriesSize);
+  }
+
+  if (cqRing != MAP_FAILED && cqRing != sqRing) {
+    munmap(cqRing, cqRingSize);
+  }
+
+  if (sqRing != MAP_FAILED) {
+    munmap(sqRing, sqRingSize);
+  }
+
+  if (eventFd != -1) {
+    int result = close(eventFd);
+    assert(result != -1);
+  }
+
+  if (ring != -1) {
+    int result = close(ring);
+    assert(result != -1);
+  }
+}
+
+}
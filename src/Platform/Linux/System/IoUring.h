@@ -0,0 +1,66 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace System {
+
+// Minimal io_uring submission/completion ring driven through raw system calls.
+// Completions are signalled through an eventfd so the ring can be polled from the dispatcher epoll.
+class IoUring {
+public:
+  explicit IoUring(unsigned entries);
+  IoUring(const IoUring&) = delete;
+  ~IoUring();
+  IoUring& operator=(const IoUring&) = delete;
+
+  int getEventFd() const;
+  // Returns a zeroed entry; it is passed to the kernel by the next submit()
+  io_uring_sqe& getSubmissionEntry();
+  void submit(unsigned minComplete = 0);
+  bool getCompletion(uint64_t& userData, int32_t& result);
+
+private:
+  int ring;
+  int eventFd;
+  void* sqRing;
+  size_t sqRingSize;
+  void* cqRing;
+  size_t cqRingSize;
+  io_uring_sqe* submissionEntries;
+  size_t submissionEntriesSize;
+  unsigned* sqHead;
+  unsigned* sqTail;
+  unsigned* sqArray;
+  unsigned sqMask;
+  unsigned sqEntries;
+  unsigned sqLocalTail;
+  unsigned* cqHead;
+  unsigned* cqTail;
+  unsigned cqMask;
+  io_uring_cqe* completionEntries;
+
+  void release();
+};
+
+}
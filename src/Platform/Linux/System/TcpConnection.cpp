@@ -19,6 +19,7 @@
 
 #include <arpa/inet.h>
 #include <cassert>
+#include <linux/io_uring.h>
 #include <sys/epoll.h>
 #include <unistd.h>
 
@@ -83,6 +84,29 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
   if (transferred == -1) {
     if (errno != EAGAIN  && errno != EWOULDBLOCK) {
       message = "recv failed, " + lastErrorMessage();
+    } else if (dispatcher->hasIoUring()) {
+      io_uring_sqe& entry = dispatcher->getSubmissionEntry();
+      entry.opcode = IORING_OP_RECV;
+      entry.fd = connection;
+      entry.addr = reinterpret_cast<uint64_t>(data);
+      entry.len = static_cast<uint32_t>(size);
+
+      OperationContext operationContext;
+      operationContext.interrupted = false;
+      operationContext.context = dispatcher->getCurrentContext();
+      contextPair.readContext = &operationContext;
+      int32_t result = dispatcher->waitCompletion(entry);
+      contextPair.readContext = nullptr;
+      if (result == -ECANCELED) {
+        throw InterruptedException();
+      }
+
+      if (result < 0) {
+        message = "recv failed, " + errorMessage(-result);
+      } else {
+        assert(result <= static_cast<ssize_t>(size));
+        return result;
+      }
     } else {
       epoll_event connectionEvent;
       OperationContext operationContext;
@@ -179,6 +203,30 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
   if (transferred == -1) {
     if (errno != EAGAIN  && errno != EWOULDBLOCK) {
       message = "send failed, " + lastErrorMessage();
+    } else if (dispatcher->hasIoUring()) {
+      io_uring_sqe& entry = dispatcher->getSubmissionEntry();
+      entry.opcode = IORING_OP_SEND;
+      entry.fd = connection;
+      entry.addr = reinterpret_cast<uint64_t>(data);
+      entry.len = static_cast<uint32_t>(size);
+      entry.msg_flags = MSG_NOSIGNAL;
+
+      OperationContext operationContext;
+      operationContext.interrupted = false;
+      operationContext.context = dispatcher->getCurrentContext();
+      contextPair.writeContext = &operationContext;
+      int32_t result = dispatcher->waitCompletion(entry);
+      contextPair.writeContext = nullptr;
+      if (result == -ECANCELED) {
+        throw InterruptedException();
+      }
+
+      if (result < 0) {
+        message = "send failed, " + errorMessage(-result);
+      } else {
+        assert(result <= static_cast<ssize_t>(size));
+        return result;
+      }
     } else {
       epoll_event connectionEvent;
       OperationContext operationContext;
@@ -269,6 +317,10 @@ std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
 TcpConnection::TcpConnection(Dispatcher& dispatcher, int socket) : dispatcher(&dispatcher), connection(socket) {
   contextPair.readContext = nullptr;
   contextPair.writeContext = nullptr;
+  if (dispatcher.hasIoUring()) {
+    return;
+  }
+
   epoll_event connectionEvent;
   connectionEvent.events = EPOLLONESHOT;
   connectionEvent.data.ptr = nullptr;
@@ -20,6 +20,7 @@
 #include <stdexcept>
 
 #include <fcntl.h>
+#include <linux/io_uring.h>
 #include <netdb.h>
 #include <sys/epoll.h>
 #include <unistd.h>
@@ -58,6 +59,9 @@ TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& addr, uint16
           message = "bind failed, " + lastErrorMessage();
         } else if (listen(listener, SOMAXCONN) != 0) {
           message = "listen failed, " + lastErrorMessage();
+        } else if (dispatcher.hasIoUring()) {
+          context = nullptr;
+          return;
         } else {
           epoll_event listenEvent;
           listenEvent.events = EPOLLONESHOT;
@@ -123,6 +127,33 @@ TcpConnection TcpListener::accept() {
     throw InterruptedException();
   }
 
+  if (dispatcher->hasIoUring()) {
+    sockaddr inAddr;
+    socklen_t inLen = sizeof(inAddr);
+    io_uring_sqe& entry = dispatcher->getSubmissionEntry();
+    entry.opcode = IORING_OP_ACCEPT;
+    entry.fd = listener;
+    entry.addr = reinterpret_cast<uint64_t>(&inAddr);
+    entry.addr2 = reinterpret_cast<uint64_t>(&inLen);
+    entry.accept_flags = SOCK_NONBLOCK;
+
+    OperationContext listenerContext;
+    listenerContext.interrupted = false;
+    listenerContext.context = dispatcher->getCurrentContext();
+    context = &listenerContext;
+    int32_t result = dispatcher->waitCompletion(entry);
+    context = nullptr;
+    if (result == -ECANCELED) {
+      throw InterruptedException();
+    }
+
+    if (result < 0) {
+      throw std::runtime_error("TcpListener::accept, accept failed, " + errorMessage(-result));
+    }
+
+    return TcpConnection(*dispatcher, result);
+  }
+
   ContextPair contextPair;
   OperationContext listenerContext;
   listenerContext.interrupted = false;
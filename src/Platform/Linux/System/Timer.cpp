@@ -19,6 +19,7 @@
 #include <cassert>
 #include <stdexcept>
 
+#include <linux/io_uring.h>
 #include <sys/timerfd.h>
 #include <sys/epoll.h>
 #include <unistd.h>
@@ -71,6 +72,28 @@ void Timer::sleep(std::chrono::nanoseconds duration) {
 
   if(duration.count() == 0 ) {
     dispatcher->yield();
+  } else if (dispatcher->hasIoUring()) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    __kernel_timespec timeout;
+    timeout.tv_sec = seconds.count();
+    timeout.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - seconds).count();
+
+    io_uring_sqe& entry = dispatcher->getSubmissionEntry();
+    entry.opcode = IORING_OP_TIMEOUT;
+    entry.fd = -1;
+    entry.addr = reinterpret_cast<uint64_t>(&timeout);
+    entry.len = 1;
+
+    context = &timeout;
+    int32_t result = dispatcher->waitCompletion(entry);
+    context = nullptr;
+    if (result == -ECANCELED) {
+      throw InterruptedException();
+    }
+
+    if (result != -ETIME) {
+      throw std::runtime_error("Timer::sleep, timeout failed, " + errorMessage(-result));
+    }
   } else {
     timer = dispatcher->getTimer();
 
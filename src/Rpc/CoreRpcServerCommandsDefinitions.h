@@ -26,6 +26,8 @@
 
 #include "Serialization/SerializationOverloads.h"
 #include "Serialization/BlockchainExplorerDataSerialization.h"
+#include <CryptoNoteCore/BlockScanTable.h>
+#include <CryptoNoteCore/EncodedBlocksCache.h>
 #include <CryptoNoteCore/ICoreDefinitions.h>
 
 namespace CryptoNote {
@@ -76,6 +78,18 @@ struct COMMAND_RPC_GET_BLOCKS_FAST {
     std::string status;
   };
 };
+
+// Server side of COMMAND_RPC_GET_BLOCKS_FAST, blocks are taken already encoded from EncodedBlocksCache
+struct COMMAND_RPC_GET_BLOCKS_FAST_ENCODED {
+  typedef COMMAND_RPC_GET_BLOCKS_FAST::request request;
+
+  struct response {
+    std::vector<EncodedBlocksCache::EncodedBlock> blocks;
+    uint64_t start_height;
+    uint64_t current_height;
+    std::string status;
+  };
+};
 //-----------------------------------------------
 struct COMMAND_RPC_GET_TRANSACTIONS {
   struct request {
@@ -151,6 +165,34 @@ struct COMMAND_RPC_GET_POOL_CHANGES_LITE {
   };
 };
 
+//-----------------------------------------------
+// Holds the request until the top block or the transaction pool differ from the ones the client knows, or the timeout passes
+struct COMMAND_RPC_WAIT_FOR_CHANGES {
+  struct request {
+    Crypto::Hash tailBlockId;
+    uint64_t poolVersion;
+    uint32_t timeout; // milliseconds
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(tailBlockId)
+      KV_MEMBER(poolVersion)
+      KV_MEMBER(timeout)
+    }
+  };
+
+  struct response {
+    Crypto::Hash tailBlockId;
+    uint64_t poolVersion;
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(tailBlockId)
+      KV_MEMBER(poolVersion)
+      KV_MEMBER(status)
+    }
+  };
+};
+
 //-----------------------------------------------
 struct COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES {
   
@@ -671,6 +713,30 @@ struct COMMAND_RPC_QUERY_BLOCKS_LITE {
   };
 };
 
+struct COMMAND_RPC_GET_SCAN_TABLES {
+  struct request {
+    uint32_t startIndex;
+    uint32_t count;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(startIndex)
+      KV_MEMBER(count)
+    }
+  };
+
+  struct response {
+    std::string status;
+    uint32_t topIndex;
+    std::vector<BlockScanTable> tables;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(topIndex)
+      KV_MEMBER(tables)
+    }
+  };
+};
+
 struct COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES {
   struct request {
     std::vector<Crypto::Hash> blockHashes;
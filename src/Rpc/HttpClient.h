@@ -55,8 +55,8 @@ private:
   std::unique_ptr<System::TcpStreambuf> m_streamBuf;
 };
 
-template <typename Request, typename Response>
-void invokeJsonCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
+template <typename Client, typename Request, typename Response>
+void invokeJsonCommand(Client& client, const std::string& url, const Request& req, Response& res) {
   HttpRequest hreq;
   HttpResponse hres;
 
@@ -73,8 +73,8 @@ void invokeJsonCommand(HttpClient& client, const std::string& url, const Request
   }
 }
 
-template <typename Request, typename Response>
-void invokeBinaryCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
+template <typename Client, typename Request, typename Response>
+void invokeBinaryCommand(Client& client, const std::string& url, const Request& req, Response& res) {
   HttpRequest hreq;
   HttpResponse hres;
 
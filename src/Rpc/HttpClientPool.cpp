@@ -0,0 +1,259 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "HttpClientPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <HTTP/HttpParser.h>
+#include <System/InterruptedException.h>
+#include <System/Ipv4Address.h>
+#include <System/Ipv4Resolver.h>
+#include <System/TcpConnection.h>
+#include <System/TcpConnector.h>
+#include <System/TcpStream.h>
+
+#include "HttpClient.h"
+
+namespace CryptoNote {
+
+namespace {
+
+void pulse(System::Event& event) {
+  event.set();
+  event.clear();
+}
+
+bool isConnectionClosedByServer(const HttpResponse& response) {
+  auto it = response.getHeaders().find("Connection");
+  return it != response.getHeaders().end() && (it->second == "close" || it->second == "Close");
+}
+
+}
+
+struct HttpClientPool::Connection {
+  explicit Connection(System::Dispatcher& dispatcher) : changed(dispatcher) {
+  }
+
+  System::TcpConnection connection;
+  std::unique_ptr<System::TcpStreambuf> streamBuf;
+  bool connected = false;
+  // set after an error, the connection is closed when the last request using it leaves
+  bool broken = false;
+  bool writing = false;
+  size_t users = 0;
+  // requests written or waiting to be written, responses arrive in this order
+  std::deque<uint64_t> queue;
+  uint64_t nextTicket = 0;
+  uint64_t generation = 0;
+  // pulsed when the writer or the head of the queue changes
+  System::Event changed;
+};
+
+HttpClientPool::HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t connectionCount, size_t pipelineDepth) :
+  m_dispatcher(dispatcher), m_address(address), m_port(port), m_maxConnectionCount(std::max<size_t>(connectionCount, 1)),
+  m_pipelineDepth(std::max<size_t>(pipelineDepth, 1)), m_connectionReleased(dispatcher), m_connected(true) {
+}
+
+HttpClientPool::~HttpClientPool() {
+  for (auto& connection : m_connections) {
+    assert(connection->users == 0);
+    if (connection->connected) {
+      connection->broken = true;
+      ++connection->users;
+      release(*connection);
+    }
+  }
+}
+
+void HttpClientPool::request(const HttpRequest& req, HttpResponse& res) {
+  Connection& connection = selectConnection();
+  uint64_t ticket = connection.nextTicket++;
+  uint64_t generation = connection.generation;
+  connection.queue.push_back(ticket);
+  ++connection.users;
+
+  // only a request that has started writing can leave a partial request or an unread response on the socket
+  bool startedWriting = false;
+  try {
+    if (!connection.connected) {
+      connect(connection);
+    }
+
+    while (connection.writing && connection.generation == generation) {
+      connection.changed.wait();
+    }
+
+    if (connection.generation != generation) {
+      throw std::runtime_error("Connection to " + m_address + " failed");
+    }
+
+    connection.writing = true;
+    startedWriting = true;
+    {
+      std::ostream stream(connection.streamBuf.get());
+      stream << req;
+      stream.flush();
+      if (!stream) {
+        throw std::runtime_error("Failed to send request to " + m_address);
+      }
+    }
+
+    connection.writing = false;
+    pulse(connection.changed);
+
+    while (connection.generation == generation && connection.queue.front() != ticket) {
+      connection.changed.wait();
+    }
+
+    if (connection.generation != generation) {
+      throw std::runtime_error("Connection to " + m_address + " failed");
+    }
+
+    std::istream stream(connection.streamBuf.get());
+    HttpParser parser;
+    parser.receiveResponse(stream, res);
+
+    connection.queue.pop_front();
+    if (isConnectionClosedByServer(res)) {
+      connection.broken = true;
+      ++connection.generation;
+      connection.queue.clear();
+    }
+
+    m_connected = true;
+  } catch (const ConnectException&) {
+    m_connected = false;
+    fail(connection);
+    release(connection);
+    throw;
+  } catch (const System::InterruptedException&) {
+    // a request that wasn't sent yet can leave without breaking the order of responses,
+    // even if another request is writing to the connection at the moment
+    if (startedWriting) {
+      fail(connection);
+    } else {
+      auto it = std::find(connection.queue.begin(), connection.queue.end(), ticket);
+      if (it != connection.queue.end()) {
+        connection.queue.erase(it);
+      }
+    }
+
+    release(connection);
+    throw;
+  } catch (const std::exception&) {
+    m_connected = false;
+    fail(connection);
+    release(connection);
+    throw;
+  }
+
+  release(connection);
+}
+
+bool HttpClientPool::isConnected() const {
+  return m_connected;
+}
+
+size_t HttpClientPool::getConnectionCount() const {
+  return m_connections.size();
+}
+
+HttpClientPool::Connection& HttpClientPool::selectConnection() {
+  for (;;) {
+    Connection* idle = nullptr;
+    for (auto& connection : m_connections) {
+      if (connection->users == 0 && (idle == nullptr || connection->connected)) {
+        idle = connection.get();
+      }
+    }
+
+    if (idle != nullptr) {
+      return *idle;
+    }
+
+    if (m_connections.size() < m_maxConnectionCount) {
+      m_connections.emplace_back(new Connection(m_dispatcher));
+      return *m_connections.back();
+    }
+
+    if (m_pipelineDepth > 1) {
+      Connection* leastBusy = nullptr;
+      for (auto& connection : m_connections) {
+        if (connection->connected && !connection->broken && connection->queue.size() < m_pipelineDepth &&
+            (leastBusy == nullptr || connection->queue.size() < leastBusy->queue.size())) {
+          leastBusy = connection.get();
+        }
+      }
+
+      if (leastBusy != nullptr) {
+        return *leastBusy;
+      }
+    }
+
+    m_connectionReleased.wait();
+  }
+}
+
+void HttpClientPool::connect(Connection& connection) {
+  try {
+    auto ipAddr = System::Ipv4Resolver(m_dispatcher).resolve(m_address);
+    connection.connection = System::TcpConnector(m_dispatcher).connect(ipAddr, m_port);
+    connection.streamBuf.reset(new System::TcpStreambuf(connection.connection));
+    connection.connected = true;
+  } catch (const System::InterruptedException&) {
+    throw;
+  } catch (const std::exception& e) {
+    throw ConnectException(e.what());
+  }
+}
+
+// Makes requests queued on the connection fail, the socket is closed by the last request leaving it
+void HttpClientPool::fail(Connection& connection) {
+  connection.broken = true;
+  connection.writing = false;
+  ++connection.generation;
+  connection.queue.clear();
+  pulse(connection.changed);
+}
+
+void HttpClientPool::release(Connection& connection) {
+  assert(connection.users > 0);
+  --connection.users;
+  pulse(connection.changed);
+
+  if (connection.broken && connection.users == 0) {
+    connection.streamBuf.reset();
+    if (connection.connected) {
+      try {
+        connection.connection.write(nullptr, 0); //Socket shutdown.
+      } catch (std::exception&) {
+        //Ignoring possible exception.
+      }
+
+      connection.connection = System::TcpConnection();
+    }
+
+    connection.connected = false;
+    connection.broken = false;
+  }
+
+  pulse(m_connectionReleased);
+}
+
+}
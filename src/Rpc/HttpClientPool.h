@@ -0,0 +1,71 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <HTTP/HttpRequest.h>
+#include <HTTP/HttpResponse.h>
+#include <System/Event.h>
+
+namespace System {
+class Dispatcher;
+}
+
+namespace CryptoNote {
+
+// HTTP client keeping several persistent connections to one server, so concurrent requests don't wait for each other.
+// With pipeline depth above one, busy connections also accept requests written before the previous responses arrive.
+// Requests are made from dispatcher contexts, like HttpClient::request.
+class HttpClientPool {
+public:
+  HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t connectionCount, size_t pipelineDepth = 1);
+  HttpClientPool(const HttpClientPool&) = delete;
+  HttpClientPool& operator=(const HttpClientPool&) = delete;
+  ~HttpClientPool();
+
+  void request(const HttpRequest& req, HttpResponse& res);
+
+  // Whether the last finished request reached the server
+  bool isConnected() const;
+  size_t getConnectionCount() const;
+
+private:
+  struct Connection;
+
+  Connection& selectConnection();
+  void connect(Connection& connection);
+  void fail(Connection& connection);
+  void release(Connection& connection);
+
+  System::Dispatcher& m_dispatcher;
+  const std::string m_address;
+  const uint16_t m_port;
+  const size_t m_maxConnectionCount;
+  const size_t m_pipelineDepth;
+
+  std::vector<std::unique_ptr<Connection>> m_connections;
+  // pulsed when a connection may have become available
+  System::Event m_connectionReleased;
+  bool m_connected;
+};
+
+}
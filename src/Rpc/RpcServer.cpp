@@ -22,6 +22,7 @@
 
 // CryptoNote
 #include "Common/StringTools.h"
+#include "CryptoNoteCore/CachedTransaction.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Core.h"
 #include "CryptoNoteCore/Miner.h"
@@ -30,6 +31,8 @@
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 
 #include "P2p/NetNode.h"
+#include "System/InterruptedException.h"
+#include "System/Timer.h"
 
 #include "CoreRpcServerErrorCodes.h"
 #include "JsonRpc.h"
@@ -43,8 +46,8 @@ using namespace Common;
 
 namespace CryptoNote {
 
-static inline void serialize(COMMAND_RPC_GET_BLOCKS_FAST::response& response, ISerializer &s) {
-  KV_MEMBER(response.blocks)
+static inline void serialize(COMMAND_RPC_GET_BLOCKS_FAST_ENCODED::response& response, ISerializer &s) {
+  serializeEncodedBlocks(response.blocks, "blocks", s);
   KV_MEMBER(response.start_height)
   KV_MEMBER(response.current_height)
   KV_MEMBER(response.status)
@@ -69,6 +72,9 @@ void serialize(BlockShortInfo& blockShortInfo, ISerializer& s) {
 
 namespace {
 
+const size_t ENCODED_BLOCKS_CACHE_SIZE = 64 * 1024 * 1024;
+const uint32_t WAIT_FOR_CHANGES_MAX_TIMEOUT = 60000;
+
 template <typename Command>
 RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
   return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
@@ -109,9 +115,10 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
 std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
 
   // binary handlers
-  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false } },
+  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST_ENCODED>(&RpcServer::on_get_blocks), false } },
   { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false } },
   { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false } },
+  { "/getscantables.bin", { binMethod<COMMAND_RPC_GET_SCAN_TABLES>(&RpcServer::onGetScanTables), false } },
   { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false } },
   { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false } },
   { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
@@ -120,6 +127,7 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/get_blocks_hashes_by_timestamps.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS>(&RpcServer::onGetBlocksHashesByTimestamps), false } },
   { "/get_transaction_details_by_hashes.bin", { binMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES>(&RpcServer::onGetTransactionDetailsByHashes), false } },
   { "/get_transaction_hashes_by_payment_id.bin", { binMethod<COMMAND_RPC_GET_TRANSACTION_HASHES_BY_PAYMENT_ID>(&RpcServer::onGetTransactionHashesByPaymentId), false } },
+  { "/wait_for_changes.bin", { binMethod<COMMAND_RPC_WAIT_FOR_CHANGES>(&RpcServer::onWaitForChanges), true } },
 
   // json handlers
   { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true } },
@@ -130,11 +138,41 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/get_generated_coins", { jsonMethod<COMMAND_RPC_GET_ISSUED_COINS>(&RpcServer::on_get_issued), true } },
 
   // json rpc
-  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
+  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } },
+
+  // prometheus
+  { "/metrics", { std::bind(&RpcServer::on_get_metrics, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
 };
 
 RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol) :
-  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol) {
+  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol),
+  m_encodedBlocks(ENCODED_BLOCKS_CACHE_SIZE, [] (RawBlock& block, ISerializer& s) { serialize(block, s); }),
+  m_blockchainMessages(dispatcher), m_poolVersion(Crypto::rand<uint64_t>()), m_changesEvent(dispatcher), m_messagesContext(dispatcher) {
+  m_core.addMessageQueue(m_blockchainMessages);
+  m_messagesContext.spawn(std::bind(&RpcServer::processBlockchainMessages, this));
+}
+
+RpcServer::~RpcServer() {
+  m_core.removeMessageQueue(m_blockchainMessages);
+  m_blockchainMessages.stop();
+  m_messagesContext.interrupt();
+  m_messagesContext.wait();
+}
+
+void RpcServer::processBlockchainMessages() {
+  try {
+    for (;;) {
+      auto type = m_blockchainMessages.front().getType();
+      if (type == BlockchainMessage::Type::AddTransaction || type == BlockchainMessage::Type::DeleteTransaction) {
+        ++m_poolVersion;
+      }
+
+      m_blockchainMessages.pop();
+      m_changesEvent.set();
+      m_changesEvent.clear();
+    }
+  } catch (System::InterruptedException&) {
+  }
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -157,6 +195,7 @@ void RpcServer::processRequest(const HttpRequest& request, HttpResponse& respons
     return;
   }
 
+  Common::MetricTimer timer(getRequestHistogram(it->first));
   it->second.handler(this, request, response);
 }
 
@@ -199,6 +238,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
     }
 
+    Common::MetricTimer timer(getJsonRpcHistogram(it->first));
     it->second.handler(this, jsonRequest, jsonResponse);
 
   } catch (const JsonRpcError& err) {
@@ -216,11 +256,48 @@ bool RpcServer::isCoreReady() {
   return m_core.getCurrency().isTestnet() || m_p2p.get_payload_object().isSynchronized();
 }
 
+Common::MetricHistogram& RpcServer::getRequestHistogram(const std::string& path) {
+  auto it = m_requestHistograms.find(path);
+  if (it == m_requestHistograms.end()) {
+    auto& histogram = Common::metrics().histogram("rpc_request_duration_seconds", "Time spent handling RPC requests", {{"path", path}});
+    it = m_requestHistograms.emplace(path, &histogram).first;
+  }
+
+  return *it->second;
+}
+
+Common::MetricHistogram& RpcServer::getJsonRpcHistogram(const std::string& method) {
+  auto it = m_jsonRpcHistograms.find(method);
+  if (it == m_jsonRpcHistograms.end()) {
+    auto& histogram = Common::metrics().histogram("rpc_json_rpc_duration_seconds", "Time spent handling JSON-RPC methods", {{"method", method}});
+    it = m_jsonRpcHistograms.emplace(method, &histogram).first;
+  }
+
+  return *it->second;
+}
+
+bool RpcServer::on_get_metrics(const HttpRequest& request, HttpResponse& response) {
+  auto& registry = Common::metrics();
+  uint64_t connectionsCount = m_p2p.get_connections_count();
+  uint64_t outgoingConnectionsCount = m_p2p.get_outgoing_connections_count();
+
+  registry.gauge("core_height", "Number of blocks in the main chain").set(m_core.getTopBlockIndex() + 1);
+  registry.gauge("core_tx_pool_size", "Number of transactions in the pool").set(m_core.getPoolTransactionCount());
+  registry.gauge("core_alternative_blocks", "Number of blocks in alternative chains").set(m_core.getAlternativeBlockCount());
+  registry.gauge("p2p_connections", "Open peer connections", {{"direction", "outgoing"}}).set(outgoingConnectionsCount);
+  registry.gauge("p2p_connections", "Open peer connections", {{"direction", "incoming"}}).set(connectionsCount - outgoingConnectionsCount);
+  registry.gauge("p2p_observed_height", "Highest chain height reported by peers").set(m_protocol.getObservedHeight());
+
+  response.addHeader("Content-Type", "text/plain; version=0.0.4");
+  response.setBody(registry.exportPrometheus());
+  return true;
+}
+
 //
 // Binary handlers
 //
 
-bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res) {
+bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST_ENCODED::request& req, COMMAND_RPC_GET_BLOCKS_FAST_ENCODED::response& res) {
   // TODO code duplication see InProcessNode::doGetNewBlocks()
   if (req.block_ids.empty()) {
     res.status = "Failed";
@@ -240,7 +317,7 @@ bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, C
   res.start_height = startBlockIndex;
 
   std::vector<Crypto::Hash> missedHashes;
-  m_core.getBlocks(supplement, res.blocks, missedHashes);
+  m_encodedBlocks.getBlocks(m_core, supplement, res.blocks, missedHashes);
   assert(missedHashes.empty());
 
   res.status = CORE_RPC_STATUS_OK;
@@ -281,6 +358,20 @@ bool RpcServer::on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::reques
   return true;
 }
 
+bool RpcServer::onGetScanTables(const COMMAND_RPC_GET_SCAN_TABLES::request& req, COMMAND_RPC_GET_SCAN_TABLES::response& res) {
+  try {
+    uint32_t count = std::min(req.count, static_cast<uint32_t>(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT));
+    res.topIndex = m_core.getTopBlockIndex();
+    res.tables = m_core.getBlockScanTables(req.startIndex, count);
+  } catch (std::exception& e) {
+    res.status = "Error: " + std::string(e.what());
+    return false;
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
 bool RpcServer::on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response& res) {
   std::vector<uint32_t> outputIndexes;
   if (!m_core.getTransactionGlobalIndexes(req.txid, outputIndexes)) {
@@ -348,6 +439,31 @@ bool RpcServer::onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::re
   return true;
 }
 
+bool RpcServer::onWaitForChanges(const COMMAND_RPC_WAIT_FOR_CHANGES::request& req, COMMAND_RPC_WAIT_FOR_CHANGES::response& rsp) {
+  bool timedOut = false;
+  System::Timer timeoutTimer(m_dispatcher);
+  System::ContextGroup timeoutContext(m_dispatcher);
+  timeoutContext.spawn([&] {
+    try {
+      timeoutTimer.sleep(std::chrono::milliseconds(std::min(req.timeout, WAIT_FOR_CHANGES_MAX_TIMEOUT)));
+      timedOut = true;
+      m_changesEvent.set();
+      m_changesEvent.clear();
+    } catch (System::InterruptedException&) {
+    }
+  });
+
+  // waits in the connection context, so stopping the server interrupts the request
+  while (!timedOut && m_core.getTopBlockHash() == req.tailBlockId && m_poolVersion == req.poolVersion) {
+    m_changesEvent.wait();
+  }
+
+  rsp.tailBlockId = m_core.getTopBlockHash();
+  rsp.poolVersion = m_poolVersion;
+  rsp.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
 bool RpcServer::onGetBlocksDetailsByHashes(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request& req, COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response& rsp) {
   try {
     std::vector<BlockDetails> blockDetails;
@@ -643,18 +759,23 @@ bool RpcServer::f_on_block_json(const F_COMMAND_RPC_GET_BLOCK_DETAILS::request&
   res.block.totalFeeAmount = 0;
 
   for (const BinaryArray& ba : txs) {
-    Transaction tx;
-    if (!fromBinaryArray(tx, ba)) {
+    // only amounts are needed, so the signatures are left in the blob
+    uint64_t amount_in = 0;
+    uint64_t amount_out = 0;
+    try {
+      CachedTransaction tx(ba);
+      amount_in = getInputAmount(tx.getTransactionPrefix());
+      amount_out = getOutputAmount(tx.getTransactionPrefix());
+    } catch (std::exception&) {
       throw std::runtime_error("Couldn't deserialize transaction");
     }
+
     f_transaction_short_response transaction_short;
-    uint64_t amount_in = getInputAmount(tx);
-    uint64_t amount_out = getOutputAmount(tx);
 
-    transaction_short.hash = Common::podToHex(getObjectHash(tx));
+    transaction_short.hash = Common::podToHex(getBinaryArrayHash(ba));
     transaction_short.fee = amount_in - amount_out;
     transaction_short.amount_out = amount_out;
-    transaction_short.size = getObjectBinarySize(tx);
+    transaction_short.size = ba.size();
     res.block.transactions.push_back(transaction_short);
 
     res.block.totalFeeAmount += transaction_short.fee;
@@ -680,7 +801,9 @@ bool RpcServer::f_on_transaction_json(const F_COMMAND_RPC_GET_TRANSACTION_DETAIL
   std::vector<BinaryArray> txs;
   m_core.getTransactions(tx_ids, txs, missed_txs);
 
+  size_t transactionSize = 0;
   if (1 == txs.size()) {
+    transactionSize = txs.front().size();
     Transaction transaction;
     if (!fromBinaryArray(transaction, txs.front())) {
       throw std::runtime_error("Couldn't deserialize transaction");
@@ -718,12 +841,12 @@ bool RpcServer::f_on_transaction_json(const F_COMMAND_RPC_GET_TRANSACTION_DETAIL
   uint64_t amount_in = getInputAmount(res.tx);
   uint64_t amount_out = getOutputAmount(res.tx);
 
-  res.txDetails.hash = Common::podToHex(getObjectHash(res.tx));
+  res.txDetails.hash = Common::podToHex(hash);
   res.txDetails.fee = amount_in - amount_out;
   if (amount_in == 0)
     res.txDetails.fee = 0;
   res.txDetails.amount_out = amount_out;
-  res.txDetails.size = getObjectBinarySize(res.tx);
+  res.txDetails.size = transactionSize;
 
   uint64_t mixin;
   if (!f_getMixin(res.tx, mixin)) {
@@ -22,6 +22,9 @@
 
 #include <Logging/LoggerRef.h>
 #include "Common/Math.h"
+#include "Common/Metrics.h"
+#include "CryptoNoteCore/BlockchainMessages.h"
+#include "CryptoNoteCore/MessageQueue.h"
 #include "CoreRpcServerCommandsDefinitions.h"
 
 namespace CryptoNote {
@@ -33,6 +36,7 @@ struct ICryptoNoteProtocolHandler;
 class RpcServer : public HttpServer {
 public:
   RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol);
+  ~RpcServer();
 
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
 
@@ -50,11 +54,17 @@ private:
   virtual void processRequest(const HttpRequest& request, HttpResponse& response) override;
   bool processJsonRpcRequest(const HttpRequest& request, HttpResponse& response);
   bool isCoreReady();
+  Common::MetricHistogram& getRequestHistogram(const std::string& path);
+  Common::MetricHistogram& getJsonRpcHistogram(const std::string& method);
+  void processBlockchainMessages();
+
+  bool on_get_metrics(const HttpRequest& request, HttpResponse& response);
 
   // binary handlers
-  bool on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res);
+  bool on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST_ENCODED::request& req, COMMAND_RPC_GET_BLOCKS_FAST_ENCODED::response& res);
   bool on_query_blocks(const COMMAND_RPC_QUERY_BLOCKS::request& req, COMMAND_RPC_QUERY_BLOCKS::response& res);
   bool on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::request& req, COMMAND_RPC_QUERY_BLOCKS_LITE::response& res);
+  bool onGetScanTables(const COMMAND_RPC_GET_SCAN_TABLES::request& req, COMMAND_RPC_GET_SCAN_TABLES::response& res);
   bool on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response& res);
   bool on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res);
   bool onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& req, COMMAND_RPC_GET_POOL_CHANGES::response& rsp);
@@ -63,6 +73,7 @@ private:
   bool onGetBlocksHashesByTimestamps(const COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS::request& req, COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS::response& rsp);
   bool onGetTransactionDetailsByHashes(const COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES::request& req, COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES::response& rsp);
   bool onGetTransactionHashesByPaymentId(const COMMAND_RPC_GET_TRANSACTION_HASHES_BY_PAYMENT_ID::request& req, COMMAND_RPC_GET_TRANSACTION_HASHES_BY_PAYMENT_ID::response& rsp);
+  bool onWaitForChanges(const COMMAND_RPC_WAIT_FOR_CHANGES::request& req, COMMAND_RPC_WAIT_FOR_CHANGES::response& rsp);
 
   // json handlers
   bool on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RPC_GET_INFO::response& res);
@@ -95,6 +106,16 @@ private:
   Core& m_core;
   NodeServer& m_p2p;
   ICryptoNoteProtocolHandler& m_protocol;
+  EncodedBlocksCache m_encodedBlocks;
+  std::unordered_map<std::string, Common::MetricHistogram*> m_requestHistograms;
+  std::unordered_map<std::string, Common::MetricHistogram*> m_jsonRpcHistograms;
+
+  MessageQueue<BlockchainMessage> m_blockchainMessages;
+  // incremented on every pool change, starts from a random value so versions from a restarted daemon don't match
+  uint64_t m_poolVersion;
+  // set and cleared on every blockchain message to wake up waiting long-poll requests
+  System::Event m_changesEvent;
+  System::ContextGroup m_messagesContext;
 };
 
 }
@@ -0,0 +1,120 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BinaryMemoryInputSerializer.h"
+
+#include <cassert>
+#include "CryptoNoteConfig.h"
+
+namespace CryptoNote {
+
+ISerializer::SerializerType BinaryMemoryInputSerializer::type() const {
+  return ISerializer::INPUT;
+}
+
+bool BinaryMemoryInputSerializer::beginObject(Common::StringView name) {
+  return true;
+}
+
+void BinaryMemoryInputSerializer::endObject() {
+}
+
+bool BinaryMemoryInputSerializer::beginArray(size_t& size, Common::StringView name) {
+  uint64_t declaredSize = readVarint<uint64_t>();
+  checkDeclaredSize(declaredSize);
+  size = static_cast<size_t>(declaredSize);
+  return true;
+}
+
+void BinaryMemoryInputSerializer::endArray() {
+}
+
+bool BinaryMemoryInputSerializer::operator()(uint8_t& value, Common::StringView name) {
+  value = readVarint<uint8_t>();
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(uint16_t& value, Common::StringView name) {
+  value = readVarint<uint16_t>();
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(int16_t& value, Common::StringView name) {
+  value = static_cast<int16_t>(readVarint<uint16_t>());
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(uint32_t& value, Common::StringView name) {
+  value = readVarint<uint32_t>();
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(int32_t& value, Common::StringView name) {
+  value = static_cast<int32_t>(readVarint<uint32_t>());
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(int64_t& value, Common::StringView name) {
+  value = static_cast<int64_t>(readVarint<uint64_t>());
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(uint64_t& value, Common::StringView name) {
+  value = readVarint<uint64_t>();
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(bool& value, Common::StringView name) {
+  uint8_t byte;
+  checkedRead(&byte, sizeof(byte));
+  value = byte != 0;
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::operator()(std::string& value, Common::StringView name) {
+  uint64_t size = readVarint<uint64_t>();
+  checkDeclaredSize(size);
+
+  /* Oversized merge mining tags are skipped, as BinaryInputStreamSerializer does */
+  if (size > CryptoNote::parameters::MAX_TX_EXTRA_SIZE && std::string(name.getData(), name.getSize()) == "mm_tag") {
+    current += size;
+    value.clear();
+    return true;
+  }
+
+  value.assign(reinterpret_cast<const char*>(current), static_cast<size_t>(size));
+  current += size;
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::binary(void* value, size_t size, Common::StringView name) {
+  checkedRead(value, size);
+  return true;
+}
+
+bool BinaryMemoryInputSerializer::binary(std::string& value, Common::StringView name) {
+  return (*this)(value, name);
+}
+
+bool BinaryMemoryInputSerializer::operator()(double& value, Common::StringView name) {
+  assert(false); //the method is not supported for this type of serialization
+  throw std::runtime_error("double serialization is not supported in BinaryMemoryInputSerializer");
+  return false;
+}
+
+}
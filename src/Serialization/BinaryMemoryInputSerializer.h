@@ -0,0 +1,123 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "ISerializer.h"
+#include "SerializationOverloads.h"
+
+namespace CryptoNote {
+
+// Wire-compatible counterpart of BinaryInputStreamSerializer for input that is already in memory.
+// Reads straight from the buffer instead of going through IInputStream::readSome for every varint byte,
+// and copies fixed-size blobs (keys, hashes, signatures) with a single memcpy.
+// String and array sizes are checked against the remaining input before anything is allocated:
+// every element takes at least one byte, so a larger size can only be malformed data.
+class BinaryMemoryInputSerializer final : public ISerializer {
+public:
+  BinaryMemoryInputSerializer(const void* data, size_t size) :
+    begin(static_cast<const uint8_t*>(data)), current(begin), end(begin + size) {}
+  virtual ~BinaryMemoryInputSerializer() {}
+
+  virtual ISerializer::SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+  size_t position() const { return current - begin; }
+  size_t remaining() const { return end - current; }
+  bool endOfStream() const { return current == end; }
+
+private:
+  void checkAvailable(size_t size) const {
+    if (size > static_cast<size_t>(end - current)) {
+      throw std::runtime_error("BinaryMemoryInputSerializer: unexpected end of data");
+    }
+  }
+
+  void checkDeclaredSize(uint64_t size) const {
+    if (size > static_cast<uint64_t>(end - current)) {
+      throw std::runtime_error("BinaryMemoryInputSerializer: declared size exceeds remaining data");
+    }
+  }
+
+  void checkedRead(void* buf, size_t size) {
+    checkAvailable(size);
+    memcpy(buf, current, size);
+    current += size;
+  }
+
+  // Same encoding and the same overflow / non-canonical checks as Common::readVarint
+  template<typename T>
+  T readVarint() {
+    if (current != end && *current < 0x80) {
+      return *current++;
+    }
+
+    T temp = 0;
+    for (uint8_t shift = 0;; shift += 7) {
+      checkAvailable(1);
+      uint8_t piece = *current++;
+      if (shift >= sizeof(temp) * 8 - 7 && piece >= 1 << (sizeof(temp) * 8 - shift)) {
+        throw std::runtime_error("readVarint, value overflow");
+      }
+
+      temp |= static_cast<T>(static_cast<uint64_t>(piece & 0x7f) << shift);
+      if ((piece & 0x80) == 0) {
+        if (piece == 0 && shift != 0) {
+          throw std::runtime_error("readVarint, invalid value representation");
+        }
+
+        break;
+      }
+    }
+
+    return temp;
+  }
+
+  const uint8_t* const begin;
+  const uint8_t* current;
+  const uint8_t* const end;
+};
+
+}
@@ -17,6 +17,7 @@
 
 #include <CryptoNote.h>
 #include "BinaryInputStreamSerializer.h"
+#include "BinaryMemoryInputSerializer.h"
 #include "BinaryOutputStreamSerializer.h"
 #include "Common/MemoryInputStream.h"
 #include "Common/StdInputStream.h"
@@ -38,8 +39,7 @@ BinaryArray storeToBinary(const T& obj) {
 
 template <typename T>
 void loadFromBinary(T& obj, const BinaryArray& blob) {
-  Common::MemoryInputStream stream(blob.data(), blob.size());
-  BinaryInputStreamSerializer ba(stream);
+  BinaryMemoryInputSerializer ba(blob.data(), blob.size());
   serialize(obj, ba);
 }
 
@@ -0,0 +1,106 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BinarySizeSerializer.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace CryptoNote {
+
+ISerializer::SerializerType BinarySizeSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+bool BinarySizeSerializer::beginObject(Common::StringView name) {
+  return true;
+}
+
+void BinarySizeSerializer::endObject() {
+}
+
+bool BinarySizeSerializer::beginArray(size_t& size, Common::StringView name) {
+  countVarint(size);
+  return true;
+}
+
+void BinarySizeSerializer::endArray() {
+}
+
+bool BinarySizeSerializer::operator()(uint8_t& value, Common::StringView name) {
+  countVarint(value);
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(uint16_t& value, Common::StringView name) {
+  countVarint(value);
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(int16_t& value, Common::StringView name) {
+  countVarint(static_cast<uint16_t>(value));
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(uint32_t& value, Common::StringView name) {
+  countVarint(value);
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(int32_t& value, Common::StringView name) {
+  countVarint(static_cast<uint32_t>(value));
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(int64_t& value, Common::StringView name) {
+  countVarint(static_cast<uint64_t>(value));
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(uint64_t& value, Common::StringView name) {
+  countVarint(value);
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(bool& value, Common::StringView name) {
+  totalSize += 1;
+  return true;
+}
+
+bool BinarySizeSerializer::operator()(std::string& value, Common::StringView name) {
+  countVarint(value.size());
+  totalSize += value.size();
+  return true;
+}
+
+bool BinarySizeSerializer::binary(void* value, size_t size, Common::StringView name) {
+  totalSize += size;
+  return true;
+}
+
+bool BinarySizeSerializer::binary(std::string& value, Common::StringView name) {
+  return (*this)(value, name);
+}
+
+bool BinarySizeSerializer::operator()(double& value, Common::StringView name) {
+  assert(false); //the method is not supported for this type of serialization
+  throw std::runtime_error("double serialization is not supported in BinarySizeSerializer");
+  return false;
+}
+
+}
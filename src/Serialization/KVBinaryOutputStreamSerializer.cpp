@@ -87,6 +87,19 @@ void KVBinaryOutputStreamSerializer::dump(IOutputStream& target) {
   write(target, stream().data(), stream().size());
 }
 
+void KVBinaryOutputStreamSerializer::dumpObjectSection(IOutputStream& target) {
+  assert(m_objectsStack.size() == 1);
+  assert(m_stack.size() == 1);
+
+  writeArraySize(target, m_stack.front().count);
+  write(target, stream().data(), stream().size());
+}
+
+void KVBinaryOutputStreamSerializer::objectSection(const void* data, size_t size, Common::StringView name) {
+  writeElementPrefix(BIN_KV_SERIALIZE_TYPE_OBJECT, name);
+  write(stream(), data, size);
+}
+
 ISerializer::SerializerType KVBinaryOutputStreamSerializer::type() const {
   return ISerializer::OUTPUT;
 }
@@ -31,6 +31,10 @@ public:
   virtual ~KVBinaryOutputStreamSerializer() {}
 
   void dump(Common::IOutputStream& target);
+  // Writes the root object without storage header, so it can be inserted later with objectSection()
+  void dumpObjectSection(Common::IOutputStream& target);
+  // Inserts an object that was written with dumpObjectSection() as is
+  void objectSection(const void* data, size_t size, Common::StringView name);
 
   virtual ISerializer::SerializerType type() const override;
 
@@ -17,6 +17,7 @@
 
 #include "BlockchainSynchronizer.h"
 
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <sstream>
@@ -26,6 +27,7 @@
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/TransactionApi.h"
 
 using namespace Common;
@@ -77,7 +79,8 @@ BlockchainSynchronizer::BlockchainSynchronizer(INode& node, Logging::ILogger& lo
   m_node(node),
   m_genesisBlockHash(genesisBlockHash),
   m_currentState(State::stopped),
-  m_futureState(State::stopped) {
+  m_futureState(State::stopped),
+  m_scanExecutor(ScanExecutor::getDefault()) {
 }
 
 BlockchainSynchronizer::~BlockchainSynchronizer() {
@@ -497,6 +500,17 @@ void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
   interval.startHeight = response.startHeight;
   std::vector<CompleteBlock> blocks;
 
+  // Coinbase transactions come without a hash, compute all of them in one batch.
+  std::vector<BinaryArray> baseTransactions;
+  for (auto& block : response.newBlocks) {
+    if (block.hasBlock) {
+      baseTransactions.push_back(toBinaryArray(block.block.baseTransaction));
+    }
+  }
+
+  auto baseTransactionHashes = getBinaryArrayHashes(baseTransactions);
+  size_t baseTransactionIndex = 0;
+
   for (auto& block : response.newBlocks) {
     if (checkIfShouldStop()) {
       break;
@@ -506,7 +520,8 @@ void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
     completeBlock.blockHash = block.blockHash;
     if (block.hasBlock) {
       completeBlock.block = std::move(block.block);
-      completeBlock.transactions.push_back(createTransactionPrefix(completeBlock.block->baseTransaction));
+      completeBlock.transactions.push_back(createTransactionPrefix(
+        static_cast<const TransactionPrefix&>(completeBlock.block->baseTransaction), baseTransactionHashes[baseTransactionIndex++]));
 
       try {
         for (const auto& txShortInfo : block.txsShortInfo) {
@@ -566,11 +581,20 @@ void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
 BlockchainSynchronizer::UpdateConsumersResult BlockchainSynchronizer::updateConsumers(const BlockchainInterval& interval, const std::vector<CompleteBlock>& blocks) {
   assert(interval.blocks.size() == blocks.size());
 
-  bool smthChanged = false;
-  bool hasErrors = false;
+  std::atomic<bool> smthChanged(false);
+  std::atomic<bool> hasErrors(false);
+  std::atomic<uint32_t> lastBlockIndex(std::numeric_limits<uint32_t>::max());
 
-  uint32_t lastBlockIndex = std::numeric_limits<uint32_t>::max();
+  // Consumers share nothing but the blocks, so all of them are updated in one pass over the batch.
+  // Each consumer scans through the same executor, and its nested job fills threads left idle by small batches.
+  std::vector<ConsumersMap::value_type*> consumers;
+  consumers.reserve(m_consumers.size());
   for (auto& kv : m_consumers) {
+    consumers.push_back(&kv);
+  }
+
+  m_scanExecutor.run(consumers.size(), [&](size_t i) {
+    auto& kv = *consumers[i];
     auto result = kv.second->checkInterval(interval);
 
     if (result.detachRequired) {
@@ -600,10 +624,13 @@ BlockchainSynchronizer::UpdateConsumersResult BlockchainSynchronizer::updateCons
       }
 
       if (addedCount > 0) {
-        lastBlockIndex = std::min(lastBlockIndex, startOffset + addedCount - 1);
+        uint32_t consumerLastBlockIndex = startOffset + addedCount - 1;
+        uint32_t currentLastBlockIndex = lastBlockIndex;
+        while (consumerLastBlockIndex < currentLastBlockIndex && !lastBlockIndex.compare_exchange_weak(currentLastBlockIndex, consumerLastBlockIndex)) {
+        }
       }
     }
-  }
+  });
 
   if (lastBlockIndex != std::numeric_limits<uint32_t>::max()) {
     assert(lastBlockIndex < blocks.size());
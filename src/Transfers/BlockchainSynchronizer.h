@@ -22,6 +22,7 @@
 #include "IBlockchainSynchronizer.h"
 #include "IObservableImpl.h"
 #include "IStreamSerializable.h"
+#include "ScanExecutor.h"
 
 #include <condition_variable>
 #include <mutex>
@@ -147,6 +148,8 @@ private:
   mutable std::mutex m_stateMutex;
   std::condition_variable m_hasWork;
 
+  ScanExecutor& m_scanExecutor;
+
   bool wasStarted = false;
 };
 
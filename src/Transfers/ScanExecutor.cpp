@@ -0,0 +1,216 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "ScanExecutor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <limits>
+
+namespace CryptoNote {
+
+namespace {
+
+// Range [begin, end) packed into one word, so it can be split between the owner and a thief with a single CAS
+uint64_t packRange(uint32_t begin, uint32_t end) {
+  return (static_cast<uint64_t>(begin) << 32) | end;
+}
+
+uint32_t rangeBegin(uint64_t range) {
+  return static_cast<uint32_t>(range >> 32);
+}
+
+uint32_t rangeEnd(uint64_t range) {
+  return static_cast<uint32_t>(range);
+}
+
+bool popFront(std::atomic<uint64_t>& range, uint32_t& index) {
+  uint64_t value = range.load();
+  for (;;) {
+    uint32_t begin = rangeBegin(value);
+    uint32_t end = rangeEnd(value);
+    if (begin >= end) {
+      return false;
+    }
+
+    if (range.compare_exchange_weak(value, packRange(begin + 1, end))) {
+      index = begin;
+      return true;
+    }
+  }
+}
+
+bool stealBackHalf(std::atomic<uint64_t>& range, uint64_t& stolen) {
+  uint64_t value = range.load();
+  for (;;) {
+    uint32_t begin = rangeBegin(value);
+    uint32_t end = rangeEnd(value);
+    if (begin >= end) {
+      return false;
+    }
+
+    uint32_t middle = begin + (end - begin) / 2;
+    if (range.compare_exchange_weak(value, packRange(begin, middle))) {
+      stolen = packRange(middle, end);
+      return true;
+    }
+  }
+}
+
+}
+
+struct ScanExecutor::Job {
+  Job(size_t count, size_t slotCount, const std::function<void(size_t)>& task) :
+    task(task), ranges(new std::atomic<uint64_t>[slotCount]), slotCount(slotCount), nextSlot(0), pendingCount(count) {
+
+    for (size_t slot = 0; slot < slotCount; ++slot) {
+      ranges[slot] = packRange(static_cast<uint32_t>(count * slot / slotCount), static_cast<uint32_t>(count * (slot + 1) / slotCount));
+    }
+  }
+
+  const std::function<void(size_t)>& task;
+  std::unique_ptr<std::atomic<uint64_t>[]> ranges;
+  const size_t slotCount;
+  std::atomic<size_t> nextSlot;
+  std::atomic<size_t> pendingCount;
+
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::exception_ptr error;
+};
+
+ScanExecutor::ScanExecutor(size_t threadCount) : m_stopped(false) {
+  for (size_t i = 0; i < threadCount; ++i) {
+    m_threads.emplace_back(&ScanExecutor::workerLoop, this);
+  }
+}
+
+ScanExecutor::~ScanExecutor() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stopped = true;
+  }
+
+  m_jobAdded.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+ScanExecutor& ScanExecutor::getDefault() {
+  static ScanExecutor executor(std::max(std::thread::hardware_concurrency(), 2u));
+  return executor;
+}
+
+size_t ScanExecutor::getThreadCount() const {
+  return m_threads.size();
+}
+
+void ScanExecutor::run(size_t count, const std::function<void(size_t)>& task) {
+  assert(count <= std::numeric_limits<uint32_t>::max());
+  if (count == 0) {
+    return;
+  }
+
+  auto job = std::make_shared<Job>(count, m_threads.size() + 1, task);
+  if (!m_threads.empty() && count > 1) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_jobs.push_back(job);
+    }
+
+    m_jobAdded.notify_all();
+  }
+
+  executeJob(*job, job->nextSlot++);
+  leaveJob(job);
+
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->finished.wait(lock, [&job] { return job->pendingCount == 0; });
+  if (job->error) {
+    std::rethrow_exception(job->error);
+  }
+}
+
+void ScanExecutor::workerLoop() {
+  for (;;) {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_jobAdded.wait(lock, [this] { return m_stopped || !m_jobs.empty(); });
+      if (m_stopped) {
+        return;
+      }
+
+      job = m_jobs.front();
+    }
+
+    executeJob(*job, job->nextSlot++);
+    leaveJob(job);
+  }
+}
+
+// Called by a thread that found no work left in the job, so no other thread needs to join it
+void ScanExecutor::leaveJob(const std::shared_ptr<Job>& job) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto it = std::find(m_jobs.begin(), m_jobs.end(), job);
+  if (it != m_jobs.end()) {
+    m_jobs.erase(it);
+  }
+}
+
+void ScanExecutor::executeJob(Job& job, size_t slot) {
+  // threads joining after every slot is taken have no range of their own and only steal
+  std::atomic<uint64_t> ownRange(packRange(0, 0));
+  std::atomic<uint64_t>& range = slot < job.slotCount ? job.ranges[slot] : ownRange;
+
+  for (;;) {
+    uint32_t index;
+    while (popFront(range, index)) {
+      try {
+        job.task(index);
+      } catch (...) {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        if (!job.error) {
+          job.error = std::current_exception();
+        }
+      }
+
+      if (--job.pendingCount == 0) {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.finished.notify_all();
+      }
+    }
+
+    uint64_t stolen;
+    bool hasStolen = false;
+    for (size_t i = 1; i <= job.slotCount && !hasStolen; ++i) {
+      size_t victim = (slot + i) % job.slotCount;
+      hasStolen = &job.ranges[victim] != &range && stealBackHalf(job.ranges[victim], stolen);
+    }
+
+    if (!hasStolen) {
+      return;
+    }
+
+    // the own range is empty, so nobody else modifies it until it's refilled
+    range = stolen;
+  }
+}
+
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CryptoNote {
+
+// Long-lived thread pool used to scan blocks for wallet outputs.
+// Every job is split into contiguous index ranges, one per participating thread; a thread that runs out of work
+// steals the back half of another thread's range, so uneven blocks don't leave threads idle.
+class ScanExecutor {
+public:
+  explicit ScanExecutor(size_t threadCount);
+  ScanExecutor(const ScanExecutor&) = delete;
+  ScanExecutor& operator=(const ScanExecutor&) = delete;
+  ~ScanExecutor();
+
+  // Executor shared by all transfers consumers in the process
+  static ScanExecutor& getDefault();
+
+  size_t getThreadCount() const;
+
+  // Calls task for every index in [0, count), the calling thread takes part in the work.
+  // Returns when all calls are finished, rethrows the first exception thrown by the task.
+  void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+  struct Job;
+
+  void workerLoop();
+  void leaveJob(const std::shared_ptr<Job>& job);
+  static void executeJob(Job& job, size_t slot);
+
+  std::mutex m_mutex;
+  std::condition_variable m_jobAdded;
+  std::deque<std::shared_ptr<Job>> m_jobs;
+  bool m_stopped;
+  std::vector<std::thread> m_threads;
+};
+
+}
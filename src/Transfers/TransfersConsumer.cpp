@@ -14,7 +14,6 @@
 #include <future>
 
 #include "CommonTypes.h"
-#include "Common/BlockingQueue.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/TransactionApi.h"
@@ -48,36 +47,16 @@ private:
     Crypto::Hash m_txHash;
 };
 
-void checkOutputKey(
-  const KeyDerivation& derivation,
-  const PublicKey& key,
-  size_t keyIndex,
-  size_t outputIndex,
-  const std::unordered_set<PublicKey>& spendKeys,
-  std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
-
-  PublicKey spendKey;
-  underive_public_key(derivation, keyIndex, key, spendKey);
-
-  if (spendKeys.find(spendKey) != spendKeys.end()) {
-    outputs[spendKey].push_back(static_cast<uint32_t>(outputIndex));
-  }
-
-}
-
 void findMyOutputs(
   const ITransactionReader& tx,
-  const SecretKey& viewSecretKey,
+  const KeyDerivation& derivation,
   const std::unordered_set<PublicKey>& spendKeys,
   std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
 
-  auto txPublicKey = tx.getTransactionPublicKey();
-  KeyDerivation derivation;
-
-  if (!generate_key_derivation( txPublicKey, viewSecretKey, derivation)) {
-    return;
-  }
-
+  // all output keys of the transaction are underived together, they share the derivation
+  std::vector<PublicKey> keys;
+  std::vector<size_t> keyIndexes;
+  std::vector<size_t> outputIndexes;
   size_t keyIndex = 0;
   size_t outputCount = tx.getOutputCount();
 
@@ -90,7 +69,9 @@ void findMyOutputs(
       uint64_t amount;
       KeyOutput out;
       tx.getOutput(idx, out, amount);
-      checkOutputKey(derivation, out.key, keyIndex, idx, spendKeys, outputs);
+      keys.push_back(out.key);
+      keyIndexes.push_back(keyIndex);
+      outputIndexes.push_back(idx);
       ++keyIndex;
 
     } else if (outType == TransactionTypes::OutputType::Multisignature) {
@@ -99,11 +80,23 @@ void findMyOutputs(
       MultisignatureOutput out;
       tx.getOutput(idx, out, amount);
       for (const auto& key : out.keys) {
-        checkOutputKey(derivation, key, idx, idx, spendKeys, outputs);
+        keys.push_back(key);
+        keyIndexes.push_back(idx);
+        outputIndexes.push_back(idx);
         ++keyIndex;
       }
     }
   }
+
+  std::vector<PublicKey> spendKeyCandidates(keys.size());
+  std::unique_ptr<bool[]> valid(new bool[keys.size()]);
+  underive_public_keys(derivation, keyIndexes.data(), keys.data(), keys.size(), spendKeyCandidates.data(), valid.get());
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (valid[i] && spendKeys.find(spendKeyCandidates[i]) != spendKeys.end()) {
+      outputs[spendKeyCandidates[i]].push_back(static_cast<uint32_t>(outputIndexes[i]));
+    }
+  }
 }
 
 std::vector<Crypto::Hash> getBlockHashes(const CryptoNote::CompleteBlock* blocks, size_t count) {
@@ -122,7 +115,7 @@ std::vector<Crypto::Hash> getBlockHashes(const CryptoNote::CompleteBlock* blocks
 namespace CryptoNote {
 
 TransfersConsumer::TransfersConsumer(const CryptoNote::Currency& currency, INode& node, Logging::ILogger& logger, const SecretKey& viewSecret) :
-  m_viewSecret(viewSecret), m_node(node), m_currency(currency), m_logger(logger, "TransfersConsumer") {
+  m_viewSecret(viewSecret), m_viewContext(viewSecret), m_node(node), m_currency(currency), m_logger(logger, "TransfersConsumer"), m_scanExecutor(ScanExecutor::getDefault()) {
   updateSyncStart();
 }
 
@@ -219,91 +212,89 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t st
 
   struct PreprocessedTx : Tx, PreprocessInfo {};
 
-  std::vector<PreprocessedTx> preprocessedTransactions;
-  std::mutex preprocessedTransactionsMutex;
-
-  size_t workers = std::thread::hardware_concurrency();
-  if (workers == 0) {
-    workers = 2;
-  }
-
-  BlockingQueue<Tx> inputQueue(workers * 2);
+  // result slots are indexed by block position, so workers don't synchronize and no sorting is needed
+  std::vector<std::vector<PreprocessedTx>> preprocessedBlocks(count);
+  std::vector<std::error_code> blockErrors(count);
 
   std::atomic<bool> stopProcessing(false);
   std::atomic<size_t> emptyBlockCount(0);
 
-  auto pushingThread = std::async(std::launch::async, [&] {
-    for( uint32_t i = 0; i < count && !stopProcessing; ++i) {
-      const auto& block = blocks[i].block;
+  auto processingFunction = [&](size_t i) {
+    if (stopProcessing) {
+      return;
+    }
 
-      if (!block.is_initialized()) {
-        ++emptyBlockCount;
-        continue;
-      }
+    const auto& block = blocks[i].block;
 
-      // filter by syncStartTimestamp
-      if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
-        ++emptyBlockCount;
-        continue;
-      }
+    if (!block.is_initialized()) {
+      ++emptyBlockCount;
+      return;
+    }
 
-      TransactionBlockInfo blockInfo;
-      blockInfo.height = startHeight + i;
-      blockInfo.timestamp = block->timestamp;
-      blockInfo.transactionIndex = 0; // position in block
+    // filter by syncStartTimestamp
+    if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
+      ++emptyBlockCount;
+      return;
+    }
 
-      for (const auto& tx : blocks[i].transactions) {
-        auto pubKey = tx->getTransactionPublicKey();
-        if (pubKey == NULL_PUBLIC_KEY) {
-          ++blockInfo.transactionIndex;
-          continue;
-        }
+    TransactionBlockInfo blockInfo;
+    blockInfo.height = startHeight + static_cast<uint32_t>(i);
+    blockInfo.timestamp = block->timestamp;
+    blockInfo.transactionIndex = 0; // position in block
+
+    // derivations of the whole block are computed in one batch against the view key
+    std::vector<PublicKey> pubKeys;
+    for (const auto& tx : blocks[i].transactions) {
+      auto pubKey = tx->getTransactionPublicKey();
+      if (pubKey != NULL_PUBLIC_KEY) {
+        pubKeys.push_back(pubKey);
+      }
+    }
 
-        bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
-        Tx item = { blockInfo, tx.get(), isLastTransactionInBlock };
-        inputQueue.push(item);
+    std::vector<KeyDerivation> derivations(pubKeys.size());
+    std::unique_ptr<bool[]> derivationsValid(new bool[pubKeys.size()]);
+    m_viewContext.generate_key_derivations(pubKeys.data(), pubKeys.size(), derivations.data(), derivationsValid.get());
+    size_t derivationIndex = 0;
+
+    for (const auto& tx : blocks[i].transactions) {
+      auto pubKey = tx->getTransactionPublicKey();
+      if (pubKey == NULL_PUBLIC_KEY) {
         ++blockInfo.transactionIndex;
+        continue;
       }
-    }
 
-    inputQueue.close();
-  });
+      const KeyDerivation* derivation = derivationsValid[derivationIndex] ? &derivations[derivationIndex] : nullptr;
+      ++derivationIndex;
 
-  auto processingFunction = [&] {
-    Tx item;
-    std::error_code ec;
-    while (!stopProcessing && inputQueue.pop(item)) {
       PreprocessedTx output;
-      static_cast<Tx&>(output) = item;
+      output.blockInfo = blockInfo;
+      output.tx = tx.get();
+      output.isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
 
-      ec = preprocessOutputs(item.blockInfo, *item.tx, output);
+      auto ec = preprocessOutputs(blockInfo, *tx, derivation, output);
       if (ec) {
+        blockErrors[i] = ec;
         stopProcessing = true;
-        break;
+        return;
       }
 
-      std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-      preprocessedTransactions.push_back(std::move(output));
+      preprocessedBlocks[i].push_back(std::move(output));
+      ++blockInfo.transactionIndex;
     }
-    return ec;
   };
 
-  std::vector<std::future<std::error_code>> processingThreads;
-  for (size_t i = 0; i < workers; ++i) {
-    processingThreads.push_back(std::async(std::launch::async, processingFunction));
+  std::error_code processingError;
+  try {
+    m_scanExecutor.run(count, processingFunction);
+  } catch (const std::system_error& e) {
+    processingError = e.code();
+  } catch (const std::exception&) {
+    processingError = std::make_error_code(std::errc::operation_canceled);
   }
 
-  std::error_code processingError;
-  for (auto& f : processingThreads) {
-    try {
-      std::error_code ec = f.get();
-      if (!processingError && ec) {
-        processingError = ec;
-      }
-    } catch (const std::system_error& e) {
-      processingError = e.code();
-    } catch (const std::exception&) {
-      processingError = std::make_error_code(std::errc::operation_canceled);
+  for (const auto& ec : blockErrors) {
+    if (!processingError && ec) {
+      processingError = ec;
     }
   }
 
@@ -318,25 +309,22 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t st
   std::vector<Crypto::Hash> blockHashes = getBlockHashes(blocks, count);
   m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-  // sort by block height and transaction index in block
-  std::sort(preprocessedTransactions.begin(), preprocessedTransactions.end(), [](const PreprocessedTx& a, const PreprocessedTx& b) {
-    return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex) < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-  });
-
-  uint32_t processedBlockCount = emptyBlockCount;
+  uint32_t processedBlockCount = static_cast<uint32_t>(emptyBlockCount);
   try {
-    for (const auto& tx : preprocessedTransactions) {
-      processTransaction(tx.blockInfo, *tx.tx, tx);
-
-      if (tx.isLastTransactionInBlock) {
-        ++processedBlockCount;
-        m_logger(TRACE) << "Processed block " << processedBlockCount << " of " << count << ", last processed block index " << tx.blockInfo.height <<
-            ", hash " << blocks[processedBlockCount - 1].blockHash;
-
-        auto newHeight = startHeight + processedBlockCount - 1;
-        forEachSubscription([newHeight](TransfersSubscription& sub) {
-            sub.advanceHeight(newHeight);
-        });
+    for (const auto& blockTransactions : preprocessedBlocks) {
+      for (const auto& tx : blockTransactions) {
+        processTransaction(tx.blockInfo, *tx.tx, tx);
+
+        if (tx.isLastTransactionInBlock) {
+          ++processedBlockCount;
+          m_logger(TRACE) << "Processed block " << processedBlockCount << " of " << count << ", last processed block index " << tx.blockInfo.height <<
+              ", hash " << blocks[processedBlockCount - 1].blockHash;
+
+          auto newHeight = startHeight + processedBlockCount - 1;
+          forEachSubscription([newHeight](TransfersSubscription& sub) {
+              sub.advanceHeight(newHeight);
+          });
+        }
       }
     }
   } catch (const MarkTransactionConfirmedException& e) {
@@ -504,9 +492,14 @@ std::error_code createTransfers(
   return std::error_code();
 }
 
-std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info) {
+std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, const KeyDerivation* derivation, PreprocessInfo& info) {
+  // no derivation: the transaction public key is not a valid point, nothing can be addressed to us
+  if (derivation == nullptr) {
+    return std::error_code();
+  }
+
   std::unordered_map<PublicKey, std::vector<uint32_t>> outputs;
-  try { findMyOutputs(tx, m_viewSecret, m_spendKeys, outputs); }
+  try { findMyOutputs(tx, *derivation, m_spendKeys, outputs); }
   catch (const std::exception& e) {
       m_logger(WARNING, BRIGHT_RED) << "Failed to process transaction: " << e.what() << ", transaction hash " << Common::podToHex(tx.getTransactionHash());
       return std::error_code();
@@ -540,7 +533,9 @@ std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo&
 
 std::error_code TransfersConsumer::processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx) {
   PreprocessInfo info;
-  auto ec = preprocessOutputs(blockInfo, tx, info);
+  KeyDerivation derivation;
+  bool derived = m_viewContext.generate_key_derivation(tx.getTransactionPublicKey(), derivation);
+  auto ec = preprocessOutputs(blockInfo, tx, derived ? &derivation : nullptr, info);
   if (ec) {
     return ec;
   }
@@ -170,9 +170,11 @@ size_t SpentOutputDescriptor::hash() const {
 
 TransfersContainer::TransfersContainer(const Currency& currency, Logging::ILogger& logger, size_t transactionSpendableAge) :
   m_currentHeight(0),
+  m_unlockTime(static_cast<uint64_t>(time(nullptr))),
   m_transactionSpendableAge(transactionSpendableAge),
   m_currency(currency),
   m_logger(logger, "TransfersContainer") {
+  rebuildBalance();
 }
 
 bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const ITransactionReader& tx,
@@ -201,7 +203,7 @@ bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const
     }
 
     if (block.height != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
-      m_currentHeight = block.height;
+      setCurrentHeight(block.height);
     }
 
     return added;
@@ -272,8 +274,8 @@ bool TransfersContainer::addTransactionOutputs(const TransactionBlockInfo& block
 
     if (transferIsUnconfirmed) {
       auto result = m_unconfirmedTransfers.emplace(std::move(info));
-      (void)result; // Disable unused warning
       assert(result.second);
+      addTransferToBalance(*result.first);
     } else {
       if (info.type == TransactionTypes::OutputType::Key) {
         bool duplicate = false;
@@ -310,8 +312,8 @@ bool TransfersContainer::addTransactionOutputs(const TransactionBlockInfo& block
       }
 
       auto result = m_availableTransfers.emplace(std::move(info));
-      (void)result; // Disable unused warning
       assert(result.second);
+      addTransferToBalance(*result.first);
     }
 
     if (info.type == TransactionTypes::OutputType::Key) {
@@ -394,6 +396,7 @@ bool TransfersContainer::addTransactionInputs(const TransactionBlockInfo& block,
       assert(spendingTransferIt->keyImage == input.keyImage);
       copyToSpent(block, tx, i, *spendingTransferIt);
       // erase from available outputs
+      removeTransferFromBalance(*spendingTransferIt);
       outputDescriptorIndex.erase(spendingTransferIt);
       updateTransfersVisibility(input.keyImage);
 
@@ -407,6 +410,7 @@ bool TransfersContainer::addTransactionInputs(const TransactionBlockInfo& block,
       if (availableOutputIt != outputDescriptorIndex.end()) {
         copyToSpent(block, tx, i, *availableOutputIt);
         // erase from available outputs
+        removeTransferFromBalance(*availableOutputIt);
         outputDescriptorIndex.erase(availableOutputIt);
 
         inputsAdded = true;
@@ -486,9 +490,10 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo& bl
       }
 
       auto result = m_availableTransfers.emplace(std::move(transfer));
-      (void)result; // Disable unused warning
       assert(result.second);
+      addTransferToBalance(*result.first);
 
+      removeTransferFromBalance(*transferIt);
       transferIt = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(transferIt);
 
       if (transfer.type == TransactionTypes::OutputType::Key) {
@@ -524,9 +529,10 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo& bl
       unconfirmedTransfer.globalOutputIndex = UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX;
 
       auto result = m_unconfirmedTransfers.emplace(std::move(unconfirmedTransfer));
-      (void)result; // Disable unused warning
       assert(result.second);
+      addTransferToBalance(*result.first);
 
+      removeTransferFromBalance(*transferIt);
       transferIt = m_availableTransfers.get<ContainingTransactionIndex>().erase(transferIt);
 
       if (unconfirmedTransfer.type == TransactionTypes::OutputType::Key) {
@@ -563,6 +569,7 @@ void TransfersContainer::deleteTransactionTransfers(const Hash& transactionHash)
 
     auto result = m_availableTransfers.emplace(static_cast<const TransactionOutputInformationEx&>(*it));
     assert(result.second);
+    addTransferToBalance(*result.first);
     it = spendingTransactionIndex.erase(it);
 
     if (result.first->type == TransactionTypes::OutputType::Key) {
@@ -572,6 +579,7 @@ void TransfersContainer::deleteTransactionTransfers(const Hash& transactionHash)
 
   auto unconfirmedTransfersRange = m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
   for (auto it = unconfirmedTransfersRange.first; it != unconfirmedTransfersRange.second;) {
+    removeTransferFromBalance(*it);
     if (it->type == TransactionTypes::OutputType::Key) {
       KeyImage keyImage = it->keyImage;
       it = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(it);
@@ -584,6 +592,7 @@ void TransfersContainer::deleteTransactionTransfers(const Hash& transactionHash)
   auto& transactionTransfersIndex = m_availableTransfers.get<ContainingTransactionIndex>();
   auto transactionTransfersRange = transactionTransfersIndex.equal_range(transactionHash);
   for (auto it = transactionTransfersRange.first; it != transactionTransfersRange.second;) {
+    removeTransferFromBalance(*it);
     if (it->type == TransactionTypes::OutputType::Key) {
       KeyImage keyImage = it->keyImage;
       it = transactionTransfersIndex.erase(it);
@@ -649,6 +658,7 @@ std::vector<Hash> TransfersContainer::detach(uint32_t height) {
 
   // TODO: notification on detach
   m_currentHeight = height == 0 ? 0 : height - 1;
+  rebuildBalance();
 
   return deletedTransactions;
 }
@@ -682,6 +692,14 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
   size_t spentCount = std::distance(spentRange.first, spentRange.second);
   assert(spentCount == 0 || spentCount == 1);
 
+  for (auto it = unconfirmedRange.first; it != unconfirmedRange.second; ++it) {
+    removeTransferFromBalance(*it);
+  }
+
+  for (auto it = availableRange.first; it != availableRange.second; ++it) {
+    removeTransferFromBalance(*it);
+  }
+
   if (spentCount > 0) {
     updateVisibility(unconfirmedIndex, unconfirmedRange, false);
     updateVisibility(availableIndex, availableRange, false);
@@ -700,13 +718,21 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
   } else {
     updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
   }
+
+  for (auto it = unconfirmedRange.first; it != unconfirmedRange.second; ++it) {
+    addTransferToBalance(*it);
+  }
+
+  for (auto it = availableRange.first; it != availableRange.second; ++it) {
+    addTransferToBalance(*it);
+  }
 }
 
 bool TransfersContainer::advanceHeight(uint32_t height) {
   std::lock_guard<std::mutex> lk(m_mutex);
 
   if (m_currentHeight <= height) {
-    m_currentHeight = height;
+    setCurrentHeight(height);
     return true;
   }
 
@@ -725,18 +751,16 @@ size_t TransfersContainer::transactionsCount() const {
 
 uint64_t TransfersContainer::balance(uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
-  uint64_t amount = 0;
+  processUnlockEvents(m_currentHeight, static_cast<uint64_t>(time(nullptr)));
 
-  for (const auto& t : m_availableTransfers) {
-    if (t.visible && isIncluded(t, flags)) {
-      amount += t.amount;
-    }
-  }
+  const TransactionTypes::OutputType types[] = { TransactionTypes::OutputType::Key, TransactionTypes::OutputType::Multisignature };
+  const uint32_t states[] = { IncludeStateUnlocked, IncludeStateLocked, IncludeStateSoftLocked };
 
-  if ((flags & IncludeStateLocked) != 0) {
-    for (const auto& t : m_unconfirmedTransfers) {
-      if (t.visible && isIncluded(t.type, IncludeStateLocked, flags)) {
-        amount += t.amount;
+  uint64_t amount = 0;
+  for (size_t typeIndex = 0; typeIndex < 2; ++typeIndex) {
+    for (size_t stateIndex = 0; stateIndex < 3; ++stateIndex) {
+      if (isIncluded(types[typeIndex], states[stateIndex], flags)) {
+        amount += m_balances[typeIndex][stateIndex];
       }
     }
   }
@@ -746,6 +770,16 @@ uint64_t TransfersContainer::balance(uint32_t flags) const {
 
 void TransfersContainer::getOutputs(std::vector<TransactionOutputInformation>& transfers, uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
+  if ((flags & IncludeStateAll) == IncludeStateUnlocked && (flags & IncludeTypeAll) == IncludeTypeKey) {
+    processUnlockEvents(m_currentHeight, static_cast<uint64_t>(time(nullptr)));
+    transfers.reserve(transfers.size() + m_unlockedOutputs.size());
+    for (auto output : m_unlockedOutputs) {
+      transfers.push_back(*output);
+    }
+
+    return;
+  }
+
   for (const auto& t : m_availableTransfers) {
     if (t.visible && isIncluded(t, flags)) {
       transfers.push_back(t);
@@ -888,6 +922,22 @@ std::vector<TransactionSpentOutputInformation> TransfersContainer::getSpentOutpu
   return spentOutputs;
 }
 
+size_t TransfersContainer::getUnlockedOutputsCount() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  processUnlockEvents(m_currentHeight, static_cast<uint64_t>(time(nullptr)));
+  return m_unlockedOutputs.size();
+}
+
+bool TransfersContainer::getUnlockedOutput(size_t index, TransactionOutputInformation& output) const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  if (index >= m_unlockedOutputs.size()) {
+    return false;
+  }
+
+  output = *m_unlockedOutputs[index];
+  return true;
+}
+
 void TransfersContainer::save(std::ostream& os) {
   std::lock_guard<std::mutex> lk(m_mutex);
   StdOutputStream stream(os);
@@ -933,6 +983,7 @@ void TransfersContainer::load(std::istream& in) {
   m_unconfirmedTransfers = std::move(unconfirmedTransfers);
   m_availableTransfers = std::move(availableTransfers);
   m_spentTransfers = std::move(spentTransfers);
+  rebuildBalance();
 
   // Repair the container if it was broken while handling addTransaction() in previous version of the code
   // Hope it isn't necessary anymore
@@ -1023,6 +1074,8 @@ void TransfersContainer::repair() {
     }
   }
 
+  rebuildBalance();
+
   if (deletedInputCount + deletedUnconfirmedOutputCount + deletedAvailableOutputCount > 0) {
     m_logger(WARNING, BRIGHT_YELLOW) << "Repair finished:\n" <<
       "    Deleted inputs " << deletedInputCount << ", total inputs " << m_spentTransfers.size() << '\n' <<
@@ -1033,30 +1086,30 @@ void TransfersContainer::repair() {
   }
 }
 
-bool TransfersContainer::isSpendTimeUnlocked(uint64_t unlockTime) const {
+bool TransfersContainer::isSpendTimeUnlocked(uint64_t unlockTime, uint32_t height, uint64_t time) const {
   if (unlockTime < m_currency.maxBlockHeight()) {
     // interpret as block index
-    return m_currentHeight + m_currency.lockedTxAllowedDeltaBlocks() >= unlockTime;
+    return height + m_currency.lockedTxAllowedDeltaBlocks() >= unlockTime;
   } else {
     //interpret as time
-    uint64_t current_time = static_cast<uint64_t>(time(NULL));
-    return current_time + m_currency.lockedTxAllowedDeltaSeconds() >= unlockTime;
+    return time + m_currency.lockedTxAllowedDeltaSeconds() >= unlockTime;
   }
 
   return false;
 }
 
-bool TransfersContainer::isIncluded(const TransactionOutputInformationEx& info, uint32_t flags) const {
-  uint32_t state;
-  if (info.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT || !isSpendTimeUnlocked(info.unlockTime)) {
-    state = IncludeStateLocked;
-  } else if (m_currentHeight < info.blockHeight + m_transactionSpendableAge) {
-    state = IncludeStateSoftLocked;
+uint32_t TransfersContainer::getTransferState(const TransactionOutputInformationEx& info, uint32_t height, uint64_t time) const {
+  if (info.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT || !isSpendTimeUnlocked(info.unlockTime, height, time)) {
+    return IncludeStateLocked;
+  } else if (height < info.blockHeight + m_transactionSpendableAge) {
+    return IncludeStateSoftLocked;
   } else {
-    state = IncludeStateUnlocked;
+    return IncludeStateUnlocked;
   }
+}
 
-  return isIncluded(info.type, state, flags);
+bool TransfersContainer::isIncluded(const TransactionOutputInformationEx& info, uint32_t flags) const {
+  return isIncluded(info.type, getTransferState(info, m_currentHeight, static_cast<uint64_t>(time(NULL))), flags);
 }
 
 bool TransfersContainer::isIncluded(TransactionTypes::OutputType type, uint32_t state, uint32_t flags) {
@@ -1071,4 +1124,168 @@ bool TransfersContainer::isIncluded(TransactionTypes::OutputType type, uint32_t
     ((flags & state) != 0);
 }
 
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::setCurrentHeight(uint32_t height) {
+  if (height < m_currentHeight) {
+    m_currentHeight = height;
+    rebuildBalance();
+  } else {
+    processUnlockEvents(height, m_unlockTime);
+    m_currentHeight = height;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::addTransferToBalance(const TransactionOutputInformationEx& info) const {
+  if (info.visible) {
+    uint32_t state = getTransferState(info, m_currentHeight, m_unlockTime);
+    changeBalance(info, state, true);
+    changeUnlockEvent(info, state, true);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::removeTransferFromBalance(const TransactionOutputInformationEx& info) const {
+  if (info.visible) {
+    uint32_t state = getTransferState(info, m_currentHeight, m_unlockTime);
+    changeBalance(info, state, false);
+    changeUnlockEvent(info, state, false);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::changeBalance(const TransactionOutputInformationEx& info, uint32_t state, bool add) const {
+  size_t typeIndex;
+  if (info.type == TransactionTypes::OutputType::Key) {
+    typeIndex = 0;
+  } else if (info.type == TransactionTypes::OutputType::Multisignature) {
+    typeIndex = 1;
+  } else {
+    return;
+  }
+
+  size_t stateIndex = state == IncludeStateUnlocked ? 0 : (state == IncludeStateLocked ? 1 : 2);
+  if (add) {
+    m_balances[typeIndex][stateIndex] += info.amount;
+  } else {
+    assert(m_balances[typeIndex][stateIndex] >= info.amount);
+    m_balances[typeIndex][stateIndex] -= info.amount;
+  }
+
+  if (typeIndex == 0 && state == IncludeStateUnlocked) {
+    if (add) {
+      m_unlockedOutputIndexes.emplace(&info, m_unlockedOutputs.size());
+      m_unlockedOutputs.push_back(&info);
+    } else {
+      auto it = m_unlockedOutputIndexes.find(&info);
+      assert(it != m_unlockedOutputIndexes.end());
+      size_t index = it->second;
+      m_unlockedOutputIndexes.erase(it);
+
+      if (index + 1 != m_unlockedOutputs.size()) {
+        m_unlockedOutputs[index] = m_unlockedOutputs.back();
+        m_unlockedOutputIndexes[m_unlockedOutputs[index]] = index;
+      }
+
+      m_unlockedOutputs.pop_back();
+    }
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::changeUnlockEvent(const TransactionOutputInformationEx& info, uint32_t state, bool add) const {
+  UnlockEventQueue* queue;
+  uint64_t key;
+  if (state == IncludeStateLocked) {
+    if (info.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+      // unconfirmed transfers stay locked until they are confirmed and added again
+      return;
+    }
+
+    if (info.unlockTime < m_currency.maxBlockHeight()) {
+      queue = &m_heightUnlockEvents;
+      key = info.unlockTime - m_currency.lockedTxAllowedDeltaBlocks();
+    } else {
+      queue = &m_timeUnlockEvents;
+      key = info.unlockTime - m_currency.lockedTxAllowedDeltaSeconds();
+    }
+  } else if (state == IncludeStateSoftLocked) {
+    queue = &m_heightUnlockEvents;
+    key = static_cast<uint64_t>(info.blockHeight) + m_transactionSpendableAge;
+  } else {
+    return;
+  }
+
+  if (add) {
+    queue->emplace(key, &info);
+  } else {
+    queue->erase(std::make_pair(key, &info));
+  }
+}
+
+/**
+ * Moves the transfers whose state changes by the given height and time between the balance totals. Called from const
+ * accessors too, since time locks expire without any change to the container.
+ *
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::processUnlockEvents(uint32_t height, uint64_t time) const {
+  time = std::max(time, m_unlockTime);
+
+  std::vector<const TransactionOutputInformationEx*> changedTransfers;
+  while (!m_heightUnlockEvents.empty() && m_heightUnlockEvents.begin()->first <= height) {
+    changedTransfers.push_back(m_heightUnlockEvents.begin()->second);
+    m_heightUnlockEvents.erase(m_heightUnlockEvents.begin());
+  }
+
+  while (!m_timeUnlockEvents.empty() && m_timeUnlockEvents.begin()->first <= time) {
+    changedTransfers.push_back(m_timeUnlockEvents.begin()->second);
+    m_timeUnlockEvents.erase(m_timeUnlockEvents.begin());
+  }
+
+  for (auto transfer : changedTransfers) {
+    changeBalance(*transfer, getTransferState(*transfer, m_currentHeight, m_unlockTime), false);
+  }
+
+  m_unlockTime = time;
+
+  for (auto transfer : changedTransfers) {
+    uint32_t state = getTransferState(*transfer, height, time);
+    changeBalance(*transfer, state, true);
+    changeUnlockEvent(*transfer, state, true);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::rebuildBalance() {
+  for (auto& typeBalances : m_balances) {
+    std::fill(std::begin(typeBalances), std::end(typeBalances), 0);
+  }
+
+  m_heightUnlockEvents.clear();
+  m_timeUnlockEvents.clear();
+  m_unlockedOutputs.clear();
+  m_unlockedOutputIndexes.clear();
+
+  for (const auto& transfer : m_unconfirmedTransfers) {
+    addTransferToBalance(transfer);
+  }
+
+  for (const auto& transfer : m_availableTransfers) {
+    addTransferToBalance(transfer);
+  }
+}
+
 }
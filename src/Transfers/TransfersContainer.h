@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdint>
+#include <set>
 #include <unordered_map>
 #include <mutex>
 
@@ -172,6 +173,8 @@ public:
   virtual std::vector<TransactionOutputInformation> getTransactionInputs(const Crypto::Hash& transactionHash, uint32_t flags) const override;
   virtual void getUnconfirmedTransactions(std::vector<Crypto::Hash>& transactions) const override;
   virtual std::vector<TransactionSpentOutputInformation> getSpentOutputs() const override;
+  virtual size_t getUnlockedOutputsCount() const override;
+  virtual bool getUnlockedOutput(size_t index, TransactionOutputInformation& output) const override;
 
   // IStreamSerializable
   virtual void save(std::ostream& os) override;
@@ -266,11 +269,20 @@ private:
                              const std::vector<TransactionOutputInformationIn>& transfers);
   bool addTransactionInputs(const TransactionBlockInfo& block, const ITransactionReader& tx);
   void deleteTransactionTransfers(const Crypto::Hash& transactionHash);
-  bool isSpendTimeUnlocked(uint64_t unlockTime) const;
+  bool isSpendTimeUnlocked(uint64_t unlockTime, uint32_t height, uint64_t time) const;
+  uint32_t getTransferState(const TransactionOutputInformationEx& info, uint32_t height, uint64_t time) const;
   bool isIncluded(const TransactionOutputInformationEx& info, uint32_t flags) const;
   static bool isIncluded(TransactionTypes::OutputType type, uint32_t state, uint32_t flags);
   void updateTransfersVisibility(const Crypto::KeyImage& keyImage);
 
+  void setCurrentHeight(uint32_t height);
+  void addTransferToBalance(const TransactionOutputInformationEx& info) const;
+  void removeTransferFromBalance(const TransactionOutputInformationEx& info) const;
+  void changeBalance(const TransactionOutputInformationEx& info, uint32_t state, bool add) const;
+  void changeUnlockEvent(const TransactionOutputInformationEx& info, uint32_t state, bool add) const;
+  void processUnlockEvents(uint32_t height, uint64_t time) const;
+  void rebuildBalance();
+
   void copyToSpent(const TransactionBlockInfo& block, const ITransactionReader& tx, size_t inputIndex, const TransactionOutputInformationEx& output);
   void repair();
 
@@ -281,6 +293,20 @@ private:
   SpentTransfersMultiIndex m_spentTransfers;
 
   uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
+
+  // Running totals of the visible unconfirmed and available transfers, by output type and state as of m_currentHeight and
+  // m_unlockTime. Transfers that are not unlocked yet wait in the event queues for the height or the time of their next
+  // state change, so that advancing the height only touches the transfers whose state changes.
+  typedef std::set<std::pair<uint64_t, const TransactionOutputInformationEx*>> UnlockEventQueue;
+
+  mutable uint64_t m_balances[2][3];
+  mutable uint64_t m_unlockTime;
+  mutable UnlockEventQueue m_heightUnlockEvents;
+  mutable UnlockEventQueue m_timeUnlockEvents;
+  // visible available key outputs in IncludeStateUnlocked, the ones a new transaction can spend
+  mutable std::vector<const TransactionOutputInformationEx*> m_unlockedOutputs;
+  mutable std::unordered_map<const TransactionOutputInformationEx*, size_t> m_unlockedOutputIndexes;
+
   size_t m_transactionSpendableAge;
   const CryptoNote::Currency& m_currency;
   mutable std::mutex m_mutex;
@@ -40,6 +40,13 @@ void TransfersSyncronizer::initTransactionPool(const std::unordered_set<Crypto::
   }
 }
 
+void TransfersSyncronizer::initTransactionPool(const Crypto::PublicKey& viewPublicKey, const std::unordered_set<Crypto::Hash>& uncommitedTransactions) {
+  auto it = m_consumers.find(viewPublicKey);
+  if (it != m_consumers.end()) {
+    it->second->initTransactionPool(uncommitedTransactions);
+  }
+}
+
 ITransfersSubscription& TransfersSyncronizer::addSubscription(const AccountSubscription& acc) {
   auto it = m_consumers.find(acc.keys.address.viewPublicKey);
 
@@ -49,6 +56,7 @@ ITransfersSubscription& TransfersSyncronizer::addSubscription(const AccountSubsc
 
     m_sync.addConsumer(consumer.get());
     consumer->addObserver(this);
+    m_consumerViewKeys.emplace(consumer.get(), acc.keys.address.viewPublicKey);
     it = m_consumers.insert(std::make_pair(acc.keys.address.viewPublicKey, std::move(consumer))).first;
   }
     
@@ -62,6 +70,7 @@ bool TransfersSyncronizer::removeSubscription(const AccountPublicAddress& acc) {
 
   if (it->second->removeSubscription(acc)) {
     m_sync.removeConsumer(it->second.get());
+    m_consumerViewKeys.erase(it->second.get());
     m_consumers.erase(it);
 
     m_subscribers.erase(acc.viewPublicKey);
@@ -76,6 +85,13 @@ void TransfersSyncronizer::getSubscriptions(std::vector<AccountPublicAddress>& s
   }
 }
 
+void TransfersSyncronizer::getSubscriptions(const Crypto::PublicKey& viewPublicKey, std::vector<AccountPublicAddress>& subscriptions) {
+  auto it = m_consumers.find(viewPublicKey);
+  if (it != m_consumers.end()) {
+    it->second->getSubscriptions(subscriptions);
+  }
+}
+
 ITransfersSubscription* TransfersSyncronizer::getSubscription(const AccountPublicAddress& acc) {
   auto it = m_consumers.find(acc.viewPublicKey);
   return (it == m_consumers.end()) ? nullptr : it->second->getSubscription(acc);
@@ -150,17 +166,29 @@ void TransfersSyncronizer::unsubscribeConsumerNotifications(const Crypto::Public
 }
 
 void TransfersSyncronizer::save(std::ostream& os) {
+  saveConsumers(os, nullptr);
+}
+
+void TransfersSyncronizer::save(std::ostream& os, const Crypto::PublicKey& viewPublicKey) {
+  saveConsumers(os, &viewPublicKey);
+}
+
+void TransfersSyncronizer::saveConsumers(std::ostream& os, const Crypto::PublicKey* viewPublicKey) {
   m_sync.save(os);
 
   StdOutputStream stream(os);
   CryptoNote::BinaryOutputStreamSerializer s(stream);
   s(const_cast<uint32_t&>(TRANSFERS_STORAGE_ARCHIVE_VERSION), "version");
 
-  size_t subscriptionCount = m_consumers.size();
+  size_t subscriptionCount = viewPublicKey == nullptr ? m_consumers.size() : m_consumers.count(*viewPublicKey);
 
   s.beginArray(subscriptionCount, "consumers");
 
   for (const auto& consumer : m_consumers) {
+    if (viewPublicKey != nullptr && consumer.first != *viewPublicKey) {
+      continue;
+    }
+
     s.beginObject("");
     s(const_cast<PublicKey&>(consumer.first), "view_key");
 
@@ -311,16 +339,12 @@ void TransfersSyncronizer::load(std::istream& is) {
 }
 
 bool TransfersSyncronizer::findViewKeyForConsumer(IBlockchainConsumer* consumer, Crypto::PublicKey& viewKey) const {
-  //since we have only couple of consumers linear complexity is fine
-  auto it = std::find_if(m_consumers.begin(), m_consumers.end(), [consumer] (const ConsumersContainer::value_type& subscription) {
-    return subscription.second.get() == consumer;
-  });
-
-  if (it == m_consumers.end()) {
+  auto it = m_consumerViewKeys.find(consumer);
+  if (it == m_consumerViewKeys.end()) {
     return false;
   }
 
-  viewKey = it->first;
+  viewKey = it->second;
   return true;
 }
 
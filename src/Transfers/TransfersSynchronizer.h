@@ -35,11 +35,13 @@ public:
   virtual ~TransfersSyncronizer() override;
 
   void initTransactionPool(const std::unordered_set<Crypto::Hash>& uncommitedTransactions);
+  void initTransactionPool(const Crypto::PublicKey& viewPublicKey, const std::unordered_set<Crypto::Hash>& uncommitedTransactions);
 
   // ITransfersSynchronizer
   virtual ITransfersSubscription& addSubscription(const AccountSubscription& acc) override;
   virtual bool removeSubscription(const AccountPublicAddress& acc) override;
   virtual void getSubscriptions(std::vector<AccountPublicAddress>& subscriptions) override;
+  void getSubscriptions(const Crypto::PublicKey& viewPublicKey, std::vector<AccountPublicAddress>& subscriptions);
   virtual ITransfersSubscription* getSubscription(const AccountPublicAddress& acc) override;
   virtual std::vector<Crypto::Hash> getViewKeyKnownBlocks(const Crypto::PublicKey& publicViewKey) override;
 
@@ -49,6 +51,8 @@ public:
   // IStreamSerializable
   virtual void save(std::ostream& os) override;
   virtual void load(std::istream& in) override;
+  // saves only the consumer of the view key, the format is the same, so load() reads it back
+  void save(std::ostream& os, const Crypto::PublicKey& viewPublicKey);
 
 private:
   Logging::LoggerRef m_logger;
@@ -56,6 +60,8 @@ private:
   // map { view public key -> consumer }
   typedef std::unordered_map<Crypto::PublicKey, std::unique_ptr<TransfersConsumer>> ConsumersContainer;
   ConsumersContainer m_consumers;
+  // reverse index, consumer notifications look up the view key on every event
+  std::unordered_map<IBlockchainConsumer*, Crypto::PublicKey> m_consumerViewKeys;
 
   typedef Tools::ObserverManager<ITransfersSynchronizerObserver> SubscribersNotifier;
   typedef std::unordered_map<Crypto::PublicKey, std::unique_ptr<SubscribersNotifier>> SubscribersContainer;
@@ -73,6 +79,7 @@ private:
   virtual void onTransactionUpdated(IBlockchainConsumer* consumer, const Crypto::Hash& transactionHash,
     const std::vector<ITransfersContainer*>& containers) override;
 
+  void saveConsumers(std::ostream& os, const Crypto::PublicKey* viewPublicKey);
   bool findViewKeyForConsumer(IBlockchainConsumer* consumer, Crypto::PublicKey& viewKey) const;
   SubscribersContainer::const_iterator findSubscriberForConsumer(IBlockchainConsumer* consumer) const;
 };
@@ -17,6 +17,7 @@
 #include <random>
 #include <set>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 
 #include <System/EventLock.h>
@@ -39,6 +40,7 @@
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/TransactionApi.h"
 #include "crypto/crypto.h"
+#include "Serialization/BinaryMemoryInputSerializer.h"
 #include "Transfers/TransfersContainer.h"
 #include "WalletSerializationV1.h"
 #include "WalletSerializationV2.h"
@@ -99,6 +101,41 @@ size_t getTransactionSize(const ITransactionReader& transaction) {
   return transaction.getTransactionData().size();
 }
 
+const uint8_t JOURNAL_TRANSACTION_RECORD = 1;
+const uint8_t JOURNAL_EXTRA_RECORD = 2;
+
+// The journal is folded back into the container snapshot once it outgrows half of the snapshot (but not before it reaches
+// this size), or once the synchronizer has gone this many blocks past the snapshot, which bounds the rescan after a restart
+const uint64_t JOURNAL_COMPACTION_MIN_SIZE = 1024 * 1024;
+const uint32_t JOURNAL_COMPACTION_BLOCK_INTERVAL = 720;
+
+void serializeJournalTransaction(CryptoNote::WalletTransaction& transaction, CryptoNote::ISerializer& serializer) {
+  typedef std::underlying_type<CryptoNote::WalletTransactionState>::type StateType;
+
+  StateType state = static_cast<StateType>(transaction.state);
+  serializer(state, "state");
+  transaction.state = static_cast<CryptoNote::WalletTransactionState>(state);
+
+  serializer(transaction.timestamp, "timestamp");
+  CryptoNote::serializeBlockHeight(serializer, transaction.blockHeight, "blockHeight");
+  serializer(transaction.hash, "hash");
+  serializer(transaction.totalAmount, "totalAmount");
+  serializer(transaction.fee, "fee");
+  serializer(transaction.creationTime, "creationTime");
+  serializer(transaction.unlockTime, "unlockTime");
+  serializer(transaction.extra, "extra");
+  serializer(transaction.isBase, "isBase");
+}
+
+void serializeJournalTransfer(CryptoNote::WalletTransfer& transfer, CryptoNote::ISerializer& serializer) {
+  uint8_t type = static_cast<uint8_t>(transfer.type);
+  serializer(type, "type");
+  transfer.type = static_cast<CryptoNote::WalletTransferType>(type);
+
+  serializer(transfer.address, "address");
+  serializer(transfer.amount, "amount");
+}
+
 uint64_t calculateDonationAmount(uint64_t freeAmount, uint64_t donationThreshold, uint64_t dustThreshold) {
   std::vector<uint64_t> decomposedAmounts;
   decomposeAmount(freeAmount, dustThreshold, decomposedAmounts);
@@ -123,17 +160,29 @@ uint64_t calculateDonationAmount(uint64_t freeAmount, uint64_t donationThreshold
 namespace CryptoNote {
 
 WalletGreen::WalletGreen(System::Dispatcher& dispatcher, const Currency& currency, INode& node, Logging::ILogger& logger, uint32_t transactionSoftLockTime) :
+  WalletGreen(dispatcher, currency, node, nullptr, logger, transactionSoftLockTime) {
+}
+
+WalletGreen::WalletGreen(System::Dispatcher& dispatcher, const Currency& currency, INode& node, WalletSynchronizerHost& syncHost, Logging::ILogger& logger, uint32_t transactionSoftLockTime) :
+  WalletGreen(dispatcher, currency, node, &syncHost, logger, transactionSoftLockTime) {
+}
+
+WalletGreen::WalletGreen(System::Dispatcher& dispatcher, const Currency& currency, INode& node, WalletSynchronizerHost* syncHost, Logging::ILogger& logger, uint32_t transactionSoftLockTime) :
   m_dispatcher(dispatcher),
   m_currency(currency),
   m_node(node),
   m_logger(logger, "WalletGreen/empty"),
   m_stopped(false),
   m_blockchainSynchronizerStarted(false),
-  m_blockchainSynchronizer(node, logger, currency.genesisBlockHash()),
-  m_synchronizer(currency, logger, m_blockchainSynchronizer, node),
+  m_ownSyncHost(syncHost == nullptr ? new WalletSynchronizerHost(dispatcher, currency, node, logger) : nullptr),
+  m_syncHost(syncHost == nullptr ? *m_ownSyncHost : *syncHost),
+  m_blockchainSynchronizer(m_syncHost.getBlockchainSynchronizer()),
+  m_synchronizer(m_syncHost.getTransfersSynchronizer()),
   m_eventOccurred(m_dispatcher),
   m_readyEvent(m_dispatcher),
   m_state(WalletState::NOT_INITIALIZED),
+  m_journalCompactionRequired(false),
+  m_journalSnapshotHeight(0),
   m_actualBalance(0),
   m_pendingBalance(0),
   m_transactionSoftLockTime(transactionSoftLockTime)
@@ -147,6 +196,8 @@ WalletGreen::~WalletGreen() {
     doShutdown();
   }
 
+  m_syncHost.detach(this);
+
   m_dispatcher.yield(); //let remote spawns finish
 }
 
@@ -188,8 +239,12 @@ void WalletGreen::doShutdown() {
   m_blockchainSynchronizer.removeObserver(this);
 
   m_containerStorage.close();
+  m_journal.close();
   m_walletsContainer.clear();
   clearCaches(true, true);
+  m_journalCompactionRequired = false;
+  // other containers of the host carry on without this one
+  m_syncHost.detach(this);
 
   std::queue<WalletEvent> noEvents;
   std::swap(m_events, noEvents);
@@ -223,7 +278,7 @@ void WalletGreen::clearCaches(bool clearTransactions, bool clearCachedData) {
     }
 
     std::vector<AccountPublicAddress> subscriptions;
-    m_synchronizer.getSubscriptions(subscriptions);
+    m_synchronizer.getSubscriptions(m_viewPublicKey, subscriptions);
     std::for_each(subscriptions.begin(), subscriptions.end(), [this](const AccountPublicAddress& address) { m_synchronizer.removeSubscription(address); });
 
     m_uncommitedTransactions.clear();
@@ -233,6 +288,13 @@ void WalletGreen::clearCaches(bool clearTransactions, bool clearCachedData) {
     m_fusionTxsCache.clear();
     m_blockchain.clear();
   }
+
+  // Cancelled transactions are unconfirmed, so none of them is left in the address index
+  m_transactionAddresses.clear();
+
+  // Cleared or cancelled transactions don't raise events, only a new snapshot captures them
+  m_journalPendingTransactions.clear();
+  m_journalCompactionRequired = true;
 }
 
 void WalletGreen::decryptKeyPair(const EncryptedWalletRecord& cipher, PublicKey& publicKey, SecretKey& secretKey,
@@ -241,8 +303,7 @@ void WalletGreen::decryptKeyPair(const EncryptedWalletRecord& cipher, PublicKey&
   std::array<char, sizeof(cipher.data)> buffer;
   chacha8(cipher.data, sizeof(cipher.data), key, cipher.iv, buffer.data());
 
-  MemoryInputStream stream(buffer.data(), buffer.size());
-  BinaryInputStreamSerializer serializer(stream);
+  BinaryMemoryInputSerializer serializer(buffer.data(), buffer.size());
 
   serializer(publicKey, "publicKey");
   serializer(secretKey, "secretKey");
@@ -308,6 +369,7 @@ void WalletGreen::initWithKeys(const std::string& path, const std::string& passw
   }
 
   throwIfStopped();
+  attachToSyncHost(viewPublicKey);
 
   ContainerStorage newStorage(path, Common::FileMappedVectorOpenMode::CREATE, sizeof(ContainerStoragePrefix));
   ContainerStoragePrefix* prefix = reinterpret_cast<ContainerStoragePrefix*>(newStorage.prefix());
@@ -344,10 +406,22 @@ void WalletGreen::save(WalletSaveLevel saveLevel, const std::string& extra) {
   throwIfNotInitialized();
   throwIfStopped();
 
+  if (saveLevel == WalletSaveLevel::SAVE_ALL && !isJournalCompactionRequired()) {
+    try {
+      appendWalletCacheJournal(extra);
+    } catch (const std::exception& e) {
+      m_logger(ERROR, BRIGHT_RED) << "Failed to save container journal: " << e.what();
+      throw;
+    }
+
+    m_logger(INFO, BRIGHT_WHITE) << "Container saved";
+    return;
+  }
+
   stopBlockchainSynchronizer();
 
   try {
-    saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+    compactWalletCache(saveLevel, extra);
   } catch (const std::exception& e) {
     m_logger(ERROR, BRIGHT_RED) << "Failed to save container: " << e.what();
     startBlockchainSynchronizer();
@@ -480,6 +554,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
 
   if (version < WalletSerializerV2::MIN_VERSION) {
     convertAndLoadWalletFile(path, std::move(walletFileStream));
+    attachToSyncHost(m_viewPublicKey);
   } else {
     walletFileStream.close();
 
@@ -496,6 +571,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
         std::unordered_set<Crypto::PublicKey> addedSpendKeys;
         std::unordered_set<Crypto::PublicKey> deletedSpendKeys;
         loadWalletCache(addedSpendKeys, deletedSpendKeys, extra);
+        loadWalletCacheJournal(path, extra);
 
         if (!addedSpendKeys.empty()) {
           m_logger(WARNING, BRIGHT_YELLOW) << "Found addresses not saved in container cache. Resynchronize container";
@@ -509,7 +585,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
         }
 
         if (!addedSpendKeys.empty() || !deletedSpendKeys.empty()) {
-          saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, extra);
+          compactWalletCache(WalletSaveLevel::SAVE_ALL, extra);
         }
       } catch (const std::exception& e) {
         m_logger(ERROR, BRIGHT_RED) << "Failed to load cache: " << e.what() << ", reset wallet data";
@@ -522,7 +598,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
   // Read all output keys cache
   try {
       std::vector<AccountPublicAddress> subscriptionList;
-      m_synchronizer.getSubscriptions(subscriptionList);
+      m_synchronizer.getSubscriptions(m_viewPublicKey, subscriptionList);
       for (auto& addr : subscriptionList) {
           auto sub = m_synchronizer.getSubscription(addr);
           if (sub != nullptr) {
@@ -550,15 +626,22 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
     m_synchronizer.subscribeConsumerNotifications(m_viewPublicKey, this);
     initBlockchain(m_viewPublicKey);
 
+    if (m_journal.recordCount() != 0) {
+      resetUnknownBlockTransactions(static_cast<uint32_t>(m_blockchain.size()));
+    }
+
     startBlockchainSynchronizer();
   } else {
     m_blockchain.push_back(m_currency.genesisBlockHash());
     m_logger(DEBUGGING) << "Add genesis block hash to blockchain";
+    m_syncHost.resume();
   }
 
   m_password = password;
   m_path = path;
   m_extra = extra;
+  m_journalSnapshotHeight = static_cast<uint32_t>(m_blockchain.size());
+  rebuildTransactionAddresses();
 
   m_state = WalletState::INITIALIZED;
   m_logger(INFO, BRIGHT_WHITE) << "Container loaded, view public key " << m_viewPublicKey <<
@@ -583,6 +666,7 @@ void WalletGreen::loadContainerStorage(const std::string& path) {
     decryptKeyPair(prefix->encryptedViewKeys, m_viewPublicKey, m_viewSecretKey, creationTimestamp);
     throwIfKeysMismatch(m_viewSecretKey, m_viewPublicKey, "Restored view public key doesn't correspond to secret key");
     m_logger = Logging::LoggerRef(m_logger.getLogger(), "WalletGreen/" + podToHex(m_viewPublicKey).substr(0, 5));
+    attachToSyncHost(m_viewPublicKey);
 
     loadSpendKeys();
 
@@ -679,6 +763,191 @@ void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chach
   m_logger(DEBUGGING) << "Container saving finished";
 }
 
+void WalletGreen::compactWalletCache(WalletSaveLevel saveLevel, const std::string& extra) {
+  saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+
+  // A crash before the journal is reset leaves it bound to the previous snapshot, so its records are discarded on load
+  Crypto::Hash snapshotDigest = WalletJournal::snapshotDigest(m_containerStorage.suffix(), m_containerStorage.suffixSize());
+  if (m_journal.isOpened()) {
+    m_journal.reset(snapshotDigest);
+  } else {
+    std::vector<BinaryArray> staleRecords;
+    m_journal.open(WalletJournal::journalPath(m_path), m_key, snapshotDigest, staleRecords);
+  }
+
+  m_journalPendingTransactions.clear();
+  // Journal records are applied on top of the snapshot, so they need one that holds every transaction
+  m_journalCompactionRequired = saveLevel != WalletSaveLevel::SAVE_ALL;
+  m_journalSnapshotHeight = static_cast<uint32_t>(m_blockchain.size());
+
+  m_logger(DEBUGGING) << "Container journal compacted";
+}
+
+void WalletGreen::loadWalletCacheJournal(const std::string& path, std::string& extra) {
+  std::vector<BinaryArray> records;
+  m_journal.open(WalletJournal::journalPath(path), m_key,
+    WalletJournal::snapshotDigest(m_containerStorage.suffix(), m_containerStorage.suffixSize()), records);
+
+  for (const auto& record : records) {
+    replayJournalRecord(record, extra);
+  }
+
+  if (!records.empty()) {
+    m_logger(INFO, BRIGHT_WHITE) << "Container journal replayed, records " << records.size();
+  }
+}
+
+void WalletGreen::appendWalletCacheJournal(const std::string& extra) {
+  std::vector<BinaryArray> records;
+  records.reserve(m_journalPendingTransactions.size() + 1);
+
+  for (auto transactionId : m_journalPendingTransactions) {
+    records.emplace_back(makeTransactionJournalRecord(transactionId));
+  }
+
+  if (extra != m_extra) {
+    std::string record;
+    Common::StringOutputStream stream(record);
+    BinaryOutputStreamSerializer serializer(stream);
+
+    uint8_t type = JOURNAL_EXTRA_RECORD;
+    serializer(type, "type");
+    serializer(const_cast<std::string&>(extra), "extra");
+
+    records.emplace_back(record.begin(), record.end());
+  }
+
+  if (!records.empty()) {
+    m_journal.append(records);
+  }
+
+  m_journalPendingTransactions.clear();
+  m_extra = extra;
+
+  m_logger(DEBUGGING) << "Container journal records appended: " << records.size() << ", journal size " << m_journal.size();
+}
+
+bool WalletGreen::isJournalCompactionRequired() const {
+  if (m_journalCompactionRequired || !m_journal.isOpened()) {
+    return true;
+  }
+
+  if (m_journal.size() >= std::max(JOURNAL_COMPACTION_MIN_SIZE, m_containerStorage.suffixSize() / 2)) {
+    return true;
+  }
+
+  return m_blockchain.size() >= static_cast<size_t>(m_journalSnapshotHeight) + JOURNAL_COMPACTION_BLOCK_INTERVAL;
+}
+
+BinaryArray WalletGreen::makeTransactionJournalRecord(size_t transactionId) const {
+  std::string record;
+  Common::StringOutputStream stream(record);
+  BinaryOutputStreamSerializer serializer(stream);
+
+  uint8_t type = JOURNAL_TRANSACTION_RECORD;
+  serializer(type, "type");
+
+  WalletTransaction transaction = m_transactions.get<RandomAccessIndex>()[transactionId];
+  serializeJournalTransaction(transaction, serializer);
+
+  auto range = getTransactionTransfersRange(transactionId);
+  uint64_t transferCount = static_cast<uint64_t>(std::distance(range.first, range.second));
+  serializer(transferCount, "transferCount");
+  for (auto it = range.first; it != range.second; ++it) {
+    WalletTransfer transfer = it->second;
+    serializeJournalTransfer(transfer, serializer);
+  }
+
+  auto uncommitedIt = m_uncommitedTransactions.find(transactionId);
+  bool hasUncommitedTransaction = uncommitedIt != m_uncommitedTransactions.end();
+  serializer(hasUncommitedTransaction, "hasUncommitedTransaction");
+  if (hasUncommitedTransaction) {
+    Transaction uncommitedTransaction = uncommitedIt->second;
+    serializer(uncommitedTransaction, "uncommitedTransaction");
+  }
+
+  return BinaryArray(record.begin(), record.end());
+}
+
+void WalletGreen::replayJournalRecord(const BinaryArray& record, std::string& extra) {
+  BinaryMemoryInputSerializer serializer(record.data(), record.size());
+
+  uint8_t type;
+  serializer(type, "type");
+  if (type == JOURNAL_EXTRA_RECORD) {
+    serializer(extra, "extra");
+    return;
+  }
+
+  if (type != JOURNAL_TRANSACTION_RECORD) {
+    throw std::runtime_error("Unknown container journal record type " + std::to_string(type));
+  }
+
+  WalletTransaction transaction;
+  serializeJournalTransaction(transaction, serializer);
+
+  uint64_t transferCount;
+  serializer(transferCount, "transferCount");
+  std::vector<WalletTransfer> transfers;
+  for (uint64_t i = 0; i < transferCount; ++i) {
+    WalletTransfer transfer;
+    serializeJournalTransfer(transfer, serializer);
+    transfers.emplace_back(std::move(transfer));
+  }
+
+  bool hasUncommitedTransaction;
+  serializer(hasUncommitedTransaction, "hasUncommitedTransaction");
+  Transaction uncommitedTransaction;
+  if (hasUncommitedTransaction) {
+    serializer(uncommitedTransaction, "uncommitedTransaction");
+  }
+
+  size_t transactionId;
+  auto& hashIndex = m_transactions.get<TransactionIndex>();
+  auto it = hashIndex.find(transaction.hash);
+  if (it != hashIndex.end()) {
+    transactionId = std::distance(m_transactions.get<RandomAccessIndex>().begin(), m_transactions.project<RandomAccessIndex>(it));
+    hashIndex.replace(it, transaction);
+  } else if (transaction.state == WalletTransactionState::DELETED) {
+    // Snapshots don't keep deleted transactions either
+    return;
+  } else {
+    transactionId = m_transactions.size();
+    m_transactions.get<RandomAccessIndex>().push_back(std::move(transaction));
+  }
+
+  auto range = std::equal_range(m_transfers.begin(), m_transfers.end(), std::make_pair(transactionId, WalletTransfer()),
+    [] (const TransactionTransferPair& a, const TransactionTransferPair& b) { return a.first < b.first; });
+  auto insertIt = m_transfers.erase(range.first, range.second);
+  for (auto& transfer : transfers) {
+    insertIt = std::next(m_transfers.emplace(insertIt, transactionId, std::move(transfer)));
+  }
+
+  if (hasUncommitedTransaction) {
+    m_uncommitedTransactions[transactionId] = std::move(uncommitedTransaction);
+  } else {
+    m_uncommitedTransactions.erase(transactionId);
+  }
+
+  m_fusionTxsCache.erase(transactionId);
+}
+
+void WalletGreen::resetUnknownBlockTransactions(uint32_t knownBlockCount) {
+  // Journaled transactions can be confirmed in blocks the restored synchronizer state has not reached yet.
+  // They stay unconfirmed until the synchronizer catches up and reports them again
+  auto& heightIndex = m_transactions.get<BlockHeightIndex>();
+  std::vector<WalletTransactions::index<RandomAccessIndex>::type::iterator> unknownBlockTransactions;
+  for (auto it = heightIndex.lower_bound(knownBlockCount); it != heightIndex.lower_bound(WALLET_UNCONFIRMED_TRANSACTION_HEIGHT); ++it) {
+    unknownBlockTransactions.push_back(m_transactions.project<RandomAccessIndex>(it));
+  }
+
+  for (auto it : unknownBlockTransactions) {
+    m_transactions.get<RandomAccessIndex>().modify(it, [](WalletTransaction& transaction) {
+      transaction.blockHeight = WALLET_UNCONFIRMED_TRANSACTION_HEIGHT;
+    });
+  }
+}
+
 void WalletGreen::copyContainerStorageKeys(ContainerStorage& src, const chacha8_key& srcKey, ContainerStorage& dst, const chacha8_key& dstKey) {
   m_logger(DEBUGGING) << "Copying wallet keys...";
   dst.reserve(src.size());
@@ -747,8 +1016,7 @@ void WalletGreen::encryptAndSaveContainerData(ContainerStorage& storage, const C
 }
 
 void WalletGreen::loadAndDecryptContainerData(ContainerStorage& storage, const Crypto::chacha8_key& key, BinaryArray& containerData) {
-  Common::MemoryInputStream suffixStream(storage.suffix(), storage.suffixSize());
-  BinaryInputStreamSerializer suffixSerializer(suffixStream);
+  BinaryMemoryInputSerializer suffixSerializer(storage.suffix(), storage.suffixSize());
   Crypto::chacha8_iv suffixIv;
   BinaryArray encryptedContainer;
   suffixSerializer(suffixIv, "suffixIv");
@@ -764,7 +1032,7 @@ void WalletGreen::initTransactionPool() {
     [](const UncommitedTransactions::value_type& pair) {
       return getObjectHash(pair.second);
     });
-  m_synchronizer.initTransactionPool(uncommitedTransactionsSet);
+  m_synchronizer.initTransactionPool(m_viewPublicKey, uncommitedTransactionsSet);
 }
 
 void WalletGreen::deleteOrphanTransactions(const std::unordered_set<Crypto::PublicKey>& deletedKeys) {
@@ -844,7 +1112,7 @@ void WalletGreen::subscribeWallets() {
     m_logger(ERROR, BRIGHT_RED) << "Failed to subscribe wallets: " << e.what();
 
     std::vector<AccountPublicAddress> subscriptionList;
-    m_synchronizer.getSubscriptions(subscriptionList);
+    m_synchronizer.getSubscriptions(m_viewPublicKey, subscriptionList);
     for (auto& subscription : subscriptionList) {
       m_synchronizer.removeSubscription(subscription);
     }
@@ -932,17 +1200,45 @@ void WalletGreen::changePassword(const std::string& oldPassword, const std::stri
   Crypto::chacha8_key newKey;
   Crypto::generate_chacha8_key(cnContext, newPassword, newKey);
 
-  m_containerStorage.atomicUpdate([this, newKey](ContainerStorage& newStorage) {
+  // Journal records are folded into the new snapshot, so they are replaced together with the container.
+  // A crash before the journal is reopened leaves it bound to the previous snapshot, and its records are discarded on load
+  bool foldJournal = m_journal.isOpened() && m_journal.recordCount() != 0;
+  if (foldJournal) {
+    stopBlockchainSynchronizer();
+  }
+
+  Tools::ScopeExit synchronizerStarter([this, foldJournal] {
+    if (foldJournal) {
+      startBlockchainSynchronizer();
+    }
+  });
+
+  m_containerStorage.atomicUpdate([this, newKey, foldJournal](ContainerStorage& newStorage) {
     copyContainerStoragePrefix(m_containerStorage, m_key, newStorage, newKey);
     copyContainerStorageKeys(m_containerStorage, m_key, newStorage, newKey);
 
-    if (m_containerStorage.suffixSize() > 0) {
+    if (foldJournal) {
+      saveWalletCache(newStorage, newKey, WalletSaveLevel::SAVE_ALL, m_extra);
+    } else if (m_containerStorage.suffixSize() > 0) {
       BinaryArray containerData;
       loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
       encryptAndSaveContainerData(newStorage, newKey, containerData.data(), containerData.size());
     }
   });
 
+  if (m_journal.isOpened()) {
+    m_journal.close();
+    std::vector<BinaryArray> staleRecords;
+    m_journal.open(WalletJournal::journalPath(m_path), newKey,
+      WalletJournal::snapshotDigest(m_containerStorage.suffix(), m_containerStorage.suffixSize()), staleRecords);
+  }
+
+  if (foldJournal) {
+    m_journalPendingTransactions.clear();
+    m_journalCompactionRequired = false;
+    m_journalSnapshotHeight = static_cast<uint32_t>(m_blockchain.size());
+  }
+
   m_key = newKey;
   m_password = newPassword;
 
@@ -1093,6 +1389,7 @@ std::vector<std::string> WalletGreen::doCreateAddressList(const std::vector<NewA
     }
 
     m_containerStorage.setAutoFlush(true);
+    m_journalCompactionRequired = true;
     auto currentTime = static_cast<uint64_t>(time(nullptr));
     if (minCreationTimestamp + m_currency.blockFutureTimeLimit() < currentTime) {
       m_logger(DEBUGGING) << "Reset is required";
@@ -1219,15 +1516,20 @@ void WalletGreen::deleteAddress(const std::string& address) {
   std::vector<size_t> deletedTransactions;
   std::vector<size_t> updatedTransactions = deleteTransfersForAddress(address, deletedTransactions);
   deleteFromUncommitedTransactions(deletedTransactions);
+  rebuildTransactionAddresses();
 
   m_walletsContainer.get<KeysIndex>().erase(it);
   m_logger(DEBUGGING) << "Wallet count " << m_walletsContainer.size();
 
+  // Transactions left without transfers are deleted silently, and the snapshot key list is out of date
+  m_journalCompactionRequired = true;
+
   if (m_walletsContainer.get<RandomAccessIndex>().size() != 0) {
     startBlockchainSynchronizer();
   } else {
     m_blockchain.clear();
     m_blockchain.push_back(m_currency.genesisBlockHash());
+    m_syncHost.resume();
   }
 
   for (auto transactionId: updatedTransactions) {
@@ -1735,6 +2037,7 @@ void WalletGreen::rollbackUncommitedTransaction(size_t transactionId) {
 
   removeUnconfirmedTransaction(getObjectHash(m_uncommitedTransactions[transactionId]));
   m_uncommitedTransactions.erase(transactionId);
+  m_journalPendingTransactions.insert(transactionId);
 
   m_logger(INFO, BRIGHT_WHITE) << "Delayed transaction rolled back, ID " << transactionId << ", hash " << m_transactions[transactionId].hash;
 }
@@ -2423,15 +2726,11 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(const Crypto::
   throwIfNotInitialized();
   throwIfStopped();
 
-  auto& hashIndex = m_blockchain.get<BlockHashIndex>();
-  auto it = hashIndex.find(blockHash);
-  if (it == hashIndex.end()) {
+  uint32_t blockIndex;
+  if (!findBlockIndex(blockHash, blockIndex)) {
     return std::vector<TransactionsInBlockInfo>();
   }
 
-  auto heightIt = m_blockchain.project<BlockHeightIndex>(it);
-
-  uint32_t blockIndex = static_cast<uint32_t>(std::distance(m_blockchain.get<BlockHeightIndex>().begin(), heightIt));
   return getTransactionsInBlocks(blockIndex, count);
 }
 
@@ -2442,6 +2741,37 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(uint32_t block
   return getTransactionsInBlocks(blockIndex, count);
 }
 
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(const std::vector<std::string>& addresses, const Crypto::Hash& blockHash, size_t count) const {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  uint32_t blockIndex;
+  if (!findBlockIndex(blockHash, blockIndex)) {
+    return std::vector<TransactionsInBlockInfo>();
+  }
+
+  return getTransactionsInBlocks(addresses, blockIndex, count);
+}
+
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  return getTransactionsInBlocks(addresses, blockIndex, count);
+}
+
+bool WalletGreen::findBlockIndex(const Crypto::Hash& blockHash, uint32_t& blockIndex) const {
+  auto& hashIndex = m_blockchain.get<BlockHashIndex>();
+  auto it = hashIndex.find(blockHash);
+  if (it == hashIndex.end()) {
+    return false;
+  }
+
+  auto heightIt = m_blockchain.project<BlockHeightIndex>(it);
+  blockIndex = static_cast<uint32_t>(std::distance(m_blockchain.get<BlockHeightIndex>().begin(), heightIt));
+  return true;
+}
+
 std::vector<Crypto::Hash> WalletGreen::getBlockHashes(uint32_t blockIndex, size_t count) const {
   throwIfNotInitialized();
   throwIfStopped();
@@ -2720,6 +3050,10 @@ void WalletGreen::transactionUpdated(const TransactionInformation& transactionIn
     static_cast<int64_t>(transactionInfo.totalAmountOut));
   updated |= transfersUpdated;
 
+  if (isNew || updated) {
+    updateTransactionAddresses(transactionId);
+  }
+
   if (isNew) {
     const auto& tx = m_transactions[transactionId];
     m_logger(INFO, BRIGHT_WHITE) << "New transaction received, ID " << transactionId <<
@@ -2741,6 +3075,13 @@ void WalletGreen::transactionUpdated(const TransactionInformation& transactionIn
 }
 
 void WalletGreen::pushEvent(const WalletEvent& event) {
+  // Every change to a transaction or its transfers is announced with one of these events
+  if (event.type == WalletEventType::TRANSACTION_CREATED) {
+    m_journalPendingTransactions.insert(event.transactionCreated.transactionIndex);
+  } else if (event.type == WalletEventType::TRANSACTION_UPDATED) {
+    m_journalPendingTransactions.insert(event.transactionUpdated.transactionIndex);
+  }
+
   m_events.push(event);
   m_eventOccurred.set();
 }
@@ -2797,6 +3138,8 @@ void WalletGreen::transactionDeleted(ITransfersSubscription* object, const Hash&
 
   if (updated) {
     auto transactionId = getTransactionId(transactionHash);
+    updateTransactionAddresses(transactionId);
+
     auto tx = m_transactions[transactionId];
     m_logger(INFO, BRIGHT_WHITE) << "Transaction deleted, ID " << transactionId <<
       ", hash " << transactionHash <<
@@ -2818,24 +3161,24 @@ void WalletGreen::deleteUnlockTransactionJob(const Hash& transactionHash) {
   index.erase(transactionHash);
 }
 
+void WalletGreen::attachToSyncHost(const Crypto::PublicKey& viewPublicKey) {
+  if (!m_syncHost.attach(this, viewPublicKey)) {
+    m_logger(ERROR, BRIGHT_RED) << "View key " << viewPublicKey << " is used by another container of the synchronizer host";
+    throw std::system_error(make_error_code(error::ADDRESS_ALREADY_EXISTS), "View key is used by another container");
+  }
+}
+
 void WalletGreen::startBlockchainSynchronizer() {
   if (!m_walletsContainer.empty() && !m_blockchainSynchronizerStarted) {
-    m_logger(DEBUGGING) << "Starting BlockchainSynchronizer";
-    m_blockchainSynchronizer.start();
+    m_syncHost.start(this);
     m_blockchainSynchronizerStarted = true;
   }
 }
 
 void WalletGreen::stopBlockchainSynchronizer() {
-  if (m_blockchainSynchronizerStarted) {
-    m_logger(DEBUGGING) << "Stopping BlockchainSynchronizer";
-    System::RemoteContext<void> stopContext(m_dispatcher, [this] () {
-      m_blockchainSynchronizer.stop();
-    });
-    stopContext.get();
-
-    m_blockchainSynchronizerStarted = false;
-  }
+  // a shared synchronizer may run for other containers, so it's stopped even if this one hasn't started it
+  m_syncHost.stop(this);
+  m_blockchainSynchronizerStarted = false;
 }
 
 void WalletGreen::addUnconfirmedTransaction(const ITransactionReader& transaction) {
@@ -3282,6 +3625,83 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32
   return result;
 }
 
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const {
+  if (count == 0) {
+    m_logger(ERROR, BRIGHT_RED) << "Bad argument: block count must be greater than zero";
+    throw std::system_error(make_error_code(error::WRONG_PARAMETERS), "blocks count must be greater than zero");
+  }
+
+  std::vector<TransactionsInBlockInfo> result;
+
+  if (blockIndex >= m_blockchain.size()) {
+    return result;
+  }
+
+  uint32_t stopIndex = static_cast<uint32_t>(std::min(m_blockchain.size(), blockIndex + count));
+
+  result.resize(stopIndex - blockIndex);
+  for (uint32_t height = blockIndex; height < stopIndex; ++height) {
+    result[height - blockIndex].blockHash = m_blockchain[height];
+  }
+
+  // A transaction can touch several of the requested addresses, so ids are collected and deduplicated first
+  std::vector<std::pair<uint32_t, size_t>> found;
+  auto& addressIndex = m_transactionAddresses.get<AddressBlockHeightIndex>();
+  for (const auto& address : std::set<std::string>(addresses.begin(), addresses.end())) {
+    auto it = addressIndex.lower_bound(boost::make_tuple(address, blockIndex));
+    auto end = addressIndex.lower_bound(boost::make_tuple(address, stopIndex));
+    for (; it != end; ++it) {
+      found.emplace_back(it->blockHeight, it->transactionId);
+    }
+  }
+
+  std::sort(found.begin(), found.end());
+  found.erase(std::unique(found.begin(), found.end()), found.end());
+
+  auto& transactionIdIndex = m_transactions.get<RandomAccessIndex>();
+  for (const auto& heightAndId : found) {
+    const WalletTransaction& transaction = transactionIdIndex[heightAndId.second];
+    if (transaction.state != WalletTransactionState::SUCCEEDED) {
+      continue;
+    }
+
+    WalletTransactionWithTransfers transactionWithTransfers;
+    transactionWithTransfers.transaction = transaction;
+    transactionWithTransfers.transfers = getTransactionTransfers(transaction);
+
+    result[heightAndId.first - blockIndex].transactions.emplace_back(std::move(transactionWithTransfers));
+  }
+
+  return result;
+}
+
+void WalletGreen::updateTransactionAddresses(size_t transactionId) {
+  m_transactionAddresses.get<TransactionIdIndex>().erase(transactionId);
+
+  const WalletTransaction& transaction = m_transactions.get<RandomAccessIndex>()[transactionId];
+  if (transaction.blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT) {
+    return;
+  }
+
+  auto range = getTransactionTransfersRange(transactionId);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (!it->second.address.empty()) {
+      // The index is unique, repeated addresses of the same transaction are dropped here
+      m_transactionAddresses.insert({ it->second.address, transaction.blockHeight, transactionId });
+    }
+  }
+}
+
+void WalletGreen::rebuildTransactionAddresses() {
+  m_transactionAddresses.clear();
+
+  for (size_t transactionId = 0; transactionId < m_transactions.size(); ++transactionId) {
+    updateTransactionAddresses(transactionId);
+  }
+
+  m_logger(DEBUGGING) << "Transaction address index rebuilt, records " << m_transactionAddresses.size();
+}
+
 Crypto::Hash WalletGreen::getBlockHashByIndex(uint32_t blockIndex) const {
   assert(blockIndex < m_blockchain.size());
   return m_blockchain.get<BlockHeightIndex>()[blockIndex];
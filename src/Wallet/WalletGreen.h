@@ -20,10 +20,13 @@
 #include "IWallet.h"
 
 #include <queue>
+#include <set>
 #include <unordered_map>
 
 #include "IFusionManager.h"
 #include "WalletIndices.h"
+#include "WalletJournal.h"
+#include "WalletSynchronizerHost.h"
 
 #include "Logging/LoggerRef.h"
 #include <System/Dispatcher.h>
@@ -40,6 +43,8 @@ class WalletGreen : public IWallet,
                     public IFusionManager {
 public:
   WalletGreen(System::Dispatcher& dispatcher, const Currency& currency, INode& node, Logging::ILogger& logger, uint32_t transactionSoftLockTime = 1);
+  // The container scans blocks through syncHost, together with the other containers attached to it
+  WalletGreen(System::Dispatcher& dispatcher, const Currency& currency, INode& node, WalletSynchronizerHost& syncHost, Logging::ILogger& logger, uint32_t transactionSoftLockTime = 1);
   virtual ~WalletGreen();
 
   virtual void initialize(const std::string& path, const std::string& password) override;
@@ -77,6 +82,8 @@ public:
   virtual WalletTransactionWithTransfers getTransaction(const Crypto::Hash& transactionHash) const override;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count) const override;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, const Crypto::Hash& blockHash, size_t count) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const override;
   virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t blockIndex, size_t count) const override;
   virtual uint32_t getBlockCount() const override;
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const override;
@@ -98,6 +105,8 @@ public:
   virtual IFusionManager::EstimateResult estimate(uint64_t threshold, const std::vector<std::string>& sourceAddresses = {}) const override;
 
 protected:
+  WalletGreen(System::Dispatcher& dispatcher, const Currency& currency, INode& node, WalletSynchronizerHost* syncHost, Logging::ILogger& logger, uint32_t transactionSoftLockTime);
+
   struct NewAddressData {
     Crypto::PublicKey spendPublicKey;
     Crypto::SecretKey spendSecretKey;
@@ -285,6 +294,7 @@ protected:
   void pushBackOutgoingTransfers(size_t txId, const std::vector<WalletTransfer>& destinations);
   void insertUnlockTransactionJob(const Crypto::Hash& transactionHash, uint32_t blockHeight, CryptoNote::ITransfersContainer* container);
   void deleteUnlockTransactionJob(const Crypto::Hash& transactionHash);
+  void attachToSyncHost(const Crypto::PublicKey& viewPublicKey);
   void startBlockchainSynchronizer();
   void stopBlockchainSynchronizer();
   void addUnconfirmedTransaction(const ITransactionReader& transaction);
@@ -300,6 +310,13 @@ protected:
   void loadContainerStorage(const std::string& path);
   void loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKeys, std::unordered_set<Crypto::PublicKey>& deletedKeys, std::string& extra);
   void saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletSaveLevel saveLevel, const std::string& extra);
+  void compactWalletCache(WalletSaveLevel saveLevel, const std::string& extra);
+  void loadWalletCacheJournal(const std::string& path, std::string& extra);
+  void appendWalletCacheJournal(const std::string& extra);
+  bool isJournalCompactionRequired() const;
+  BinaryArray makeTransactionJournalRecord(size_t transactionId) const;
+  void replayJournalRecord(const BinaryArray& record, std::string& extra);
+  void resetUnknownBlockTransactions(uint32_t knownBlockCount);
   void subscribeWallets();
 
   std::vector<OutputToTransfer> pickRandomFusionInputs(const std::vector<std::string>& addresses,
@@ -321,6 +338,10 @@ protected:
 
   TransfersRange getTransactionTransfersRange(size_t transactionIndex) const;
   std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(uint32_t blockIndex, size_t count) const;
+  std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const;
+  bool findBlockIndex(const Crypto::Hash& blockHash, uint32_t& blockIndex) const;
+  void updateTransactionAddresses(size_t transactionId);
+  void rebuildTransactionAddresses();
   Crypto::Hash getBlockHashByIndex(uint32_t blockIndex) const;
 
   std::vector<WalletTransfer> getTransactionTransfers(const WalletTransaction& transaction) const;
@@ -344,12 +365,15 @@ protected:
   UnlockTransactionJobs m_unlockTransactionsJob;
   WalletTransactions m_transactions;
   WalletTransfers m_transfers; //sorted
+  TransactionAddresses m_transactionAddresses; // transfer addresses of confirmed transactions
   mutable std::unordered_map<size_t, bool> m_fusionTxsCache; // txIndex -> isFusion
   UncommitedTransactions m_uncommitedTransactions;
 
   bool m_blockchainSynchronizerStarted;
-  BlockchainSynchronizer m_blockchainSynchronizer;
-  TransfersSyncronizer m_synchronizer;
+  std::unique_ptr<WalletSynchronizerHost> m_ownSyncHost;
+  WalletSynchronizerHost& m_syncHost;
+  BlockchainSynchronizer& m_blockchainSynchronizer;
+  TransfersSyncronizer& m_synchronizer;
 
   System::Event m_eventOccurred;
   std::queue<WalletEvent> m_events;
@@ -362,6 +386,11 @@ protected:
   std::string m_path;
   std::string m_extra; // workaround for wallet reset
 
+  WalletJournal m_journal;
+  std::set<size_t> m_journalPendingTransactions; // changed since the last save, in id order so replay appends in the same order
+  bool m_journalCompactionRequired;
+  uint32_t m_journalSnapshotHeight;
+
   Crypto::PublicKey m_viewPublicKey;
   Crypto::SecretKey m_viewSecretKey;
 
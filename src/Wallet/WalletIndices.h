@@ -66,6 +66,9 @@ struct TransactionHashIndex {};
 struct TransactionIndex {};
 struct BlockHashIndex {};
 
+struct AddressBlockHeightIndex {};
+struct TransactionIdIndex {};
+
 typedef boost::multi_index_container <
   WalletRecord,
   boost::multi_index::indexed_by <
@@ -108,6 +111,29 @@ typedef boost::multi_index_container <
   >
 > WalletTransactions;
 
+struct TransactionAddressRecord {
+  std::string address;
+  uint32_t blockHeight;
+  size_t transactionId;
+};
+
+typedef boost::multi_index_container <
+  TransactionAddressRecord,
+  boost::multi_index::indexed_by <
+    boost::multi_index::ordered_unique < boost::multi_index::tag <AddressBlockHeightIndex>,
+      boost::multi_index::composite_key <
+        TransactionAddressRecord,
+        BOOST_MULTI_INDEX_MEMBER(TransactionAddressRecord, std::string, address),
+        BOOST_MULTI_INDEX_MEMBER(TransactionAddressRecord, uint32_t, blockHeight),
+        BOOST_MULTI_INDEX_MEMBER(TransactionAddressRecord, size_t, transactionId)
+      >
+    >,
+    boost::multi_index::hashed_non_unique < boost::multi_index::tag <TransactionIdIndex>,
+      BOOST_MULTI_INDEX_MEMBER(TransactionAddressRecord, size_t, transactionId)
+    >
+  >
+> TransactionAddresses;
+
 typedef Common::FileMappedVector<EncryptedWalletRecord> ContainerStorage;
 typedef std::pair<size_t, CryptoNote::WalletTransfer> TransactionTransferPair;
 typedef std::vector<TransactionTransferPair> WalletTransfers;
@@ -0,0 +1,251 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "WalletJournal.h"
+
+#include <cassert>
+#include <cstring>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include "crypto/crypto.h"
+
+namespace CryptoNote {
+
+namespace {
+
+// std::ofstream::flush() only hands the data over to the OS, a saved record has to reach the disk before save() returns
+bool syncFile(const std::string& path) {
+#ifdef _WIN32
+  HANDLE file = ::CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  bool synced = ::FlushFileBuffers(file) != 0;
+  ::CloseHandle(file);
+  return synced;
+#else
+  int file = ::open(path.c_str(), O_WRONLY);
+  if (file == -1) {
+    return false;
+  }
+
+  bool synced = ::fsync(file) == 0;
+  ::close(file);
+  return synced;
+#endif
+}
+
+}
+
+WalletJournal::WalletJournal() : m_size(0), m_recordCount(0) {
+}
+
+WalletJournal::~WalletJournal() {
+  close();
+}
+
+std::string WalletJournal::journalPath(const std::string& containerPath) {
+  return containerPath + ".journal";
+}
+
+Crypto::Hash WalletJournal::snapshotDigest(const uint8_t* snapshot, size_t snapshotSize) {
+  return Crypto::cn_fast_hash(snapshot, snapshotSize);
+}
+
+void WalletJournal::open(const std::string& path, const Crypto::chacha8_key& key, const Crypto::Hash& snapshotDigest, std::vector<BinaryArray>& records) {
+  assert(!isOpened());
+
+  m_path = path;
+  m_key = key;
+  records.clear();
+
+  boost::system::error_code ec;
+  uint64_t fileSize = boost::filesystem::file_size(m_path, ec);
+  if (ec || fileSize < sizeof(Header)) {
+    reset(snapshotDigest);
+    return;
+  }
+
+  std::ifstream input(m_path, std::ios_base::binary);
+  Header header;
+  if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.version != VERSION || header.snapshotDigest != snapshotDigest) {
+    input.close();
+    reset(snapshotDigest);
+    return;
+  }
+
+  uint64_t validSize = readRecords(input, fileSize, records);
+  input.close();
+
+  if (validSize != fileSize) {
+    boost::filesystem::resize_file(m_path, validSize);
+  }
+
+  m_size = validSize;
+  m_recordCount = records.size();
+  openForAppend();
+}
+
+void WalletJournal::close() {
+  if (m_stream.is_open()) {
+    m_stream.close();
+  }
+
+  m_size = 0;
+  m_recordCount = 0;
+}
+
+bool WalletJournal::isOpened() const {
+  return m_stream.is_open();
+}
+
+void WalletJournal::reset(const Crypto::Hash& snapshotDigest) {
+  if (m_stream.is_open()) {
+    m_stream.close();
+  }
+
+  std::ofstream output(m_path, std::ios_base::binary | std::ios_base::trunc);
+  writeHeader(output, snapshotDigest);
+  output.flush();
+  output.close();
+  if (!output || !syncFile(m_path)) {
+    throw std::system_error(std::make_error_code(std::errc::io_error), "Failed to reset wallet journal " + m_path);
+  }
+
+  m_size = sizeof(Header);
+  m_recordCount = 0;
+  openForAppend();
+}
+
+void WalletJournal::append(const std::vector<BinaryArray>& records) {
+  assert(isOpened());
+
+  uint64_t appended = 0;
+  for (const auto& record : records) {
+    appended += writeRecord(m_stream, m_key, record);
+  }
+
+  m_stream.flush();
+  if (!m_stream || !syncFile(m_path)) {
+    // Cut off whatever part of the batch has reached the file, so later appends don't land behind a torn record
+    m_stream.close();
+    boost::system::error_code ignore;
+    boost::filesystem::resize_file(m_path, m_size, ignore);
+    openForAppend();
+
+    throw std::system_error(std::make_error_code(std::errc::io_error), "Failed to append to wallet journal " + m_path);
+  }
+
+  m_size += appended;
+  m_recordCount += records.size();
+}
+
+uint64_t WalletJournal::size() const {
+  return m_size;
+}
+
+size_t WalletJournal::recordCount() const {
+  return m_recordCount;
+}
+
+uint32_t WalletJournal::recordChecksum(const RecordHeader& header, const uint8_t* data) {
+  BinaryArray buffer(sizeof(header) + header.size);
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  std::memcpy(buffer.data() + sizeof(header), data, header.size);
+
+  Crypto::Hash hash = Crypto::cn_fast_hash(buffer.data(), buffer.size());
+  uint32_t checksum;
+  std::memcpy(&checksum, &hash, sizeof(checksum));
+  return checksum;
+}
+
+void WalletJournal::writeHeader(std::ostream& stream, const Crypto::Hash& snapshotDigest) {
+  Header header;
+  header.version = VERSION;
+  header.snapshotDigest = snapshotDigest;
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+uint64_t WalletJournal::writeRecord(std::ostream& stream, const Crypto::chacha8_key& key, const BinaryArray& record) {
+  RecordHeader header;
+  header.size = static_cast<uint32_t>(record.size());
+  header.iv = Crypto::rand<Crypto::chacha8_iv>();
+
+  BinaryArray encrypted(record.size());
+  Crypto::chacha8(record.data(), record.size(), key, header.iv, reinterpret_cast<char*>(encrypted.data()));
+  uint32_t checksum = recordChecksum(header, encrypted.data());
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(reinterpret_cast<const char*>(encrypted.data()), encrypted.size());
+  stream.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+  return sizeof(header) + encrypted.size() + sizeof(checksum);
+}
+
+uint64_t WalletJournal::readRecords(std::istream& stream, uint64_t fileSize, std::vector<BinaryArray>& records) const {
+  uint64_t offset = sizeof(Header);
+
+  for (;;) {
+    RecordHeader header;
+    if (fileSize - offset < sizeof(header) + sizeof(uint32_t) || !stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+      break;
+    }
+
+    if (header.size > fileSize - offset - sizeof(header) - sizeof(uint32_t)) {
+      break;
+    }
+
+    BinaryArray encrypted(header.size);
+    uint32_t checksum;
+    if (!stream.read(reinterpret_cast<char*>(encrypted.data()), encrypted.size()) ||
+        !stream.read(reinterpret_cast<char*>(&checksum), sizeof(checksum)) ||
+        checksum != recordChecksum(header, encrypted.data())) {
+      break;
+    }
+
+    BinaryArray record(header.size);
+    Crypto::chacha8(encrypted.data(), encrypted.size(), m_key, header.iv, reinterpret_cast<char*>(record.data()));
+    records.emplace_back(std::move(record));
+
+    offset += sizeof(header) + header.size + sizeof(checksum);
+  }
+
+  return offset;
+}
+
+void WalletJournal::openForAppend() {
+  m_stream.open(m_path, std::ios_base::binary | std::ios_base::app);
+  if (!m_stream) {
+    throw std::system_error(std::make_error_code(std::errc::io_error), "Failed to open wallet journal " + m_path);
+  }
+}
+
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CryptoNote.h"
+#include "crypto/chacha8.h"
+#include "crypto/hash.h"
+
+namespace CryptoNote {
+
+// Append-only log of encrypted wallet cache records, layered on top of the container snapshot.
+// The journal header stores the digest of the snapshot the records apply to, so records left over from an
+// older snapshot are discarded on open. Every record carries its own IV and checksum, an incomplete or damaged
+// tail left by an interrupted append is cut off on open.
+class WalletJournal {
+public:
+  WalletJournal();
+  WalletJournal(const WalletJournal&) = delete;
+  WalletJournal& operator=(const WalletJournal&) = delete;
+  ~WalletJournal();
+
+  static std::string journalPath(const std::string& containerPath);
+  static Crypto::Hash snapshotDigest(const uint8_t* snapshot, size_t snapshotSize);
+
+  void open(const std::string& path, const Crypto::chacha8_key& key, const Crypto::Hash& snapshotDigest, std::vector<BinaryArray>& records);
+  void close();
+  bool isOpened() const;
+
+  // Drops all records and binds the journal to a new snapshot
+  void reset(const Crypto::Hash& snapshotDigest);
+
+  void append(const std::vector<BinaryArray>& records);
+
+  uint64_t size() const;
+  size_t recordCount() const;
+
+  static const uint8_t VERSION = 1;
+
+private:
+#pragma pack(push, 1)
+  struct Header {
+    uint8_t version;
+    Crypto::Hash snapshotDigest;
+  };
+
+  struct RecordHeader {
+    uint32_t size;
+    Crypto::chacha8_iv iv;
+  };
+#pragma pack(pop)
+
+  static uint32_t recordChecksum(const RecordHeader& header, const uint8_t* data);
+  static void writeHeader(std::ostream& stream, const Crypto::Hash& snapshotDigest);
+  static uint64_t writeRecord(std::ostream& stream, const Crypto::chacha8_key& key, const BinaryArray& record);
+  uint64_t readRecords(std::istream& stream, uint64_t fileSize, std::vector<BinaryArray>& records) const;
+  void openForAppend();
+
+  std::string m_path;
+  Crypto::chacha8_key m_key;
+  std::ofstream m_stream;
+  uint64_t m_size;
+  size_t m_recordCount;
+};
+
+}
@@ -129,6 +129,7 @@ WalletSerializerV2::WalletSerializerV2(
   uint32_t transactionSoftLockTime
 ) :
   m_transfersObserver(transfersObserver),
+  m_viewPublicKey(viewPublicKey),
   m_actualBalance(actualBalance),
   m_pendingBalance(pendingBalance),
   m_walletsContainer(walletsContainer),
@@ -334,7 +335,8 @@ void WalletSerializerV2::loadTransfersSynchronizer(CryptoNote::ISerializer& seri
 
 void WalletSerializerV2::saveTransfersSynchronizer(CryptoNote::ISerializer& serializer) {
   std::stringstream stream;
-  m_synchronizer.save(stream);
+  // the synchronizer may be shared with other containers, only this container's consumer goes to the file
+  m_synchronizer.save(stream, m_viewPublicKey);
   stream.flush();
 
   std::string transfersSynchronizerData = stream.str();
@@ -69,6 +69,7 @@ private:
   void saveUnlockTransactionsJobs(CryptoNote::ISerializer& serializer);
 
   ITransfersObserver& m_transfersObserver;
+  const Crypto::PublicKey& m_viewPublicKey;
   uint64_t& m_actualBalance;
   uint64_t& m_pendingBalance;
   WalletsContainer& m_walletsContainer;
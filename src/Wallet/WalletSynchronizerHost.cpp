@@ -0,0 +1,96 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "WalletSynchronizerHost.h"
+
+#include <System/RemoteContext.h>
+
+#include "Common/StringTools.h"
+#include "CryptoNoteCore/Currency.h"
+
+using namespace Logging;
+
+namespace CryptoNote {
+
+WalletSynchronizerHost::WalletSynchronizerHost(System::Dispatcher& dispatcher, const Currency& currency, INode& node, Logging::ILogger& logger) :
+  m_dispatcher(dispatcher),
+  m_logger(logger, "WalletSynchronizerHost"),
+  m_blockchainSynchronizer(node, logger, currency.genesisBlockHash()),
+  m_transfersSynchronizer(currency, logger, m_blockchainSynchronizer, node),
+  m_started(false) {
+}
+
+BlockchainSynchronizer& WalletSynchronizerHost::getBlockchainSynchronizer() {
+  return m_blockchainSynchronizer;
+}
+
+TransfersSyncronizer& WalletSynchronizerHost::getTransfersSynchronizer() {
+  return m_transfersSynchronizer;
+}
+
+bool WalletSynchronizerHost::attach(const WalletGreen* container, const Crypto::PublicKey& viewPublicKey) {
+  for (const auto& kv : m_containers) {
+    if (kv.first != container && kv.second == viewPublicKey) {
+      return false;
+    }
+  }
+
+  m_containers[container] = viewPublicKey;
+  m_logger(DEBUGGING) << "Container attached, view key " << Common::podToHex(viewPublicKey) << ", container count " << m_containers.size();
+  return true;
+}
+
+void WalletSynchronizerHost::detach(const WalletGreen* container) {
+  m_startedContainers.erase(container);
+  if (m_containers.erase(container) != 0) {
+    m_logger(DEBUGGING) << "Container detached, container count " << m_containers.size();
+  }
+
+  resume();
+}
+
+void WalletSynchronizerHost::start(const WalletGreen* container) {
+  m_startedContainers.insert(container);
+  resume();
+}
+
+void WalletSynchronizerHost::stop(const WalletGreen* container) {
+  m_startedContainers.erase(container);
+  if (!m_started) {
+    return;
+  }
+
+  m_logger(DEBUGGING) << "Stopping BlockchainSynchronizer";
+  // the synchronizer thread may wait for the node, whose callbacks run in this dispatcher
+  System::RemoteContext<void> stopContext(m_dispatcher, [this] () {
+    m_blockchainSynchronizer.stop();
+  });
+  stopContext.get();
+
+  m_started = false;
+}
+
+void WalletSynchronizerHost::resume() {
+  if (!m_started && !m_startedContainers.empty()) {
+    m_logger(DEBUGGING) << "Starting BlockchainSynchronizer, started containers " << m_startedContainers.size();
+    m_blockchainSynchronizer.start();
+    m_started = true;
+  }
+}
+
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <System/Dispatcher.h>
+#include "Logging/LoggerRef.h"
+#include "Transfers/BlockchainSynchronizer.h"
+#include "Transfers/TransfersSynchronizer.h"
+
+namespace CryptoNote {
+
+class Currency;
+class INode;
+class WalletGreen;
+
+// Block synchronization shared by the containers of one process. Blocks are downloaded and parsed once,
+// and each container's view key becomes one consumer of the same BlockchainSynchronizer.
+// A standalone WalletGreen owns a host of its own.
+class WalletSynchronizerHost {
+public:
+  WalletSynchronizerHost(System::Dispatcher& dispatcher, const Currency& currency, INode& node, Logging::ILogger& logger);
+  WalletSynchronizerHost(const WalletSynchronizerHost&) = delete;
+  WalletSynchronizerHost& operator=(const WalletSynchronizerHost&) = delete;
+
+  BlockchainSynchronizer& getBlockchainSynchronizer();
+  TransfersSyncronizer& getTransfersSynchronizer();
+
+  // Subscriptions of one view key end up in a single consumer, so two containers can't share a view key
+  bool attach(const WalletGreen* container, const Crypto::PublicKey& viewPublicKey);
+  void detach(const WalletGreen* container);
+
+  // The synchronizer runs while any attached container has started it. Consumers can only change while it is stopped,
+  // so stop() pauses it for every container; the caller restarts it with start(), or with resume() if it has nothing to scan.
+  void start(const WalletGreen* container);
+  void stop(const WalletGreen* container);
+  void resume();
+
+private:
+  System::Dispatcher& m_dispatcher;
+  Logging::LoggerRef m_logger;
+  BlockchainSynchronizer m_blockchainSynchronizer;
+  TransfersSyncronizer m_transfersSynchronizer;
+
+  std::unordered_map<const WalletGreen*, Crypto::PublicKey> m_containers;
+  std::unordered_set<const WalletGreen*> m_startedContainers;
+  bool m_started;
+};
+
+}
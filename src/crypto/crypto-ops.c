@@ -16,6 +16,7 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "crypto-ops.h"
@@ -1497,20 +1498,20 @@ static void ge_precomp_cmov(ge_precomp *t, const ge_precomp *u, unsigned char b)
   fe_cmov(t->xy2d, u->xy2d, b);
 }
 
-static void select(ge_precomp *t, int pos, signed char b) {
+static void select(ge_precomp *t, const ge_precomp table[32][8], int pos, signed char b) {
   ge_precomp minust;
   unsigned char bnegative = negative(b);
   unsigned char babs = b - (((-bnegative) & b) << 1);
 
   ge_precomp_0(t);
-  ge_precomp_cmov(t, &ge_base[pos][0], equal(babs, 1));
-  ge_precomp_cmov(t, &ge_base[pos][1], equal(babs, 2));
-  ge_precomp_cmov(t, &ge_base[pos][2], equal(babs, 3));
-  ge_precomp_cmov(t, &ge_base[pos][3], equal(babs, 4));
-  ge_precomp_cmov(t, &ge_base[pos][4], equal(babs, 5));
-  ge_precomp_cmov(t, &ge_base[pos][5], equal(babs, 6));
-  ge_precomp_cmov(t, &ge_base[pos][6], equal(babs, 7));
-  ge_precomp_cmov(t, &ge_base[pos][7], equal(babs, 8));
+  ge_precomp_cmov(t, &table[pos][0], equal(babs, 1));
+  ge_precomp_cmov(t, &table[pos][1], equal(babs, 2));
+  ge_precomp_cmov(t, &table[pos][2], equal(babs, 3));
+  ge_precomp_cmov(t, &table[pos][3], equal(babs, 4));
+  ge_precomp_cmov(t, &table[pos][4], equal(babs, 5));
+  ge_precomp_cmov(t, &table[pos][5], equal(babs, 6));
+  ge_precomp_cmov(t, &table[pos][6], equal(babs, 7));
+  ge_precomp_cmov(t, &table[pos][7], equal(babs, 8));
   fe_copy(minust.yplusx, t->yminusx);
   fe_copy(minust.yminusx, t->yplusx);
   fe_neg(minust.xy2d, t->xy2d);
@@ -1527,6 +1528,15 @@ Preconditions:
 */
 
 void ge_scalarmult_base(ge_p3 *h, const unsigned char *a) {
+  ge_scalarmult_precomp(h, a, ge_base);
+}
+
+/*
+h = a * A
+where table[i][j] = (j + 1) * 256^i * A, as filled by ge_precomp_init
+*/
+
+void ge_scalarmult_precomp(ge_p3 *h, const unsigned char *a, const ge_precomp table[32][8]) {
   signed char e[64];
   signed char carry;
   ge_p1p1 r;
@@ -1553,7 +1563,7 @@ void ge_scalarmult_base(ge_p3 *h, const unsigned char *a) {
 
   ge_p3_0(h);
   for (i = 1; i < 64; i += 2) {
-    select(&t, i / 2, e[i]);
+    select(&t, table, i / 2, e[i]);
     ge_madd(&r, h, &t); ge_p1p1_to_p3(h, &r);
   }
 
@@ -1563,7 +1573,7 @@ void ge_scalarmult_base(ge_p3 *h, const unsigned char *a) {
   ge_p2_dbl(&r, &s); ge_p1p1_to_p3(h, &r);
 
   for (i = 0; i < 64; i += 2) {
-    select(&t, i / 2, e[i]);
+    select(&t, table, i / 2, e[i]);
     ge_madd(&r, h, &t); ge_p1p1_to_p3(h, &r);
   }
 }
@@ -1927,10 +1937,13 @@ static void ge_cached_cmov(ge_cached *t, const ge_cached *u, unsigned char b) {
 /* Assumes that a[31] <= 127 */
 void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A) {
   signed char e[64];
+  ge_scalarmult_recode(e, a);
+  ge_scalarmult_recoded(r, e, A);
+}
+
+/* Signed radix-16 digits of a, for reuse when the same scalar multiplies many points. Assumes that a[31] <= 127 */
+void ge_scalarmult_recode(signed char *e, const unsigned char *a) {
   int carry, carry2, i;
-  ge_cached Ai[8]; /* 1 * A, 2 * A, ..., 8 * A */
-  ge_p1p1 t;
-  ge_p3 u;
 
   carry = 0; /* 0..1 */
   for (i = 0; i < 31; i++) {
@@ -1944,6 +1957,13 @@ void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A) {
   carry2 = (carry + 8) >> 4; /* 0..8 */
   e[62] = carry - (carry2 << 4); /* -8..7 */
   e[63] = carry2; /* 0..8 */
+}
+
+void ge_scalarmult_recoded(ge_p2 *r, const signed char *e, const ge_p3 *A) {
+  int i;
+  ge_cached Ai[8]; /* 1 * A, 2 * A, ..., 8 * A */
+  ge_p1p1 t;
+  ge_p3 u;
 
   ge_p3_to_cached(&Ai[0], A);
   for (i = 0; i < 7; i++) {
@@ -2578,6 +2598,88 @@ int ge_check_subgroup_precomp_vartime(const ge_dsmp p) {
   return fe_isnonzero(t.Y);
 }
 
+/* table[i][j] = (j + 1) * 256^i * A, the layout of ge_base. Each row of eight points is brought to affine form with one shared inversion. */
+void ge_precomp_init(ge_precomp table[32][8], const ge_p3 *A) {
+  ge_p3 row[8];
+  fe acc[8];
+  fe inv, zinv, x, y;
+  ge_cached step;
+  ge_p1p1 t;
+  ge_p2 s;
+  int i, j, k;
+
+  row[0] = *A;
+  for (i = 0; i < 32; i++) {
+    ge_p3_to_cached(&step, &row[0]);
+    for (j = 1; j < 8; j++) {
+      ge_add(&t, &row[j - 1], &step);
+      ge_p1p1_to_p3(&row[j], &t);
+    }
+
+    fe_copy(acc[0], row[0].Z);
+    for (j = 1; j < 8; j++) {
+      fe_mul(acc[j], acc[j - 1], row[j].Z);
+    }
+
+    fe_invert(inv, acc[7]);
+    for (j = 7; j >= 0; j--) {
+      if (j > 0) {
+        fe_mul(zinv, inv, acc[j - 1]);
+        fe_mul(inv, inv, row[j].Z);
+      } else {
+        fe_copy(zinv, inv);
+      }
+
+      fe_mul(x, row[j].X, zinv);
+      fe_mul(y, row[j].Y, zinv);
+      fe_add(table[i][j].yplusx, y, x);
+      fe_sub(table[i][j].yminusx, y, x);
+      fe_mul(table[i][j].xy2d, x, y);
+      fe_mul(table[i][j].xy2d, table[i][j].xy2d, fe_d2);
+    }
+
+    if (i < 31) {
+      ge_p3_dbl(&t, &row[0]);
+      for (k = 1; k < 8; k++) {
+        ge_p1p1_to_p2(&s, &t);
+        ge_p2_dbl(&t, &s);
+      }
+
+      ge_p1p1_to_p3(&row[0], &t);
+    }
+  }
+}
+
+/* Encodes count points with a single field inversion (Montgomery's trick). The T coordinates of h are used as scratch space and left clobbered. */
+void ge_p3_batch_tobytes(unsigned char *s, ge_p3 *h, size_t count) {
+  fe inv, zinv, x, y;
+  size_t i;
+
+  if (count == 0) {
+    return;
+  }
+
+  fe_copy(h[0].T, h[0].Z);
+  for (i = 1; i < count; i++) {
+    fe_mul(h[i].T, h[i - 1].T, h[i].Z);
+  }
+
+  fe_invert(inv, h[count - 1].T);
+  for (i = count; i-- > 0;) {
+    if (i > 0) {
+      fe_mul(zinv, inv, h[i - 1].T);
+      fe_mul(inv, inv, h[i].Z);
+    } else {
+      fe_copy(zinv, inv);
+    }
+
+    fe_mul(x, h[i].X, zinv);
+    fe_mul(y, h[i].Y, zinv);
+    fe_tobytes(s + 32 * i, y);
+    s[32 * i + 31] ^= fe_isnegative(x) << 7;
+  }
+}
+
 void ge_mul8(ge_p1p1 *r, const ge_p2 *t) {
   ge_p2 u;
   ge_p2_dbl(r, t);
@@ -23,6 +23,7 @@
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "Common/Varint.h"
 #include "crypto.h"
@@ -237,6 +238,190 @@ namespace Crypto {
   }
 
 
+  static void derivation_to_scalars(const KeyDerivation &derivation, const size_t *output_indexes, size_t count, EllipticCurveScalar *res) {
+    struct buffer {
+      KeyDerivation derivation;
+      char output_index[(sizeof(size_t) * 8 + 6) / 7];
+    };
+    std::vector<buffer> bufs(count);
+    std::vector<const void *> data(count);
+    std::vector<size_t> lengths(count);
+    for (size_t i = 0; i < count; i++) {
+      char *end = bufs[i].output_index;
+      bufs[i].derivation = derivation;
+      Tools::write_varint(end, output_indexes[i]);
+      assert(end <= bufs[i].output_index + sizeof bufs[i].output_index);
+      data[i] = &bufs[i];
+      lengths[i] = end - reinterpret_cast<char *>(&bufs[i]);
+    }
+    cn_fast_hash_batch(data.data(), lengths.data(), count, reinterpret_cast<Hash *>(res));
+    for (size_t i = 0; i < count; i++) {
+      sc_reduce32(reinterpret_cast<unsigned char*>(&res[i]));
+    }
+  }
+
+  void crypto_ops::underive_public_keys(const KeyDerivation &derivation, const size_t *output_indexes,
+    const PublicKey *derived_keys, size_t count, PublicKey *bases, bool *results) {
+    std::vector<EllipticCurveScalar> scalars(count);
+    std::vector<ge_p3> points;
+    std::vector<PublicKey> encoded;
+    std::vector<size_t> positions;
+    points.reserve(count);
+    positions.reserve(count);
+    derivation_to_scalars(derivation, output_indexes, count, scalars.data());
+    for (size_t i = 0; i < count; i++) {
+      ge_p3 point1;
+      ge_p3 point2;
+      ge_cached point3;
+      ge_p1p1 point4;
+      results[i] = ge_frombytes_vartime(&point1, reinterpret_cast<const unsigned char*>(&derived_keys[i])) == 0;
+      if (!results[i]) {
+        continue;
+      }
+      ge_scalarmult_base(&point2, reinterpret_cast<unsigned char*>(&scalars[i]));
+      ge_p3_to_cached(&point3, &point2);
+      ge_sub(&point4, &point1, &point3);
+      points.emplace_back();
+      ge_p1p1_to_p3(&points.back(), &point4);
+      positions.push_back(i);
+    }
+    encoded.resize(points.size());
+    ge_p3_batch_tobytes(reinterpret_cast<unsigned char*>(encoded.data()), points.data(), points.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+      bases[positions[i]] = encoded[i];
+    }
+  }
+
+  struct secret_key_context::state {
+    SecretKey key;
+    signed char digits[64];
+  };
+
+  secret_key_context::secret_key_context(const SecretKey &key) : data(new state) {
+    assert(sc_check(reinterpret_cast<const unsigned char*>(&key)) == 0);
+    data->key = key;
+    ge_scalarmult_recode(data->digits, reinterpret_cast<const unsigned char*>(&key));
+  }
+
+  secret_key_context::secret_key_context(secret_key_context &&) = default;
+  secret_key_context::~secret_key_context() = default;
+  secret_key_context &secret_key_context::operator=(secret_key_context &&) = default;
+
+  const SecretKey &secret_key_context::secret_key() const {
+    return data->key;
+  }
+
+  bool secret_key_context::generate_key_derivation(const PublicKey &key, KeyDerivation &derivation) const {
+    bool result;
+    generate_key_derivations(&key, 1, &derivation, &result);
+    return result;
+  }
+
+  void secret_key_context::generate_key_derivations(const PublicKey *keys, size_t count, KeyDerivation *derivations, bool *results) const {
+    std::vector<ge_p3> points;
+    std::vector<KeyDerivation> encoded;
+    std::vector<size_t> positions;
+    points.reserve(count);
+    positions.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      ge_p3 point;
+      ge_p2 point2;
+      ge_p1p1 point3;
+      results[i] = ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char*>(&keys[i])) == 0;
+      if (!results[i]) {
+        continue;
+      }
+      ge_scalarmult_recoded(&point2, data->digits, &point);
+      ge_mul8(&point3, &point2);
+      points.emplace_back();
+      ge_p1p1_to_p3(&points.back(), &point3);
+      positions.push_back(i);
+    }
+    encoded.resize(points.size());
+    ge_p3_batch_tobytes(reinterpret_cast<unsigned char*>(encoded.data()), points.data(), points.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+      derivations[positions[i]] = encoded[i];
+    }
+  }
+
+  struct public_key_context::state {
+    PublicKey key;
+    bool valid;
+    ge_p3 point;
+    ge_cached cached;
+    std::vector<ge_precomp> table;
+  };
+
+  public_key_context::public_key_context(const PublicKey &key) : data(new state) {
+    data->key = key;
+    data->valid = ge_frombytes_vartime(&data->point, reinterpret_cast<const unsigned char*>(&key)) == 0;
+    if (data->valid) {
+      ge_p3_to_cached(&data->cached, &data->point);
+    }
+  }
+
+  public_key_context::public_key_context(public_key_context &&) = default;
+  public_key_context::~public_key_context() = default;
+  public_key_context &public_key_context::operator=(public_key_context &&) = default;
+
+  bool public_key_context::valid() const {
+    return data->valid;
+  }
+
+  const PublicKey &public_key_context::public_key() const {
+    return data->key;
+  }
+
+  void public_key_context::precompute() {
+    if (data->valid && data->table.empty()) {
+      data->table.resize(32 * 8);
+      ge_precomp_init(reinterpret_cast<ge_precomp (*)[8]>(data->table.data()), &data->point);
+    }
+  }
+
+  bool public_key_context::generate_key_derivation(const SecretKey &sec, KeyDerivation &derivation) const {
+    ge_p2 point2;
+    ge_p1p1 point3;
+    assert(sc_check(reinterpret_cast<const unsigned char*>(&sec)) == 0);
+    if (!data->valid) {
+      return false;
+    }
+    if (data->table.empty()) {
+      ge_scalarmult(&point2, reinterpret_cast<const unsigned char*>(&sec), &data->point);
+    } else {
+      ge_p3 point;
+      ge_scalarmult_precomp(&point, reinterpret_cast<const unsigned char*>(&sec), reinterpret_cast<const ge_precomp (*)[8]>(data->table.data()));
+      ge_p3_to_p2(&point2, &point);
+    }
+    ge_mul8(&point3, &point2);
+    ge_p1p1_to_p2(&point2, &point3);
+    ge_tobytes(reinterpret_cast<unsigned char*>(&derivation), &point2);
+    return true;
+  }
+
+  bool public_key_context::derive_public_key(const KeyDerivation &derivation, size_t output_index, PublicKey &derived_key) const {
+    return derive_public_keys(derivation, &output_index, 1, &derived_key);
+  }
+
+  bool public_key_context::derive_public_keys(const KeyDerivation &derivation, const size_t *output_indexes, size_t count,
+    PublicKey *derived_keys) const {
+    if (!data->valid) {
+      return false;
+    }
+    std::vector<EllipticCurveScalar> scalars(count);
+    std::vector<ge_p3> points(count);
+    derivation_to_scalars(derivation, output_indexes, count, scalars.data());
+    for (size_t i = 0; i < count; i++) {
+      ge_p3 point2;
+      ge_p1p1 point4;
+      ge_scalarmult_base(&point2, reinterpret_cast<unsigned char*>(&scalars[i]));
+      ge_add(&point4, &point2, &data->cached);
+      ge_p1p1_to_p3(&points[i], &point4);
+    }
+    ge_p3_batch_tobytes(reinterpret_cast<unsigned char*>(derived_keys), points.data(), count);
+    return true;
+  }
+
   struct s_comm {
     Hash h;
     EllipticCurvePoint key;
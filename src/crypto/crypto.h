@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <type_traits>
 #include <vector>
@@ -76,6 +77,8 @@ struct EllipticCurveScalar {
     friend bool underive_public_key(const KeyDerivation &, size_t, const PublicKey &, PublicKey &);
     static bool underive_public_key(const KeyDerivation &, size_t, const PublicKey &, const uint8_t*, size_t, PublicKey &);
     friend bool underive_public_key(const KeyDerivation &, size_t, const PublicKey &, const uint8_t*, size_t, PublicKey &);
+    static void underive_public_keys(const KeyDerivation &, const size_t *, const PublicKey *, size_t, PublicKey *, bool *);
+    friend void underive_public_keys(const KeyDerivation &, const size_t *, const PublicKey *, size_t, PublicKey *, bool *);
     static void generate_signature(const Hash &, const PublicKey &, const SecretKey &, Signature &);
     friend void generate_signature(const Hash &, const PublicKey &, const SecretKey &, Signature &);
     static bool check_signature(const Hash &, const PublicKey &, const Signature &);
@@ -202,6 +205,61 @@ struct EllipticCurveScalar {
     return crypto_ops::underive_public_key(derivation, output_index, derived_key, base);
   }
 
+  /* Batch form of underive_public_key for several outputs of one transaction. The output scalars are hashed
+   * together and the results are encoded with one shared field inversion. results[i] is false where
+   * derived_keys[i] is not a valid point.
+   */
+  inline void underive_public_keys(const KeyDerivation &derivation, const size_t *output_indexes,
+    const PublicKey *derived_keys, size_t count, PublicKey *bases, bool *results) {
+    crypto_ops::underive_public_keys(derivation, output_indexes, derived_keys, count, bases, results);
+  }
+
+  /* A secret key that derives many transactions, such as a wallet's view secret key. Its scalar is kept in the
+   * recoded form used by the point multiplication, and the batch variant encodes all derivations with one
+   * shared field inversion. results[i] is false where keys[i] is not a valid point.
+   */
+  class secret_key_context {
+  public:
+    explicit secret_key_context(const SecretKey &key);
+    secret_key_context(secret_key_context &&);
+    ~secret_key_context();
+    secret_key_context &operator=(secret_key_context &&);
+
+    const SecretKey &secret_key() const;
+    bool generate_key_derivation(const PublicKey &key, KeyDerivation &derivation) const;
+    void generate_key_derivations(const PublicKey *keys, size_t count, KeyDerivation *derivations, bool *results) const;
+
+  private:
+    struct state;
+    std::unique_ptr<state> data;
+  };
+
+  /* A public key used in many derivations, such as a recipient's keys during transaction construction.
+   * The point is decoded once. As a spend key it derives output keys, several at a time with one shared
+   * inversion. As a view key it takes secret keys; after precompute() these multiply through a fixed-base
+   * table (about 30 KB) as fast as the base point does. Every call returns false if the key is not a valid point.
+   */
+  class public_key_context {
+  public:
+    explicit public_key_context(const PublicKey &key);
+    public_key_context(public_key_context &&);
+    ~public_key_context();
+    public_key_context &operator=(public_key_context &&);
+
+    bool valid() const;
+    const PublicKey &public_key() const;
+    void precompute();
+
+    bool generate_key_derivation(const SecretKey &sec, KeyDerivation &derivation) const;
+    bool derive_public_key(const KeyDerivation &derivation, size_t output_index, PublicKey &derived_key) const;
+    bool derive_public_keys(const KeyDerivation &derivation, const size_t *output_indexes, size_t count,
+      PublicKey *derived_keys) const;
+
+  private:
+    struct state;
+    std::unique_ptr<state> data;
+  };
+
   /* Generation and checking of a standard signature.
    */
   inline void generate_signature(const Hash &prefix_hash, const PublicKey &pub, const SecretKey &sec, Signature &sig) {
@@ -55,6 +55,11 @@ static_assert(sizeof(union hash_state) == 200, "Invalid structure size");
 void hash_permutation(union hash_state *state);
 void hash_process(union hash_state *state, const uint8_t *buf, size_t count);
 
+extern const int keccak_x4_compiled;
+extern const int keccak_x8_compiled;
+void keccak_hash_x4(const void *const *data, const size_t *lengths, size_t count, char (*hashes)[32]);
+void keccak_hash_x8(const void *const *data, const size_t *lengths, size_t count, char (*hashes)[32]);
+
 #endif
 
 enum {
@@ -65,6 +70,7 @@ enum {
 };
 
 void cn_fast_hash(const void *data, size_t length, char *hash);
+void cn_fast_hash_batch(const void *const *data, const size_t *lengths, size_t count, char (*hashes)[HASH_SIZE]);
 
 void cn_slow_hash_f(void *, const void *, size_t, void *, int, int);
 
@@ -19,7 +19,12 @@
 #include <stdint.h>
 #include <string.h>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
 #include "hash-ops.h"
+#include "initializer.h"
 #include "keccak.h"
 
 void hash_permutation(union hash_state *state) {
@@ -35,3 +40,67 @@ void cn_fast_hash(const void *data, size_t length, char *hash) {
   hash_process(&state, data, length);
   memcpy(hash, &state, HASH_SIZE);
 }
+
+enum {
+  KECCAK_BATCH_SCALAR = 1,
+  KECCAK_BATCH_X4 = 4,
+  KECCAK_BATCH_X8 = 8
+};
+
+// Same feature tests as xmrig's BasicCpuInfo, repeated here because the Crypto
+// library sits below CryptoNoteCore and cannot reach xmrig::Cpu.
+static int keccak_batch_width(void) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if (keccak_x8_compiled && __builtin_cpu_supports("avx512f")) {
+    return KECCAK_BATCH_X8;
+  }
+
+  if (keccak_x4_compiled && __builtin_cpu_supports("avx2")) {
+    return KECCAK_BATCH_X4;
+  }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int info[4];
+  unsigned long long xcr0;
+
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 27)) == 0) {
+    return KECCAK_BATCH_SCALAR;
+  }
+
+  xcr0 = _xgetbv(0);
+  __cpuidex(info, 7, 0);
+  if (keccak_x8_compiled && (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6) {
+    return KECCAK_BATCH_X8;
+  }
+
+  if (keccak_x4_compiled && (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06) {
+    return KECCAK_BATCH_X4;
+  }
+#endif
+
+  return KECCAK_BATCH_SCALAR;
+}
+
+// Resolved before any thread can hash, so the batch path reads it without synchronization.
+static int batch_width = KECCAK_BATCH_SCALAR;
+
+INITIALIZER(init_keccak_batch_width) {
+  batch_width = keccak_batch_width();
+}
+
+void cn_fast_hash_batch(const void *const *data, const size_t *lengths, size_t count, char (*hashes)[HASH_SIZE]) {
+  int width = batch_width;
+  size_t i;
+
+  // A single message gains nothing from the wide path, the idle lanes would only burn cycles.
+  if (count < 2 || width == KECCAK_BATCH_SCALAR) {
+    for (i = 0; i < count; i++) {
+      cn_fast_hash(data[i], lengths[i], hashes[i]);
+    }
+  } else if (width == KECCAK_BATCH_X8 && (count > KECCAK_BATCH_X4 || !keccak_x4_compiled)) {
+    keccak_hash_x8(data, lengths, count, hashes);
+  } else {
+    keccak_hash_x4(data, lengths, count, hashes);
+  }
+}
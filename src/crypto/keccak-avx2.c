@@ -0,0 +1,56 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hash-ops.h"
+#include "keccak.h"
+
+// Built with -mavx2; cn_fast_hash_batch calls into it only when the CPU reports AVX2.
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define VEC __m256i
+#define LANES 4
+#define LOAD(p) _mm256_loadu_si256((const __m256i *) (p))
+#define STORE(p, v) _mm256_storeu_si256((__m256i *) (p), v)
+#define SETZERO() _mm256_setzero_si256()
+#define SET1(x) _mm256_set1_epi64x((long long) (x))
+#define XOR(a, b) _mm256_xor_si256(a, b)
+#define XOR3(a, b, c) XOR(XOR(a, b), c)
+#define ANDNOT(a, b) _mm256_andnot_si256(a, b)
+#define CHI(a, b, c) XOR(a, ANDNOT(b, c))
+#define ROL(x, n) _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - (n)))
+#define KECCAKF_X keccakf_x4
+#define HASH_X keccak_hash_x4
+
+const int keccak_x4_compiled = 1;
+
+#include "keccak-simd.inl"
+
+#else
+
+const int keccak_x4_compiled = 0;
+
+void keccak_hash_x4(const void *const *data, const size_t *lengths, size_t count, char (*hashes)[HASH_SIZE]) {
+  assert(0 && "keccak_hash_x4 is not compiled in");
+}
+
+#endif
@@ -0,0 +1,56 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hash-ops.h"
+#include "keccak.h"
+
+// Built with -mavx512f; cn_fast_hash_batch calls into it only when the CPU reports AVX-512F.
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+#define VEC __m512i
+#define LANES 8
+#define LOAD(p) _mm512_loadu_si512((const void *) (p))
+#define STORE(p, v) _mm512_storeu_si512((void *) (p), v)
+#define SETZERO() _mm512_setzero_si512()
+#define SET1(x) _mm512_set1_epi64((long long) (x))
+#define XOR(a, b) _mm512_xor_si512(a, b)
+#define XOR3(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0x96)
+#define ANDNOT(a, b) _mm512_andnot_si512(a, b)
+#define CHI(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0xD2)
+#define ROL(x, n) _mm512_rol_epi64(x, n)
+#define KECCAKF_X keccakf_x8
+#define HASH_X keccak_hash_x8
+
+const int keccak_x8_compiled = 1;
+
+#include "keccak-simd.inl"
+
+#else
+
+const int keccak_x8_compiled = 0;
+
+void keccak_hash_x8(const void *const *data, const size_t *lengths, size_t count, char (*hashes)[HASH_SIZE]) {
+  assert(0 && "keccak_hash_x8 is not compiled in");
+}
+
+#endif
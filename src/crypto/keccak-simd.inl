@@ -0,0 +1,168 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+// Multi-buffer Keccak-f[1600] shared by the SIMD translation units. The includer
+// defines VEC, LANES and the lane operations below, plus KECCAKF_X and HASH_X
+// naming the generated functions. Lane i of st[w] holds word w of message i.
+
+extern const uint64_t keccakf_rndc[24];
+
+#define THETA_COLUMN(i, t) \
+  st[i] = XOR(st[i], t); st[i + 5] = XOR(st[i + 5], t); st[i + 10] = XOR(st[i + 10], t); \
+  st[i + 15] = XOR(st[i + 15], t); st[i + 20] = XOR(st[i + 20], t);
+
+#define RHO_PI(j, r) t = st[j]; st[j] = ROL(u, r); u = t;
+
+#define CHI_ROW(j) \
+  bc0 = st[j]; bc1 = st[j + 1]; bc2 = st[j + 2]; bc3 = st[j + 3]; bc4 = st[j + 4]; \
+  st[j] = CHI(bc0, bc1, bc2); st[j + 1] = CHI(bc1, bc2, bc3); st[j + 2] = CHI(bc2, bc3, bc4); \
+  st[j + 3] = CHI(bc3, bc4, bc0); st[j + 4] = CHI(bc4, bc0, bc1);
+
+static void KECCAKF_X(VEC st[25]) {
+  VEC bc0, bc1, bc2, bc3, bc4, t, u;
+  int round;
+
+  for (round = 0; round < KECCAK_ROUNDS; round++) {
+    // Theta
+    bc0 = XOR(XOR3(st[0], st[5], st[10]), XOR(st[15], st[20]));
+    bc1 = XOR(XOR3(st[1], st[6], st[11]), XOR(st[16], st[21]));
+    bc2 = XOR(XOR3(st[2], st[7], st[12]), XOR(st[17], st[22]));
+    bc3 = XOR(XOR3(st[3], st[8], st[13]), XOR(st[18], st[23]));
+    bc4 = XOR(XOR3(st[4], st[9], st[14]), XOR(st[19], st[24]));
+
+    t = XOR(bc4, ROL(bc1, 1)); THETA_COLUMN(0, t)
+    t = XOR(bc0, ROL(bc2, 1)); THETA_COLUMN(1, t)
+    t = XOR(bc1, ROL(bc3, 1)); THETA_COLUMN(2, t)
+    t = XOR(bc2, ROL(bc4, 1)); THETA_COLUMN(3, t)
+    t = XOR(bc3, ROL(bc0, 1)); THETA_COLUMN(4, t)
+
+    // Rho Pi, same walk as keccakf_piln/keccakf_rotc
+    u = st[1];
+    RHO_PI(10, 1) RHO_PI(7, 3) RHO_PI(11, 6) RHO_PI(17, 10) RHO_PI(18, 15) RHO_PI(3, 21)
+    RHO_PI(5, 28) RHO_PI(16, 36) RHO_PI(8, 45) RHO_PI(21, 55) RHO_PI(24, 2) RHO_PI(4, 14)
+    RHO_PI(15, 27) RHO_PI(23, 41) RHO_PI(19, 56) RHO_PI(13, 8) RHO_PI(12, 25) RHO_PI(2, 43)
+    RHO_PI(20, 62) RHO_PI(14, 18) RHO_PI(22, 39) RHO_PI(9, 61) RHO_PI(6, 20) RHO_PI(1, 44)
+
+    // Chi
+    CHI_ROW(0) CHI_ROW(5) CHI_ROW(10) CHI_ROW(15) CHI_ROW(20)
+
+    // Iota
+    st[0] = XOR(st[0], SET1(keccakf_rndc[round]));
+  }
+}
+
+#undef THETA_COLUMN
+#undef RHO_PI
+#undef CHI_ROW
+
+// Same result as cn_fast_hash for each message. Every lane walks its own message
+// block by block; when a lane absorbs its final padded block the digest is taken
+// out after the permutation and the lane is reloaded with the next pending message.
+void HASH_X(const void *const *data, const size_t *lengths, size_t count, char (*hashes)[HASH_SIZE]) {
+  VEC st[25], mask;
+  uint64_t block[HASH_DATA_AREA / 8][LANES];
+  uint64_t digest[HASH_SIZE / 8][LANES];
+  uint64_t reset[LANES];
+  uint8_t temp[HASH_DATA_AREA];
+  const uint8_t *in[LANES];
+  size_t remaining[LANES];
+  size_t index[LANES];
+  int active[LANES];
+  int finished[LANES];
+  size_t next = 0;
+  int lane, i, busy, done;
+
+  for (i = 0; i < 25; i++) {
+    st[i] = SETZERO();
+  }
+
+  for (lane = 0; lane < LANES; lane++) {
+    active[lane] = next < count;
+    if (active[lane]) {
+      in[lane] = (const uint8_t *) data[next];
+      remaining[lane] = lengths[next];
+      index[lane] = next++;
+    }
+  }
+
+  busy = count > 0;
+  while (busy) {
+    done = 0;
+    for (lane = 0; lane < LANES; lane++) {
+      const uint8_t *source = temp;
+      finished[lane] = 0;
+
+      if (!active[lane]) {
+        memset(temp, 0, sizeof(temp));
+      } else if (remaining[lane] >= HASH_DATA_AREA) {
+        source = in[lane];
+        in[lane] += HASH_DATA_AREA;
+        remaining[lane] -= HASH_DATA_AREA;
+      } else {
+        memcpy(temp, in[lane], remaining[lane]);
+        temp[remaining[lane]] = 1;
+        memset(temp + remaining[lane] + 1, 0, HASH_DATA_AREA - remaining[lane] - 1);
+        temp[HASH_DATA_AREA - 1] |= 0x80;
+        finished[lane] = 1;
+        done = 1;
+      }
+
+      for (i = 0; i < HASH_DATA_AREA / 8; i++) {
+        memcpy(&block[i][lane], source + 8 * i, 8);
+      }
+    }
+
+    for (i = 0; i < HASH_DATA_AREA / 8; i++) {
+      st[i] = XOR(st[i], LOAD(block[i]));
+    }
+
+    KECCAKF_X(st);
+
+    if (!done) {
+      continue;
+    }
+
+    for (i = 0; i < HASH_SIZE / 8; i++) {
+      STORE(digest[i], st[i]);
+    }
+
+    busy = 0;
+    for (lane = 0; lane < LANES; lane++) {
+      reset[lane] = 0;
+      if (finished[lane]) {
+        for (i = 0; i < HASH_SIZE / 8; i++) {
+          memcpy(hashes[index[lane]] + 8 * i, &digest[i][lane], 8);
+        }
+
+        reset[lane] = ~(uint64_t) 0;
+        active[lane] = next < count;
+        if (active[lane]) {
+          in[lane] = (const uint8_t *) data[next];
+          remaining[lane] = lengths[next];
+          index[lane] = next++;
+        }
+      }
+
+      busy |= active[lane];
+    }
+
+    mask = LOAD(reset);
+    for (i = 0; i < 25; i++) {
+      st[i] = ANDNOT(mask, st[i]);
+    }
+  }
+}
@@ -36,17 +36,33 @@ void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
       cnt |= cnt >> i;
     }
     cnt &= ~(cnt >> 1);
+    // Every level is a batch of independent 64-byte messages, hashed into the
+    // other half of a ping-pong buffer so no pair reads an overwritten input.
+    char (*next)[HASH_SIZE];
+    const void **data;
+    size_t *lengths;
     ints = alloca(cnt * HASH_SIZE);
+    next = alloca(cnt / 2 * HASH_SIZE);
+    data = alloca(cnt * sizeof(const void *));
+    lengths = alloca(cnt * sizeof(size_t));
     memcpy(ints, hashes, (2 * cnt - count) * HASH_SIZE);
     for (i = 2 * cnt - count, j = 2 * cnt - count; j < cnt; i += 2, ++j) {
-      cn_fast_hash(hashes[i], 2 * HASH_SIZE, ints[j]);
+      data[j - (2 * cnt - count)] = hashes[i];
+      lengths[j - (2 * cnt - count)] = 2 * HASH_SIZE;
     }
     assert(i == count);
+    cn_fast_hash_batch(data, lengths, count - cnt, ints + (2 * cnt - count));
     while (cnt > 2) {
+      char (*swap)[HASH_SIZE];
       cnt >>= 1;
       for (i = 0, j = 0; j < cnt; i += 2, ++j) {
-        cn_fast_hash(ints[i], 2 * HASH_SIZE, ints[j]);
+        data[j] = ints[i];
+        lengths[j] = 2 * HASH_SIZE;
       }
+      cn_fast_hash_batch(data, lengths, cnt, next);
+      swap = ints;
+      ints = next;
+      next = swap;
     }
     cn_fast_hash(ints[0], 2 * HASH_SIZE, root_hash);
   }
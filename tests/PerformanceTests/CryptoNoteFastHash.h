@@ -0,0 +1,60 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <vector>
+
+#include "crypto/hash.h"
+
+// Hashes a sync-sized batch of transaction-sized messages one by one or through cn_fast_hash_batch.
+template<bool batched>
+class test_cn_fast_hash {
+public:
+  static const size_t loop_count = 1000;
+  static const size_t message_count = 64;
+
+  bool init() {
+    m_messages.resize(message_count);
+    for (size_t i = 0; i < message_count; ++i) {
+      m_messages[i].resize(200 + 37 * i % 400, static_cast<uint8_t>(i));
+      m_data.push_back(m_messages[i].data());
+      m_lengths.push_back(m_messages[i].size());
+    }
+
+    m_hashes.resize(message_count);
+    return true;
+  }
+
+  bool test() {
+    if (batched) {
+      Crypto::cn_fast_hash_batch(m_data.data(), m_lengths.data(), message_count, m_hashes.data());
+    } else {
+      for (size_t i = 0; i < message_count; ++i) {
+        Crypto::cn_fast_hash(m_data[i], m_lengths[i], m_hashes[i]);
+      }
+    }
+
+    return true;
+  }
+
+private:
+  std::vector<std::vector<uint8_t>> m_messages;
+  std::vector<const void*> m_data;
+  std::vector<size_t> m_lengths;
+  std::vector<Crypto::Hash> m_hashes;
+};
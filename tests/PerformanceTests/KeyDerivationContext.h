@@ -0,0 +1,155 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "crypto/crypto.h"
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+
+#include "SingleTransactionTestBase.h"
+
+// One loop derives count transactions against the wallet view key, compare with count * test_generate_key_derivation.
+template<size_t count>
+class test_generate_key_derivations : public single_tx_test_base
+{
+public:
+  static const size_t loop_count = 1000 / count + 1;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    m_context.reset(new Crypto::secret_key_context(m_bob.getAccountKeys().viewSecretKey));
+    for (size_t i = 0; i < count; ++i) {
+      m_keys[i] = CryptoNote::generateKeyPair().publicKey;
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    Crypto::KeyDerivation derivations[count];
+    bool results[count];
+    m_context->generate_key_derivations(m_keys, count, derivations, results);
+    return results[0];
+  }
+
+private:
+  std::unique_ptr<Crypto::secret_key_context> m_context;
+  Crypto::PublicKey m_keys[count];
+};
+
+// One loop derives count output keys of one transaction, compare with count * test_derive_public_key.
+template<size_t count>
+class test_derive_public_keys : public single_tx_test_base
+{
+public:
+  static const size_t loop_count = 1000 / count + 1;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    Crypto::generate_key_derivation(m_tx_pub_key, m_bob.getAccountKeys().viewSecretKey, m_key_derivation);
+    m_context.reset(new Crypto::public_key_context(m_bob.getAccountKeys().address.spendPublicKey));
+    for (size_t i = 0; i < count; ++i) {
+      m_indexes[i] = i;
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    Crypto::PublicKey keys[count];
+    return m_context->derive_public_keys(m_key_derivation, m_indexes, count, keys);
+  }
+
+private:
+  Crypto::KeyDerivation m_key_derivation;
+  std::unique_ptr<Crypto::public_key_context> m_context;
+  size_t m_indexes[count];
+};
+
+// The wallet scanner's per-transaction output check.
+template<size_t count>
+class test_underive_public_keys : public single_tx_test_base
+{
+public:
+  static const size_t loop_count = 1000 / count + 1;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    Crypto::generate_key_derivation(m_tx_pub_key, m_bob.getAccountKeys().viewSecretKey, m_key_derivation);
+    for (size_t i = 0; i < count; ++i) {
+      m_indexes[i] = i;
+      Crypto::derive_public_key(m_key_derivation, i, m_bob.getAccountKeys().address.spendPublicKey, m_keys[i]);
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    Crypto::PublicKey bases[count];
+    bool results[count];
+    Crypto::underive_public_keys(m_key_derivation, m_indexes, m_keys, count, bases, results);
+    return bases[0] == m_bob.getAccountKeys().address.spendPublicKey;
+  }
+
+private:
+  Crypto::KeyDerivation m_key_derivation;
+  Crypto::PublicKey m_keys[count];
+  size_t m_indexes[count];
+};
+
+// Sender side: a fresh transaction key against a recipient view key with a precomputed table.
+class test_generate_key_derivation_precomputed : public single_tx_test_base
+{
+public:
+  static const size_t loop_count = 1000;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    m_context.reset(new Crypto::public_key_context(m_bob.getAccountKeys().address.viewPublicKey));
+    m_context->precompute();
+    m_tx_key = CryptoNote::generateKeyPair().secretKey;
+    return true;
+  }
+
+  bool test()
+  {
+    Crypto::KeyDerivation derivation;
+    return m_context->generate_key_derivation(m_tx_key, derivation);
+  }
+
+private:
+  std::unique_ptr<Crypto::public_key_context> m_context;
+  Crypto::SecretKey m_tx_key;
+};
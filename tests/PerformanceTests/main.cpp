@@ -21,6 +21,7 @@
 // tests
 #include "ConstructTransaction.h"
 #include "CheckRingSignature.h"
+#include "CryptoNoteFastHash.h"
 #include "CryptoNoteSlowHash.h"
 #include "DerivePublicKey.h"
 #include "DeriveSecretKey.h"
@@ -28,6 +29,7 @@
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
 #include "IsOutToAccount.h"
+#include "KeyDerivationContext.h"
 
 int main(int argc, char** argv)
 {
@@ -66,11 +68,20 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_is_out_to_acc);
   TEST_PERFORMANCE0(test_generate_key_image_helper);
   TEST_PERFORMANCE0(test_generate_key_derivation);
+  TEST_PERFORMANCE1(test_generate_key_derivations, 1);
+  TEST_PERFORMANCE1(test_generate_key_derivations, 16);
+  TEST_PERFORMANCE0(test_generate_key_derivation_precomputed);
   TEST_PERFORMANCE0(test_generate_key_image);
   TEST_PERFORMANCE0(test_derive_public_key);
+  TEST_PERFORMANCE1(test_derive_public_keys, 1);
+  TEST_PERFORMANCE1(test_derive_public_keys, 16);
+  TEST_PERFORMANCE1(test_underive_public_keys, 1);
+  TEST_PERFORMANCE1(test_underive_public_keys, 16);
   TEST_PERFORMANCE0(test_derive_secret_key);
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
+  TEST_PERFORMANCE1(test_cn_fast_hash, false);
+  TEST_PERFORMANCE1(test_cn_fast_hash, true);
 
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
@@ -15,7 +15,10 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cfenv>
 #include <future>
+#include <memory>
+#include <vector>
 #include <System/Context.h>
 #include <System/Dispatcher.h>
 #include <System/Event.h>
@@ -386,3 +389,80 @@ TEST_F(DispatcherTests, yieldExecutesIoOnItsFront) {
   dispatcher.yield();
   ASSERT_TRUE(spawnDone);
 }
+
+TEST_F(DispatcherTests, dispatchResumesEveryContextWokenTogether) {
+  size_t wokenCount = 0;
+  std::vector<std::unique_ptr<Context<>>> contexts;
+  for (size_t i = 0; i < 100; ++i) {
+    contexts.emplace_back(new Context<>(dispatcher, [&]() {
+      Timer(dispatcher).sleep(std::chrono::milliseconds(5));
+      ++wokenCount;
+    }));
+  }
+
+  for (auto& context : contexts) {
+    context->get();
+  }
+
+  ASSERT_EQ(100, wokenCount);
+}
+
+#ifdef __linux__
+TEST(DispatcherStackTests, contextUsesConfiguredStackSize) {
+  Dispatcher dispatcher(512 * 1024);
+  volatile uint8_t result = 0;
+  Context<> context(dispatcher, [&]() {
+    volatile uint8_t buffer[256 * 1024];
+    for (size_t i = 0; i < sizeof(buffer); ++i) {
+      buffer[i] = static_cast<uint8_t>(i);
+    }
+
+    Timer(dispatcher).sleep(std::chrono::milliseconds(1));
+    result = buffer[sizeof(buffer) - 1];
+  });
+
+  context.get();
+  ASSERT_EQ(0xff, result);
+}
+
+TEST(DispatcherStackTests, contextSwitchPreservesFloatingPointState) {
+  Dispatcher dispatcher;
+  const int defaultRounding = fegetround();
+  volatile double one = 1.0;
+  volatile double three = 3.0;
+
+  int upwardRounding = -1;
+  int downwardRounding = -1;
+  double upwardQuotient = 0;
+  double downwardQuotient = 0;
+  Context<> upward(dispatcher, [&]() {
+    fesetround(FE_UPWARD);
+    for (int i = 0; i < 10; ++i) {
+      dispatcher.yield();
+    }
+
+    upwardRounding = fegetround();
+    upwardQuotient = one / three;
+  });
+
+  Context<> downward(dispatcher, [&]() {
+    fesetround(FE_DOWNWARD);
+    for (int i = 0; i < 10; ++i) {
+      dispatcher.yield();
+    }
+
+    downwardRounding = fegetround();
+    downwardQuotient = one / three;
+  });
+
+  upward.get();
+  downward.get();
+  const int mainRounding = fegetround();
+  fesetround(defaultRounding);
+
+  ASSERT_EQ(FE_UPWARD, upwardRounding);
+  ASSERT_EQ(FE_DOWNWARD, downwardRounding);
+  ASSERT_EQ(defaultRounding, mainRounding);
+  ASSERT_GT(upwardQuotient, downwardQuotient);
+}
+#endif
@@ -364,3 +364,26 @@ TEST_F(TcpConnectionTests, sendBigChunkThruTcpStream) {
     ASSERT_EQ(buf[i], incoming[i]); //for better output.
   }
 }
+
+#ifdef __linux__
+TEST(TcpConnectionEpollTests, readWaitsForDataWithoutIoUring) {
+  Dispatcher dispatcher(Dispatcher::DEFAULT_CONTEXT_STACK_SIZE, false);
+  ASSERT_FALSE(dispatcher.hasIoUring());
+  TcpListener listener(dispatcher, LISTEN_ADDRESS, LISTEN_PORT);
+  TcpConnection connection1 = TcpConnector(dispatcher).connect(LISTEN_ADDRESS, LISTEN_PORT);
+  TcpConnection connection2 = listener.accept();
+
+  ContextGroup contextGroup(dispatcher);
+  size_t size = 0;
+  uint8_t data[1024];
+  contextGroup.spawn([&] {
+    size = connection2.read(data, sizeof(data));
+  });
+
+  Timer(dispatcher).sleep(std::chrono::milliseconds(1));
+  connection1.write(reinterpret_cast<const uint8_t*>("Test"), 4);
+  contextGroup.wait();
+  ASSERT_EQ(4, size);
+  ASSERT_EQ(0, memcmp(data, "Test", 4));
+}
+#endif
@@ -179,6 +179,10 @@ bool ICoreStub::removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue
   return queueList.remove(messageQueue);
 }
 
+CryptoNote::BlockchainEventRing& ICoreStub::getBlockchainEventRing() {
+  return eventRing;
+}
+
 uint32_t ICoreStub::getTopBlockIndex() const {
   return topHeight;
 }
@@ -229,7 +233,9 @@ void ICoreStub::addBlock(const CryptoNote::BlockTemplate& block) {
     blockHashByTxHashIndex.emplace(std::make_pair(txHash, hash));
   }
 
-  notifyObservers(BlockchainMessage{CryptoNote::Messages::NewBlock{topHeight, topId}}, queueList);
+  BlockchainMessage message{CryptoNote::Messages::NewBlock{topHeight, topId}};
+  eventRing.publish(message, topHeight);
+  notifyObservers(std::move(message), queueList);
   m_observerManager.notify(&CryptoNote::ICoreObserver::blockchainUpdated);
 }
 
@@ -244,9 +250,23 @@ std::vector<CryptoNote::RawBlock> ICoreStub::getBlocks(uint32_t startIndex, uint
   return {};
 }
 
-void ICoreStub::getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<CryptoNote::RawBlock>& blocks, std::vector<Crypto::Hash>& missedHashes) const {
+std::vector<CryptoNote::BlockScanTable> ICoreStub::getBlockScanTables(uint32_t startIndex, uint32_t count) const {
   //TODO:
   assert(false);
+  return {};
+}
+
+void ICoreStub::getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<CryptoNote::RawBlock>& rawBlocks, std::vector<Crypto::Hash>& missedHashes) const {
+  ++getBlocksCalls;
+  for (const auto& hash : blockHashes) {
+    auto it = blocks.find(hash);
+    if (it == blocks.end()) {
+      missedHashes.push_back(hash);
+    } else {
+      rawBlocks.push_back(CryptoNote::RawBlock{CryptoNote::toBinaryArray(it->second), {}});
+      ++blocksRequested;
+    }
+  }
 }
   
 std::error_code ICoreStub::submitBlock(CryptoNote::BinaryArray&& rawBlockTemplate) {
@@ -292,6 +312,18 @@ std::vector<Crypto::Hash> ICoreStub::getPoolTransactionHashes() const {
   return {};
 }
 
+void ICoreStub::getPoolTransactions(const std::vector<Crypto::Hash>& txs_ids, std::vector<CryptoNote::BinaryArray>& txs,
+                                    std::vector<Crypto::Hash>& missed_txs) const {
+  for (const Crypto::Hash& hash : txs_ids) {
+    auto iter = transactionPool.find(hash);
+    if (iter != transactionPool.end()) {
+      txs.push_back(iter->second);
+    } else {
+      missed_txs.push_back(hash);
+    }
+  }
+}
+
 bool ICoreStub::getBlockTemplate(CryptoNote::BlockTemplate& b, const CryptoNote::AccountPublicAddress& adr, const CryptoNote::BinaryArray& extraNonce, CryptoNote::Difficulty& difficulty, uint32_t& height) const {
   assert(false);
   return false;
@@ -43,6 +43,7 @@ public:
 
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>&  messageQueue) override;
   virtual bool removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) override;
+  virtual CryptoNote::BlockchainEventRing& getBlockchainEventRing() override;
   virtual uint32_t getTopBlockIndex() const override;
   virtual Crypto::Hash getTopBlockHash() const override;
   virtual uint64_t getBlockTimestampByIndex(uint32_t blockIndex) const override;
@@ -55,9 +56,11 @@ public:
   
   virtual std::vector<CryptoNote::RawBlock> getBlocks(uint32_t startIndex, uint32_t count) const override;
   virtual void getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<CryptoNote::RawBlock>& blocks, std::vector<Crypto::Hash>& missedHashes) const override;
+  virtual std::vector<CryptoNote::BlockScanTable> getBlockScanTables(uint32_t startIndex, uint32_t count) const override;
   virtual bool getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_t>& globalIndexes, std::vector<Crypto::PublicKey>& publicKeys) const override;
   virtual bool addTransactionToPool(const CryptoNote::BinaryArray& transactionBinaryArray) override;
   virtual std::vector<Crypto::Hash> getPoolTransactionHashes() const override;
+  virtual void getPoolTransactions(const std::vector<Crypto::Hash>& txs_ids, std::vector<CryptoNote::BinaryArray>& txs, std::vector<Crypto::Hash>& missed_txs) const override;
   virtual bool getBlockTemplate(CryptoNote::BlockTemplate& b, const CryptoNote::AccountPublicAddress& adr, const CryptoNote::BinaryArray& extraNonce, CryptoNote::Difficulty& difficulty, uint32_t& height) const override;
 
   virtual CryptoNote::CoreStatistics getCoreStatistics() const override;
@@ -94,6 +97,10 @@ public:
   void addBlock(const CryptoNote::BlockTemplate& block);
   void addTransaction(const CryptoNote::Transaction& tx);
 
+  // number of blocks returned by getBlocks
+  mutable size_t blocksRequested = 0;
+  mutable size_t getBlocksCalls = 0;
+
   void setPoolTxVerificationResult(bool result);
   void setPoolChangesResult(bool result);
   boost::optional<std::pair<CryptoNote::MultisignatureOutput, uint64_t>>
@@ -129,4 +136,5 @@ private:
   Tools::ObserverManager<CryptoNote::ICoreObserver> m_observerManager;
 
   CryptoNote::IntrusiveLinkedList<MessageQueue<BlockchainMessage>> queueList;
+  CryptoNote::BlockchainEventRing eventRing;
 };
@@ -23,6 +23,7 @@
 #include "Serialization/KVBinaryOutputStreamSerializer.h"
 #include "Serialization/SerializationOverloads.h"
 #include "Serialization/SerializationTools.h"
+#include "Common/StringOutputStream.h"
 
 #include <array>
 
@@ -152,3 +153,56 @@ TEST(KVSerialize, DISABLED_CollectionOfCollections) {
   ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(ts2, buf));
   EXPECT_EQ(ts1, ts2);
 }
+
+namespace {
+
+std::string dumpObjectSection(TestElement& element) {
+  KVBinaryOutputStreamSerializer serializer;
+  element.serialize(serializer);
+
+  std::string section;
+  Common::StringOutputStream stream(section);
+  serializer.dumpObjectSection(stream);
+  return section;
+}
+
+}
+
+TEST(KVSerialize, ObjectSectionsMatchSerializedObjects) {
+  TestStruct ts;
+  ts.u8 = 100;
+  ts.u32 = 0xff0000;
+  ts.u64 = 1ULL << 60;
+  ts.root.name = "hello";
+  ts.root.u32array = { 1, 2, 3 };
+
+  TestElement sample;
+  sample.nonce = 101;
+  ts.vec1.resize(3, sample);
+
+  std::string expected = CryptoNote::storeToBinaryKeyValue(ts);
+
+  KVBinaryOutputStreamSerializer serializer;
+  std::string root = dumpObjectSection(ts.root);
+  serializer.objectSection(root.data(), root.size(), "root");
+
+  size_t count = ts.vec1.size();
+  serializer.beginArray(count, "vec1");
+  for (auto& element : ts.vec1) {
+    std::string section = dumpObjectSection(element);
+    serializer.objectSection(section.data(), section.size(), "");
+  }
+  serializer.endArray();
+
+  serializer(ts.vec2, "vec2");
+  serializer(ts.vecOfVec, "vecOfVec");
+  serializer(ts.u8, "u8");
+  serializer(ts.u32, "u32");
+  serializer(ts.u64, "u64");
+
+  std::string actual;
+  Common::StringOutputStream stream(actual);
+  serializer.dump(stream);
+
+  ASSERT_EQ(expected, actual);
+}
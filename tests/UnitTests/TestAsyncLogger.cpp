@@ -0,0 +1,177 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Logging/AsyncLogger.h"
+#include "Logging/LoggerManager.h"
+
+using namespace Logging;
+
+namespace {
+
+struct Collected {
+  Collected() : flushCount(0) {
+  }
+
+  std::vector<std::string> messages;
+  size_t flushCount;
+};
+
+class CollectingLogger : public CommonLogger {
+public:
+  CollectingLogger(Collected& collected, std::chrono::milliseconds delay = std::chrono::milliseconds(0)) : CommonLogger(TRACE), collected(collected), delay(delay) {
+    setPattern("");
+  }
+
+  virtual void flush() override {
+    ++collected.flushCount;
+  }
+
+protected:
+  virtual void doLogString(const std::string& message) override {
+    if (delay.count() != 0) {
+      std::this_thread::sleep_for(delay);
+    }
+
+    collected.messages.push_back(message);
+  }
+
+private:
+  Collected& collected;
+  std::chrono::milliseconds delay;
+};
+
+void log(ILogger& logger, Level level, const std::string& body) {
+  logger("test", level, boost::posix_time::microsec_clock::local_time(), body);
+}
+
+Common::JsonValue makeAsyncConfiguration(int64_t ringSize) {
+  Common::JsonValue configuration(Common::JsonValue::OBJECT);
+  Common::JsonValue& loggers = configuration.insert("loggers", Common::JsonValue::ARRAY);
+  Common::JsonValue& consoleLogger = loggers.pushBack(Common::JsonValue::OBJECT);
+  consoleLogger.insert("type", "console");
+  consoleLogger.insert("async", Common::JsonValue(true));
+  consoleLogger.insert("ringSize", ringSize);
+  return configuration;
+}
+
+}
+
+TEST(AsyncLogger, keepsOrderOfOneThread) {
+  Collected collected;
+  AsyncLogger logger(std::unique_ptr<CommonLogger>(new CollectingLogger(collected)), TRACE);
+  for (size_t i = 0; i < 1000; ++i) {
+    log(logger, INFO, std::to_string(i));
+  }
+
+  logger.waitWritten();
+  ASSERT_EQ(1000, collected.messages.size());
+  for (size_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(std::to_string(i), collected.messages[i]);
+  }
+
+  ASSERT_GT(collected.flushCount, 0);
+  ASSERT_LT(collected.flushCount, 1000);
+}
+
+TEST(AsyncLogger, filtersLevelOnCallingThread) {
+  Collected collected;
+  AsyncLogger logger(std::unique_ptr<CommonLogger>(new CollectingLogger(collected)), INFO);
+  log(logger, TRACE, "trace");
+  log(logger, INFO, "info");
+  logger.waitWritten();
+  ASSERT_EQ(std::vector<std::string>{"info"}, collected.messages);
+}
+
+TEST(AsyncLogger, collectsMessagesOfAllThreads) {
+  Collected collected;
+  {
+    AsyncLogger logger(std::unique_ptr<CommonLogger>(new CollectingLogger(collected)), TRACE, 16, AsyncLogger::BLOCK);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+      threads.emplace_back([&logger] {
+        for (size_t j = 0; j < 500; ++j) {
+          log(logger, DEBUGGING, "message");
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  ASSERT_EQ(2000, collected.messages.size());
+}
+
+TEST(AsyncLogger, reportsDroppedMessages) {
+  Collected collected;
+  {
+    AsyncLogger logger(std::unique_ptr<CommonLogger>(new CollectingLogger(collected, std::chrono::milliseconds(5))), TRACE, 4, AsyncLogger::DROP);
+    for (size_t i = 0; i < 100; ++i) {
+      log(logger, INFO, "message");
+    }
+  }
+
+  ASSERT_LT(collected.messages.size(), 100);
+  ASSERT_TRUE(std::any_of(collected.messages.begin(), collected.messages.end(), [](const std::string& message) {
+    return message.find("log messages dropped") != std::string::npos;
+  }));
+}
+
+TEST(AsyncLogger, loggerManagerRejectsNonPositiveRingSize) {
+  LoggerManager manager;
+  ASSERT_ANY_THROW(manager.configure(makeAsyncConfiguration(0)));
+  ASSERT_ANY_THROW(manager.configure(makeAsyncConfiguration(-1)));
+  ASSERT_NO_THROW(manager.configure(makeAsyncConfiguration(std::numeric_limits<int64_t>::max())));
+}
+
+TEST(AsyncLogger, loggerManagerDispatchesWhileLoggersChange) {
+  Collected collected;
+  Collected other;
+  CollectingLogger logger(collected);
+  CollectingLogger otherLogger(other);
+  LoggerManager manager;
+  manager.setMaxLevel(TRACE);
+  manager.addLogger(logger);
+
+  std::thread writer([&manager] {
+    for (size_t i = 0; i < 2000; ++i) {
+      log(manager, INFO, "message");
+    }
+  });
+
+  for (size_t i = 0; i < 200; ++i) {
+    manager.addLogger(otherLogger);
+    manager.removeLogger(otherLogger);
+  }
+
+  writer.join();
+  ASSERT_EQ(2000, collected.messages.size());
+
+  size_t otherCount = other.messages.size();
+  log(manager, INFO, "message");
+  ASSERT_EQ(otherCount, other.messages.size());
+  ASSERT_EQ(2001, collected.messages.size());
+}
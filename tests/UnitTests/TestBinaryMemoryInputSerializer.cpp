@@ -0,0 +1,276 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+#include "Common/MemoryInputStream.h"
+#include "Common/VectorOutputStream.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinaryMemoryInputSerializer.h"
+#include "Serialization/BinaryOutputStreamSerializer.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const size_t FUZZ_ITERATIONS = 3000;
+
+class BinaryMemoryInputSerializerTest : public ::testing::Test {
+public:
+  BinaryMemoryInputSerializerTest() : generator(42) {
+  }
+
+protected:
+  // raw engine output only, so that the corpus is the same with every standard library
+  uint32_t random(uint32_t bound) {
+    return generator() % bound;
+  }
+
+  template<typename T>
+  void randomPod(T& value) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&value);
+    for (size_t i = 0; i < sizeof(value); ++i) {
+      bytes[i] = static_cast<uint8_t>(generator());
+    }
+  }
+
+  Transaction makeTransaction() {
+    Transaction transaction;
+    transaction.version = 1;
+    transaction.unlockTime = generator();
+
+    KeyInput keyInput;
+    keyInput.amount = generator();
+    keyInput.outputIndexes = { static_cast<uint32_t>(generator() % 1000), static_cast<uint32_t>(generator() % 100000), 1 };
+    randomPod(keyInput.keyImage);
+    transaction.inputs.push_back(keyInput);
+    transaction.inputs.push_back(MultisignatureInput{ 1000000, 2, static_cast<uint32_t>(generator()) });
+
+    KeyOutput keyOutput;
+    randomPod(keyOutput.key);
+    transaction.outputs.push_back({ 70000000000, keyOutput });
+    MultisignatureOutput multisignatureOutput;
+    multisignatureOutput.keys.resize(2);
+    randomPod(multisignatureOutput.keys[0]);
+    randomPod(multisignatureOutput.keys[1]);
+    multisignatureOutput.requiredSignatureCount = 2;
+    transaction.outputs.push_back({ 1000, multisignatureOutput });
+
+    Crypto::PublicKey transactionPublicKey;
+    randomPod(transactionPublicKey);
+    addTransactionPublicKeyToExtra(transaction.extra, transactionPublicKey);
+    addExtraNonceToTransactionExtra(transaction.extra, { 1, 2, 3, 4 });
+
+    transaction.signatures.resize(2);
+    transaction.signatures[0].resize(keyInput.outputIndexes.size());
+    transaction.signatures[1].resize(2);
+    for (auto& signatures : transaction.signatures) {
+      for (auto& signature : signatures) {
+        randomPod(signature);
+      }
+    }
+
+    return transaction;
+  }
+
+  BlockTemplate makeBlock(uint8_t majorVersion) {
+    BlockTemplate block;
+    block.majorVersion = majorVersion;
+    block.minorVersion = 0;
+    block.nonce = generator();
+    block.timestamp = generator();
+    randomPod(block.previousBlockHash);
+
+    block.baseTransaction = makeTransaction();
+    block.baseTransaction.inputs.assign(1, BaseInput{ static_cast<uint32_t>(generator()) });
+    block.baseTransaction.signatures.clear();
+
+    block.transactionHashes.resize(3);
+    for (auto& hash : block.transactionHashes) {
+      randomPod(hash);
+    }
+
+    if (majorVersion >= BLOCK_MAJOR_VERSION_2) {
+      block.parentBlock.majorVersion = BLOCK_MAJOR_VERSION_1;
+      block.parentBlock.minorVersion = 0;
+      randomPod(block.parentBlock.previousBlockHash);
+      block.parentBlock.transactionCount = 2;
+      block.parentBlock.baseTransactionBranch.resize(1);
+      randomPod(block.parentBlock.baseTransactionBranch[0]);
+      block.parentBlock.baseTransaction.version = 1;
+      block.parentBlock.baseTransaction.unlockTime = 0;
+      block.parentBlock.baseTransaction.inputs.assign(1, BaseInput{ 1 });
+
+      TransactionExtraMergeMiningTag mmTag;
+      mmTag.depth = 0;
+      randomPod(mmTag.merkleRoot);
+      appendMergeMiningTagToExtra(block.parentBlock.baseTransaction.extra, mmTag);
+    }
+
+    return block;
+  }
+
+  BinaryArray mutate(const BinaryArray& data) {
+    BinaryArray result = data;
+    switch (random(4)) {
+    case 0: {
+      size_t flips = 1 + random(4);
+      for (size_t i = 0; i < flips && !result.empty(); ++i) {
+        result[random(static_cast<uint32_t>(result.size()))] ^= static_cast<uint8_t>(1 << random(8));
+      }
+      break;
+    }
+
+    case 1:
+      result.resize(random(static_cast<uint32_t>(result.size())));
+      break;
+
+    case 2: {
+      size_t position = random(static_cast<uint32_t>(result.size() + 1));
+      result.insert(result.begin() + position, static_cast<uint8_t>(generator()));
+      break;
+    }
+
+    default:
+      if (!result.empty()) {
+        result[random(static_cast<uint32_t>(result.size()))] = static_cast<uint8_t>(generator());
+      }
+    }
+
+    return result;
+  }
+
+  template<typename T>
+  static BinaryArray store(T& value) {
+    BinaryArray result;
+    Common::VectorOutputStream stream(result);
+    BinaryOutputStreamSerializer serializer(stream);
+    serializer(value, "");
+    return result;
+  }
+
+  // Decodes with both serializers; they must agree on failure, on the decoded value and on the consumed size
+  template<typename T>
+  void checkSameResult(const BinaryArray& data) {
+    T memoryValue;
+    bool memoryFailed = false;
+    size_t memoryConsumed = 0;
+    try {
+      BinaryMemoryInputSerializer serializer(data.data(), data.size());
+      serializer(memoryValue, "");
+      memoryConsumed = serializer.position();
+    } catch (std::exception& e) {
+      if (std::string(e.what()).find("declared size exceeds") != std::string::npos) {
+        // the stream serializer can't decode it either, it would only allocate the declared size before failing
+        return;
+      }
+
+      memoryFailed = true;
+    }
+
+    T streamValue;
+    bool streamFailed = false;
+    size_t streamConsumed = 0;
+    try {
+      Common::MemoryInputStream stream(data.data(), data.size());
+      BinaryInputStreamSerializer serializer(stream);
+      serializer(streamValue, "");
+      streamConsumed = stream.getPosition();
+    } catch (std::exception&) {
+      streamFailed = true;
+    }
+
+    ASSERT_EQ(streamFailed, memoryFailed);
+    if (!streamFailed) {
+      ASSERT_EQ(streamConsumed, memoryConsumed);
+      ASSERT_EQ(store(streamValue), store(memoryValue));
+    }
+  }
+
+  std::mt19937 generator;
+};
+
+TEST_F(BinaryMemoryInputSerializerTest, readsWhatBinaryOutputSerializerWrites) {
+  Transaction transaction = makeTransaction();
+  BinaryArray data = toBinaryArray(transaction);
+
+  BinaryMemoryInputSerializer serializer(data.data(), data.size());
+  Transaction restored;
+  serialize(restored, serializer);
+
+  ASSERT_TRUE(serializer.endOfStream());
+  ASSERT_EQ(data, toBinaryArray(restored));
+}
+
+TEST_F(BinaryMemoryInputSerializerTest, varintsMatchStreamSerializer) {
+  std::vector<BinaryArray> cases = {
+    { 0x00 }, { 0x7f }, { 0x80, 0x01 }, { 0xff, 0x01 }, { 0xff, 0x03 }, { 0x80, 0x00 }, { 0x80 },
+    { 0xff, 0xff, 0x03 }, { 0xff, 0xff, 0x04 }, { 0xff, 0xff, 0xff, 0xff, 0x0f }, { 0xff, 0xff, 0xff, 0xff, 0x10 },
+    { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 }, { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02 },
+    { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 }
+  };
+
+  for (const auto& data : cases) {
+    checkSameResult<uint8_t>(data);
+    checkSameResult<uint16_t>(data);
+    checkSameResult<int16_t>(data);
+    checkSameResult<uint32_t>(data);
+    checkSameResult<int32_t>(data);
+    checkSameResult<uint64_t>(data);
+    checkSameResult<int64_t>(data);
+    checkSameResult<std::string>(data);
+  }
+}
+
+TEST_F(BinaryMemoryInputSerializerTest, fuzzTransactionsMatchStreamSerializer) {
+  BinaryArray data = toBinaryArray(makeTransaction());
+  checkSameResult<Transaction>(data);
+
+  for (size_t i = 0; i < FUZZ_ITERATIONS; ++i) {
+    checkSameResult<Transaction>(mutate(data));
+  }
+}
+
+TEST_F(BinaryMemoryInputSerializerTest, fuzzBlocksMatchStreamSerializer) {
+  for (uint8_t majorVersion : { BLOCK_MAJOR_VERSION_1, BLOCK_MAJOR_VERSION_2 }) {
+    BinaryArray data = toBinaryArray(makeBlock(majorVersion));
+    checkSameResult<BlockTemplate>(data);
+
+    for (size_t i = 0; i < FUZZ_ITERATIONS; ++i) {
+      checkSameResult<BlockTemplate>(mutate(data));
+    }
+  }
+}
+
+TEST_F(BinaryMemoryInputSerializerTest, fuzzRandomBytesMatchStreamSerializer) {
+  for (size_t i = 0; i < FUZZ_ITERATIONS; ++i) {
+    BinaryArray data(random(200));
+    for (auto& byte : data) {
+      byte = static_cast<uint8_t>(generator());
+    }
+
+    checkSameResult<Transaction>(data);
+    checkSameResult<BlockTemplate>(data);
+  }
+}
+
+}
@@ -0,0 +1,232 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <thread>
+
+#include "CryptoNoteCore/BlockchainEventRing.h"
+#include "crypto/hash.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+typedef BlockchainEventRing::ReadResult ReadResult;
+
+Crypto::Hash makeHash(uint32_t value) {
+  Crypto::Hash hash = {};
+  std::memcpy(hash.data, &value, sizeof(value));
+  return hash;
+}
+
+std::vector<Crypto::Hash> makeHashes(uint32_t first, size_t count) {
+  std::vector<Crypto::Hash> hashes;
+  for (size_t i = 0; i < count; ++i) {
+    hashes.push_back(makeHash(first + static_cast<uint32_t>(i)));
+  }
+
+  return hashes;
+}
+
+TEST(BlockchainEventRing, emptyRingHasNothingToRead) {
+  BlockchainEventRing ring(16);
+  BlockchainEventRing::Subscriber subscriber(ring);
+
+  boost::optional<BlockchainMessage> message;
+  uint32_t topIndex;
+  ASSERT_EQ(ReadResult::Empty, subscriber.tryRead(message, topIndex));
+  ASSERT_FALSE(message);
+}
+
+TEST(BlockchainEventRing, everySubscriberGetsAllMessagesInOrder) {
+  BlockchainEventRing ring(64);
+  BlockchainEventRing::Subscriber first(ring);
+  BlockchainEventRing::Subscriber second(ring);
+
+  ring.publish(makeNewBlockMessage(10, makeHash(10)), 10);
+  ring.publish(makeNewAlternativeBlockMessage(10, makeHash(11)), 10);
+  ring.publish(makeChainSwitchMessage(9, makeHashes(20, 3)), 11);
+  ring.publish(makeAddTransactionMessage(makeHashes(30, 2)), 11);
+  ring.publish(makeDelTransactionMessage(makeHashes(40, 1), Messages::DeleteTransaction::Reason::Outdated), 11);
+
+  for (BlockchainEventRing::Subscriber* subscriber : { &first, &second }) {
+    boost::optional<BlockchainMessage> message;
+    uint32_t topIndex;
+
+    ASSERT_EQ(ReadResult::Message, subscriber->tryRead(message, topIndex));
+    ASSERT_EQ(BlockchainMessage::Type::NewBlock, message->getType());
+    ASSERT_EQ(10, message->getNewBlock().blockIndex);
+    ASSERT_EQ(makeHash(10), message->getNewBlock().blockHash);
+    ASSERT_EQ(10, topIndex);
+
+    ASSERT_EQ(ReadResult::Message, subscriber->tryRead(message, topIndex));
+    ASSERT_EQ(BlockchainMessage::Type::NewAlternativeBlock, message->getType());
+    ASSERT_EQ(makeHash(11), message->getNewAlternativeBlock().blockHash);
+
+    ASSERT_EQ(ReadResult::Message, subscriber->tryRead(message, topIndex));
+    ASSERT_EQ(BlockchainMessage::Type::ChainSwitch, message->getType());
+    ASSERT_EQ(9, message->getChainSwitch().commonRootIndex);
+    ASSERT_EQ(makeHashes(20, 3), message->getChainSwitch().blocksFromCommonRoot);
+    ASSERT_EQ(11, topIndex);
+
+    ASSERT_EQ(ReadResult::Message, subscriber->tryRead(message, topIndex));
+    ASSERT_EQ(BlockchainMessage::Type::AddTransaction, message->getType());
+    ASSERT_EQ(makeHashes(30, 2), message->getAddTransaction().hashes);
+
+    ASSERT_EQ(ReadResult::Message, subscriber->tryRead(message, topIndex));
+    ASSERT_EQ(BlockchainMessage::Type::DeleteTransaction, message->getType());
+    ASSERT_EQ(makeHashes(40, 1), message->getDeleteTransaction().hashes);
+    ASSERT_EQ(Messages::DeleteTransaction::Reason::Outdated, message->getDeleteTransaction().reason);
+
+    ASSERT_EQ(ReadResult::Empty, subscriber->tryRead(message, topIndex));
+  }
+}
+
+TEST(BlockchainEventRing, lappedSubscriberDetectsOverflowAndContinues) {
+  BlockchainEventRing ring(8);
+  BlockchainEventRing::Subscriber slow(ring);
+  BlockchainEventRing::Subscriber fast(ring);
+
+  boost::optional<BlockchainMessage> message;
+  uint32_t topIndex;
+  for (uint32_t i = 0; i < 20; ++i) {
+    ring.publish(makeNewBlockMessage(i, makeHash(i)), i);
+    ASSERT_EQ(ReadResult::Message, fast.tryRead(message, topIndex));
+    ASSERT_EQ(i, message->getNewBlock().blockIndex);
+  }
+
+  ASSERT_EQ(ReadResult::Overflow, slow.tryRead(message, topIndex));
+  ASSERT_EQ(1, slow.getOverflowCount());
+  ASSERT_EQ(ReadResult::Empty, slow.tryRead(message, topIndex));
+
+  ring.publish(makeNewBlockMessage(20, makeHash(20)), 20);
+  ASSERT_EQ(ReadResult::Message, slow.tryRead(message, topIndex));
+  ASSERT_EQ(20, message->getNewBlock().blockIndex);
+  ASSERT_EQ(0, fast.getOverflowCount());
+}
+
+TEST(BlockchainEventRing, poolMessagesDropHashesWhenSlowestSubscriberHasNoRoom) {
+  BlockchainEventRing ring(8);
+  BlockchainEventRing::Subscriber subscriber(ring);
+
+  ring.publish(makeAddTransactionMessage(makeHashes(0, 6)), 0);
+  ASSERT_EQ(2, ring.getFreeSpace());
+
+  ring.publish(makeAddTransactionMessage(makeHashes(10, 4)), 0);
+  ring.publish(makeChainSwitchMessage(0, makeHashes(20, 9)), 9);
+
+  boost::optional<BlockchainMessage> message;
+  uint32_t topIndex;
+  ASSERT_EQ(ReadResult::Message, subscriber.tryRead(message, topIndex));
+  ASSERT_EQ(makeHashes(0, 6), message->getAddTransaction().hashes);
+  ASSERT_EQ(ReadResult::Overflow, subscriber.tryRead(message, topIndex));
+  ASSERT_EQ(ReadResult::Overflow, subscriber.tryRead(message, topIndex));
+  ASSERT_EQ(9, topIndex);
+  ASSERT_EQ(2, subscriber.getOverflowCount());
+  ASSERT_EQ(ReadResult::Empty, subscriber.tryRead(message, topIndex));
+}
+
+TEST(BlockchainEventRing, truncatedMessageDoesNotSkipFollowingMessages) {
+  BlockchainEventRing ring(8);
+  BlockchainEventRing::Subscriber subscriber(ring);
+
+  ring.publish(makeChainSwitchMessage(0, makeHashes(20, 9)), 9);
+  ring.publish(makeNewBlockMessage(10, makeHash(10)), 10);
+
+  boost::optional<BlockchainMessage> message;
+  uint32_t topIndex;
+  ASSERT_EQ(ReadResult::Overflow, subscriber.tryRead(message, topIndex));
+  ASSERT_EQ(ReadResult::Message, subscriber.tryRead(message, topIndex));
+  ASSERT_EQ(BlockchainMessage::Type::NewBlock, message->getType());
+  ASSERT_EQ(10, message->getNewBlock().blockIndex);
+  ASSERT_EQ(10, topIndex);
+}
+
+TEST(BlockchainEventRing, stopWakesBlockedReader) {
+  BlockchainEventRing ring(16);
+  BlockchainEventRing::Subscriber subscriber(ring);
+
+  ReadResult result = ReadResult::Empty;
+  std::thread reader([&] {
+    boost::optional<BlockchainMessage> message;
+    uint32_t topIndex;
+    result = subscriber.read(message, topIndex);
+  });
+
+  subscriber.stop();
+  reader.join();
+  ASSERT_EQ(ReadResult::Stopped, result);
+}
+
+TEST(BlockchainEventRing, readersOnOtherThreadsSeeOrderedMessages) {
+  const uint32_t MESSAGE_COUNT = 20000;
+  BlockchainEventRing ring(256);
+
+  std::vector<std::unique_ptr<BlockchainEventRing::Subscriber>> subscribers;
+  for (size_t i = 0; i < 3; ++i) {
+    subscribers.emplace_back(new BlockchainEventRing::Subscriber(ring));
+  }
+
+  std::vector<bool> ordered(subscribers.size(), true);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < subscribers.size(); ++i) {
+    readers.emplace_back([&, i] {
+      boost::optional<BlockchainMessage> message;
+      uint32_t topIndex;
+      int64_t lastIndex = -1;
+      for (;;) {
+        ReadResult result = subscribers[i]->read(message, topIndex);
+        if (result == ReadResult::Stopped) {
+          break;
+        }
+
+        if (result == ReadResult::Overflow) {
+          continue;
+        }
+
+        uint32_t index = message->getNewBlock().blockIndex;
+        if (index <= lastIndex || message->getNewBlock().blockHash != makeHash(index) || topIndex != index) {
+          ordered[i] = false;
+        }
+
+        lastIndex = index;
+      }
+    });
+  }
+
+  for (uint32_t i = 0; i < MESSAGE_COUNT; ++i) {
+    ring.publish(makeNewBlockMessage(i, makeHash(i)), i);
+  }
+
+  for (auto& subscriber : subscribers) {
+    subscriber->stop();
+  }
+
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  for (size_t i = 0; i < subscribers.size(); ++i) {
+    ASSERT_TRUE(ordered[i]);
+  }
+}
+
+}
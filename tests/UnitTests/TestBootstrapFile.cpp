@@ -0,0 +1,147 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "CryptoNoteCore/BootstrapFile.h"
+#include "crypto/crypto.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+RawBlock makeRawBlock(uint32_t index) {
+  RawBlock block;
+  block.block.assign(16 + index % 5, static_cast<uint8_t>(index));
+  for (uint32_t i = 0; i < index % 3; ++i) {
+    block.transactions.push_back(BinaryArray(8, static_cast<uint8_t>(index + i)));
+  }
+
+  return block;
+}
+
+class BootstrapFileTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_bootstrap_%%%%%%%%%%%%");
+    genesisBlockHash = Crypto::rand<Crypto::Hash>();
+  }
+
+  void TearDown() override {
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove(path, ignoredErrorCode);
+  }
+
+  void writeFile(uint32_t blockCount, uint32_t chunkBlockCount) {
+    BootstrapFileWriter writer(path.string(), genesisBlockHash, chunkBlockCount);
+    for (uint32_t i = 0; i < blockCount; ++i) {
+      writer.pushBlock(makeRawBlock(i));
+    }
+
+    writer.finish();
+    ASSERT_EQ(blockCount, writer.getBlockCount());
+  }
+
+  void corruptByte(uint64_t offset) {
+    std::fstream file(path.string(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(offset);
+    char value = static_cast<char>(file.get());
+    file.seekp(offset);
+    file.put(static_cast<char>(value ^ 0xff));
+  }
+
+  boost::filesystem::path path;
+  Crypto::Hash genesisBlockHash;
+};
+
+TEST_F(BootstrapFileTest, readsBlocksWritten) {
+  writeFile(25, 10);
+
+  BootstrapFileReader reader(path.string());
+  ASSERT_EQ(genesisBlockHash, reader.getGenesisBlockHash());
+  ASSERT_EQ(25, reader.getBlockCount());
+  ASSERT_EQ(3, reader.getChunks().size());
+
+  uint32_t index = 0;
+  for (size_t chunk = 0; chunk < reader.getChunks().size(); ++chunk) {
+    ASSERT_EQ(index, reader.getChunks()[chunk].startIndex);
+    for (const auto& block : reader.readChunk(chunk)) {
+      RawBlock expected = makeRawBlock(index++);
+      ASSERT_EQ(expected.block, block.block);
+      ASSERT_EQ(expected.transactions, block.transactions);
+    }
+  }
+
+  ASSERT_EQ(25, index);
+}
+
+TEST_F(BootstrapFileTest, findChunkReturnsChunkContainingBlock) {
+  writeFile(25, 10);
+
+  BootstrapFileReader reader(path.string());
+  ASSERT_EQ(0, reader.findChunk(0));
+  ASSERT_EQ(0, reader.findChunk(9));
+  ASSERT_EQ(1, reader.findChunk(10));
+  ASSERT_EQ(2, reader.findChunk(24));
+  ASSERT_EQ(reader.getChunks().size(), reader.findChunk(25));
+}
+
+TEST_F(BootstrapFileTest, emptyFileHasNoChunks) {
+  writeFile(0, 10);
+
+  BootstrapFileReader reader(path.string());
+  ASSERT_EQ(0, reader.getBlockCount());
+  ASSERT_TRUE(reader.getChunks().empty());
+  ASSERT_EQ(0, reader.findChunk(0));
+}
+
+TEST_F(BootstrapFileTest, damagedChunkIsDetected) {
+  writeFile(25, 10);
+
+  uint64_t secondChunkOffset;
+  {
+    BootstrapFileReader reader(path.string());
+    secondChunkOffset = reader.getChunks()[1].offset;
+  }
+
+  corruptByte(secondChunkOffset + 60);
+
+  BootstrapFileReader reader(path.string());
+  ASSERT_NO_THROW(reader.readChunk(0));
+  ASSERT_THROW(reader.readChunk(1), std::runtime_error);
+  ASSERT_NO_THROW(reader.readChunk(2));
+}
+
+TEST_F(BootstrapFileTest, damagedIndexIsDetected) {
+  writeFile(25, 10);
+  corruptByte(boost::filesystem::file_size(path) - 60);
+
+  ASSERT_THROW(BootstrapFileReader reader(path.string()), std::runtime_error);
+}
+
+TEST_F(BootstrapFileTest, truncatedFileIsRejected) {
+  writeFile(25, 10);
+  boost::filesystem::resize_file(path, boost::filesystem::file_size(path) - 1);
+
+  ASSERT_THROW(BootstrapFileReader reader(path.string()), std::runtime_error);
+}
+
+}
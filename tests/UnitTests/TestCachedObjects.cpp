@@ -0,0 +1,183 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/CachedTransaction.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "Logging/ConsoleLogger.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+class CachedObjectsTest : public ::testing::Test {
+public:
+  CachedObjectsTest() : currency(CurrencyBuilder(logger).currency()) {
+  }
+
+protected:
+  Transaction makeTransaction() {
+    Transaction transaction;
+    transaction.version = CURRENT_TRANSACTION_VERSION;
+    transaction.unlockTime = 100;
+
+    KeyInput keyInput;
+    keyInput.amount = 1000000;
+    keyInput.outputIndexes = { 1, 200, 30000 };
+    keyInput.keyImage = Crypto::rand<Crypto::KeyImage>();
+    transaction.inputs.push_back(keyInput);
+    transaction.inputs.push_back(MultisignatureInput{ 500000, 2, 7 });
+
+    transaction.outputs.push_back({ 700000, KeyOutput{ Crypto::rand<Crypto::PublicKey>() } });
+    transaction.outputs.push_back({ 300000, MultisignatureOutput{ { Crypto::rand<Crypto::PublicKey>(), Crypto::rand<Crypto::PublicKey>() }, 2 } });
+    addTransactionPublicKeyToExtra(transaction.extra, Crypto::rand<Crypto::PublicKey>());
+
+    transaction.signatures.resize(2);
+    transaction.signatures[0].resize(keyInput.outputIndexes.size());
+    transaction.signatures[1].resize(2);
+    for (auto& signatures : transaction.signatures) {
+      for (auto& signature : signatures) {
+        signature = Crypto::rand<Crypto::Signature>();
+      }
+    }
+
+    return transaction;
+  }
+
+  BlockTemplate makeMergeMinedBlock() {
+    BlockTemplate block = currency.genesisBlock();
+    block.majorVersion = BLOCK_MAJOR_VERSION_2;
+    block.transactionHashes = { Crypto::rand<Crypto::Hash>(), Crypto::rand<Crypto::Hash>() };
+
+    block.parentBlock.majorVersion = BLOCK_MAJOR_VERSION_1;
+    block.parentBlock.minorVersion = 0;
+    block.parentBlock.transactionCount = 1;
+    block.parentBlock.baseTransaction.version = CURRENT_TRANSACTION_VERSION;
+    block.parentBlock.baseTransaction.unlockTime = 0;
+    block.parentBlock.baseTransaction.inputs.assign(1, BaseInput{ 1 });
+
+    TransactionExtraMergeMiningTag mmTag;
+    mmTag.depth = 0;
+    mmTag.merkleRoot = CachedBlock(block).getAuxiliaryBlockHeaderHash();
+    appendMergeMiningTagToExtra(block.parentBlock.baseTransaction.extra, mmTag);
+    return block;
+  }
+
+  Logging::ConsoleLogger logger;
+  Currency currency;
+};
+
+TEST_F(CachedObjectsTest, binarySizeMatchesSerializedSize) {
+  Transaction transaction = makeTransaction();
+  ASSERT_EQ(toBinaryArray(transaction).size(), getObjectBinarySize(transaction));
+  ASSERT_EQ(toBinaryArray(static_cast<const TransactionPrefix&>(transaction)).size(), getObjectBinarySize(static_cast<const TransactionPrefix&>(transaction)));
+
+  BlockTemplate genesis = currency.genesisBlock();
+  ASSERT_EQ(toBinaryArray(genesis).size(), getObjectBinarySize(genesis));
+  ASSERT_EQ(toBinaryArray(genesis.baseTransaction).size(), getObjectBinarySize(genesis.baseTransaction));
+
+  BlockTemplate mergeMinedBlock = makeMergeMinedBlock();
+  ASSERT_EQ(toBinaryArray(mergeMinedBlock).size(), getObjectBinarySize(mergeMinedBlock));
+}
+
+TEST_F(CachedObjectsTest, blockFromBinaryArrayHasSameHashes) {
+  for (const BlockTemplate& original : { currency.genesisBlock(), makeMergeMinedBlock() }) {
+    BinaryArray blockBinaryArray = toBinaryArray(original);
+    BlockTemplate block = fromBinaryArray<BlockTemplate>(blockBinaryArray);
+
+    CachedBlock fromTemplate(block);
+    CachedBlock fromBlob(block, blockBinaryArray);
+    ASSERT_EQ(getObjectHash(block.baseTransaction), fromBlob.getBaseTransactionHash());
+    ASSERT_EQ(getObjectBinarySize(block.baseTransaction), fromBlob.getBaseTransactionSize());
+    ASSERT_EQ(fromTemplate.getTransactionTreeHash(), fromBlob.getTransactionTreeHash());
+    ASSERT_EQ(fromTemplate.getBlockHash(), fromBlob.getBlockHash());
+  }
+}
+
+TEST_F(CachedObjectsTest, blockFromForeignBinaryArrayIsRejected) {
+  BlockTemplate block = makeMergeMinedBlock();
+  BinaryArray shortBinaryArray(10);
+  ASSERT_ANY_THROW(CachedBlock(block, shortBinaryArray));
+}
+
+TEST_F(CachedObjectsTest, transactionFromBinaryArrayHasSamePrefixHash) {
+  Transaction transaction = makeTransaction();
+  BinaryArray transactionBinaryArray = toBinaryArray(transaction);
+  Crypto::Hash expectedPrefixHash = getObjectHash(static_cast<const TransactionPrefix&>(transaction));
+
+  CachedTransaction fromBlob(transactionBinaryArray);
+  ASSERT_EQ(expectedPrefixHash, fromBlob.getTransactionPrefixHash());
+  ASSERT_EQ(getBinaryArrayHash(transactionBinaryArray), fromBlob.getTransactionHash());
+
+  CachedTransaction fromMovedBlob{BinaryArray(transactionBinaryArray)};
+  ASSERT_EQ(expectedPrefixHash, fromMovedBlob.getTransactionPrefixHash());
+  ASSERT_EQ(transactionBinaryArray, fromMovedBlob.getTransactionBinaryArray());
+}
+
+TEST_F(CachedObjectsTest, baseTransactionFromBinaryArrayHasSamePrefixHash) {
+  const Transaction& baseTransaction = currency.genesisBlock().baseTransaction;
+  CachedTransaction fromBlob(toBinaryArray(baseTransaction));
+  ASSERT_EQ(getObjectHash(static_cast<const TransactionPrefix&>(baseTransaction)), fromBlob.getTransactionPrefixHash());
+}
+
+TEST_F(CachedObjectsTest, transactionFromBinaryArrayReadsSignaturesInPlace) {
+  Transaction transaction = makeTransaction();
+  CachedTransaction fromBlob(toBinaryArray(transaction));
+  ASSERT_TRUE(toBinaryArray(static_cast<const TransactionPrefix&>(transaction)) ==
+    toBinaryArray(fromBlob.getTransactionPrefix()));
+
+  for (size_t i = 0; i < transaction.inputs.size(); ++i) {
+    const Crypto::Signature* signatures = fromBlob.getInputSignatures(i);
+    ASSERT_TRUE(std::equal(transaction.signatures[i].begin(), transaction.signatures[i].end(), signatures));
+  }
+
+  ASSERT_EQ(transaction.signatures, fromBlob.getTransaction().signatures);
+  for (size_t i = 0; i < transaction.inputs.size(); ++i) {
+    ASSERT_EQ(fromBlob.getTransaction().signatures[i].data(), fromBlob.getInputSignatures(i));
+  }
+}
+
+TEST_F(CachedObjectsTest, baseTransactionFromBinaryArrayHasNoSignatures) {
+  const Transaction& baseTransaction = currency.genesisBlock().baseTransaction;
+  CachedTransaction fromBlob(toBinaryArray(baseTransaction));
+  ASSERT_TRUE(fromBlob.getTransaction().signatures.empty());
+  ASSERT_EQ(toBinaryArray(baseTransaction), toBinaryArray(fromBlob.getTransaction()));
+}
+
+TEST_F(CachedObjectsTest, transactionWithWrongSignaturesSizeIsRejected) {
+  BinaryArray transactionBinaryArray = toBinaryArray(makeTransaction());
+
+  BinaryArray truncated(transactionBinaryArray.begin(), transactionBinaryArray.end() - 1);
+  ASSERT_ANY_THROW(CachedTransaction{truncated});
+
+  BinaryArray extended(transactionBinaryArray);
+  extended.push_back(0);
+  ASSERT_ANY_THROW(CachedTransaction{extended});
+
+  BinaryArray extraSignature(transactionBinaryArray);
+  extraSignature.insert(extraSignature.end(), sizeof(Crypto::Signature), 0);
+  ASSERT_ANY_THROW(CachedTransaction{extraSignature});
+}
+
+}
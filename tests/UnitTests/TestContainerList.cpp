@@ -0,0 +1,107 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "PaymentGateService/PaymentServiceConfiguration.h"
+
+using namespace PaymentService;
+
+namespace {
+
+const std::string CONTAINER_LIST_PATH = "containers.list";
+
+class ContainerListTest : public ::testing::Test {
+public:
+  void TearDown() override {
+    boost::filesystem::remove(CONTAINER_LIST_PATH);
+  }
+
+  void writeList(const std::string& content) {
+    std::ofstream file(CONTAINER_LIST_PATH, std::ios::binary);
+    file << content;
+  }
+};
+
+TEST_F(ContainerListTest, commentsAndBlankLinesAreSkipped) {
+  writeList("# name file password\n"
+            "\n"
+            "alice alice.wallet secret\n"
+            "   # indented comment\n"
+            "bob bob.wallet pass\n");
+
+  auto containers = readContainerList(CONTAINER_LIST_PATH);
+
+  ASSERT_EQ(2, containers.size());
+  ASSERT_EQ("alice", containers[0].name);
+  ASSERT_EQ("alice.wallet", containers[0].containerFile);
+  ASSERT_EQ("secret", containers[0].containerPassword);
+  ASSERT_EQ("bob", containers[1].name);
+  ASSERT_EQ("bob.wallet", containers[1].containerFile);
+  ASSERT_EQ("pass", containers[1].containerPassword);
+}
+
+TEST_F(ContainerListTest, passwordIsRestOfLine) {
+  writeList("alice alice.wallet   correct horse battery staple\n"
+            "bob bob.wallet pass # not a comment\r\n");
+
+  auto containers = readContainerList(CONTAINER_LIST_PATH);
+
+  ASSERT_EQ(2, containers.size());
+  ASSERT_EQ("correct horse battery staple", containers[0].containerPassword);
+  ASSERT_EQ("pass # not a comment", containers[1].containerPassword);
+}
+
+TEST_F(ContainerListTest, passwordCanBeEmpty) {
+  writeList("alice alice.wallet\n");
+
+  auto containers = readContainerList(CONTAINER_LIST_PATH);
+
+  ASSERT_EQ(1, containers.size());
+  ASSERT_EQ("alice.wallet", containers[0].containerFile);
+  ASSERT_EQ("", containers[0].containerPassword);
+}
+
+TEST_F(ContainerListTest, duplicateNameIsRejected) {
+  writeList("alice alice.wallet secret\n"
+            "alice bob.wallet pass\n");
+
+  ASSERT_THROW(readContainerList(CONTAINER_LIST_PATH), ConfigurationError);
+}
+
+TEST_F(ContainerListTest, missingContainerFileIsRejected) {
+  writeList("alice\n");
+
+  ASSERT_THROW(readContainerList(CONTAINER_LIST_PATH), ConfigurationError);
+}
+
+TEST_F(ContainerListTest, listWithoutContainersIsRejected) {
+  writeList("# nothing here\n\n");
+
+  ASSERT_THROW(readContainerList(CONTAINER_LIST_PATH), ConfigurationError);
+}
+
+TEST_F(ContainerListTest, missingListIsRejected) {
+  ASSERT_THROW(readContainerList(CONTAINER_LIST_PATH), ConfigurationError);
+}
+
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <System/Dispatcher.h>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/DatabaseBlockchainCacheFactory.h"
+#include "CryptoNoteCore/TransactionApi.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "CryptoNoteCore/UpgradeDetector.h"
+#include "Logging/ConsoleLogger.h"
+
+#include "../Common/VectorMainChainStorage.h"
+#include "DataBaseMock.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint32_t UPGRADE_INDEX = 3;
+const uint64_t OUTPUT_AMOUNT = UINT64_C(10000000);
+
+class CoreTransactionPoolStateTest : public ::testing::Test {
+public:
+  CoreTransactionPoolStateTest() :
+    logger(Logging::ERROR),
+    // blocks after UPGRADE_INDEX are version 2, from which on every ring needs at least two members
+    currency(CurrencyBuilder(logger).upgradeHeightV2(UPGRADE_INDEX).upgradeHeightV3(IUpgradeDetector::UNDEF_HEIGHT)
+      .upgradeHeightV4(IUpgradeDetector::UNDEF_HEIGHT).mandatoryMixinBlockVersion(BLOCK_MAJOR_VERSION_2).minMixin(2).currency()) {
+    account.generate();
+    blocks.push_back(RawBlock{toBinaryArray(currency.genesisBlock()), {}});
+  }
+
+  void SetUp() override {
+    dataFolder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_pool_state_%%%%%%%%%%%%");
+    boost::filesystem::create_directory(dataFolder);
+  }
+
+  void TearDown() override {
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(dataFolder, ignoredErrorCode);
+  }
+
+  // The blocks are imported from the main chain storage without validation, so the coinbase can pay whatever the test needs
+  void appendBlock(size_t outputCount) {
+    auto transaction = createTransaction();
+    for (size_t i = 0; i < outputCount; ++i) {
+      transaction->addOutput(OUTPUT_AMOUNT, account.getAccountKeys().address);
+    }
+
+    BlockTemplate block = boost::value_initialized<BlockTemplate>();
+    block.majorVersion = BLOCK_MAJOR_VERSION_1;
+    block.previousBlockHash = CachedBlock(fromBinaryArray<BlockTemplate>(blocks.back().block)).getBlockHash();
+    block.timestamp = currency.genesisBlock().timestamp + blocks.size() * currency.difficultyTarget();
+    ASSERT_TRUE(fromBinaryArray(block.baseTransaction, transaction->getTransactionData()));
+    block.baseTransaction.inputs.push_back(BaseInput{static_cast<uint32_t>(blocks.size())});
+
+    blocks.push_back(RawBlock{toBinaryArray(block), {}});
+  }
+
+  std::unique_ptr<Core> loadCore() {
+    std::unique_ptr<IMainChainStorage> storage(new VectorMainChainStorage());
+    for (const auto& block : blocks) {
+      storage->pushBlock(block);
+    }
+
+    std::unique_ptr<Core> core(new Core(currency, logger, Checkpoints(logger), dispatcher,
+      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger, true)), std::move(storage),
+      dataFolder.string()));
+    core->load();
+    return core;
+  }
+
+  // Spends the coinbase output realOutput of block 1, with the given coinbase outputs of that block as the ring
+  BinaryArray makeSpendingTransaction(Core& core, const std::vector<size_t>& ring, size_t realOutput) {
+    const Transaction& coinbase = fromBinaryArray<BlockTemplate>(blocks[1].block).baseTransaction;
+    std::vector<uint32_t> globalIndexes;
+    EXPECT_TRUE(core.getTransactionGlobalIndexes(getObjectHash(coinbase), globalIndexes));
+
+    TransactionTypes::InputKeyInfo info;
+    info.amount = OUTPUT_AMOUNT;
+    for (size_t output : ring) {
+      info.outputs.push_back({boost::get<KeyOutput>(coinbase.outputs[output].target).key, globalIndexes[output]});
+    }
+
+    info.realOutput.transactionPublicKey = getTransactionPublicKeyFromExtra(coinbase.extra);
+    info.realOutput.transactionIndex = std::find(ring.begin(), ring.end(), realOutput) - ring.begin();
+    info.realOutput.outputInTransaction = realOutput;
+
+    auto transaction = createTransaction();
+    KeyPair ephemeralKeys;
+    size_t index = transaction->addInput(account.getAccountKeys(), info, ephemeralKeys);
+    transaction->addOutput(OUTPUT_AMOUNT - currency.minimumFee(), account.getAccountKeys().address);
+    transaction->signInputKey(index, info, ephemeralKeys);
+    return transaction->getTransactionData();
+  }
+
+  std::unordered_set<Crypto::Hash> getPoolHashes(const Core& core) {
+    auto hashes = core.getPoolTransactionHashes();
+    return std::unordered_set<Crypto::Hash>(hashes.begin(), hashes.end());
+  }
+
+  System::Dispatcher dispatcher;
+  Logging::ConsoleLogger logger;
+  Currency currency;
+  DataBaseMock database;
+  AccountBase account;
+  std::vector<RawBlock> blocks;
+  boost::filesystem::path dataFolder;
+};
+
+}
+
+TEST_F(CoreTransactionPoolStateTest, poolIsRestoredAndRecheckedForCurrentHeight) {
+  ASSERT_NO_FATAL_FAILURE(appendBlock(3));
+
+  std::unordered_set<Crypto::Hash> poolHashes;
+  Crypto::Hash singleMemberRingHash;
+  {
+    auto core = loadCore();
+    auto twoMemberRing = makeSpendingTransaction(*core, {0, 1}, 0);
+    auto singleMemberRing = makeSpendingTransaction(*core, {2}, 2);
+    ASSERT_TRUE(core->addTransactionToPool(twoMemberRing));
+    ASSERT_TRUE(core->addTransactionToPool(singleMemberRing));
+
+    singleMemberRingHash = getBinaryArrayHash(singleMemberRing);
+    poolHashes = getPoolHashes(*core);
+    ASSERT_EQ(2, poolHashes.size());
+    core->save();
+  }
+
+  {
+    auto core = loadCore();
+    ASSERT_EQ(poolHashes, getPoolHashes(*core));
+    core->save();
+  }
+
+  // the chain grows past the upgrade, so the single member ring is no longer acceptable at the current height
+  for (uint32_t i = 0; i < UPGRADE_INDEX; ++i) {
+    ASSERT_NO_FATAL_FAILURE(appendBlock(0));
+  }
+
+  {
+    auto core = loadCore();
+    ASSERT_EQ(blocks.size() - 1, core->getTopBlockIndex());
+
+    auto restoredHashes = core->getPoolTransactionHashes();
+    ASSERT_EQ(1, restoredHashes.size());
+    ASSERT_NE(singleMemberRingHash, restoredHashes[0]);
+    ASSERT_EQ(1, poolHashes.count(restoredHashes[0]));
+  }
+}
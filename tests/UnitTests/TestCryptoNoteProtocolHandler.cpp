@@ -0,0 +1,240 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+#include <boost/uuid/random_generator.hpp>
+
+#include <System/Dispatcher.h>
+
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "Logging/ConsoleLogger.h"
+#include "P2p/LevinProtocol.h"
+
+#include "ICoreStub.h"
+
+namespace CryptoNote {
+
+// the protocol handler keeps this one private, transactions go over the wire as strings
+static inline void serialize(NOTIFY_NEW_TRANSACTIONS_request& request, ISerializer& s) {
+  std::vector<std::string> transactions;
+  for (const auto& transaction : request.txs) {
+    transactions.emplace_back(transaction.begin(), transaction.end());
+  }
+
+  s(transactions, "txs");
+  if (s.type() == ISerializer::INPUT) {
+    request.txs.clear();
+    for (const auto& transaction : transactions) {
+      request.txs.emplace_back(transaction.begin(), transaction.end());
+    }
+  }
+}
+
+}
+
+using namespace CryptoNote;
+
+namespace {
+
+class P2pEndpointRecorder : public IP2pEndpoint {
+public:
+  struct Notification {
+    boost::uuids::uuid connectionId;
+    int command;
+    BinaryArray data;
+  };
+
+  virtual void relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) override {
+    for (auto connection : connections) {
+      if (excludeConnection == nullptr || connection->m_connection_id != *excludeConnection) {
+        notifications.push_back({connection->m_connection_id, command, data_buff});
+      }
+    }
+  }
+
+  virtual bool invoke_notify_to_peer(int command, const BinaryArray& req_buff, const CryptoNoteConnectionContext& context) override {
+    notifications.push_back({context.m_connection_id, command, req_buff});
+    return true;
+  }
+
+  virtual uint64_t get_connections_count() override {
+    return connections.size();
+  }
+
+  virtual void for_each_connection(std::function<void(CryptoNoteConnectionContext&, PeerIdType)> f) override {
+    for (auto connection : connections) {
+      f(*connection, 1);
+    }
+  }
+
+  virtual void externalRelayNotifyToAll(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) override {
+    relay_notify_to_all(command, data_buff, excludeConnection);
+  }
+
+  template <typename Command>
+  std::vector<typename Command::request> sentTo(const CryptoNoteConnectionContext& context) const {
+    std::vector<typename Command::request> requests;
+    for (const auto& notification : notifications) {
+      if (notification.connectionId == context.m_connection_id && notification.command == Command::ID) {
+        typename Command::request request;
+        EXPECT_TRUE(LevinProtocol::decode(notification.data, request));
+        requests.push_back(std::move(request));
+      }
+    }
+
+    return requests;
+  }
+
+  size_t countSentTo(const CryptoNoteConnectionContext& context) const {
+    return std::count_if(notifications.begin(), notifications.end(), [&context] (const Notification& notification) {
+      return notification.connectionId == context.m_connection_id;
+    });
+  }
+
+  std::vector<CryptoNoteConnectionContext*> connections;
+  std::vector<Notification> notifications;
+};
+
+class CryptoNoteProtocolHandlerTest : public ::testing::Test {
+public:
+  CryptoNoteProtocolHandlerTest() :
+    logger(Logging::ERROR),
+    currency(CurrencyBuilder(logger).currency()),
+    handler(currency, dispatcher, core, &p2p, logger) {
+  }
+
+  CryptoNoteConnectionContext& addPeer(uint8_t version, CryptoNoteConnectionContext::state state = CryptoNoteConnectionContext::state_normal) {
+    peers.emplace_back(new CryptoNoteConnectionContext());
+    CryptoNoteConnectionContext& context = *peers.back();
+    context.version = version;
+    context.m_connection_id = boost::uuids::random_generator()();
+    context.m_state = state;
+    p2p.connections.push_back(&context);
+    return context;
+  }
+
+  template <typename Command>
+  void receive(typename Command::request request, CryptoNoteConnectionContext& context) {
+    BinaryArray response;
+    bool handled = false;
+    handler.handleCommand(true, Command::ID, LevinProtocol::encode(request), response, context, handled);
+    ASSERT_TRUE(handled);
+  }
+
+  BinaryArray makeTransaction(uint8_t seed) {
+    return BinaryArray(100, seed);
+  }
+
+  System::Dispatcher dispatcher;
+  Logging::ConsoleLogger logger;
+  Currency currency;
+  ICoreStub core;
+  P2pEndpointRecorder p2p;
+  CryptoNoteProtocolHandler handler;
+  std::vector<std::unique_ptr<CryptoNoteConnectionContext>> peers;
+};
+
+}
+
+TEST_F(CryptoNoteProtocolHandlerTest, newTransactionsAreAnnouncedByHashToV2Peers) {
+  auto& source = addPeer(P2PProtocolVersion::V2);
+  auto& peer = addPeer(P2PProtocolVersion::V2);
+  auto transaction = makeTransaction(1);
+
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_NEW_TRANSACTIONS>({{transaction}}, source));
+  ASSERT_TRUE(core.hasTransaction(getBinaryArrayHash(transaction)));
+
+  // hashes are queued until the next announcement
+  ASSERT_EQ(0, p2p.countSentTo(peer));
+
+  handler.announceTransactions();
+
+  auto announcements = p2p.sentTo<NOTIFY_NEW_TRANSACTION_HASHES>(peer);
+  ASSERT_EQ(1, announcements.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>({getBinaryArrayHash(transaction)}), announcements[0].txs);
+  ASSERT_TRUE(p2p.sentTo<NOTIFY_NEW_TRANSACTIONS>(peer).empty());
+
+  // nothing goes back to the peer the transaction came from
+  ASSERT_EQ(0, p2p.countSentTo(source));
+}
+
+TEST_F(CryptoNoteProtocolHandlerTest, legacyPeersGetTransactionBlobs) {
+  auto& source = addPeer(P2PProtocolVersion::V2);
+  auto& legacyPeer = addPeer(P2PProtocolVersion::V1);
+  auto transaction = makeTransaction(1);
+
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_NEW_TRANSACTIONS>({{transaction}}, source));
+
+  auto notifications = p2p.sentTo<NOTIFY_NEW_TRANSACTIONS>(legacyPeer);
+  ASSERT_EQ(1, notifications.size());
+  ASSERT_EQ(std::vector<BinaryArray>({transaction}), notifications[0].txs);
+
+  handler.announceTransactions();
+  ASSERT_TRUE(p2p.sentTo<NOTIFY_NEW_TRANSACTION_HASHES>(legacyPeer).empty());
+}
+
+TEST_F(CryptoNoteProtocolHandlerTest, onlyUnknownTransactionsAreRequested) {
+  auto& peer = addPeer(P2PProtocolVersion::V2);
+  auto& otherPeer = addPeer(P2PProtocolVersion::V2);
+  auto known = makeTransaction(1);
+  auto unknown = makeTransaction(2);
+  core.addTransactionToPool(known);
+
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_NEW_TRANSACTION_HASHES>({{getBinaryArrayHash(known), getBinaryArrayHash(unknown)}}, peer));
+
+  auto requests = p2p.sentTo<NOTIFY_REQUEST_TRANSACTIONS>(peer);
+  ASSERT_EQ(1, requests.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>({getBinaryArrayHash(unknown)}), requests[0].txs);
+
+  // a transaction that is already being fetched isn't requested again from another peer
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_NEW_TRANSACTION_HASHES>({{getBinaryArrayHash(unknown)}}, otherPeer));
+  ASSERT_EQ(0, p2p.countSentTo(otherPeer));
+}
+
+TEST_F(CryptoNoteProtocolHandlerTest, requestedTransactionsAreSentFromPool) {
+  auto& peer = addPeer(P2PProtocolVersion::V2);
+  auto transaction = makeTransaction(1);
+  core.addTransactionToPool(transaction);
+
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_REQUEST_TRANSACTIONS>({{getBinaryArrayHash(transaction), getBinaryArrayHash(makeTransaction(2))}}, peer));
+
+  auto notifications = p2p.sentTo<NOTIFY_NEW_TRANSACTIONS>(peer);
+  ASSERT_EQ(1, notifications.size());
+  ASSERT_EQ(std::vector<BinaryArray>({transaction}), notifications[0].txs);
+
+  // the peer has it now, so it isn't announced to it when another peer relays it
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_NEW_TRANSACTIONS>({{transaction}}, addPeer(P2PProtocolVersion::V2)));
+  handler.announceTransactions();
+  ASSERT_TRUE(p2p.sentTo<NOTIFY_NEW_TRANSACTION_HASHES>(peer).empty());
+}
+
+TEST_F(CryptoNoteProtocolHandlerTest, unsynchronizedPeersAreIgnored) {
+  auto& peer = addPeer(P2PProtocolVersion::V2, CryptoNoteConnectionContext::state_synchronizing);
+  auto transaction = makeTransaction(1);
+  core.addTransactionToPool(transaction);
+
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_REQUEST_TRANSACTIONS>({{getBinaryArrayHash(transaction)}}, peer));
+  ASSERT_NO_FATAL_FAILURE(receive<NOTIFY_NEW_TRANSACTION_HASHES>({{getBinaryArrayHash(makeTransaction(2))}}, peer));
+
+  ASSERT_EQ(0, p2p.countSentTo(peer));
+}
@@ -17,11 +17,15 @@
 
 #include "gtest/gtest.h"
 
+#include <unordered_set>
+
 #include "crypto/crypto.h"
 
 #include "CryptoNoteCore/BlockchainCache.h"
+#include "CryptoNoteCore/BlockScanTable.h"
 #include <CryptoNoteCore/DatabaseBlockchainCache.h>
 #include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/TransactionExtra.h"
 #include "CryptoNoteCore/TransactionValidatiorState.h"
 #include "DataBaseMock.h"
 #include <CryptoNoteCore/DBUtils.h>
@@ -42,6 +46,37 @@ Hash randomBlockHash() {
   return hash;
 }
 
+Transaction makeSpendingTransaction(const std::vector<KeyImage>& keyImages) {
+  Transaction transaction;
+  transaction.version = CURRENT_TRANSACTION_VERSION;
+  transaction.unlockTime = 0;
+
+  for (const auto& keyImage : keyImages) {
+    transaction.inputs.push_back(KeyInput{100, {0}, keyImage});
+    transaction.signatures.push_back({Signature()});
+  }
+
+  PublicKey outputKey;
+  SecretKey outputSecretKey;
+  generate_keys(outputKey, outputSecretKey);
+  transaction.outputs.push_back({90, KeyOutput{outputKey}});
+
+  PublicKey transactionPublicKey;
+  SecretKey transactionSecretKey;
+  generate_keys(transactionPublicKey, transactionSecretKey);
+  addTransactionPublicKeyToExtra(transaction.extra, transactionPublicKey);
+
+  return transaction;
+}
+
+KeyImage randomKeyImage() {
+  KeyImage keyImage;
+  for (auto& b : keyImage.data) {
+    b = rand();
+  }
+  return keyImage;
+}
+
 class DatabaseBlockchainCacheTests : public ::testing::Test {
 public:
   DatabaseBlockchainCacheTests()
@@ -186,3 +221,175 @@ TEST_F(DatabaseBlockchainCacheTests, RawBlocksWithTxsSerialization) {
   ASSERT_EQ(deserializedRawBlock.block, rawBlock.block);
   ASSERT_EQ(deserializedRawBlock.transactions, rawBlock.transactions);
 }
+
+TEST_F(DatabaseBlockchainCacheTests, ScanTablesAreStoredWhenEnabled) {
+  DataBaseMock scanDatabase;
+  DatabaseBlockchainCache scanBlockchain(currency, scanDatabase, blockchainCacheFactory, logger, true);
+  for (auto& block : generator.getBlockchain()) {
+    TransactionValidatorState state;
+    scanBlockchain.pushBlock(CachedBlock{block}, {}, state, 0, 0, 0, { toBinaryArray(block), {} });
+  }
+
+  // the first generated block repeats the genesis, so start with the blocks that follow it
+  for (uint32_t i = 1; i < count; ++i) {
+    const BlockTemplate& block = generator.getBlockchain()[i];
+    BlockScanTable table = scanBlockchain.getBlockScanTable(i + 1);
+    ASSERT_EQ(generatedBlockHashes[i], table.blockHash);
+    ASSERT_EQ(block.timestamp, table.timestamp);
+    ASSERT_EQ(1, table.transactions.size());
+
+    const ScanTableTransaction& base = table.transactions.front();
+    CachedTransaction cachedBase(block.baseTransaction);
+    ASSERT_EQ(cachedBase.getTransactionHash(), base.transactionHash);
+    ASSERT_EQ(getTransactionPublicKeyFromExtra(block.baseTransaction.extra), base.transactionPublicKey);
+    ASSERT_TRUE(base.keyImages.empty());
+
+    std::vector<uint32_t> globalIndexes;
+    ASSERT_TRUE(scanBlockchain.getTransactionGlobalIndexes(cachedBase.getTransactionHash(), globalIndexes));
+    ASSERT_EQ(block.baseTransaction.outputs.size(), base.outputs.size());
+    for (size_t j = 0; j < base.outputs.size(); ++j) {
+      ASSERT_EQ(boost::get<KeyOutput>(block.baseTransaction.outputs[j].target).key, base.outputs[j].key);
+      ASSERT_EQ(block.baseTransaction.outputs[j].amount, base.outputs[j].amount);
+      ASSERT_EQ(globalIndexes[j], base.outputs[j].globalIndex);
+      ASSERT_EQ(j, base.outputs[j].outputIndex);
+    }
+  }
+}
+
+TEST_F(DatabaseBlockchainCacheTests, ScanTablesAreBuiltWhenNotStored) {
+  DataBaseMock scanDatabase;
+  DatabaseBlockchainCache scanBlockchain(currency, scanDatabase, blockchainCacheFactory, logger, true);
+  DataBaseMock plainDatabase;
+  DatabaseBlockchainCache plainBlockchain(currency, plainDatabase, blockchainCacheFactory, logger);
+  for (auto& block : generator.getBlockchain()) {
+    TransactionValidatorState state;
+    scanBlockchain.pushBlock(CachedBlock{block}, {}, state, 0, 0, 0, { toBinaryArray(block), {} });
+    plainBlockchain.pushBlock(CachedBlock{block}, {}, state, 0, 0, 0, { toBinaryArray(block), {} });
+  }
+
+  for (uint32_t i = 1; i < count; ++i) {
+    BlockScanTable stored = scanBlockchain.getBlockScanTable(i + 1);
+    BlockScanTable built = plainBlockchain.getBlockScanTable(i + 1);
+    ASSERT_EQ(toBinaryArray(stored), toBinaryArray(built));
+  }
+}
+
+TEST_F(DatabaseBlockchainCacheTests, ScanTablesListKeyImagesOfSpendingTransactions) {
+  DataBaseMock scanDatabase;
+  DatabaseBlockchainCache scanBlockchain(currency, scanDatabase, blockchainCacheFactory, logger, true);
+  for (auto& block : generator.getBlockchain()) {
+    TransactionValidatorState state;
+    scanBlockchain.pushBlock(CachedBlock{block}, {}, state, 0, 0, 0, { toBinaryArray(block), {} });
+  }
+
+  std::vector<KeyImage> keyImages { randomKeyImage(), randomKeyImage() };
+  CachedTransaction spending(makeSpendingTransaction(keyImages));
+
+  // the next block reuses the last generated one with its own coinbase height, so its base transaction is unique
+  BlockTemplate block = generator.getBlockchain().back();
+  block.previousBlockHash = generatedBlockHashes.back();
+  block.timestamp += currency.difficultyTarget();
+  boost::get<BaseInput>(block.baseTransaction.inputs.front()).blockIndex += 1;
+  block.transactionHashes = { spending.getTransactionHash() };
+
+  TransactionValidatorState state;
+  state.spentKeyImages.insert(keyImages.begin(), keyImages.end());
+  RawBlock rawBlock { toBinaryArray(block), { spending.getTransactionBinaryArray() } };
+  scanBlockchain.pushBlock(CachedBlock{block}, { spending }, state, 0, 0, 0, RawBlock(rawBlock));
+  blockchain.pushBlock(CachedBlock{block}, { spending }, state, 0, 0, 0, std::move(rawBlock));
+
+  uint32_t blockIndex = scanBlockchain.getTopBlockIndex();
+  BlockScanTable stored = scanBlockchain.getBlockScanTable(blockIndex);
+  ASSERT_EQ(2, stored.transactions.size());
+  ASSERT_TRUE(stored.transactions[0].keyImages.empty());
+
+  const ScanTableTransaction& entry = stored.transactions[1];
+  ASSERT_EQ(spending.getTransactionHash(), entry.transactionHash);
+  ASSERT_EQ(getTransactionPublicKeyFromExtra(spending.getTransaction().extra), entry.transactionPublicKey);
+  ASSERT_EQ(keyImages, entry.keyImages);
+  ASSERT_EQ(1, entry.outputs.size());
+  ASSERT_EQ(boost::get<KeyOutput>(spending.getTransaction().outputs[0].target).key, entry.outputs[0].key);
+  ASSERT_EQ(90, entry.outputs[0].amount);
+
+  // the table built from the raw block of a cache that doesn't store them is the same
+  BlockScanTable built = blockchain.getBlockScanTable(blockIndex);
+  ASSERT_EQ(toBinaryArray(stored), toBinaryArray(built));
+}
+
+TEST_F(DatabaseBlockchainCacheTests, SplitRemovesScanTables) {
+  DataBaseMock scanDatabase;
+  DatabaseBlockchainCache scanBlockchain(currency, scanDatabase, blockchainCacheFactory, logger, true);
+  for (auto& block : generator.getBlockchain()) {
+    TransactionValidatorState state;
+    scanBlockchain.pushBlock(CachedBlock{block}, {}, state, 0, 0, 0, { toBinaryArray(block), {} });
+  }
+
+  uint32_t topIndex = scanBlockchain.getTopBlockIndex();
+  uint32_t splitIndex = topIndex / 2;
+  for (uint32_t i = 1; i <= topIndex; ++i) {
+    ASSERT_EQ(1, scanDatabase.baseState.count(DB::serializeKey(DB::BLOCK_INDEX_TO_SCAN_TABLE_PREFIX, i)));
+  }
+
+  auto upper = scanBlockchain.split(splitIndex);
+  ASSERT_EQ(splitIndex - 1, scanBlockchain.getTopBlockIndex());
+  for (uint32_t i = 1; i < splitIndex; ++i) {
+    ASSERT_EQ(1, scanDatabase.baseState.count(DB::serializeKey(DB::BLOCK_INDEX_TO_SCAN_TABLE_PREFIX, i)));
+  }
+
+  for (uint32_t i = splitIndex; i <= topIndex; ++i) {
+    ASSERT_EQ(0, scanDatabase.baseState.count(DB::serializeKey(DB::BLOCK_INDEX_TO_SCAN_TABLE_PREFIX, i)));
+  }
+}
+
+TEST_F(DatabaseBlockchainCacheTests, RandomOutsFollowPushedAndSplitBlocks) {
+  // generated coinbases have no outputs, so every pushed block carries a transaction with one output of 90
+  const uint64_t amount = 90;
+  BlockTemplate block = generator.getBlockchain().back();
+  Hash previousHash = generatedBlockHashes.back();
+  auto pushBlockWithOutput = [&] {
+    std::vector<KeyImage> keyImages { randomKeyImage() };
+    CachedTransaction transaction(makeSpendingTransaction(keyImages));
+    block.previousBlockHash = previousHash;
+    block.timestamp += currency.difficultyTarget();
+    boost::get<BaseInput>(block.baseTransaction.inputs.front()).blockIndex += 1;
+    block.transactionHashes = { transaction.getTransactionHash() };
+
+    TransactionValidatorState state;
+    state.spentKeyImages.insert(keyImages.begin(), keyImages.end());
+    CachedBlock cachedBlock(block);
+    previousHash = cachedBlock.getBlockHash();
+    blockchain.pushBlock(cachedBlock, { transaction }, state, 0, 0, 0, { toBinaryArray(block), { transaction.getTransactionBinaryArray() } });
+  };
+
+  auto getAllOuts = [&] {
+    return blockchain.getRandomOutsByAmount(amount, 100, blockchain.getTopBlockIndex() + static_cast<uint32_t>(currency.minedMoneyUnlockWindow()) + 1);
+  };
+
+  uint32_t firstIndex = blockchain.getTopBlockIndex() + 1;
+  for (size_t i = 0; i < 3; ++i) {
+    pushBlockWithOutput();
+  }
+
+  // the first request loads the amount from the database
+  ASSERT_EQ(3, getAllOuts().size());
+
+  // outputs of pushed blocks are added to the loaded amount
+  for (size_t i = 0; i < 2; ++i) {
+    pushBlockWithOutput();
+  }
+
+  auto outs = getAllOuts();
+  ASSERT_EQ(5, outs.size());
+  ASSERT_EQ(5, std::unordered_set<uint32_t>(outs.begin(), outs.end()).size());
+
+  // a split cuts them off again
+  auto upper = blockchain.split(firstIndex + 3);
+  outs = getAllOuts();
+  ASSERT_EQ(3, outs.size());
+  for (auto out : outs) {
+    ASSERT_LT(out, 3);
+  }
+
+  pushBlockWithOutput();
+  ASSERT_EQ(4, getAllOuts().size());
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "CryptoNoteCore/DecoyOutputsIndex.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const DecoyOutputsIndex::Amount TEST_AMOUNT = 100;
+
+bool alwaysUnlocked(uint64_t) {
+  return true;
+}
+
+class DecoyOutputsIndexTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    // two outputs per block for blocks 0..9, output 5 is locked until block 1000
+    std::vector<uint32_t> blockIndexes;
+    for (uint32_t i = 0; i < 20; ++i) {
+      blockIndexes.push_back(i / 2);
+    }
+
+    index.addAmount(TEST_AMOUNT, std::move(blockIndexes), {{5, 1000}});
+  }
+
+  DecoyOutputsIndex index;
+};
+
+TEST_F(DecoyOutputsIndexTest, spendablePrefixCoversOutputsUpToBlock) {
+  ASSERT_EQ(2, index.getSpendablePrefix(TEST_AMOUNT, 0));
+  ASSERT_EQ(8, index.getSpendablePrefix(TEST_AMOUNT, 3));
+  ASSERT_EQ(20, index.getSpendablePrefix(TEST_AMOUNT, 100));
+  ASSERT_EQ(0, index.getSpendablePrefix(TEST_AMOUNT + 1, 100));
+}
+
+TEST_F(DecoyOutputsIndexTest, randomOutsAreUniqueAndInPrefix) {
+  auto outs = index.getRandomOuts(TEST_AMOUNT, 4, 3, alwaysUnlocked);
+
+  ASSERT_EQ(4, outs.size());
+  ASSERT_EQ(4, std::unordered_set<uint32_t>(outs.begin(), outs.end()).size());
+  for (auto out : outs) {
+    ASSERT_LT(out, 8);
+  }
+}
+
+TEST_F(DecoyOutputsIndexTest, randomOutsSkipLockedOutputs) {
+  auto outs = index.getRandomOuts(TEST_AMOUNT, 20, 100, [] (uint64_t unlockTime) { return unlockTime < 1000; });
+
+  ASSERT_EQ(19, outs.size());
+  ASSERT_EQ(outs.end(), std::find(outs.begin(), outs.end(), 5));
+}
+
+TEST_F(DecoyOutputsIndexTest, randomOutsReturnsLessIfNotEnoughOutputs) {
+  ASSERT_EQ(2, index.getRandomOuts(TEST_AMOUNT, 10, 0, alwaysUnlocked).size());
+  ASSERT_TRUE(index.getRandomOuts(TEST_AMOUNT + 1, 10, 100, alwaysUnlocked).empty());
+}
+
+TEST_F(DecoyOutputsIndexTest, pushOutputExtendsLoadedAmountOnly) {
+  index.pushOutput(TEST_AMOUNT, 20, 10, 0);
+  index.pushOutput(TEST_AMOUNT + 1, 0, 10, 0);
+
+  ASSERT_EQ(21, index.getOutputsCount(TEST_AMOUNT));
+  ASSERT_EQ(21, index.getSpendablePrefix(TEST_AMOUNT, 10));
+  ASSERT_FALSE(index.hasAmount(TEST_AMOUNT + 1));
+}
+
+TEST_F(DecoyOutputsIndexTest, pushOutputWithGapDropsAmount) {
+  index.pushOutput(TEST_AMOUNT, 21, 10, 0);
+
+  ASSERT_FALSE(index.hasAmount(TEST_AMOUNT));
+  ASSERT_EQ(0, index.getOutputsCount(TEST_AMOUNT));
+}
+
+TEST_F(DecoyOutputsIndexTest, cutOutputsRemovesTailAndUnlockTimes) {
+  ASSERT_EQ(20, index.getSpendablePrefix(TEST_AMOUNT, 100));
+
+  index.cutOutputs(TEST_AMOUNT, 4);
+  ASSERT_EQ(4, index.getSpendablePrefix(TEST_AMOUNT, 100));
+
+  index.pushOutput(TEST_AMOUNT, 4, 2, 0);
+  index.pushOutput(TEST_AMOUNT, 5, 2, 0);
+  auto outs = index.getRandomOuts(TEST_AMOUNT, 6, 100, [] (uint64_t) { return false; });
+  ASSERT_EQ(6, outs.size());
+}
+
+TEST_F(DecoyOutputsIndexTest, finishLoadReplaysOutputsPushedDuringLoad) {
+  const DecoyOutputsIndex::Amount amount = TEST_AMOUNT + 1;
+  uint64_t loadId = index.beginLoad(amount);
+  index.pushOutput(amount, 2, 5, 0);
+  index.pushOutput(amount, 3, 6, 2000);
+
+  // the database was read before the first pushed output was written
+  ASSERT_TRUE(index.finishLoad(loadId, {1, 4}, {}));
+  ASSERT_EQ(4, index.getOutputsCount(amount));
+  ASSERT_EQ(3, index.getSpendablePrefix(amount, 5));
+
+  auto outs = index.getRandomOuts(amount, 4, 100, [] (uint64_t unlockTime) { return unlockTime < 2000; });
+  ASSERT_EQ(3, outs.size());
+  ASSERT_EQ(outs.end(), std::find(outs.begin(), outs.end(), 3));
+}
+
+TEST_F(DecoyOutputsIndexTest, finishLoadKeepsOutputsAlreadyRead) {
+  const DecoyOutputsIndex::Amount amount = TEST_AMOUNT + 1;
+  uint64_t loadId = index.beginLoad(amount);
+  index.pushOutput(amount, 2, 5, 0);
+
+  // the database was read after the pushed output was written
+  ASSERT_TRUE(index.finishLoad(loadId, {1, 4, 5}, {}));
+  ASSERT_EQ(3, index.getOutputsCount(amount));
+}
+
+TEST_F(DecoyOutputsIndexTest, finishLoadReplaysCutsDuringLoad) {
+  const DecoyOutputsIndex::Amount amount = TEST_AMOUNT + 1;
+  uint64_t loadId = index.beginLoad(amount);
+  index.cutOutputs(amount, 1);
+  index.pushOutput(amount, 1, 3, 0);
+
+  ASSERT_TRUE(index.finishLoad(loadId, {1, 4, 5}, {{2, 1000}}));
+  ASSERT_EQ(2, index.getOutputsCount(amount));
+  ASSERT_EQ(2, index.getSpendablePrefix(amount, 3));
+  ASSERT_EQ(2, index.getRandomOuts(amount, 2, 100, [] (uint64_t) { return false; }).size());
+}
+
+TEST_F(DecoyOutputsIndexTest, finishLoadFailsOnGap) {
+  const DecoyOutputsIndex::Amount amount = TEST_AMOUNT + 1;
+  uint64_t loadId = index.beginLoad(amount);
+  index.pushOutput(amount, 3, 5, 0);
+
+  ASSERT_FALSE(index.finishLoad(loadId, {1, 4}, {}));
+  ASSERT_FALSE(index.hasAmount(amount));
+}
+
+TEST_F(DecoyOutputsIndexTest, secondLoadOfSameAmountKeepsFirst) {
+  const DecoyOutputsIndex::Amount amount = TEST_AMOUNT + 1;
+  uint64_t first = index.beginLoad(amount);
+  uint64_t second = index.beginLoad(amount);
+
+  ASSERT_TRUE(index.finishLoad(first, {1, 4}, {}));
+  ASSERT_TRUE(index.finishLoad(second, {1}, {}));
+  ASSERT_EQ(2, index.getOutputsCount(amount));
+}
+
+TEST_F(DecoyOutputsIndexTest, cancelledLoadStopsRecording) {
+  uint64_t loadId = index.beginLoad(TEST_AMOUNT + 1);
+  index.cancelLoad(loadId);
+  ASSERT_FALSE(index.finishLoad(loadId, {}, {}));
+}
+
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/EncodedBlocksCache.h"
+#include "Serialization/SerializationOverloads.h"
+#include "Serialization/SerializationTools.h"
+
+#include "ICoreStub.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+struct RawBlocks {
+  std::vector<RawBlock> blocks;
+
+  void serialize(ISerializer& s) {
+    s(blocks, "blocks");
+  }
+};
+
+struct EncodedBlocks {
+  std::vector<EncodedBlocksCache::EncodedBlock> blocks;
+
+  void serialize(ISerializer& s) {
+    serializeEncodedBlocks(blocks, "blocks", s);
+  }
+};
+
+class EncodedBlocksCacheTest : public ::testing::Test {
+public:
+  EncodedBlocksCacheTest() :
+    cache(1024 * 1024, [] (RawBlock& block, ISerializer& s) { serialize(block, s); }) {
+  }
+
+  void SetUp() override {
+    for (uint32_t i = 0; i < 3; ++i) {
+      BlockTemplate block;
+      block.majorVersion = BLOCK_MAJOR_VERSION_1;
+      block.timestamp = 1000 + i;
+      block.baseTransaction.inputs.push_back(BaseInput{i});
+      core.addBlock(block);
+
+      blockHashes.push_back(CachedBlock(block).getBlockHash());
+      rawBlocks.push_back(RawBlock{toBinaryArray(block), {}});
+    }
+  }
+
+  ICoreStub core;
+  EncodedBlocksCache cache;
+  std::vector<Crypto::Hash> blockHashes;
+  std::vector<RawBlock> rawBlocks;
+};
+
+TEST_F(EncodedBlocksCacheTest, encodedBlocksAreSerializedAsRawBlocks) {
+  EncodedBlocks encoded;
+  std::vector<Crypto::Hash> missedHashes;
+  cache.getBlocks(core, blockHashes, encoded.blocks, missedHashes);
+
+  ASSERT_TRUE(missedHashes.empty());
+  ASSERT_EQ(3, encoded.blocks.size());
+
+  RawBlocks expected{rawBlocks};
+  ASSERT_EQ(storeToBinaryKeyValue(expected), storeToBinaryKeyValue(encoded));
+}
+
+TEST_F(EncodedBlocksCacheTest, cachedBlocksAreNotRequestedFromCore) {
+  std::vector<EncodedBlocksCache::EncodedBlock> blocks;
+  std::vector<Crypto::Hash> missedHashes;
+  cache.getBlocks(core, blockHashes, blocks, missedHashes);
+  cache.getBlocks(core, blockHashes, blocks, missedHashes);
+
+  ASSERT_EQ(6, blocks.size());
+  ASSERT_EQ(3, core.blocksRequested);
+  ASSERT_EQ(3, cache.getCount());
+}
+
+TEST_F(EncodedBlocksCacheTest, unknownBlocksAreReportedAsMissed) {
+  Crypto::Hash unknownHash = Crypto::rand<Crypto::Hash>();
+
+  std::vector<EncodedBlocksCache::EncodedBlock> blocks;
+  std::vector<Crypto::Hash> missedHashes;
+  cache.getBlocks(core, {blockHashes[0], unknownHash}, blocks, missedHashes);
+
+  ASSERT_EQ(1, blocks.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>{unknownHash}, missedHashes);
+  ASSERT_EQ(1, cache.getCount());
+}
+
+TEST_F(EncodedBlocksCacheTest, uncachedBlocksAreReadFromCoreInOneCall) {
+  Crypto::Hash unknownHash = Crypto::rand<Crypto::Hash>();
+
+  std::vector<EncodedBlocksCache::EncodedBlock> cachedBlocks;
+  std::vector<Crypto::Hash> missedHashes;
+  cache.getBlocks(core, {blockHashes[0]}, cachedBlocks, missedHashes);
+  ASSERT_EQ(1, core.getBlocksCalls);
+
+  EncodedBlocks encoded;
+  cache.getBlocks(core, {blockHashes[1], unknownHash, blockHashes[0], blockHashes[2], blockHashes[1]}, encoded.blocks, missedHashes);
+
+  ASSERT_EQ(2, core.getBlocksCalls);
+  ASSERT_EQ(3, core.blocksRequested);
+  ASSERT_EQ(std::vector<Crypto::Hash>{unknownHash}, missedHashes);
+
+  RawBlocks expected{{rawBlocks[1], rawBlocks[0], rawBlocks[2], rawBlocks[1]}};
+  ASSERT_EQ(storeToBinaryKeyValue(expected), storeToBinaryKeyValue(encoded));
+  ASSERT_EQ(3, cache.getCount());
+}
+
+TEST_F(EncodedBlocksCacheTest, leastRecentlyUsedBlocksAreEvicted) {
+  std::vector<EncodedBlocksCache::EncodedBlock> blocks;
+  std::vector<Crypto::Hash> missedHashes;
+  cache.getBlocks(core, {blockHashes[0]}, blocks, missedHashes);
+
+  EncodedBlocksCache smallCache(blocks[0]->size() * 2, [] (RawBlock& block, ISerializer& s) { serialize(block, s); });
+  smallCache.getBlocks(core, {blockHashes[0], blockHashes[1]}, blocks, missedHashes);
+  smallCache.getBlocks(core, {blockHashes[0], blockHashes[2]}, blocks, missedHashes);
+  ASSERT_EQ(2, smallCache.getCount());
+  ASSERT_LE(smallCache.getSize(), blocks[0]->size() * 2);
+
+  size_t requested = core.blocksRequested;
+  smallCache.getBlocks(core, {blockHashes[0], blockHashes[2]}, blocks, missedHashes);
+  ASSERT_EQ(requested, core.blocksRequested);
+
+  smallCache.getBlocks(core, {blockHashes[1]}, blocks, missedHashes);
+  ASSERT_EQ(requested + 1, core.blocksRequested);
+}
+
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "crypto/hash.h"
+
+using namespace Crypto;
+
+namespace {
+
+class FastHashBatchTest : public ::testing::Test {
+public:
+  FastHashBatchTest() : generator(20190101) {
+  }
+
+  std::vector<uint8_t> randomMessage(size_t length) {
+    std::vector<uint8_t> message(length);
+    for (auto& byte : message) {
+      byte = static_cast<uint8_t>(generator());
+    }
+
+    return message;
+  }
+
+  void checkBatch(const std::vector<std::vector<uint8_t>>& messages) {
+    std::vector<const void*> data;
+    std::vector<size_t> lengths;
+    for (auto& message : messages) {
+      data.push_back(message.data());
+      lengths.push_back(message.size());
+    }
+
+    std::vector<Hash> hashes(messages.size());
+    cn_fast_hash_batch(data.data(), lengths.data(), messages.size(), hashes.data());
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+      ASSERT_EQ(cn_fast_hash(messages[i].data(), messages[i].size()), hashes[i]) << "message " << i << ", length " << messages[i].size();
+    }
+  }
+
+  std::mt19937 generator;
+};
+
+TEST_F(FastHashBatchTest, emptyBatch) {
+  Hash hash;
+  cn_fast_hash_batch(nullptr, nullptr, 0, &hash);
+}
+
+TEST_F(FastHashBatchTest, lengthsAroundRateBoundaries) {
+  std::vector<std::vector<uint8_t>> messages;
+  for (size_t length : {0, 1, 7, 8, 31, 32, 64, 134, 135, 136, 137, 200, 271, 272, 273, 1000, 4096}) {
+    messages.push_back(randomMessage(length));
+  }
+
+  checkBatch(messages);
+}
+
+TEST_F(FastHashBatchTest, everyBatchSize) {
+  for (size_t count = 1; count <= 20; ++count) {
+    std::vector<std::vector<uint8_t>> messages;
+    for (size_t i = 0; i < count; ++i) {
+      messages.push_back(randomMessage(generator() % 600));
+    }
+
+    checkBatch(messages);
+  }
+}
+
+TEST_F(FastHashBatchTest, mixedShortAndLongMessages) {
+  std::vector<std::vector<uint8_t>> messages;
+  for (size_t i = 0; i < 50; ++i) {
+    messages.push_back(randomMessage(i % 5 == 0 ? 20000 + i : 64));
+  }
+
+  checkBatch(messages);
+}
+
+TEST_F(FastHashBatchTest, treeHashMatchesPairwiseHashing) {
+  for (size_t count = 1; count <= 40; ++count) {
+    std::vector<Hash> leaves(count);
+    for (auto& leaf : leaves) {
+      auto bytes = randomMessage(sizeof(Hash));
+      std::copy(bytes.begin(), bytes.end(), leaf.data);
+    }
+
+    // Reference: the same reduction done one cn_fast_hash at a time.
+    std::vector<Hash> level = leaves;
+    if (count > 2) {
+      size_t cnt = 1;
+      while (cnt * 2 < count) {
+        cnt *= 2;
+      }
+
+      std::vector<Hash> next(level.begin(), level.begin() + (2 * cnt - count));
+      for (size_t i = 2 * cnt - count; i < count; i += 2) {
+        next.push_back(cn_fast_hash(&level[i], 2 * sizeof(Hash)));
+      }
+
+      level = next;
+      while (level.size() > 2) {
+        next.clear();
+        for (size_t i = 0; i < level.size(); i += 2) {
+          next.push_back(cn_fast_hash(&level[i], 2 * sizeof(Hash)));
+        }
+
+        level = next;
+      }
+    }
+
+    Hash expected = count == 1 ? level[0] : cn_fast_hash(level.data(), 2 * sizeof(Hash));
+    Hash actual;
+    tree_hash(leaves.data(), leaves.size(), actual);
+    ASSERT_EQ(expected, actual) << "count " << count;
+  }
+}
+
+}
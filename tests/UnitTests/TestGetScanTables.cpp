@@ -0,0 +1,164 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <ctime>
+
+#include <System/Dispatcher.h>
+
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/AddBlockErrors.h"
+#include "CryptoNoteCore/BlockScanTable.h"
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/DatabaseBlockchainCacheFactory.h"
+#include "CryptoNoteCore/UpgradeDetector.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "Logging/ConsoleLogger.h"
+#include "P2p/NetNode.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/RpcServer.h"
+
+#include "../Common/VectorMainChainStorage.h"
+#include "DataBaseMock.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t RPC_PORT = 16493;
+
+class GetScanTablesTest : public ::testing::Test {
+public:
+  GetScanTablesTest() :
+    logger(Logging::ERROR),
+    // version 1 blocks don't need merge mining, so the test can mine them itself;
+    // on testnet the RPC server answers without waiting for the protocol to synchronize
+    currency(CurrencyBuilder(logger).testnetUpgradeHeightV2(IUpgradeDetector::UNDEF_HEIGHT).testnetUpgradeHeightV3(IUpgradeDetector::UNDEF_HEIGHT)
+      .testnetUpgradeHeightV4(IUpgradeDetector::UNDEF_HEIGHT).testnet(true).currency()),
+    core(currency, logger, Checkpoints(logger), dispatcher,
+         std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger, true)),
+         createVectorMainChainStorage(currency)),
+    protocol(currency, dispatcher, core, nullptr, logger),
+    p2p(dispatcher, protocol, logger) {
+    core.load();
+    account.generate();
+  }
+
+  void SetUp() override {
+    server.reset(new RpcServer(dispatcher, logger, core, p2p, protocol));
+    server->start("127.0.0.1", RPC_PORT);
+  }
+
+  void TearDown() override {
+    server->stop();
+    server.reset();
+  }
+
+  COMMAND_RPC_GET_SCAN_TABLES::response getScanTables(uint32_t startIndex, uint32_t count) {
+    COMMAND_RPC_GET_SCAN_TABLES::request req;
+    req.startIndex = startIndex;
+    req.count = count;
+
+    COMMAND_RPC_GET_SCAN_TABLES::response rsp;
+    HttpClient client(dispatcher, "127.0.0.1", RPC_PORT);
+    invokeBinaryCommand(client, "/getscantables.bin", req, rsp);
+    return rsp;
+  }
+
+  // Blocks are spaced by the difficulty target, so the difficulty stays at its minimum
+  void addBlocks(uint32_t count) {
+    uint64_t timestamp = time(nullptr) - (count + 1) * currency.difficultyTarget();
+    Crypto::cn_context context;
+    for (uint32_t i = 0; i < count; ++i) {
+      BlockTemplate block;
+      Difficulty difficulty;
+      uint32_t height;
+      ASSERT_TRUE(core.getBlockTemplate(block, account.getAccountKeys().address, BinaryArray(), difficulty, height));
+
+      timestamp += currency.difficultyTarget();
+      block.timestamp = timestamp;
+      while (!currency.checkProofOfWork(context, CachedBlock(block), difficulty)) {
+        ++block.nonce;
+      }
+
+      ASSERT_EQ(error::AddBlockErrorCode::ADDED_TO_MAIN, core.submitBlock(toBinaryArray(block)));
+    }
+  }
+
+  System::Dispatcher dispatcher;
+  Logging::ConsoleLogger logger;
+  Currency currency;
+  DataBaseMock database;
+  Core core;
+  CryptoNoteProtocolHandler protocol;
+  NodeServer p2p;
+  std::unique_ptr<RpcServer> server;
+  AccountBase account;
+};
+
+}
+
+TEST_F(GetScanTablesTest, returnsTablesOfRequestedBlocks) {
+  ASSERT_NO_FATAL_FAILURE(addBlocks(3));
+
+  auto rsp = getScanTables(1, 2);
+  ASSERT_EQ(CORE_RPC_STATUS_OK, rsp.status);
+  ASSERT_EQ(3, rsp.topIndex);
+  ASSERT_EQ(2, rsp.tables.size());
+
+  for (uint32_t i = 0; i < rsp.tables.size(); ++i) {
+    const BlockScanTable& table = rsp.tables[i];
+    ASSERT_EQ(core.getBlockHashByIndex(1 + i), table.blockHash);
+    ASSERT_EQ(1, table.transactions.size());
+
+    BlockTemplate block = core.getBlockByIndex(1 + i);
+    ASSERT_EQ(block.timestamp, table.timestamp);
+    ASSERT_EQ(getObjectHash(block.baseTransaction), table.transactions[0].transactionHash);
+    ASSERT_EQ(block.baseTransaction.outputs.size(), table.transactions[0].outputs.size());
+  }
+}
+
+TEST_F(GetScanTablesTest, stopsAtTopBlock) {
+  ASSERT_NO_FATAL_FAILURE(addBlocks(3));
+
+  auto rsp = getScanTables(2, 100);
+  ASSERT_EQ(CORE_RPC_STATUS_OK, rsp.status);
+  ASSERT_EQ(2, rsp.tables.size());
+  ASSERT_EQ(core.getTopBlockHash(), rsp.tables.back().blockHash);
+
+  rsp = getScanTables(4, 100);
+  ASSERT_EQ(CORE_RPC_STATUS_OK, rsp.status);
+  ASSERT_TRUE(rsp.tables.empty());
+}
+
+TEST_F(GetScanTablesTest, countIsCappedPerRequest) {
+  ASSERT_NO_FATAL_FAILURE(addBlocks(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT + 5));
+
+  auto rsp = getScanTables(0, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT * 2);
+  ASSERT_EQ(CORE_RPC_STATUS_OK, rsp.status);
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT + 5, rsp.topIndex);
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, rsp.tables.size());
+  ASSERT_EQ(core.getBlockHashByIndex(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT - 1), rsp.tables.back().blockHash);
+
+  rsp = getScanTables(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT * 2);
+  ASSERT_EQ(6, rsp.tables.size());
+}
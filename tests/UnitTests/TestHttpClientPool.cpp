@@ -0,0 +1,193 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+
+#include "Logging/ConsoleLogger.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/HttpClientPool.h"
+#include "Rpc/HttpServer.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t TEST_PORT = 16487;
+
+class TestHttpServer : public HttpServer {
+public:
+  TestHttpServer(System::Dispatcher& dispatcher, Logging::ILogger& logger) : HttpServer(dispatcher, logger), requestCount(0) {
+  }
+
+  virtual void processRequest(const HttpRequest& request, HttpResponse& response) override {
+    ++requestCount;
+    if (request.getUrl() == "/slow") {
+      System::Timer(m_dispatcher).sleep(std::chrono::milliseconds(100));
+    }
+
+    response.setBody(request.getUrl() + ":" + request.getBody());
+  }
+
+  size_t requestCount;
+};
+
+class HttpClientPoolTest : public ::testing::Test {
+public:
+  HttpClientPoolTest() : logger(Logging::ERROR), server(dispatcher, logger) {
+  }
+
+  void SetUp() override {
+    server.start("127.0.0.1", TEST_PORT);
+  }
+
+  void TearDown() override {
+    server.stop();
+  }
+
+  std::string call(HttpClientPool& pool, const std::string& url, const std::string& body) {
+    HttpRequest request;
+    request.setUrl(url);
+    request.setBody(body);
+
+    HttpResponse response;
+    pool.request(request, response);
+    return response.getBody();
+  }
+
+  System::Dispatcher dispatcher;
+  Logging::ConsoleLogger logger;
+  TestHttpServer server;
+};
+
+TEST_F(HttpClientPoolTest, concurrentRequestUsesAnotherConnection) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 2);
+  std::vector<std::string> finished;
+
+  System::ContextGroup group(dispatcher);
+  group.spawn([&] {
+    ASSERT_EQ("/slow:a", call(pool, "/slow", "a"));
+    finished.push_back("slow");
+  });
+
+  group.spawn([&] {
+    ASSERT_EQ("/fast:b", call(pool, "/fast", "b"));
+    finished.push_back("fast");
+  });
+
+  group.wait();
+
+  ASSERT_EQ(std::vector<std::string>({"fast", "slow"}), finished);
+  ASSERT_EQ(2, pool.getConnectionCount());
+  ASSERT_TRUE(pool.isConnected());
+}
+
+TEST_F(HttpClientPoolTest, connectionsAreReused) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 4);
+  for (size_t i = 0; i < 5; ++i) {
+    ASSERT_EQ("/fast:" + std::to_string(i), call(pool, "/fast", std::to_string(i)));
+  }
+
+  ASSERT_EQ(1, pool.getConnectionCount());
+}
+
+TEST_F(HttpClientPoolTest, requestsWaitForFreeConnection) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 2);
+  size_t succeeded = 0;
+
+  System::ContextGroup group(dispatcher);
+  for (size_t i = 0; i < 6; ++i) {
+    group.spawn([&, i] {
+      ASSERT_EQ("/slow:" + std::to_string(i), call(pool, "/slow", std::to_string(i)));
+      ++succeeded;
+    });
+  }
+
+  group.wait();
+
+  ASSERT_EQ(6, succeeded);
+  ASSERT_EQ(2, pool.getConnectionCount());
+}
+
+TEST_F(HttpClientPoolTest, pipelinedResponsesMatchRequests) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 1, 4);
+  size_t succeeded = 0;
+
+  System::ContextGroup group(dispatcher);
+  for (size_t i = 0; i < 8; ++i) {
+    group.spawn([&, i] {
+      std::string url = i % 3 == 0 ? "/slow" : "/fast";
+      ASSERT_EQ(url + ":" + std::to_string(i), call(pool, url, std::to_string(i)));
+      ++succeeded;
+    });
+  }
+
+  group.wait();
+
+  ASSERT_EQ(8, succeeded);
+  ASSERT_EQ(1, pool.getConnectionCount());
+  ASSERT_EQ(8, server.requestCount);
+}
+
+TEST_F(HttpClientPoolTest, interruptedQueuedRequestKeepsConnection) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 1, 2);
+  ASSERT_EQ("/fast:a", call(pool, "/fast", "a"));
+
+  // large enough to fill the socket buffers, so the writer yields while the second request waits behind it
+  std::string largeBody(16 * 1024 * 1024, 'x');
+  bool largeSucceeded = false;
+  bool queuedInterrupted = false;
+
+  System::ContextGroup group(dispatcher);
+  group.spawn([&] {
+    ASSERT_EQ("/fast:" + largeBody, call(pool, "/fast", largeBody));
+    largeSucceeded = true;
+  });
+
+  System::ContextGroup queued(dispatcher);
+  queued.spawn([&] {
+    try {
+      call(pool, "/fast", "b");
+    } catch (const System::InterruptedException&) {
+      queuedInterrupted = true;
+    }
+  });
+
+  dispatcher.yield();
+  queued.interrupt();
+  queued.wait();
+  group.wait();
+
+  ASSERT_TRUE(queuedInterrupted);
+  ASSERT_TRUE(largeSucceeded);
+  ASSERT_EQ("/fast:c", call(pool, "/fast", "c"));
+  ASSERT_EQ(1, pool.getConnectionCount());
+  ASSERT_EQ(3, server.requestCount);
+}
+
+TEST_F(HttpClientPoolTest, failedConnectIsReported) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT + 1, 2);
+
+  ASSERT_THROW(call(pool, "/fast", "a"), ConnectException);
+  ASSERT_FALSE(pool.isConnected());
+}
+
+}
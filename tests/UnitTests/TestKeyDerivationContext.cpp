@@ -0,0 +1,163 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include "crypto/crypto.h"
+
+using namespace Crypto;
+
+namespace {
+
+class KeyDerivationContextTest : public ::testing::Test {
+public:
+  KeyDerivationContextTest() {
+    generate_keys(viewPublicKey, viewSecretKey);
+    generate_keys(spendPublicKey, spendSecretKey);
+    generate_keys(transactionPublicKey, transactionSecretKey);
+  }
+
+  PublicKey viewPublicKey;
+  SecretKey viewSecretKey;
+  PublicKey spendPublicKey;
+  SecretKey spendSecretKey;
+  PublicKey transactionPublicKey;
+  SecretKey transactionSecretKey;
+};
+
+PublicKey invalidPoint() {
+  // Not every 32-byte string decodes to a curve point, pick the first that fails.
+  PublicKey key = {};
+  for (uint8_t i = 0;; ++i) {
+    key.data[0] = i;
+    if (!check_key(key)) {
+      return key;
+    }
+  }
+}
+
+TEST_F(KeyDerivationContextTest, secretKeyContextMatchesGenerateKeyDerivation) {
+  secret_key_context context(viewSecretKey);
+
+  const size_t count = 9;
+  PublicKey keys[count];
+  KeyDerivation expected[count];
+  for (size_t i = 0; i < count; ++i) {
+    SecretKey secretKey;
+    generate_keys(keys[i], secretKey);
+    ASSERT_TRUE(generate_key_derivation(keys[i], viewSecretKey, expected[i]));
+  }
+
+  keys[4] = invalidPoint();
+
+  KeyDerivation derivations[count];
+  std::unique_ptr<bool[]> results(new bool[count]);
+  context.generate_key_derivations(keys, count, derivations, results.get());
+
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(i != 4, results[i]);
+    if (results[i]) {
+      ASSERT_EQ(0, memcmp(&expected[i], &derivations[i], sizeof(KeyDerivation)));
+    }
+  }
+
+  KeyDerivation single;
+  ASSERT_TRUE(context.generate_key_derivation(keys[0], single));
+  ASSERT_EQ(0, memcmp(&expected[0], &single, sizeof(KeyDerivation)));
+  ASSERT_FALSE(context.generate_key_derivation(keys[4], single));
+}
+
+TEST_F(KeyDerivationContextTest, publicKeyContextDerivesLikeFreeFunctions) {
+  KeyDerivation expected;
+  ASSERT_TRUE(generate_key_derivation(viewPublicKey, transactionSecretKey, expected));
+
+  public_key_context viewContext(viewPublicKey);
+  ASSERT_TRUE(viewContext.valid());
+
+  KeyDerivation derivation;
+  ASSERT_TRUE(viewContext.generate_key_derivation(transactionSecretKey, derivation));
+  ASSERT_EQ(0, memcmp(&expected, &derivation, sizeof(KeyDerivation)));
+
+  viewContext.precompute();
+  for (size_t i = 0; i < 5; ++i) {
+    PublicKey publicKey;
+    SecretKey secretKey;
+    generate_keys(publicKey, secretKey);
+
+    KeyDerivation reference;
+    ASSERT_TRUE(generate_key_derivation(viewPublicKey, secretKey, reference));
+    ASSERT_TRUE(viewContext.generate_key_derivation(secretKey, derivation));
+    ASSERT_EQ(0, memcmp(&reference, &derivation, sizeof(KeyDerivation)));
+  }
+
+  public_key_context spendContext(spendPublicKey);
+  const size_t count = 7;
+  size_t indexes[count] = {0, 1, 2, 3, 100, 1000, 1 << 20};
+  PublicKey derivedKeys[count];
+  ASSERT_TRUE(spendContext.derive_public_keys(expected, indexes, count, derivedKeys));
+
+  for (size_t i = 0; i < count; ++i) {
+    PublicKey reference;
+    ASSERT_TRUE(derive_public_key(expected, indexes[i], spendPublicKey, reference));
+    ASSERT_EQ(reference, derivedKeys[i]);
+
+    PublicKey single;
+    ASSERT_TRUE(spendContext.derive_public_key(expected, indexes[i], single));
+    ASSERT_EQ(reference, single);
+  }
+}
+
+TEST_F(KeyDerivationContextTest, invalidPublicKeyContextFails) {
+  public_key_context context(invalidPoint());
+  ASSERT_FALSE(context.valid());
+
+  context.precompute();
+  KeyDerivation derivation;
+  ASSERT_FALSE(context.generate_key_derivation(transactionSecretKey, derivation));
+
+  PublicKey derivedKey;
+  ASSERT_FALSE(context.derive_public_key(derivation, 0, derivedKey));
+}
+
+TEST_F(KeyDerivationContextTest, underivePublicKeysMatchesUnderivePublicKey) {
+  KeyDerivation derivation;
+  ASSERT_TRUE(generate_key_derivation(transactionPublicKey, viewSecretKey, derivation));
+
+  const size_t count = 6;
+  size_t indexes[count] = {0, 1, 2, 3, 4, 5};
+  PublicKey outputKeys[count];
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_TRUE(derive_public_key(derivation, indexes[i], spendPublicKey, outputKeys[i]));
+  }
+
+  outputKeys[2] = invalidPoint();
+
+  PublicKey bases[count];
+  std::unique_ptr<bool[]> results(new bool[count]);
+  underive_public_keys(derivation, indexes, outputKeys, count, bases, results.get());
+
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(i != 2, results[i]);
+    if (results[i]) {
+      ASSERT_EQ(spendPublicKey, bases[i]);
+    }
+  }
+}
+
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "Logging/LoggerGroup.h"
+#include "Logging/LoggerManager.h"
+#include "Logging/LoggerRef.h"
+#include "Logging/StreamLogger.h"
+
+using namespace Logging;
+
+namespace {
+
+size_t formatCount = 0;
+
+struct Formatted {
+};
+
+std::ostream& operator<<(std::ostream& stream, const Formatted&) {
+  if (stream.good()) {
+    ++formatCount;
+  }
+
+  return stream;
+}
+
+size_t evaluate(size_t value) {
+  ++formatCount;
+  return value;
+}
+
+}
+
+TEST(LoggerRef, maxLevelIsMostVerboseLevelOfLoggerTree) {
+  LoggerGroup group(TRACE);
+  ASSERT_EQ(FATAL, group.getMaxLevel());
+
+  StreamLogger infoLogger(INFO);
+  StreamLogger debugLogger(DEBUGGING);
+  group.addLogger(infoLogger);
+  group.addLogger(debugLogger);
+  ASSERT_EQ(DEBUGGING, group.getMaxLevel());
+
+  group.setMaxLevel(WARNING);
+  ASSERT_EQ(WARNING, group.getMaxLevel());
+}
+
+TEST(LoggerRef, filteredMessageIsNotFormatted) {
+  std::ostringstream output;
+  StreamLogger streamLogger(output, INFO);
+  LoggerGroup group(TRACE);
+  group.addLogger(streamLogger);
+  LoggerRef logger(group, "test");
+
+  formatCount = 0;
+  logger(DEBUGGING) << "hidden " << 42 << Formatted();
+  ASSERT_EQ(0, formatCount);
+  ASSERT_TRUE(output.str().empty());
+
+  logger(INFO) << "shown " << 42 << Formatted();
+  ASSERT_EQ(1, formatCount);
+  ASSERT_NE(std::string::npos, output.str().find("shown 42"));
+}
+
+TEST(LoggerRef, logMessageSkipsArgumentsOfFilteredLevel) {
+  std::ostringstream output;
+  StreamLogger streamLogger(output, INFO);
+  LoggerRef logger(streamLogger, "test");
+
+  formatCount = 0;
+  LOG_MESSAGE(logger, TRACE) << evaluate(1);
+  ASSERT_EQ(0, formatCount);
+  ASSERT_FALSE(logger.isEnabled(TRACE));
+
+  LOG_MESSAGE(logger, INFO) << evaluate(2);
+  ASSERT_EQ(1, formatCount);
+  ASSERT_TRUE(logger.isEnabled(INFO));
+}
+
+TEST(LoggerRef, loggerManagerMaxLevelFollowsReconfiguration) {
+  LoggerManager manager;
+  ASSERT_EQ(FATAL, manager.getMaxLevel());
+
+  Common::JsonValue configuration(Common::JsonValue::OBJECT);
+  configuration.insert("globalLevel", static_cast<int64_t>(TRACE));
+  Common::JsonValue& loggers = configuration.insert("loggers", Common::JsonValue::ARRAY);
+  Common::JsonValue& consoleLogger = loggers.pushBack(Common::JsonValue::OBJECT);
+  consoleLogger.insert("type", "console");
+  consoleLogger.insert("level", static_cast<int64_t>(INFO));
+  manager.configure(configuration);
+  ASSERT_EQ(INFO, manager.getMaxLevel());
+
+  manager.setMaxLevel(WARNING);
+  ASSERT_EQ(WARNING, manager.getMaxLevel());
+
+  configuration.erase("loggers");
+  ASSERT_ANY_THROW(manager.configure(configuration));
+  ASSERT_EQ(FATAL, manager.getMaxLevel());
+}
+
+TEST(LoggerRef, loggerManagerMaxLevelFollowsAddedAndRemovedLoggers) {
+  LoggerManager manager;
+  manager.setMaxLevel(TRACE);
+  ASSERT_EQ(FATAL, manager.getMaxLevel());
+
+  std::ostringstream output;
+  StreamLogger streamLogger(output, DEBUGGING);
+  manager.addLogger(streamLogger);
+  ASSERT_EQ(DEBUGGING, manager.getMaxLevel());
+
+  LoggerRef logger(manager, "test");
+  LOG_MESSAGE(logger, DEBUGGING) << "shown";
+  ASSERT_NE(std::string::npos, output.str().find("shown"));
+
+  manager.removeLogger(streamLogger);
+  ASSERT_EQ(FATAL, manager.getMaxLevel());
+
+  formatCount = 0;
+  LOG_MESSAGE(logger, DEBUGGING) << evaluate(1);
+  ASSERT_EQ(0, formatCount);
+}
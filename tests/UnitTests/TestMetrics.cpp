@@ -0,0 +1,104 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "Common/Metrics.h"
+
+using namespace Common;
+
+TEST(Metrics, registryReturnsSameMetricForSameNameAndLabels) {
+  MetricsRegistry registry;
+  auto& first = registry.counter("requests_total", "Requests", {{"method", "a"}});
+  auto& second = registry.counter("requests_total", "Requests", {{"method", "a"}});
+  auto& other = registry.counter("requests_total", "Requests", {{"method", "b"}});
+
+  first.add(2);
+  second.add();
+  ASSERT_EQ(&first, &second);
+  ASSERT_NE(&first, &other);
+  ASSERT_EQ(3, first.get());
+  ASSERT_EQ(0, other.get());
+  ASSERT_THROW(registry.gauge("requests_total", "Requests"), std::runtime_error);
+}
+
+TEST(Metrics, histogramBucketsKeepQuarterPrecision) {
+  for (uint64_t value = 1; value < (uint64_t(1) << 20); value = value * 3 / 2 + 1) {
+    size_t index = MetricHistogram::bucketIndex(value);
+    uint64_t upperBound = MetricHistogram::bucketUpperBound(index);
+    ASSERT_LE(value, upperBound);
+    ASSERT_GT(value, index == 0 ? 0 : MetricHistogram::bucketUpperBound(index - 1));
+    ASSERT_LE(upperBound - value, value / 4 + 1);
+  }
+
+  ASSERT_EQ(MetricHistogram::BUCKET_COUNT - 1, MetricHistogram::bucketIndex(std::numeric_limits<uint64_t>::max()));
+}
+
+TEST(Metrics, histogramCountsValuesNotGreaterThanPowerOfTwoBound) {
+  MetricHistogram histogram;
+  histogram.observe(uint64_t(8));
+  histogram.observe(uint64_t(9));
+  histogram.observe(uint64_t(1000));
+
+  auto snapshot = histogram.snapshot();
+  ASSERT_EQ(3, snapshot.count);
+  ASSERT_EQ(1017, snapshot.sum);
+  ASSERT_EQ(1, snapshot.countNotGreaterThan(8));
+  ASSERT_EQ(2, snapshot.countNotGreaterThan(16));
+  ASSERT_EQ(3, snapshot.countNotGreaterThan(1024));
+  ASSERT_EQ(10, snapshot.valueAtQuantile(0.5));
+}
+
+TEST(Metrics, histogramMergesObservationsOfAllThreads) {
+  MetricHistogram histogram;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&histogram] {
+      for (uint64_t value = 0; value < 10000; ++value) {
+        histogram.observe(value);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = histogram.snapshot();
+  ASSERT_EQ(40000, snapshot.count);
+  ASSERT_EQ(4 * (9999 * 10000 / 2), snapshot.sum);
+}
+
+TEST(Metrics, exportsPrometheusTextFormat) {
+  MetricsRegistry registry;
+  registry.counter("p2p_bytes_total", "Bytes", {{"command", "1001"}}).add(5);
+  registry.gauge("height", "Height").set(-1);
+  registry.histogram("latency_seconds", "Latency", {{"path", "/getinfo"}}).observe(uint64_t(3));
+
+  std::string text = registry.exportPrometheus();
+  ASSERT_NE(std::string::npos, text.find("# TYPE p2p_bytes_total counter\np2p_bytes_total{command=\"1001\"} 5\n"));
+  ASSERT_NE(std::string::npos, text.find("# HELP height Height\n# TYPE height gauge\nheight -1\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{path=\"/getinfo\",le=\"8e-06\"} 1\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{path=\"/getinfo\",le=\"+Inf\"} 1\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_sum{path=\"/getinfo\"} 3e-06\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_count{path=\"/getinfo\"} 1\n"));
+}
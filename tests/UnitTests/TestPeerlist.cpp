@@ -74,3 +74,64 @@ TEST(peer_list, merge_peer_lists)
 
 
 }
+
+TEST(peer_list, get_peer_by_index_returns_most_recent_first)
+{
+  PeerlistManager plm;
+  plm.init(false);
+
+  for (uint32_t i = 1; i <= 50; ++i) {
+    ADD_GRAY_NODE(MAKE_IP(123,43,i,1), 8080, i, 1000 + i);
+  }
+
+  ASSERT_EQ(50, plm.get_gray_peers_count());
+  for (size_t i = 0; i < 50; ++i) {
+    PeerlistEntry pe;
+    ASSERT_TRUE(plm.get_gray_peer_by_index(pe, i));
+    ASSERT_EQ(1050 - i, pe.last_seen);
+  }
+
+  PeerlistEntry pe;
+  ASSERT_FALSE(plm.get_gray_peer_by_index(pe, 50));
+}
+
+TEST(peer_list, gray_list_limits_peers_per_bucket)
+{
+  PeerlistManager plm;
+  plm.init(false);
+
+  for (uint32_t i = 0; i < P2P_MAX_GRAY_PEERS_PER_BUCKET + 10; ++i) {
+    ADD_GRAY_NODE(MAKE_IP(123,43,i / 256,i % 256), 8080, i, 34345);
+  }
+
+  ASSERT_EQ(P2P_MAX_GRAY_PEERS_PER_BUCKET, plm.get_gray_peers_count());
+
+  ADD_GRAY_NODE(MAKE_IP(123,44,0,1), 8080, 1, 34345);
+  ASSERT_EQ(P2P_MAX_GRAY_PEERS_PER_BUCKET + 1, plm.get_gray_peers_count());
+}
+
+TEST(peer_list, unreachable_peer_backs_off_and_leaves_gray_list)
+{
+  PeerlistManager plm;
+  plm.init(false);
+
+  PeerlistEntry ple;
+  ple.adr.ip = MAKE_IP(123,43,12,1);
+  ple.adr.port = 8080;
+  ple.id = 1;
+  ple.last_seen = 34345;
+  plm.append_with_peer_gray(ple);
+
+  time_t now = time(nullptr);
+  ASSERT_TRUE(plm.is_peer_connectable(ple.adr, now));
+
+  plm.set_peer_unreachable(ple);
+  ASSERT_FALSE(plm.is_peer_connectable(ple.adr, now));
+  ASSERT_TRUE(plm.is_peer_connectable(ple.adr, now + P2P_FAILED_PEER_BASE_BACKOFF));
+
+  for (uint32_t i = 1; i < P2P_MAX_PEER_CONNECT_FAILURES; ++i) {
+    plm.set_peer_unreachable(ple);
+  }
+
+  ASSERT_EQ(0, plm.get_gray_peers_count());
+}
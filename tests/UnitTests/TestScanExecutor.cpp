@@ -0,0 +1,113 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+
+#include "Transfers/ScanExecutor.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+void runAndCheckEveryIndexOnce(ScanExecutor& executor, size_t count) {
+  std::unique_ptr<std::atomic<size_t>[]> calls(new std::atomic<size_t>[count]);
+  for (size_t i = 0; i < count; ++i) {
+    calls[i] = 0;
+  }
+
+  executor.run(count, [&](size_t i) { ++calls[i]; });
+
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(1, calls[i]) << "index " << i;
+  }
+}
+
+TEST(ScanExecutorTest, callsTaskForEveryIndexOnce) {
+  ScanExecutor executor(4);
+  runAndCheckEveryIndexOnce(executor, 1);
+  runAndCheckEveryIndexOnce(executor, 3);
+  runAndCheckEveryIndexOnce(executor, 10000);
+}
+
+TEST(ScanExecutorTest, worksWithoutThreads) {
+  ScanExecutor executor(0);
+  runAndCheckEveryIndexOnce(executor, 100);
+}
+
+TEST(ScanExecutorTest, emptyJobReturnsImmediately) {
+  ScanExecutor executor(2);
+  executor.run(0, [](size_t) { FAIL(); });
+}
+
+TEST(ScanExecutorTest, unevenTasksAreStolen) {
+  ScanExecutor executor(3);
+  std::atomic<size_t> sum(0);
+
+  // the first quarter of indexes is much slower, its range gets stolen by other threads
+  executor.run(400, [&](size_t i) {
+    if (i < 100) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    sum += i;
+  });
+
+  ASSERT_EQ(400 * 399 / 2, sum);
+}
+
+TEST(ScanExecutorTest, concurrentJobsAreExecuted) {
+  ScanExecutor executor(2);
+  std::vector<std::thread> callers;
+  std::atomic<size_t> failures(0);
+
+  for (size_t i = 0; i < 4; ++i) {
+    callers.emplace_back([&executor, &failures] {
+      for (size_t j = 0; j < 50; ++j) {
+        std::atomic<size_t> calls(0);
+        executor.run(100, [&calls](size_t) { ++calls; });
+        if (calls != 100) {
+          ++failures;
+        }
+      }
+    });
+  }
+
+  for (auto& caller : callers) {
+    caller.join();
+  }
+
+  ASSERT_EQ(0, failures);
+}
+
+TEST(ScanExecutorTest, taskExceptionIsRethrownAfterAllTasksFinish) {
+  ScanExecutor executor(2);
+  std::atomic<size_t> calls(0);
+
+  ASSERT_THROW(executor.run(100, [&calls](size_t i) {
+    ++calls;
+    if (i == 50) {
+      throw std::runtime_error("task failed");
+    }
+  }), std::runtime_error);
+
+  ASSERT_EQ(100, calls);
+}
+
+}
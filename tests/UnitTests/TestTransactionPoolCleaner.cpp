@@ -0,0 +1,258 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include "crypto/crypto.h"
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/TransactionPool.h"
+#include "CryptoNoteCore/TransactionPoolCleaner.h"
+#include "CryptoNoteCore/TransactionValidatiorState.h"
+#include "Logging/LoggerGroup.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint64_t POOL_TIMEOUT = 60 * 60 * 24;
+
+class FakeTimeProvider : public ITimeProvider {
+public:
+  explicit FakeTimeProvider(time_t& currentTime) : currentTime(currentTime) {
+  }
+
+  virtual time_t now() override {
+    return currentTime;
+  }
+
+private:
+  time_t& currentTime;
+};
+
+CachedTransaction createTransaction(TransactionValidatorState& state, uint64_t fee = 10) {
+  KeyInput input;
+  input.amount = fee;
+  input.outputIndexes.push_back(0);
+  input.keyImage = Crypto::rand<Crypto::KeyImage>();
+  state.spentKeyImages.insert(input.keyImage);
+
+  Transaction transaction;
+  transaction.version = 1;
+  transaction.unlockTime = 0;
+  transaction.inputs.push_back(input);
+  transaction.signatures.push_back({Crypto::Signature()});
+  return CachedTransaction(std::move(transaction));
+}
+
+Crypto::Hash pushTransaction(ITransactionPool& pool, uint64_t fee, uint64_t receiveTime) {
+  TransactionValidatorState state;
+  auto transaction = createTransaction(state, fee);
+  auto hash = transaction.getTransactionHash();
+  EXPECT_TRUE(pool.pushTransaction(std::move(transaction), std::move(state), receiveTime));
+  return hash;
+}
+
+class TransactionPoolCleanerTest : public ::testing::Test {
+public:
+  TransactionPoolCleanerTest() : currentTime(time(nullptr)) {
+  }
+
+  std::unique_ptr<TransactionPoolCleanWrapper> createPool() {
+    return std::unique_ptr<TransactionPoolCleanWrapper>(new TransactionPoolCleanWrapper(
+      std::unique_ptr<ITransactionPool>(new TransactionPool(logger)),
+      std::unique_ptr<ITimeProvider>(new FakeTimeProvider(currentTime)),
+      logger,
+      POOL_TIMEOUT));
+  }
+
+protected:
+  Logging::LoggerGroup logger;
+  time_t currentTime;
+};
+
+class TransactionPoolEvictionTest : public ::testing::Test {
+public:
+  TransactionPoolEvictionTest() : currentTime(1000000) {
+    TransactionPool sizingPool(logger);
+    pushTransaction(sizingPool, 1000, currentTime);
+    transactionMemoryUsage = sizingPool.getTransactionsMemoryUsage();
+  }
+
+  std::unique_ptr<TransactionPool> createPool(size_t capacity, uint64_t incrementalFee) {
+    return std::unique_ptr<TransactionPool>(new TransactionPool(logger, capacity * transactionMemoryUsage, incrementalFee));
+  }
+
+protected:
+  Logging::LoggerGroup logger;
+  uint64_t currentTime;
+  uint64_t transactionMemoryUsage;
+};
+
+}
+
+TEST_F(TransactionPoolCleanerTest, pushedTransactionKeepsGivenReceiveTime) {
+  auto pool = createPool();
+  TransactionValidatorState state;
+  auto transaction = createTransaction(state);
+  auto hash = transaction.getTransactionHash();
+
+  ASSERT_TRUE(pool->pushTransaction(std::move(transaction), std::move(state), currentTime - 100));
+  ASSERT_EQ(currentTime - 100, pool->getTransactionReceiveTime(hash));
+}
+
+TEST_F(TransactionPoolCleanerTest, restoredRecentlyDeletedTransactionCannotBeAddedAgain) {
+  auto pool = createPool();
+  TransactionValidatorState state;
+  auto transaction = createTransaction(state);
+  auto hash = transaction.getTransactionHash();
+  TransactionValidatorState stateCopy = state;
+  CachedTransaction transactionCopy = transaction;
+
+  ASSERT_TRUE(pool->pushTransaction(std::move(transaction), std::move(state), currentTime - POOL_TIMEOUT));
+  ASSERT_EQ(1, pool->clean().size());
+
+  auto recentlyDeleted = pool->getRecentlyDeletedTransactions();
+  ASSERT_EQ(1, recentlyDeleted.count(hash));
+
+  auto restoredPool = createPool();
+  restoredPool->addRecentlyDeletedTransactions(recentlyDeleted);
+  ASSERT_FALSE(restoredPool->pushTransaction(std::move(transactionCopy), std::move(stateCopy), currentTime));
+}
+
+TEST_F(TransactionPoolCleanerTest, expiredRecentlyDeletedTransactionsAreNotRestored) {
+  auto pool = createPool();
+  pool->addRecentlyDeletedTransactions({{Crypto::rand<Crypto::Hash>(), currentTime - POOL_TIMEOUT}});
+
+  ASSERT_TRUE(pool->getRecentlyDeletedTransactions().empty());
+}
+
+TEST_F(TransactionPoolCleanerTest, cleanRemovesOnlyOutdatedTransactions) {
+  auto pool = createPool();
+  auto outdatedHash = pushTransaction(*pool, 10, currentTime - POOL_TIMEOUT);
+  auto freshHash = pushTransaction(*pool, 10, currentTime - POOL_TIMEOUT + 1);
+
+  auto deleted = pool->clean();
+  ASSERT_EQ(1, deleted.size());
+  ASSERT_EQ(outdatedHash, deleted[0]);
+  ASSERT_FALSE(pool->checkIfTransactionPresent(outdatedHash));
+  ASSERT_TRUE(pool->checkIfTransactionPresent(freshHash));
+}
+
+TEST_F(TransactionPoolEvictionTest, outdatedTransactionHashesAreOrderedByReceiveTime) {
+  auto pool = createPool(10, 0);
+  auto second = pushTransaction(*pool, 10, currentTime - 10);
+  auto first = pushTransaction(*pool, 10, currentTime - 20);
+  pushTransaction(*pool, 10, currentTime);
+
+  auto hashes = pool->getOutdatedTransactionHashes(currentTime - 10);
+  ASSERT_EQ(2, hashes.size());
+  ASSERT_EQ(first, hashes[0]);
+  ASSERT_EQ(second, hashes[1]);
+}
+
+TEST_F(TransactionPoolEvictionTest, nothingIsEvictedWithinBudget) {
+  auto pool = createPool(2, 0);
+  pushTransaction(*pool, 10, currentTime);
+  pushTransaction(*pool, 20, currentTime);
+
+  ASSERT_TRUE(pool->evictLowestFeeTransactions(currentTime).empty());
+  ASSERT_EQ(2, pool->getTransactionCount());
+  ASSERT_EQ(0, pool->getMinimumFeePerKilobyte(currentTime));
+}
+
+TEST_F(TransactionPoolEvictionTest, lowestFeeTransactionsAreEvictedAboveBudget) {
+  auto pool = createPool(2, 0);
+  auto cheapest = pushTransaction(*pool, 1000, currentTime);
+  auto cheap = pushTransaction(*pool, 2000, currentTime);
+  auto expensive = pushTransaction(*pool, 4000, currentTime);
+
+  auto evicted = pool->evictLowestFeeTransactions(currentTime);
+  ASSERT_EQ(1, evicted.size());
+  ASSERT_EQ(cheapest, evicted[0]);
+  ASSERT_TRUE(pool->checkIfTransactionPresent(cheap));
+  ASSERT_TRUE(pool->checkIfTransactionPresent(expensive));
+  ASSERT_EQ(2 * transactionMemoryUsage, pool->getTransactionsMemoryUsage());
+}
+
+TEST_F(TransactionPoolEvictionTest, evictionRaisesMinimumFeeAboveEvictedRate) {
+  const uint64_t INCREMENTAL_FEE = 100;
+  auto pool = createPool(1, INCREMENTAL_FEE);
+  auto evictedHash = pushTransaction(*pool, 1000, currentTime);
+  uint64_t evictedFeePerKilobyte = getFeePerKilobyte(pool->getTransaction(evictedHash));
+  pushTransaction(*pool, 2000, currentTime);
+
+  ASSERT_EQ(1, pool->evictLowestFeeTransactions(currentTime).size());
+  ASSERT_EQ(evictedFeePerKilobyte + INCREMENTAL_FEE, pool->getMinimumFeePerKilobyte(currentTime));
+}
+
+TEST_F(TransactionPoolEvictionTest, minimumFeeDecaysAndResets) {
+  const uint64_t INCREMENTAL_FEE = 100;
+  auto pool = createPool(4, INCREMENTAL_FEE);
+  for (uint64_t fee = 1000; fee < 6000; fee += 1000) {
+    pushTransaction(*pool, fee, currentTime);
+  }
+
+  ASSERT_EQ(1, pool->evictLowestFeeTransactions(currentTime).size());
+  uint64_t minimumFee = pool->getMinimumFeePerKilobyte(currentTime);
+
+  // the pool is still full, so the floor halves once per half-life
+  currentTime += CryptoNote::parameters::CRYPTONOTE_MEMPOOL_MIN_FEE_HALF_LIFE;
+  uint64_t decayedFee = pool->getMinimumFeePerKilobyte(currentTime);
+  ASSERT_GE(decayedFee, minimumFee / 2 - 1);
+  ASSERT_LE(decayedFee, minimumFee / 2 + 1);
+
+  currentTime += 64 * CryptoNote::parameters::CRYPTONOTE_MEMPOOL_MIN_FEE_HALF_LIFE;
+  ASSERT_EQ(0, pool->getMinimumFeePerKilobyte(currentTime));
+}
+
+TEST_F(TransactionPoolEvictionTest, zeroFeeFusionTransactionIsExemptFromMinimumFee) {
+  Currency currency = CurrencyBuilder(logger).currency();
+  const uint64_t MINIMUM_FEE = 1000;
+
+  Transaction fusion;
+  fusion.version = 1;
+  fusion.unlockTime = 0;
+  for (size_t i = 0; i < currency.fusionTxMinInputCount(); ++i) {
+    KeyInput input;
+    input.amount = 10 * currency.defaultDustThreshold();
+    input.outputIndexes.push_back(0);
+    input.keyImage = Crypto::rand<Crypto::KeyImage>();
+    fusion.inputs.push_back(input);
+    fusion.signatures.push_back({Crypto::Signature()});
+  }
+
+  // 12 inputs of ten dust thresholds decompose into 20 and 100 thresholds
+  for (uint64_t amount : { 20 * currency.defaultDustThreshold(), 100 * currency.defaultDustThreshold() }) {
+    TransactionOutput output;
+    output.amount = amount;
+    output.target = KeyOutput{Crypto::rand<Crypto::PublicKey>()};
+    fusion.outputs.push_back(output);
+  }
+
+  CachedTransaction cachedFusion(std::move(fusion));
+  ASSERT_EQ(0, cachedFusion.getTransactionFee());
+  ASSERT_TRUE(currency.isFusionTransaction(cachedFusion.getTransaction()));
+  ASSERT_FALSE(isBelowMinimumFee(cachedFusion, MINIMUM_FEE, currency));
+
+  TransactionValidatorState state;
+  ASSERT_TRUE(isBelowMinimumFee(createTransaction(state, 0), MINIMUM_FEE, currency));
+  ASSERT_TRUE(isBelowMinimumFee(createTransaction(state, 10), MINIMUM_FEE, currency));
+  ASSERT_FALSE(isBelowMinimumFee(createTransaction(state, 10), 0, currency));
+  ASSERT_FALSE(isBelowMinimumFee(createTransaction(state, 1000000), MINIMUM_FEE, currency));
+}
@@ -411,6 +411,34 @@ TEST_F(TransfersApi, state) {
   ASSERT_TRUE(compareStates(m_transfersSync, sync2));
 }
 
+TEST_F(TransfersApi, stateOfOneViewKey) {
+  addAccounts(2);
+  subscribeAccounts();
+
+  generator.generateEmptyBlocks(5);
+
+  startSync();
+
+  m_sync.stop();
+  std::stringstream memstm;
+  m_transfersSync.save(memstm, m_accounts[0].address.viewPublicKey);
+
+  BlockchainSynchronizer bsync2(m_node, m_logger, m_currency.genesisBlockHash());
+  TransfersSyncronizer sync2(m_currency, m_logger, bsync2, m_node);
+
+  for (size_t i = 0; i < m_accounts.size(); ++i) {
+    sync2.addSubscription(createSubscription(i));
+  }
+
+  sync2.load(memstm);
+
+  // only the saved consumer knows the synchronized blocks
+  ASSERT_EQ(m_transfersSync.getViewKeyKnownBlocks(m_accounts[0].address.viewPublicKey),
+    sync2.getViewKeyKnownBlocks(m_accounts[0].address.viewPublicKey));
+  ASSERT_EQ(1, sync2.getViewKeyKnownBlocks(m_accounts[1].address.viewPublicKey).size());
+  ASSERT_LT(1, m_transfersSync.getViewKeyKnownBlocks(m_accounts[1].address.viewPublicKey).size());
+}
+
 TEST_F(TransfersApi, sameTrackingKey) {
 
   size_t offset = 2; // miner account + ordinary account
@@ -1001,6 +1001,38 @@ TEST_F(TransfersContainer_balance, filtersByStateAndKeySimultaneously) {
   ASSERT_EQ(AMOUNT_1 + AMOUNT_2, container.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeKey));
 }
 
+TEST_F(TransfersContainer_balance, lockedByHeightTransferMovesToUnlockedWhenHeightAdvances) {
+  const uint32_t UNLOCK_HEIGHT = TEST_BLOCK_HEIGHT + 10;
+
+  TestTransactionBuilder tx1;
+  tx1.setUnlockTime(UNLOCK_HEIGHT);
+  tx1.addTestInput(AMOUNT_1 + 1);
+  auto outInfo = tx1.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX, account);
+  ASSERT_TRUE(container.addTransaction(blockInfo(TEST_BLOCK_HEIGHT), *tx1.build(), { outInfo }));
+
+  uint32_t unlockedHeight = static_cast<uint32_t>(UNLOCK_HEIGHT - currency.lockedTxAllowedDeltaBlocks());
+  container.advanceHeight(unlockedHeight - 1);
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllLocked));
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllUnlocked));
+
+  container.advanceHeight(unlockedHeight);
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllLocked));
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllUnlocked));
+
+  container.detach(unlockedHeight);
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeStateLocked | ITransfersContainer::IncludeTypeAll));
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllUnlocked));
+}
+
+TEST_F(TransfersContainer_balance, spentTransferIsNotCounted) {
+  auto tx = addTransaction(TEST_BLOCK_HEIGHT, AMOUNT_1);
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT);
+  ASSERT_EQ(AMOUNT_1, container.balance(ITransfersContainer::IncludeAllUnlocked));
+
+  addSpendingTransaction(tx->getTransactionHash(), TEST_CONTAINER_CURRENT_HEIGHT, 0, AMOUNT_1);
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAll));
+}
+
 
 //--------------------------------------------------------------------------- 
 // TransfersContainer_getOutputs
@@ -1131,3 +1163,47 @@ TEST_F(TransfersContainer_getOutputs, filtersByStateAndKeySimultaneously) {
   ASSERT_EQ(AMOUNT_1 + AMOUNT_2, transfers.front().amount);
 }
 
+
+//--------------------------------------------------------------------------- 
+// TransfersContainer_getUnlockedOutput
+//--------------------------------------------------------------------------- 
+
+class TransfersContainer_getUnlockedOutput : public TransfersContainerTest {
+public:
+  TransfersContainer_getUnlockedOutput() {
+  }
+};
+
+TEST_F(TransfersContainer_getUnlockedOutput, returnsOnlyUnlockedKeyOutputs) {
+  auto unconfirmedTx = addTransaction(WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT);
+  auto unlockedTx = addTransaction(TEST_CONTAINER_CURRENT_HEIGHT - TEST_TRANSACTION_SPENDABLE_AGE);
+  auto softLockedTx = addTransaction(TEST_CONTAINER_CURRENT_HEIGHT);
+
+  ASSERT_EQ(1, container.getUnlockedOutputsCount());
+
+  TransactionOutputInformation output;
+  ASSERT_TRUE(container.getUnlockedOutput(0, output));
+  ASSERT_EQ(unlockedTx->getTransactionHash(), output.transactionHash);
+  ASSERT_FALSE(container.getUnlockedOutput(1, output));
+}
+
+TEST_F(TransfersContainer_getUnlockedOutput, followsAdvanceAndSpending) {
+  auto tx1 = addTransaction(TEST_BLOCK_HEIGHT);
+  auto tx2 = addTransaction(TEST_BLOCK_HEIGHT);
+  ASSERT_EQ(0, container.getUnlockedOutputsCount());
+
+  container.advanceHeight(TEST_BLOCK_HEIGHT + TEST_TRANSACTION_SPENDABLE_AGE);
+  ASSERT_EQ(2, container.getUnlockedOutputsCount());
+
+  addSpendingTransaction(tx1->getTransactionHash(), TEST_BLOCK_HEIGHT + TEST_TRANSACTION_SPENDABLE_AGE, 0);
+  ASSERT_EQ(1, container.getUnlockedOutputsCount());
+
+  TransactionOutputInformation output;
+  ASSERT_TRUE(container.getUnlockedOutput(0, output));
+  ASSERT_EQ(tx2->getTransactionHash(), output.transactionHash);
+
+  std::vector<TransactionOutputInformation> outputs;
+  container.getOutputs(outputs, ITransfersContainer::IncludeKeyUnlocked);
+  ASSERT_EQ(1, outputs.size());
+  ASSERT_EQ(tx2->getTransactionHash(), outputs[0].transactionHash);
+}
@@ -0,0 +1,322 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Timer.h>
+
+#include "crypto/crypto.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/AddBlockErrors.h"
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/DatabaseBlockchainCacheFactory.h"
+#include "CryptoNoteCore/UpgradeDetector.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "Logging/ConsoleLogger.h"
+#include "NodeRpcProxy/NodeRpcProxy.h"
+#include "P2p/NetNode.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/RpcServer.h"
+
+#include "../Common/VectorMainChainStorage.h"
+#include "DataBaseMock.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t RPC_PORT = 16491;
+const uint16_t NODE_STUB_PORT = 16492;
+
+class TestCore : public Core {
+public:
+  TestCore(const Currency& currency, Logging::ILogger& logger, System::Dispatcher& dispatcher, IDataBase& database) :
+    Core(currency, logger, Checkpoints(logger), dispatcher,
+         std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger)),
+         createVectorMainChainStorage(currency)) {
+  }
+
+  virtual bool addMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) override {
+    queues.push_back(&messageQueue);
+    return Core::addMessageQueue(messageQueue);
+  }
+
+  virtual bool removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) override {
+    queues.erase(std::remove(queues.begin(), queues.end(), &messageQueue), queues.end());
+    return Core::removeMessageQueue(messageQueue);
+  }
+
+  // Emulates a pool change without building a spendable transaction
+  void notifyTransactionAdded() {
+    for (auto queue : queues) {
+      queue->push(makeAddTransactionMessage({Crypto::rand<Crypto::Hash>()}));
+    }
+  }
+
+  std::vector<MessageQueue<BlockchainMessage>*> queues;
+};
+
+class WaitForChangesTest : public ::testing::Test {
+public:
+  WaitForChangesTest() :
+    logger(Logging::ERROR),
+    // version 1 blocks don't need merge mining, so the test can mine them itself
+    currency(CurrencyBuilder(logger).upgradeHeightV2(IUpgradeDetector::UNDEF_HEIGHT).upgradeHeightV3(IUpgradeDetector::UNDEF_HEIGHT)
+      .upgradeHeightV4(IUpgradeDetector::UNDEF_HEIGHT).currency()),
+    core(currency, logger, dispatcher, database),
+    protocol(currency, dispatcher, core, nullptr, logger),
+    p2p(dispatcher, protocol, logger) {
+    core.load();
+    account.generate();
+  }
+
+  void SetUp() override {
+    server.reset(new RpcServer(dispatcher, logger, core, p2p, protocol));
+    server->start("127.0.0.1", RPC_PORT);
+  }
+
+  void TearDown() override {
+    server->stop();
+    server.reset();
+  }
+
+  COMMAND_RPC_WAIT_FOR_CHANGES::response waitForChanges(const Crypto::Hash& tailBlockId, uint64_t poolVersion, uint32_t timeout) {
+    COMMAND_RPC_WAIT_FOR_CHANGES::request req;
+    req.tailBlockId = tailBlockId;
+    req.poolVersion = poolVersion;
+    req.timeout = timeout;
+
+    COMMAND_RPC_WAIT_FOR_CHANGES::response rsp;
+    HttpClient client(dispatcher, "127.0.0.1", RPC_PORT);
+    invokeBinaryCommand(client, "/wait_for_changes.bin", req, rsp);
+    return rsp;
+  }
+
+  void addBlock() {
+    BlockTemplate block;
+    Difficulty difficulty;
+    uint32_t height;
+    ASSERT_TRUE(core.getBlockTemplate(block, account.getAccountKeys().address, BinaryArray(), difficulty, height));
+
+    Crypto::cn_context context;
+    while (!currency.checkProofOfWork(context, CachedBlock(block), difficulty)) {
+      ++block.nonce;
+    }
+
+    ASSERT_EQ(error::AddBlockErrorCode::ADDED_TO_MAIN, core.submitBlock(toBinaryArray(block)));
+  }
+
+  void spawnDelayed(System::ContextGroup& group, std::function<void()> action) {
+    group.spawn([this, action] {
+      System::Timer(dispatcher).sleep(std::chrono::milliseconds(50));
+      action();
+    });
+  }
+
+  System::Dispatcher dispatcher;
+  Logging::ConsoleLogger logger;
+  Currency currency;
+  DataBaseMock database;
+  TestCore core;
+  CryptoNoteProtocolHandler protocol;
+  NodeServer p2p;
+  std::unique_ptr<RpcServer> server;
+  AccountBase account;
+};
+
+TEST_F(WaitForChangesTest, returnsImmediatelyIfClientKnowsAnotherTopBlock) {
+  auto rsp = waitForChanges(NULL_HASH, 0, 10000);
+
+  ASSERT_EQ(CORE_RPC_STATUS_OK, rsp.status);
+  ASSERT_EQ(core.getTopBlockHash(), rsp.tailBlockId);
+}
+
+TEST_F(WaitForChangesTest, returnsWhenNewBlockIsAdded) {
+  auto known = waitForChanges(NULL_HASH, 0, 0);
+
+  System::ContextGroup group(dispatcher);
+  spawnDelayed(group, [this] { addBlock(); });
+
+  auto start = std::chrono::steady_clock::now();
+  auto rsp = waitForChanges(known.tailBlockId, known.poolVersion, 10000);
+  group.wait();
+
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ASSERT_NE(known.tailBlockId, rsp.tailBlockId);
+  ASSERT_EQ(core.getTopBlockHash(), rsp.tailBlockId);
+}
+
+TEST_F(WaitForChangesTest, returnsWhenPoolChanges) {
+  auto known = waitForChanges(NULL_HASH, 0, 0);
+
+  System::ContextGroup group(dispatcher);
+  spawnDelayed(group, [this] { core.notifyTransactionAdded(); });
+
+  auto start = std::chrono::steady_clock::now();
+  auto rsp = waitForChanges(known.tailBlockId, known.poolVersion, 10000);
+  group.wait();
+
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ASSERT_EQ(known.tailBlockId, rsp.tailBlockId);
+  ASSERT_EQ(known.poolVersion + 1, rsp.poolVersion);
+}
+
+TEST_F(WaitForChangesTest, returnsCurrentStateAfterTimeout) {
+  auto known = waitForChanges(NULL_HASH, 0, 0);
+
+  auto start = std::chrono::steady_clock::now();
+  auto rsp = waitForChanges(known.tailBlockId, known.poolVersion, 100);
+
+  ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+  ASSERT_EQ(CORE_RPC_STATUS_OK, rsp.status);
+  ASSERT_EQ(known.tailBlockId, rsp.tailBlockId);
+  ASSERT_EQ(known.poolVersion, rsp.poolVersion);
+}
+
+// Answers the change notification requests of NodeRpcProxy, all other requests fail
+class NodeStub : public HttpServer {
+public:
+  enum class Mode { NOT_FOUND, HOLD, CHANGES };
+
+  NodeStub(System::Dispatcher& dispatcher, Logging::ILogger& logger) : HttpServer(dispatcher, logger), mode(Mode::NOT_FOUND), poolVersion(0) {
+  }
+
+  virtual void processRequest(const HttpRequest& request, HttpResponse& response) override {
+    ++requestCounts[request.getUrl()];
+    if (request.getUrl() != "/wait_for_changes.bin") {
+      response.setStatus(HttpResponse::STATUS_500);
+      return;
+    }
+
+    if (mode == Mode::NOT_FOUND) {
+      response.setStatus(HttpResponse::STATUS_404);
+    } else if (mode == Mode::HOLD) {
+      System::Timer(m_dispatcher).sleep(std::chrono::seconds(60));
+    } else {
+      System::Timer(m_dispatcher).sleep(std::chrono::milliseconds(20));
+
+      COMMAND_RPC_WAIT_FOR_CHANGES::response rsp;
+      rsp.tailBlockId = NULL_HASH;
+      rsp.poolVersion = ++poolVersion;
+      rsp.status = CORE_RPC_STATUS_OK;
+      response.setBody(storeToBinaryKeyValue(rsp));
+    }
+  }
+
+  size_t requestCount(const std::string& url) const {
+    auto it = requestCounts.find(url);
+    return it == requestCounts.end() ? 0 : it->second;
+  }
+
+  Mode mode;
+  uint64_t poolVersion;
+  std::map<std::string, size_t> requestCounts;
+};
+
+class NodeRpcProxyChangesTest : public ::testing::Test {
+public:
+  NodeRpcProxyChangesTest() : logger(Logging::ERROR), stub(dispatcher, logger), proxy("127.0.0.1", NODE_STUB_PORT, logger) {
+  }
+
+  void SetUp() override {
+    stub.start("127.0.0.1", NODE_STUB_PORT);
+  }
+
+  void TearDown() override {
+    shutdownProxy();
+    stub.stop();
+  }
+
+  // Runs the stub until the condition holds or the timeout passes
+  bool waitFor(std::function<bool()> condition, std::chrono::milliseconds timeout) {
+    System::Timer timer(dispatcher);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+
+      timer.sleep(std::chrono::milliseconds(10));
+    }
+
+    return true;
+  }
+
+  // NodeRpcProxy::shutdown blocks, so it is called from another thread while the stub keeps serving
+  std::chrono::steady_clock::duration shutdownProxy() {
+    std::atomic<bool> finished(false);
+    auto start = std::chrono::steady_clock::now();
+    std::thread shutdownThread([this, &finished] {
+      proxy.shutdown();
+      finished = true;
+    });
+
+    waitFor([&finished] { return finished.load(); }, std::chrono::seconds(30));
+    shutdownThread.join();
+    return std::chrono::steady_clock::now() - start;
+  }
+
+  void initProxy() {
+    proxy.init([](std::error_code) {});
+  }
+
+  System::Dispatcher dispatcher;
+  Logging::ConsoleLogger logger;
+  NodeStub stub;
+  NodeRpcProxy proxy;
+};
+
+TEST_F(NodeRpcProxyChangesTest, refreshesStatusWhenNodeReportsChanges) {
+  stub.mode = NodeStub::Mode::CHANGES;
+  initProxy();
+
+  // polling would refresh the status once in 5 seconds
+  ASSERT_TRUE(waitFor([this] { return stub.requestCount("/getinfo") >= 3; }, std::chrono::seconds(3)));
+  ASSERT_GE(stub.requestCount("/wait_for_changes.bin"), 2);
+}
+
+TEST_F(NodeRpcProxyChangesTest, fallsBackToPollingIfNodeDoesntSupportChanges) {
+  stub.mode = NodeStub::Mode::NOT_FOUND;
+  initProxy();
+
+  ASSERT_TRUE(waitFor([this] { return stub.requestCount("/wait_for_changes.bin") == 1; }, std::chrono::seconds(3)));
+  waitFor([] { return false; }, std::chrono::milliseconds(300));
+
+  ASSERT_EQ(1, stub.requestCount("/wait_for_changes.bin"));
+  ASSERT_EQ(1, stub.requestCount("/getinfo"));
+}
+
+TEST_F(NodeRpcProxyChangesTest, shutdownInterruptsPendingWait) {
+  stub.mode = NodeStub::Mode::HOLD;
+  initProxy();
+
+  ASSERT_TRUE(waitFor([this] { return stub.requestCount("/wait_for_changes.bin") == 1; }, std::chrono::seconds(3)));
+  ASSERT_LT(shutdownProxy(), std::chrono::seconds(2));
+}
+
+}
@@ -34,6 +34,7 @@
 #include "Wallet/WalletErrors.h"
 #include "Wallet/WalletGreen.h"
 #include "Wallet/WalletSerializationV2.h"
+#include "Wallet/WalletSynchronizerHost.h"
 #include "Wallet/WalletUtils.h"
 #include "WalletLegacy/WalletUserTransactionsCache.h"
 #include "WalletLegacy/WalletLegacySerializer.h"
@@ -157,10 +158,13 @@ public:
 
 protected:
   void cleanUpWalletFiles() const;
+  void copyWalletFiles(const std::string& from, const std::string& to) const;
+  uint64_t journalSize(const std::string& path) const;
   CryptoNote::AccountPublicAddress parseAddress(const std::string& address);
   void generateBlockReward();
   void generateBlockReward(const std::string& address);
   void generateAndUnlockMoney();
+  CryptoNote::Transaction makeIncomingTransaction(const std::string& address, uint64_t amount);
   void generateAddressesWithPendingMoney(size_t count);
   void generateFusionOutputsAndUnlock(WalletGreen& wallet, INodeTrivialRefreshStub& node,
     const CryptoNote::Currency& walletCurrency, uint64_t threshold, size_t addressIndex = 0);
@@ -262,6 +266,23 @@ void WalletApi::cleanUpWalletFiles() const {
   if (boost::filesystem::exists(BOB_WALLET_BACKUP_PATH)) {
     boost::filesystem::remove(BOB_WALLET_BACKUP_PATH);
   }
+
+  for (const auto& path : { ALICE_WALLET_PATH, BOB_WALLET_PATH, BOB_WALLET_BACKUP_PATH }) {
+    if (boost::filesystem::exists(WalletJournal::journalPath(path))) {
+      boost::filesystem::remove(WalletJournal::journalPath(path));
+    }
+  }
+}
+
+void WalletApi::copyWalletFiles(const std::string& from, const std::string& to) const {
+  boost::filesystem::copy(from, to);
+  if (boost::filesystem::exists(WalletJournal::journalPath(from))) {
+    boost::filesystem::copy(WalletJournal::journalPath(from), WalletJournal::journalPath(to));
+  }
+}
+
+uint64_t WalletApi::journalSize(const std::string& path) const {
+  return boost::filesystem::file_size(WalletJournal::journalPath(path));
 }
 
 void WalletApi::setMinerTo(CryptoNote::WalletGreen& wallet) {
@@ -358,6 +379,13 @@ void WalletApi::generateAndUnlockMoney() {
   unlockMoney();
 }
 
+CryptoNote::Transaction WalletApi::makeIncomingTransaction(const std::string& address, uint64_t amount) {
+  auto transaction = createTransaction();
+  transaction->addOutput(amount, parseAddress(address));
+  addTestInput(*transaction, amount + FEE);
+  return convertTx(*transaction);
+}
+
 void WalletApi::waitForPredicate(CryptoNote::WalletGreen& wallet, std::function<bool()>&& pred, std::chrono::nanoseconds timeout) {
   System::Context<> waitContext(dispatcher, [&wallet, &pred]() {
     while (!pred()) {
@@ -1284,6 +1312,162 @@ TEST_F(WalletApi, loadWithWrongPassword) {
   }
 }
 
+TEST_F(WalletApi, journaledTransactionsKeepTheirIdsAfterLoad) {
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+
+  alice.save();
+  auto emptyJournalSize = journalSize(ALICE_WALLET_PATH);
+
+  generator.putTxToPool(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 2);
+  ASSERT_EQ(WALLET_UNCONFIRMED_TRANSACTION_HEIGHT, alice.getTransaction(1).blockHeight);
+  alice.save();
+
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  generator.putTxPoolToBlockchain();
+  node.updateObservers();
+  waitForTransactionCount(alice, 3);
+  waitForTransactionConfirmed(alice, 1);
+
+  alice.save();
+  ASSERT_LT(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+
+  copyWalletFiles(ALICE_WALLET_PATH, BOB_WALLET_PATH);
+
+  WalletGreen bob(dispatcher, currency, node, logger);
+  bob.load(BOB_WALLET_PATH, "pass");
+
+  ASSERT_EQ(alice.getTransactionCount(), bob.getTransactionCount());
+  for (size_t i = 0; i < alice.getTransactionCount(); ++i) {
+    ASSERT_EQ(alice.getTransaction(i).hash, bob.getTransaction(i).hash);
+  }
+
+  waitForTransactionConfirmed(bob, 1);
+  waitForTransactionConfirmed(bob, 2);
+  compareWalletsTransactionTransfers(alice, bob, true);
+
+  bob.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, journaledTransactionsFromBlocksUnknownToSnapshotAreUnconfirmedAfterLoad) {
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+
+  alice.save();
+  auto snapshotBlockCount = alice.getBlockCount();
+
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 2);
+  ASSERT_LE(snapshotBlockCount, alice.getTransaction(1).blockHeight);
+
+  alice.save();
+
+  copyWalletFiles(ALICE_WALLET_PATH, BOB_WALLET_PATH);
+
+  WalletGreen bob(dispatcher, currency, node, logger);
+  bob.load(BOB_WALLET_PATH, "pass");
+
+  ASSERT_EQ(2, bob.getTransactionCount());
+  ASSERT_EQ(alice.getTransaction(0), bob.getTransaction(0));
+  ASSERT_EQ(alice.getTransaction(1).hash, bob.getTransaction(1).hash);
+  ASSERT_EQ(WALLET_UNCONFIRMED_TRANSACTION_HEIGHT, bob.getTransaction(1).blockHeight);
+
+  waitForTransactionConfirmed(bob, 1);
+  compareWalletsTransactionTransfers(alice, bob, true);
+
+  bob.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, saveWithoutDetailsCompactsJournal) {
+  alice.save();
+  auto emptyJournalSize = journalSize(ALICE_WALLET_PATH);
+
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+
+  alice.save();
+  ASSERT_LT(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+
+  alice.save(WalletSaveLevel::SAVE_KEYS_AND_TRANSACTIONS);
+  ASSERT_EQ(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+
+  // The snapshot has no cache to apply journal records to, so it is written in full once more
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 2);
+
+  alice.save();
+  ASSERT_EQ(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+
+  copyWalletFiles(ALICE_WALLET_PATH, BOB_WALLET_PATH);
+
+  WalletGreen bob(dispatcher, currency, node, logger);
+  bob.load(BOB_WALLET_PATH, "pass");
+
+  compareWalletsActualBalance(alice, bob);
+  compareWalletsPendingBalance(alice, bob);
+  compareWalletsTransactionTransfers(alice, bob, true);
+
+  bob.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, journalIsCompactedAfterBlockInterval) {
+  const uint32_t JOURNAL_COMPACTION_BLOCK_INTERVAL = 720;
+
+  alice.save();
+  auto emptyJournalSize = journalSize(ALICE_WALLET_PATH);
+
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+
+  alice.save();
+  ASSERT_LT(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+
+  auto blockCount = alice.getBlockCount();
+  generator.generateEmptyBlocks(JOURNAL_COMPACTION_BLOCK_INTERVAL);
+  node.updateObservers();
+  waitForValue<size_t>(alice, blockCount + JOURNAL_COMPACTION_BLOCK_INTERVAL, [this] () { return alice.getBlockCount(); });
+
+  alice.save();
+  ASSERT_EQ(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+}
+
+TEST_F(WalletApi, changePasswordKeepsJournaledTransactions) {
+  alice.save();
+  auto emptyJournalSize = journalSize(ALICE_WALLET_PATH);
+
+  generator.addTxToBlockchain(makeIncomingTransaction(aliceAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+
+  alice.save();
+  ASSERT_LT(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+
+  alice.changePassword("pass", "pass2");
+  ASSERT_EQ(emptyJournalSize, journalSize(ALICE_WALLET_PATH));
+
+  copyWalletFiles(ALICE_WALLET_PATH, BOB_WALLET_PATH);
+
+  WalletGreen bob(dispatcher, currency, node, logger);
+  bob.load(BOB_WALLET_PATH, "pass2");
+
+  compareWalletsPendingBalance(alice, bob);
+  compareWalletsTransactionTransfers(alice, bob, true);
+
+  bob.shutdown();
+  wait(100);
+}
+
 void WalletApi::testIWalletDataCompatibility(bool details, const std::string& cache, const std::vector<WalletLegacyTransaction>& txs,
     const std::vector<WalletLegacyTransfer>& trs, const std::vector<std::pair<TransactionInformation, int64_t>>& externalTxs) {
   CryptoNote::AccountBase account;
@@ -3639,6 +3823,95 @@ TEST_F(WalletApi, getTransactionsDoesntReturnDeletedTransactions) {
   ASSERT_FALSE(transactionWithTransfersFound(alice, transactions, id));
 }
 
+TEST_F(WalletApi, getTransactionsByAddressesReturnsTransactionOnceItIsConfirmed) {
+  std::string bobAddress = alice.createAddress();
+
+  generator.putTxToPool(makeIncomingTransaction(bobAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+
+  uint32_t blockCount = static_cast<uint32_t>(generator.getBlockchain().size());
+  ASSERT_FALSE(transactionWithTransfersFound(alice, alice.getTransactions({ bobAddress }, 0, blockCount + 1), 0));
+
+  generator.putTxPoolToBlockchain();
+  node.updateObservers();
+  waitForTransactionConfirmed(alice, 0);
+
+  uint32_t blockIndex = alice.getTransaction(0).blockHeight;
+  ASSERT_TRUE(transactionWithTransfersFound(alice, alice.getTransactions({ bobAddress }, blockIndex, 1), 0));
+  ASSERT_TRUE(alice.getTransactions({ aliceAddress }, 0, blockCount + 1)[blockIndex].transactions.empty());
+}
+
+TEST_F(WalletApi, getTransactionsByAddressesFollowsTransactionToAnotherBlockAfterDetach) {
+  auto transaction = makeIncomingTransaction(aliceAddress, SENT);
+  generator.addTxToBlockchain(transaction);
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+
+  uint32_t blockIndex = alice.getTransaction(0).blockHeight;
+  ASSERT_TRUE(transactionWithTransfersFound(alice, alice.getTransactions({ aliceAddress }, blockIndex, 1), 0));
+
+  node.startAlternativeChain(blockIndex);
+  generator.generateEmptyBlocks(2);
+  generator.addTxToBlockchain(transaction);
+  node.updateObservers();
+  waitForPredicate(alice, [this, blockIndex] { return alice.getTransaction(0).blockHeight == blockIndex + 2; });
+
+  ASSERT_EQ(1, alice.getTransactionCount());
+  auto transactions = alice.getTransactions({ aliceAddress }, blockIndex, 3);
+  ASSERT_EQ(3, transactions.size());
+  ASSERT_TRUE(transactions[0].transactions.empty());
+  ASSERT_TRUE(transactions[1].transactions.empty());
+  ASSERT_TRUE(transactionWithTransfersFound(alice, { transactions[2] }, 0));
+}
+
+TEST_F(WalletApi, getTransactionsByAddressesAfterDeleteAddress) {
+  std::string bobAddress = alice.createAddress();
+
+  generator.addTxToBlockchain(makeIncomingTransaction(bobAddress, SENT));
+
+  auto transaction = createTransaction();
+  transaction->addOutput(SENT, parseAddress(aliceAddress));
+  transaction->addOutput(SENT, parseAddress(bobAddress));
+  addTestInput(*transaction, 2 * SENT + FEE);
+  generator.addTxToBlockchain(convertTx(*transaction));
+
+  node.updateObservers();
+  waitForTransactionCount(alice, 2);
+
+  uint32_t bobBlockIndex = alice.getTransaction(0).blockHeight;
+  uint32_t sharedBlockIndex = alice.getTransaction(1).blockHeight;
+  ASSERT_TRUE(transactionWithTransfersFound(alice, alice.getTransactions({ bobAddress }, bobBlockIndex, 1), 0));
+
+  alice.deleteAddress(bobAddress);
+
+  // The transaction left without transfers to the container is deleted, the other one keeps its transfer to alice
+  ASSERT_EQ(WalletTransactionState::DELETED, alice.getTransaction(0).state);
+  ASSERT_TRUE(alice.getTransactions({ bobAddress }, bobBlockIndex, 1)[0].transactions.empty());
+  ASSERT_TRUE(transactionWithTransfersFound(alice, alice.getTransactions({ aliceAddress }, sharedBlockIndex, 1), 1));
+}
+
+TEST_F(WalletApi, getTransactionsByAddressesAfterLoad) {
+  std::string bobAddress = alice.createAddress();
+
+  generator.addTxToBlockchain(makeIncomingTransaction(bobAddress, SENT));
+  node.updateObservers();
+  waitForTransactionCount(alice, 1);
+  uint32_t blockIndex = alice.getTransaction(0).blockHeight;
+
+  alice.save();
+  copyWalletFiles(ALICE_WALLET_PATH, BOB_WALLET_PATH);
+
+  WalletGreen bob(dispatcher, currency, node, logger);
+  bob.load(BOB_WALLET_PATH, "pass");
+
+  ASSERT_TRUE(transactionWithTransfersFound(bob, bob.getTransactions({ bobAddress }, blockIndex, 1), 0));
+  ASSERT_TRUE(bob.getTransactions({ aliceAddress }, blockIndex, 1)[0].transactions.empty());
+
+  bob.shutdown();
+  wait(100);
+}
+
 TEST_F(WalletApi, getTransactionsByBlockHashThrowsIfNotInitialized) {
   CryptoNote::WalletGreen bob(dispatcher, currency, node, logger, TRANSACTION_SOFTLOCK_TIME);
   auto hash = getBlockHash(generator.getBlockchain().back());
@@ -4374,3 +4647,115 @@ TEST_F(WalletApi, walletExportFailedIfFileAlreadyExists) {
     ASSERT_EQ(1, boost::filesystem::file_size(BOB_WALLET_PATH));
   }
 }
+
+TEST_F(WalletApi, containersSharingSyncHostAreSynchronized) {
+  WalletSynchronizerHost syncHost(dispatcher, currency, node, logger);
+
+  WalletGreen bob(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  bob.initialize(BOB_WALLET_PATH, "pass");
+  std::string bobAddress = bob.createAddress();
+
+  WalletGreen carol(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  carol.initialize(BOB_WALLET_BACKUP_PATH, "pass");
+  std::string carolAddress = carol.createAddress();
+
+  generator.addTxToBlockchain(makeIncomingTransaction(bobAddress, SENT));
+  generator.addTxToBlockchain(makeIncomingTransaction(carolAddress, SENT + FEE));
+  node.updateObservers();
+
+  waitForTransactionCount(bob, 1);
+  waitForTransactionCount(carol, 1);
+
+  ASSERT_EQ(SENT, bob.getTransaction(0).totalAmount);
+  ASSERT_EQ(SENT + FEE, carol.getTransaction(0).totalAmount);
+  ASSERT_EQ(bob.getBlockCount(), carol.getBlockCount());
+
+  bob.shutdown();
+  carol.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, containerOfSharedSyncHostSavesOnlyItsOwnState) {
+  WalletSynchronizerHost syncHost(dispatcher, currency, node, logger);
+
+  WalletGreen bob(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  bob.initialize(BOB_WALLET_PATH, "pass");
+  std::string bobAddress = bob.createAddress();
+
+  WalletGreen carol(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  carol.initialize(BOB_WALLET_BACKUP_PATH, "pass");
+  std::string carolAddress = carol.createAddress();
+
+  generator.addTxToBlockchain(makeIncomingTransaction(bobAddress, SENT));
+  generator.addTxToBlockchain(makeIncomingTransaction(carolAddress, SENT + FEE));
+  node.updateObservers();
+  waitForTransactionCount(bob, 1);
+  waitForTransactionCount(carol, 1);
+
+  bob.save(WalletSaveLevel::SAVE_ALL);
+  auto bobTransaction = bob.getTransaction(0);
+  auto bobBlockCount = bob.getBlockCount();
+  carol.shutdown();
+  bob.shutdown();
+
+  // a standalone container gets bob's state back, and carol's consumer isn't in it
+  WalletGreen dave(dispatcher, currency, node, logger, TRANSACTION_SOFTLOCK_TIME);
+  dave.load(BOB_WALLET_PATH, "pass");
+  ASSERT_EQ(1, dave.getAddressCount());
+  ASSERT_EQ(bobAddress, dave.getAddress(0));
+  ASSERT_EQ(1, dave.getTransactionCount());
+  ASSERT_EQ(bobTransaction.hash, dave.getTransaction(0).hash);
+  ASSERT_EQ(bobTransaction.totalAmount, dave.getTransaction(0).totalAmount);
+  ASSERT_EQ(bobBlockCount, dave.getBlockCount());
+
+  dave.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, sharedSyncHostRejectsContainerWithSameViewKey) {
+  WalletSynchronizerHost syncHost(dispatcher, currency, node, logger);
+  auto viewKey = alice.getViewKey();
+
+  WalletGreen bob(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  bob.initializeWithViewKey(BOB_WALLET_PATH, "pass", viewKey.secretKey);
+
+  WalletGreen carol(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  try {
+    carol.initializeWithViewKey(BOB_WALLET_BACKUP_PATH, "pass", viewKey.secretKey);
+    ASSERT_FALSE(true);
+  } catch (const std::system_error& e) {
+    ASSERT_EQ(make_error_code(CryptoNote::error::ADDRESS_ALREADY_EXISTS), e.code());
+  }
+
+  ASSERT_FALSE(boost::filesystem::exists(BOB_WALLET_BACKUP_PATH));
+
+  bob.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, sharedSyncHostRejectsLoadedContainerWithSameViewKey) {
+  alice.save();
+  copyWalletFiles(ALICE_WALLET_PATH, BOB_WALLET_PATH);
+  copyWalletFiles(ALICE_WALLET_PATH, BOB_WALLET_BACKUP_PATH);
+
+  WalletSynchronizerHost syncHost(dispatcher, currency, node, logger);
+
+  WalletGreen bob(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  bob.load(BOB_WALLET_PATH, "pass");
+
+  WalletGreen carol(dispatcher, currency, node, syncHost, logger, TRANSACTION_SOFTLOCK_TIME);
+  try {
+    carol.load(BOB_WALLET_BACKUP_PATH, "pass");
+    ASSERT_FALSE(true);
+  } catch (const std::system_error& e) {
+    ASSERT_EQ(make_error_code(CryptoNote::error::ADDRESS_ALREADY_EXISTS), e.code());
+  }
+
+  // the host is still usable once the first container is gone
+  bob.shutdown();
+  carol.load(BOB_WALLET_BACKUP_PATH, "pass");
+  ASSERT_EQ(aliceAddress, carol.getAddress(0));
+
+  carol.shutdown();
+  wait(100);
+}
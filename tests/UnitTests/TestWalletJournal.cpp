@@ -0,0 +1,165 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <fstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "crypto/crypto.h"
+#include "Wallet/WalletJournal.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const std::string TEST_JOURNAL_NAME = "WalletJournalTest.journal";
+
+BinaryArray makeRecord(const std::string& data) {
+  return BinaryArray(data.begin(), data.end());
+}
+
+class WalletJournalTest : public ::testing::Test {
+protected:
+  virtual void SetUp() override {
+    clean();
+
+    Crypto::cn_context context;
+    Crypto::generate_chacha8_key(context, "password", key);
+    snapshotDigest = Crypto::rand<Crypto::Hash>();
+  }
+
+  virtual void TearDown() override {
+    clean();
+  }
+
+  void clean() {
+    boost::system::error_code ignore;
+    boost::filesystem::remove(TEST_JOURNAL_NAME, ignore);
+  }
+
+  std::vector<BinaryArray> reopen(const Crypto::chacha8_key& openKey, const Crypto::Hash& digest) {
+    std::vector<BinaryArray> records;
+    WalletJournal journal;
+    journal.open(TEST_JOURNAL_NAME, openKey, digest, records);
+    return records;
+  }
+
+  void appendRecords(const std::vector<BinaryArray>& records) {
+    std::vector<BinaryArray> existing;
+    WalletJournal journal;
+    journal.open(TEST_JOURNAL_NAME, key, snapshotDigest, existing);
+    journal.append(records);
+  }
+
+  Crypto::chacha8_key key;
+  Crypto::Hash snapshotDigest;
+};
+
+TEST_F(WalletJournalTest, openCreatesEmptyJournal) {
+  std::vector<BinaryArray> records;
+  WalletJournal journal;
+  journal.open(TEST_JOURNAL_NAME, key, snapshotDigest, records);
+
+  ASSERT_TRUE(journal.isOpened());
+  ASSERT_TRUE(records.empty());
+  ASSERT_EQ(0, journal.recordCount());
+  ASSERT_TRUE(boost::filesystem::exists(TEST_JOURNAL_NAME));
+}
+
+TEST_F(WalletJournalTest, appendedRecordsAreReplayedInOrder) {
+  appendRecords({ makeRecord("first"), makeRecord("second") });
+  appendRecords({ makeRecord("third") });
+
+  auto records = reopen(key, snapshotDigest);
+  ASSERT_EQ(3, records.size());
+  ASSERT_EQ(makeRecord("first"), records[0]);
+  ASSERT_EQ(makeRecord("second"), records[1]);
+  ASSERT_EQ(makeRecord("third"), records[2]);
+}
+
+TEST_F(WalletJournalTest, recordsAreEncrypted) {
+  appendRecords({ makeRecord("plain text wallet record") });
+
+  std::ifstream file(TEST_JOURNAL_NAME, std::ios_base::binary);
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  ASSERT_EQ(std::string::npos, content.find("plain text wallet record"));
+}
+
+TEST_F(WalletJournalTest, recordsOfAnotherSnapshotAreDiscarded) {
+  appendRecords({ makeRecord("first") });
+
+  auto records = reopen(key, Crypto::rand<Crypto::Hash>());
+  ASSERT_TRUE(records.empty());
+
+  // The journal was rebound to the new snapshot, the old records are gone for good
+  records = reopen(key, snapshotDigest);
+  ASSERT_TRUE(records.empty());
+}
+
+TEST_F(WalletJournalTest, truncatedTailIsCutOff) {
+  appendRecords({ makeRecord("first"), makeRecord("second") });
+  auto fullSize = boost::filesystem::file_size(TEST_JOURNAL_NAME);
+  boost::filesystem::resize_file(TEST_JOURNAL_NAME, fullSize - 3);
+
+  auto records = reopen(key, snapshotDigest);
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ(makeRecord("first"), records[0]);
+
+  appendRecords({ makeRecord("third") });
+  records = reopen(key, snapshotDigest);
+  ASSERT_EQ(2, records.size());
+  ASSERT_EQ(makeRecord("first"), records[0]);
+  ASSERT_EQ(makeRecord("third"), records[1]);
+}
+
+TEST_F(WalletJournalTest, damagedRecordStopsReplay) {
+  appendRecords({ makeRecord("first"), makeRecord("second") });
+  auto fullSize = boost::filesystem::file_size(TEST_JOURNAL_NAME);
+
+  {
+    std::fstream file(TEST_JOURNAL_NAME, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+    file.seekp(fullSize - 6);
+    file.put('\x5a');
+  }
+
+  auto records = reopen(key, snapshotDigest);
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ(makeRecord("first"), records[0]);
+  ASSERT_LT(boost::filesystem::file_size(TEST_JOURNAL_NAME), fullSize);
+}
+
+TEST_F(WalletJournalTest, resetDropsRecords) {
+  std::vector<BinaryArray> records;
+  WalletJournal journal;
+  journal.open(TEST_JOURNAL_NAME, key, snapshotDigest, records);
+  journal.append({ makeRecord("first") });
+
+  Crypto::Hash newDigest = Crypto::rand<Crypto::Hash>();
+  journal.reset(newDigest);
+  journal.append({ makeRecord("second") });
+  ASSERT_EQ(1, journal.recordCount());
+  journal.close();
+
+  records = reopen(key, newDigest);
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ(makeRecord("second"), records[0]);
+}
+
+}
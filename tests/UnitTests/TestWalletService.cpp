@@ -27,6 +27,7 @@
 #include "Logging/LoggerGroup.h"
 #include "Logging/ConsoleLogger.h"
 #include <System/Event.h>
+#include "PaymentGate/PaymentServiceJsonRpcServer.h"
 #include "PaymentGate/WalletService.h"
 #include "PaymentGate/WalletServiceErrorCategory.h"
 #include "INodeStubs.h"
@@ -86,6 +87,8 @@ struct IWalletBaseStub : public CryptoNote::IWallet, public CryptoNote::IFusionM
   virtual WalletTransactionWithTransfers getTransaction(const Crypto::Hash& transactionHash) const override { return WalletTransactionWithTransfers(); }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count) const override { return {}; }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, const Crypto::Hash& blockHash, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const override { return {}; }
   virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t blockIndex, size_t count) const override { return {}; }
   virtual uint32_t getBlockCount() const override { return 0; }
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const override { return {}; }
@@ -549,7 +552,18 @@ public:
     return transactions;
   }
 
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, const Crypto::Hash& blockHash, size_t count) const override {
+    requestedAddresses = addresses;
+    return transactions;
+  }
+
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const override {
+    requestedAddresses = addresses;
+    return transactions;
+  }
+
   std::vector<TransactionsInBlockInfo> transactions;
+  mutable std::vector<std::string> requestedAddresses;
 };
 
 TEST_F(WalletServiceTest_getTransactions, addressesFilter_emptyReturnsTransaction) {
@@ -612,6 +626,23 @@ TEST_F(WalletServiceTest_getTransactions, addressesFilter_existentAndNonExistent
   ASSERT_EQ(Common::podToHex(testTransactions[0].transactions[0].transaction.hash), transactions[0].transactions[0].transactionHash);
 }
 
+TEST_F(WalletServiceTest_getTransactions, addressesFilter_isPassedToWallet) {
+  WalletGetTransactionsStub wallet(dispatcher);
+  wallet.transactions = testTransactions;
+
+  CryptoNote::AccountBase account;
+  account.generate();
+  std::string address = currency.accountAddressAsString(account);
+
+  auto service = createWalletService(wallet);
+
+  std::vector<TransactionsInBlockRpcInfo> transactions;
+  auto ec = service->getTransactions({address, address}, 0, 1, "", transactions);
+
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(std::vector<std::string>{address}, wallet.requestedAddresses);
+}
+
 TEST_F(WalletServiceTest_getTransactions, paymentIdFilter_existentReturnsTransaction) {
   WalletGetTransactionsStub wallet(dispatcher);
   wallet.transactions = testTransactions;
@@ -1197,3 +1228,74 @@ TEST_F(WalletServiceTest_estimateFusion, returnsDataReceivedFromWallet) {
   ASSERT_EQ(wallet.TEST_FUSION_READY_COUNT, fusionReadyCount);
   ASSERT_EQ(wallet.TEST_TOTAL_OUTPUT_COUNT, totalOutputCount);
 }
+
+class PaymentServiceJsonRpcServerStub : public PaymentServiceJsonRpcServer {
+public:
+  using PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer;
+
+  Common::JsonValue call(const std::string& request) {
+    Common::JsonValue response(Common::JsonValue::OBJECT);
+    processJsonRpcRequest(Common::JsonValue::fromString(request), response);
+    return response;
+  }
+};
+
+class WalletServiceTest_containerRouting : public WalletServiceTest {
+public:
+  WalletServiceTest_containerRouting() : stopEvent(dispatcher), aliceWallet(dispatcher), bobWallet(dispatcher) {
+  }
+
+  virtual void SetUp() override {
+    WalletServiceTest::SetUp();
+    aliceService = createWalletService(aliceWallet);
+    bobService = createWalletService(bobWallet);
+  }
+
+  std::string errorMessage(const Common::JsonValue& response) {
+    return response("error")("message").getString();
+  }
+
+  System::Event stopEvent;
+  WalletGetViewKeyStub aliceWallet;
+  WalletGetViewKeyStub bobWallet;
+  std::unique_ptr<WalletService> aliceService;
+  std::unique_ptr<WalletService> bobService;
+};
+
+TEST_F(WalletServiceTest_containerRouting, requestIsServedByNamedContainer) {
+  PaymentServiceJsonRpcServerStub server(dispatcher, stopEvent, {{"alice", aliceService.get()}, {"bob", bobService.get()}}, logger);
+
+  auto response = server.call(R"({"jsonrpc": "2.0", "id": 1, "method": "getViewKey", "params": {"container": "bob"}})");
+  ASSERT_EQ(Common::podToHex(bobWallet.keyPair.secretKey), response("result")("viewSecretKey").getString());
+
+  response = server.call(R"({"jsonrpc": "2.0", "id": 2, "method": "getViewKey", "params": {"container": "alice"}})");
+  ASSERT_EQ(Common::podToHex(aliceWallet.keyPair.secretKey), response("result")("viewSecretKey").getString());
+}
+
+TEST_F(WalletServiceTest_containerRouting, unknownContainerIsNotFound) {
+  PaymentServiceJsonRpcServerStub server(dispatcher, stopEvent, {{"alice", aliceService.get()}, {"bob", bobService.get()}}, logger);
+
+  auto response = server.call(R"({"jsonrpc": "2.0", "id": 1, "method": "getViewKey", "params": {"container": "carol"}})");
+  ASSERT_FALSE(response.contains("result"));
+  ASSERT_EQ("Container not found", errorMessage(response));
+}
+
+TEST_F(WalletServiceTest_containerRouting, missingContainerIsNotFound) {
+  PaymentServiceJsonRpcServerStub server(dispatcher, stopEvent, {{"alice", aliceService.get()}, {"bob", bobService.get()}}, logger);
+
+  auto response = server.call(R"({"jsonrpc": "2.0", "id": 1, "method": "getViewKey", "params": {}})");
+  ASSERT_EQ("Container not found", errorMessage(response));
+
+  response = server.call(R"({"jsonrpc": "2.0", "id": 2, "method": "getViewKey", "params": {"container": 1}})");
+  ASSERT_EQ("Container not found", errorMessage(response));
+}
+
+TEST_F(WalletServiceTest_containerRouting, singleContainerIgnoresContainerParameter) {
+  PaymentServiceJsonRpcServerStub server(dispatcher, stopEvent, *aliceService, logger);
+
+  auto response = server.call(R"({"jsonrpc": "2.0", "id": 1, "method": "getViewKey", "params": {"container": "bob"}})");
+  ASSERT_EQ(Common::podToHex(aliceWallet.keyPair.secretKey), response("result")("viewSecretKey").getString());
+
+  response = server.call(R"({"jsonrpc": "2.0", "id": 2, "method": "getViewKey"})");
+  ASSERT_EQ(Common::podToHex(aliceWallet.keyPair.secretKey), response("result")("viewSecretKey").getString());
+}